@@ -57,6 +57,17 @@ function matmul_mknk_repro() {
   (${COMMAND} --expert_list DoubleTile2DPadAndHoist --problem_sizes_list 1920,2304,2304 --n_iters=200)
 }
 
+# Compares peeling with the padded, out-of-bounds transfers of
+# vectorize_with_masking. This does not exercise vector.predicate masking.
+function matmul_masking_vs_peeling_repro() {
+  COMMAND="cset proc -s sandbox_parallel -e python -- -m python.examples.matmul.bench --spec_list mk,kn ${DUMP_DATA_FLAG} --dynamic_at_compile_time_list [] "
+
+  (${COMMAND} --expert_list SingleTiling3DPeel SingleTiling3DMask SingleTiling3DAutoMask --problem_sizes_list 17,33,19 --n_iters=200)
+  (${COMMAND} --expert_list SingleTiling3DPeel SingleTiling3DMask SingleTiling3DAutoMask --problem_sizes_list 131,67,95 --n_iters=200)
+  (${COMMAND} --expert_list SingleTiling3DPeel SingleTiling3DMask SingleTiling3DAutoMask --problem_sizes_list 260,280,300 --n_iters=200)
+  (${COMMAND} --expert_list SingleTiling3DPeel SingleTiling3DMask SingleTiling3DAutoMask --problem_sizes_list 1020,1021,1022 --n_iters=200)
+}
+
 function run_matmul_benchmarks_n_times() {
   if (test -z "$1") || (test -z "$2")
   then
@@ -9,6 +9,7 @@
 
 #include "Dialect/LinalgExt/IR/LinalgExtInterfaces.h"
 #include "Dialect/LinalgExt/IR/TiledOpInterface.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Dialect.h"
@@ -19,6 +19,8 @@ std::unique_ptr<OperationPass<func::FuncOp>> createTiledOpInterfaceTilingPass();
 
 std::unique_ptr<OperationPass<func::FuncOp>> createLinalgExtToLoopsPass();
 
+std::unique_ptr<OperationPass<func::FuncOp>> createTopkSplitReductionPass();
+
 std::unique_ptr<OperationPass<>> createPadContractionToBlockSizePass();
 
 void registerTilingInterfaceExternalModels(DialectRegistry &registry);
@@ -59,9 +59,14 @@ struct TileOpToSCFRewriter : public OpRewritePattern<TileOp> {
   }
 };
 
-/// Pattern to rewrite a TileOp to a InParallelOp.
+/// Pattern to rewrite a TileOp to a InParallelOp with the given schedule and
+/// chunk size.
 struct TileOpToInParallelRewriter : public OpRewritePattern<TileOp> {
-  using OpRewritePattern::OpRewritePattern;
+  TileOpToInParallelRewriter(MLIRContext *context,
+                             StringRef schedule = "static",
+                             int64_t chunkSize = 1)
+      : OpRewritePattern<TileOp>(context), schedule(schedule.str()),
+        chunkSize(chunkSize) {}
 
   FailureOr<InParallelOp>
   returningMatchAndRewrite(TileOp tileOp, PatternRewriter &rewriter) const;
@@ -70,12 +75,37 @@ struct TileOpToInParallelRewriter : public OpRewritePattern<TileOp> {
                                 PatternRewriter &rewriter) const override {
     return returningMatchAndRewrite(tileOp, rewriter);
   }
+
+private:
+  std::string schedule;
+  int64_t chunkSize;
 };
 
-/// Pattern to rewrite a InParallelOp to the async dialect.
-struct InParallelOpToAsyncRewriter : public OpRewritePattern<InParallelOp> {
+/// Pattern to flatten a bufferized InParallelOp into its parent InParallelOp,
+/// which then iterates over the product of the numbers of threads of the two
+/// levels. Only applies if both ops have the static schedule.
+struct InParallelOpFlatteningRewriter : public OpRewritePattern<InParallelOp> {
   using OpRewritePattern::OpRewritePattern;
 
+  FailureOr<InParallelOp>
+  returningMatchAndRewrite(InParallelOp inParallelOp,
+                           PatternRewriter &rewriter) const;
+
+  LogicalResult matchAndRewrite(InParallelOp inParallelOp,
+                                PatternRewriter &rewriter) const override {
+    return returningMatchAndRewrite(inParallelOp, rewriter);
+  }
+};
+
+/// Pattern to rewrite a InParallelOp to the async dialect. Every async task
+/// executes `blockSize` consecutive iterations of the InParallelOp. A nested
+/// InParallelOp is flattened into its parent instead, which is rewritten once
+/// all its nested InParallelOps have been flattened, unless either of them has
+/// a dynamic or guided schedule.
+struct InParallelOpToAsyncRewriter : public OpRewritePattern<InParallelOp> {
+  InParallelOpToAsyncRewriter(MLIRContext *context, int64_t blockSize = 1)
+      : OpRewritePattern<InParallelOp>(context), blockSize(blockSize) {}
+
   FailureOr<Operation *>
   returningMatchAndRewrite(InParallelOp inParallelOp,
                            PatternRewriter &rewriter) const;
@@ -84,6 +114,9 @@ struct InParallelOpToAsyncRewriter : public OpRewritePattern<InParallelOp> {
                                 PatternRewriter &rewriter) const override {
     return returningMatchAndRewrite(inParallelOp, rewriter);
   }
+
+private:
+  int64_t blockSize;
 };
 
 /// Pattern to rewrite a InParallelOp to the HAL dialect.
@@ -114,6 +147,166 @@ struct InParallelOpToScfForRewriter : public OpRewritePattern<InParallelOp> {
   }
 };
 
+/// Pattern to rewrite a SoftmaxOp to linalg.generic ops implementing the
+/// online normalization.
+struct SoftmaxOpToLinalgRewriter : public OpRewritePattern<SoftmaxOp> {
+  using OpRewritePattern::OpRewritePattern;
+
+  FailureOr<linalg::GenericOp>
+  returningMatchAndRewrite(SoftmaxOp softmaxOp,
+                           PatternRewriter &rewriter) const;
+
+  LogicalResult matchAndRewrite(SoftmaxOp softmaxOp,
+                                PatternRewriter &rewriter) const override {
+    return returningMatchAndRewrite(softmaxOp, rewriter);
+  }
+};
+
+/// Pattern to rewrite a PackOp to a linalg.generic transposing the padded and
+/// expanded input.
+struct PackOpToLinalgRewriter : public OpRewritePattern<PackOp> {
+  using OpRewritePattern::OpRewritePattern;
+
+  FailureOr<linalg::GenericOp>
+  returningMatchAndRewrite(PackOp packOp, PatternRewriter &rewriter) const;
+
+  LogicalResult matchAndRewrite(PackOp packOp,
+                                PatternRewriter &rewriter) const override {
+    return returningMatchAndRewrite(packOp, rewriter);
+  }
+};
+
+/// Pattern to rewrite an UnPackOp to a linalg.generic transposing the input
+/// followed by the collapse and the extraction of the unpadded output.
+struct UnPackOpToLinalgRewriter : public OpRewritePattern<UnPackOp> {
+  using OpRewritePattern::OpRewritePattern;
+
+  FailureOr<linalg::GenericOp>
+  returningMatchAndRewrite(UnPackOp unpackOp, PatternRewriter &rewriter) const;
+
+  LogicalResult matchAndRewrite(UnPackOp unpackOp,
+                                PatternRewriter &rewriter) const override {
+    return returningMatchAndRewrite(unpackOp, rewriter);
+  }
+};
+
+/// Pattern to rewrite a 3x3 stride-1 linalg.conv_2d_nhwc_hwcf into the
+/// Winograd transform ops of F(m x m, 3 x 3), where m is `outputTileSize`,
+/// around a linalg.batch_matmul.
+struct ConvOpToWinogradRewriter
+    : public OpRewritePattern<linalg::Conv2DNhwcHwcfOp> {
+  ConvOpToWinogradRewriter(MLIRContext *context, int64_t outputTileSize)
+      : OpRewritePattern<linalg::Conv2DNhwcHwcfOp>(context),
+        outputTileSize(outputTileSize) {}
+
+  FailureOr<linalg::BatchMatmulOp>
+  returningMatchAndRewrite(linalg::Conv2DNhwcHwcfOp convOp,
+                           PatternRewriter &rewriter) const;
+
+  LogicalResult matchAndRewrite(linalg::Conv2DNhwcHwcfOp convOp,
+                                PatternRewriter &rewriter) const override {
+    return returningMatchAndRewrite(convOp, rewriter);
+  }
+
+private:
+  int64_t outputTileSize;
+};
+
+/// Pattern to rewrite a 1-D SortOp into a parallel merge sort over
+/// `numThreads` threads: the chunks of the operands are sorted independently
+/// in an InParallelOp and the sorted runs are then merged pairwise in
+/// InParallelOps partitioned along the merge path.
+struct SortOpToParallelMergeSortRewriter : public OpRewritePattern<SortOp> {
+  SortOpToParallelMergeSortRewriter(MLIRContext *context, int64_t numThreads)
+      : OpRewritePattern<SortOp>(context), numThreads(numThreads) {}
+
+  FailureOr<InParallelOp>
+  returningMatchAndRewrite(SortOp sortOp, PatternRewriter &rewriter) const;
+
+  LogicalResult matchAndRewrite(SortOp sortOp,
+                                PatternRewriter &rewriter) const override {
+    return returningMatchAndRewrite(sortOp, rewriter);
+  }
+
+private:
+  int64_t numThreads;
+};
+
+/// Pattern to pad the operands of a row-major linalg matmul on tensors to
+/// multiples of `rowAlignment` along M and K and `columnAlignment` along N. If
+/// `vectorBitWidth` is positive, the dimensions that are contiguous in an
+/// operand (K in the lhs, N in the rhs and the output) are further aligned to
+/// full vectors of that many bits. The matmul is padded unconditionally if a
+/// static dimension is misaligned. Otherwise, an scf.if checks the dynamic
+/// dimensions at runtime and dispatches to the unpadded matmul when they are
+/// all aligned, to a padded copy otherwise. Returns the padded matmul.
+struct PadContractionToBlockSizeRewriter
+    : public OpInterfaceRewritePattern<linalg::LinalgOp> {
+  PadContractionToBlockSizeRewriter(MLIRContext *context, int64_t rowAlignment,
+                                    int64_t columnAlignment,
+                                    int64_t vectorBitWidth = 0,
+                                    PatternBenefit benefit = 1)
+      : OpInterfaceRewritePattern<linalg::LinalgOp>(context, benefit),
+        rowAlignment(rowAlignment), columnAlignment(columnAlignment),
+        vectorBitWidth(vectorBitWidth) {}
+
+  FailureOr<linalg::LinalgOp>
+  returningMatchAndRewrite(linalg::LinalgOp linalgOp,
+                           PatternRewriter &rewriter) const;
+
+  LogicalResult matchAndRewrite(linalg::LinalgOp linalgOp,
+                                PatternRewriter &rewriter) const override {
+    return returningMatchAndRewrite(linalgOp, rewriter);
+  }
+
+private:
+  int64_t rowAlignment;
+  int64_t columnAlignment;
+  int64_t vectorBitWidth;
+};
+
+/// Pattern to lower an op implementing the TiledOpInterface with buffer
+/// semantics to a nest of scf.for ops, one per loop of its iteration domain,
+/// around its scalar implementation. Returns the loops, outermost first.
+struct TiledOpInterfaceToLoopsRewriter
+    : public OpInterfaceRewritePattern<TiledOpInterface> {
+  using OpInterfaceRewritePattern::OpInterfaceRewritePattern;
+
+  FailureOr<SmallVector<scf::ForOp>>
+  returningMatchAndRewrite(TiledOpInterface tiledOp,
+                           PatternRewriter &rewriter) const;
+
+  LogicalResult matchAndRewrite(TiledOpInterface tiledOp,
+                                PatternRewriter &rewriter) const override {
+    return returningMatchAndRewrite(tiledOp, rewriter);
+  }
+};
+
+struct TopkSplitReductionResult {
+  TopkOp splitTopkOp;
+  TopkOp mergeTopkOp;
+};
+
+/// Pattern to split the top-k dimension of a static TopkOp into `splitRatio`
+/// chunks: a parallel TopkOp selects the top-k of every chunk and a second
+/// TopkOp merges the candidates of all chunks into the original outputs.
+struct TopkOpSplitReductionRewriter : public OpRewritePattern<TopkOp> {
+  TopkOpSplitReductionRewriter(MLIRContext *context, int64_t splitRatio,
+                               PatternBenefit benefit = 1)
+      : OpRewritePattern<TopkOp>(context, benefit), splitRatio(splitRatio) {}
+
+  FailureOr<TopkSplitReductionResult>
+  returningMatchAndRewrite(TopkOp topkOp, PatternRewriter &rewriter) const;
+
+  LogicalResult matchAndRewrite(TopkOp topkOp,
+                                PatternRewriter &rewriter) const override {
+    return returningMatchAndRewrite(topkOp, rewriter);
+  }
+
+private:
+  int64_t splitRatio;
+};
+
 struct FusionResult {
   linalg::LinalgOp consumerOp;
   SmallVector<linalg::LinalgOp> fusedOps;
@@ -139,6 +332,30 @@ private:
   SmallVector<int64_t> operandsToFuse;
 };
 
+/// Pattern to fuse an elementwise LinalgOp into the TileOp or InParallelOp
+/// producing its `operandToFuse`-th operand. The consumer is applied to each
+/// tile of the producer inside the loop, which returns the consumer result as
+/// an additional result. The results of the InParallelOp that are only used by
+/// the consumer are not returned anymore.
+struct LinalgExtConsumerFusionPattern
+    : public OpInterfaceRewritePattern<linalg::LinalgOp> {
+  LinalgExtConsumerFusionPattern(MLIRContext *context, int64_t operandToFuse)
+      : OpInterfaceRewritePattern<linalg::LinalgOp>(context),
+        operandToFuse(operandToFuse) {}
+
+  FailureOr<Operation *>
+  returningMatchAndRewrite(linalg::LinalgOp consumerOp,
+                           PatternRewriter &rewriter) const;
+
+  LogicalResult matchAndRewrite(linalg::LinalgOp consumerOp,
+                                PatternRewriter &rewriter) const override {
+    return returningMatchAndRewrite(consumerOp, rewriter);
+  }
+
+private:
+  int64_t operandToFuse;
+};
+
 } // namespace LinalgExt
 } // namespace IREE
 } // namespace iree_compiler
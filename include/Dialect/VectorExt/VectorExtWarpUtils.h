@@ -19,8 +19,26 @@ class TransferWriteOp;
 }
 namespace vector_ext {
 
-/// Collect patterns to propagate warp distribution.
-void populatePropagateVectorDistributionPatterns(RewritePatternSet &pattern);
+/// Lamdba function to let users emit the shuffles exchanging values between the
+/// lanes of a warp, e.g. for the reductions across the lanes.
+/// The function needs to return the value `val`, a scalar or a vector, of the
+/// lane whose id is the id of the current lane xor `offset`, in a warp of
+/// `warpSize` lanes.
+using WarpShuffleFn =
+    std::function<Value(Location, OpBuilder &, Value, int64_t, int64_t)>;
+
+/// Collect patterns to propagate warp distribution. The reductions across the
+/// lanes use butterflies of shuffles emitted with `shuffleFn`, which defaults
+/// to gpu.shuffle xor ops of 32-bit scalars.
+void populatePropagateVectorDistributionPatterns(
+    RewritePatternSet &pattern, WarpShuffleFn shuffleFn = nullptr);
+
+/// Collect patterns to rewrite vector.reduction ops of 1-D vectors whose size
+/// is a power of two to butterflies of in-register vector.shuffle ops. This
+/// gives log-depth reductions on CPU, e.g. in the regions of warp ops lowered
+/// with `populateWarpLaneLoopToCpuPatterns`.
+void populateVectorReductionToButterflyShufflePatterns(
+    RewritePatternSet &patterns);
 
 /// Lamdba function to let users allocate memory needed for the lowering of
 /// WarpExecuteOnLane0Op.
@@ -35,6 +53,35 @@ using WarpAllocationFn =
 void populateWarpExecuteOnLane0OpToScfForPattern(RewritePatternSet &patterns,
                                                  WarpAllocationFn allocationFn);
 
+/// Lower the WarpExecuteOnLane0Ops nested in loops over the lanes of the warp
+/// for execution on CPU. Every loop is split around its warp ops, whose region
+/// executes once for all the lanes on the full vectors. The values exchanged
+/// between the lanes and the region go through buffers allocated with
+/// `allocationFn`. If `parallelLanes` is set, the lanes are executed by
+/// scf.parallel ops, e.g. on the worker threads of the async runtime.
+/// Example:
+/// ```
+/// scf.for %laneid = %c0 to %c32 step %c1 {
+///   %r = vector_ext.warp_execute_on_lane_0(%laneid)[32] -> (vector<1xf32>) {
+///     ...
+///     vector_ext.yield %0 : vector<32xf32>
+///   }
+///   "some_use"(%r) : (vector<1xf32>) -> ()
+/// }
+/// ```
+/// To
+/// ```
+/// ...
+/// vector.store %0, %buffer[%c0] : memref<32xf32>, vector<32xf32>
+/// scf.for %laneid = %c0 to %c32 step %c1 {
+///   %r = vector.load %buffer[%laneid] : memref<32xf32>, vector<1xf32>
+///   "some_use"(%r) : (vector<1xf32>) -> ()
+/// }
+/// ```
+void populateWarpLaneLoopToCpuPatterns(RewritePatternSet &patterns,
+                                       WarpAllocationFn allocationFn,
+                                       bool parallelLanes = false);
+
 using DistributionMapFn = std::function<AffineMap(vector::TransferWriteOp)>;
 
 /// Distribute transfer_write ops based on the affine map returned by
@@ -59,6 +59,18 @@ void maskGenericOpWithSideEffects(
     OpBuilder &builder, Operation *op, Value activeMask, const WalkStage &stage,
     llvm::SmallVectorImpl<Operation *> &erasedOps);
 
+/// Masking strategy that masks the operations masked by
+/// `maskGenericOpWithSideEffects` and vector.fma operations. The masked-off
+/// lanes of a masked vector.fma keep the value of its accumulator, which
+/// lowers to a merge-masked FMA on targets with mask registers (e.g., AVX-512).
+/// Like `maskVectorPredicateOps`, it only applies to vector.predicate regions,
+/// which the tiling experts do not create: their partial tiles are peeled,
+/// padded, or vectorized with zero-padded out-of-bounds transfers that leave
+/// the accumulators unchanged.
+void maskGenericOpWithSideEffectsAndFMAs(
+    OpBuilder &builder, Operation *op, Value activeMask, const WalkStage &stage,
+    llvm::SmallVectorImpl<Operation *> &erasedOps);
+
 // TODO: Implement full masking strategy.
 
 } // namespace vector_ext
@@ -0,0 +1,96 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Entry points of the sandbox copy of the async runtime that do not exist in
+// the upstream MLIR async runtime.
+
+#ifndef IREE_LLVM_SANDBOX_EXECUTIONENGINE_ASYNCRUNTIMEEXTENSIONS_H
+#define IREE_LLVM_SANDBOX_EXECUTIONENGINE_ASYNCRUNTIMEEXTENSIONS_H
+
+#include "mlir/ExecutionEngine/AsyncRuntime.h"
+
+namespace mlir {
+namespace runtime {
+
+//===----------------------------------------------------------------------===//
+// Worker placement.
+//===----------------------------------------------------------------------===//
+
+// Returns the number of worker threads of the async runtime.
+extern "C" MLIR_ASYNCRUNTIME_EXPORT int64_t
+mlirAsyncRuntimeGetNumWorkerThreads();
+
+// Executes the callback on the worker `workerIndex` modulo the number of
+// workers. The same index always maps to the same worker thread, such that
+// the tasks processing the same data in repeated kernel invocations find it in
+// the caches and in the NUMA node of their worker.
+//
+// The in_parallel lowering does not emit it: `async.execute` has no worker
+// operand, and the upstream async to LLVM conversion always calls
+// `mlirAsyncRuntimeExecute`. Only hand-written callers bind tasks to workers.
+extern "C" MLIR_ASYNCRUNTIME_EXPORT void
+mlirAsyncRuntimeExecuteOnWorker(int64_t workerIndex, CoroHandle, CoroResume);
+
+// Zeroes the buffer in parallel, such that its pages are first touched, and
+// thus allocated in the NUMA node, of the workers that will process them. The
+// buffer is split in one contiguous chunk per worker, with page aligned
+// boundaries: the i-th chunk is zeroed by the worker `i`. Returns once the
+// whole buffer is zeroed.
+//
+// The previous contents of the buffer are overwritten with zeros: call it
+// right after the allocation, before the buffer is initialized.
+extern "C" MLIR_ASYNCRUNTIME_EXPORT void
+mlirAsyncRuntimeFirstTouch(void *data, int64_t sizeInBytes);
+
+//===----------------------------------------------------------------------===//
+// Parallel loops.
+//===----------------------------------------------------------------------===//
+
+// Body of a parallel loop, runs the iterations [begin, end).
+using ParallelForBody = void (*)(int64_t begin, int64_t end, void *ctx);
+
+// Runs the iterations [begin, end) of a parallel loop on the persistent
+// workers of the async runtime and returns once all of them completed. The
+// iterations are split in chunks of `grain` iterations, and the chunks in one
+// contiguous part per worker: the i-th part always runs on the i-th worker,
+// such that it finds the data first touched by `mlirAsyncRuntimeFirstTouch`
+// or used by the previous invocations in its caches and NUMA node. Unlike the
+// `async` dialect lowering, this creates no token, group or coroutine: the
+// overhead of a parallel region is that of a barrier.
+//
+// No lowering targets this entry point yet: the in_parallel lowering emits
+// `async.execute` ops, and calling a C function pointer with the captures
+// packed in `ctx` requires outlining the body at the LLVM dialect level. Its
+// only caller is the async-runtime-bench.
+extern "C" MLIR_ASYNCRUNTIME_EXPORT void
+mlirAsyncRuntimeParallelFor(int64_t begin, int64_t end, int64_t grain,
+                            ParallelForBody body, void *ctx);
+
+//===----------------------------------------------------------------------===//
+// Allocation counters.
+//===----------------------------------------------------------------------===//
+
+// Counters of the memory allocations performed by the async runtime objects.
+// Pooled allocations reuse the blocks released by previous objects, only the
+// heap allocations call the system allocator.
+struct AsyncRuntimeAllocationCounters {
+  int64_t numPooledAllocations;
+  int64_t numHeapAllocations;
+  int64_t numHeapDeallocations;
+};
+
+// Returns the allocation counters accumulated since the process started.
+extern "C" MLIR_ASYNCRUNTIME_EXPORT AsyncRuntimeAllocationCounters
+mlirAsyncRuntimeGetAllocationCounters();
+
+// Prints the allocation counters to the standard output.
+extern "C" MLIR_ASYNCRUNTIME_EXPORT void
+mlirAsyncRuntimePrintAllocationCounters();
+
+} // namespace runtime
+} // namespace mlir
+
+#endif // IREE_LLVM_SANDBOX_EXECUTIONENGINE_ASYNCRUNTIMEEXTENSIONS_H
@@ -29,6 +29,9 @@ std::unique_ptr<OperationPass<FuncOp>> createLinalgFusePass();
 std::unique_ptr<OperationPass<FuncOp>>
 createLinalgFuseOutputIntoReductionPass();
 
+/// Creates a pass to split reductions into partial results and their combine.
+std::unique_ptr<OperationPass<FuncOp>> createLinalgSplitReductionPass();
+
 /// Creates a pass to drive one-level tile + vectorization.
 std::unique_ptr<OperationPass<FuncOp>> createLinalgSingleTilingExpertPass();
 
@@ -15,8 +15,55 @@
 namespace mlir {
 namespace linalg {
 
+/// Returns the single op combining the region output argument of `linalg_op`
+/// with the value it reduces, e.g. the `arith.addf` of a sum.
+FailureOr<Operation *> DetectCombiner(LinalgOp linalg_op);
+
 void populateFuseFillIntoReductionPatterns(RewritePatternSet &patterns);
 
+/// Splits the single reduction dimension of `op`, of static size N, into a
+/// parallel dimension of size `ratio` and a reduction dimension of size
+/// N / `ratio`. The parallel dimension is the outer one, i.e. each of its
+/// iterations reduces a contiguous chunk, unless `innerParallel` is set, in
+/// which case it is the inner one, i.e. consecutive elements are reduced in
+/// different iterations. The returned op reduces into a partial result tensor
+/// that has the parallel dimension leading, respectively trailing, and that is
+/// initialized with the neutral element of the combiner. It is followed by an
+/// op reducing the partial results into the original output with the same
+/// combiner, which replaces `op`.
+FailureOr<GenericOp> splitReduction(RewriterBase &rewriter, GenericOp op,
+                                    int64_t ratio, bool innerParallel);
+
+/// Ways of handling the partial last tile of a tiled loop.
+enum class PartialTileStrategy {
+  /// Leave the loop as is, e.g. because it has no partial tile.
+  None,
+  /// Peel the partial last iteration out of the loop.
+  Peel,
+  /// Pad the partial tile to the full tile size.
+  Pad,
+  /// Leave the partial tile to the masked vectorization, which pads it without
+  /// copies by folding the padding into out-of-bounds vector transfers.
+  Mask,
+};
+
+/// Chooses how to handle the partial last tile of a loop tiling a dimension of
+/// size `size`, possibly dynamic, by `tileSize`. The choice is based on a cost
+/// model weighing the computation wasted on the padding and the copies into
+/// the padded tiles against the less efficient execution of a peeled partial
+/// tile. `canPad` tells whether padding the dimension is legal, e.g. it is not
+/// for a reduction dimension whose combiner is not neutral on the padding
+/// value. `canMask` tells whether the tiled op is vectorized with masking, in
+/// which case masking is also considered for the paddable dimensions.
+PartialTileStrategy choosePartialTileStrategy(int64_t size, int64_t tileSize,
+                                              bool canPad,
+                                              bool canMask = false);
+
+/// Returns the dimensions of `linalgOp` that can be padded with zeros without
+/// changing its results: the parallel dimensions and, for contractions, the
+/// reduction dimensions whose combiner is neutral on zero.
+SmallVector<int64_t> getZeroPaddableDims(LinalgOp linalgOp);
+
 void populateTiledLoopsToSCF(RewritePatternSet &patterns);
 
 void populateDistributeTiledLoopPattern(
@@ -16,6 +16,7 @@
 #include "mlir/Dialect/SCF/SCF.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/Dialect/Utils/StructuredOpsUtils.h"
+#include "mlir/Dialect/Vector/IR/VectorOps.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/Diagnostics.h"
@@ -80,6 +81,29 @@ static Value getSlice(OpBuilder &b, Location loc, Value source,
       .Default([&](Type t) { return nullptr; });
 }
 
+/// Returns the offset `tileOffset * tileStride` and the size
+/// `min(tileSize * tileStride + halo, dimSize - offset)` of the slice of a
+/// dimension covered by the tiles [tileOffset, tileOffset + tileSize) of a
+/// dimension split into tiles of `tileStride` elements, each extended by
+/// `halo` elements.
+static std::pair<OpFoldResult, OpFoldResult>
+getSliceOfTiles(OpBuilder &b, Location loc, OpFoldResult tileOffset,
+                OpFoldResult tileSize, Value dimSize, int64_t tileStride,
+                int64_t halo) {
+  AffineExpr d0, d1, s0;
+  bindDims(b.getContext(), d0, d1);
+  bindSymbols(b.getContext(), s0);
+  Value offsetValue = getValueOrCreateConstantIndexOp(b, loc, tileOffset);
+  Value sizeValue = getValueOrCreateConstantIndexOp(b, loc, tileSize);
+  Value offset = b.create<AffineApplyOp>(
+      loc, AffineMap::get(1, 0, d0 * tileStride), offsetValue);
+  AffineMap sizeMap = AffineMap::get(
+      2, 1, {d0 * tileStride + halo, s0 - d1 * tileStride}, b.getContext());
+  Value size = b.create<AffineMinOp>(
+      loc, sizeMap, ValueRange{sizeValue, offsetValue, dimSize});
+  return {offset, size};
+}
+
 Value IREE::LinalgExt::getDimValue(OpBuilder &builder, Location loc, Value v,
                                    int64_t dim) {
   return TypeSwitch<Type, Value>(v.getType())
@@ -1180,214 +1204,1736 @@ Operation *ReverseOp::getTiledImplementation(OpBuilder &builder,
   return tiledRevOp;
 }
 
-#define DEFINE_OP_GET_EFFECTS(OP_NAME)                                         \
-  void OP_NAME::getEffects(                                                    \
-      SmallVectorImpl<SideEffects::EffectInstance<MemoryEffects::Effect>>      \
-          &effects) {                                                          \
-    SmallVector<Value> inputBuffers = getInputBufferOperands();                \
-    SmallVector<Value> outputBuffers = getOutputBufferOperands();              \
-    getEffectsImpl(effects, getOperation()->getResults(), inputBuffers,        \
-                   outputBuffers);                                             \
-  }
+//===----------------------------------------------------------------------===//
+// TopkOp
+//===----------------------------------------------------------------------===//
 
-DEFINE_OP_GET_EFFECTS(ScatterOp)
-DEFINE_OP_GET_EFFECTS(SortOp)
-DEFINE_OP_GET_EFFECTS(FftOp)
-DEFINE_OP_GET_EFFECTS(ReverseOp)
-DEFINE_OP_GET_EFFECTS(ScanOp)
+/// Largest static `k` for which the scalar implementation keeps the running
+/// top-k in a vector and inserts every element with a single shuffle.
+static constexpr int64_t kMaxVectorizedTopkSize = 16;
 
-namespace {
-/// This is derived from mlir/lib/Dialect/Linalg/IR/LinalgOps.cpp without any
-/// changes.
-struct FoldTensorCastOp : public OpInterfaceRewritePattern<LinalgExtOp> {
-  using OpInterfaceRewritePattern<LinalgExtOp>::OpInterfaceRewritePattern;
+LogicalResult TopkOp::verify() {
+  Operation *op = getOperation();
+  if (getNumInputs() != 1 && getNumInputs() != 2) {
+    return op->emitOpError("expected one or two input operands");
+  }
+  if (getNumOutputs() != 2) {
+    return op->emitOpError("expected two output operands");
+  }
 
-  LogicalResult matchAndRewrite(LinalgExtOp op,
-                                PatternRewriter &rewriter) const override {
-    // If no operand comes from a tensor::CastOp and can be folded then fail.
-    bool hasTensorCastOperand =
-        llvm::any_of(op.getInputAndOutputOperands(), [&](OpOperand *opOperand) {
-          if (opOperand->get().isa<BlockArgument>())
-            return false;
-          auto castOp = opOperand->get().getDefiningOp<tensor::CastOp>();
-          return castOp && canFoldIntoConsumerOp(castOp);
-        });
-    if (!hasTensorCastOperand)
-      return failure();
+  int64_t rank = getInputRank();
+  int64_t topkDim = dimension();
+  if (topkDim < 0 || topkDim >= rank) {
+    return op->emitOpError("dimension must be within [0, ") << rank << ")";
+  }
 
-    SmallVector<Type, 4> newResultTypes;
-    newResultTypes.reserve(op->getNumResults());
-    SmallVector<Value, 4> newOperands;
-    newOperands.reserve(op->getNumOperands());
-    // Inputs may fold.
-    for (OpOperand *opOperand : op.getInputOperands()) {
-      auto tensorCastOp = opOperand->get().getDefiningOp<tensor::CastOp>();
-      newOperands.push_back(canFoldIntoConsumerOp(tensorCastOp)
-                                ? tensorCastOp.source()
-                                : opOperand->get());
+  ShapedType inputValuesType = getInputType();
+  auto outputValuesType = getOutputType();
+  auto outputIndicesType = outputIndices().getType().cast<ShapedType>();
+  Type elementType = inputValuesType.getElementType();
+  if (outputValuesType.getElementType() != elementType) {
+    return op->emitOpError(
+        "expected input/output value element types to be identical");
+  }
+  if (!outputIndicesType.getElementType().isInteger(32)) {
+    return op->emitOpError("expected output indices to be of type i32");
+  }
+  if (Value inputIndices = indices()) {
+    auto inputIndicesType = inputIndices.getType().cast<ShapedType>();
+    if (!inputIndicesType.getElementType().isInteger(32)) {
+      return op->emitOpError("expected input indices to be of type i32");
     }
-    // Init tensors may fold, in which case the resultType must also change.
-    for (OpOperand *opOperand : op.getOutputOperands()) {
-      auto tensorCastOp = opOperand->get().getDefiningOp<tensor::CastOp>();
-      bool fold = canFoldIntoConsumerOp(tensorCastOp);
-      newOperands.push_back(fold ? tensorCastOp.getOperand()
-                                 : opOperand->get());
-      newResultTypes.push_back(newOperands.back().getType());
+    if (failed(verifyCompatibleShape(inputValuesType.getShape(),
+                                     inputIndicesType.getShape()))) {
+      return op->emitOpError("expected input values/indices shapes to match");
     }
-    // Clone op.
-    Operation *newOp =
-        op.clone(rewriter, op->getLoc(), newResultTypes, newOperands);
-    SmallVector<Value, 4> replacements;
-    replacements.reserve(newOp->getNumResults());
-    for (auto result : llvm::zip(op->getResults(), newOp->getResults())) {
-      Value oldResult = std::get<0>(result);
-      Value newResult = std::get<1>(result);
-      if (newResult.getType() != oldResult.getType()) {
-        replacements.push_back(rewriter.create<tensor::CastOp>(
-            op->getLoc(), oldResult.getType(), newResult));
-      } else {
-        replacements.push_back(newResult);
-      }
+  }
+  if (failed(verifyCompatibleShape(outputValuesType.getShape(),
+                                   outputIndicesType.getShape()))) {
+    return op->emitOpError("expected output values/indices shapes to match");
+  }
+  if (outputValuesType.getRank() != rank) {
+    return op->emitOpError("expected input/output to have identical ranks");
+  }
+  for (int64_t dim = 0; dim < rank; ++dim) {
+    if (dim == topkDim)
+      continue;
+    int64_t inputSize = inputValuesType.getDimSize(dim);
+    int64_t outputSize = outputValuesType.getDimSize(dim);
+    if (inputSize != ShapedType::kDynamicSize &&
+        outputSize != ShapedType::kDynamicSize && inputSize != outputSize) {
+      return op->emitOpError("incompatible input/output shapes");
     }
-    rewriter.replaceOp(op, replacements);
-
-    return success();
   }
-};
-} // namespace
-
-//===----------------------------------------------------------------------===//
-// TileOp
-//===----------------------------------------------------------------------===//
-
-void TileOp::build(mlir::OpBuilder &builder, mlir::OperationState &result,
-                   Value tileSize, ValueRange outs, int64_t tiledDim,
-                   TileOp::TileOpBodyBuilderFn bodyBuilder) {
-  result.addOperands(tileSize);
-  result.addOperands(outs);
-  result.addAttribute(TileOp::getTiledDimAttrName(),
-                      builder.getI64IntegerAttr(tiledDim));
-  result.addTypes(outs.getType());
-
-  Region *bodyRegion = result.addRegion();
-  bodyRegion->push_back(new Block);
-  Block &bodyBlock = bodyRegion->front();
-  // TODO: Pass a better location here.
-  Location loc = tileSize.getLoc();
-  bodyBlock.addArgument(builder.getIndexType(), loc);
-  bodyBlock.addArgument(builder.getIndexType(), loc);
-  // Handle the sliced out types in a conservative fashion: all dimensions
-  // become dynamic and a later canonicalization is expected to recover static
-  // types.
-  // TODO: should we relax this and use something less strict?
-  auto dynamicTypes =
-      llvm::to_vector(llvm::map_range(outs.getTypes(), [](Type t) -> Type {
-        auto rankedTensorType = t.cast<RankedTensorType>();
-        RankedTensorType::Builder rttb(rankedTensorType);
-        SmallVector<int64_t> dynamicShape(rankedTensorType.getRank(),
-                                          ShapedType::kDynamicSize);
-        return rttb.setShape(dynamicShape);
-      }));
-  SmallVector<Location> locs(dynamicTypes.size(), loc);
-  bodyBlock.addArguments(dynamicTypes, locs);
 
-  OpBuilder::InsertionGuard guard(builder);
-  builder.setInsertionPointToStart(&bodyBlock);
-  bodyBuilder(builder, result.location, bodyBlock.getArgument(0),
-              bodyBlock.getArgument(1), bodyBlock.getArguments().drop_front(2));
+  Block &block = region().front();
+  if (block.getNumArguments() != 2) {
+    return op->emitOpError("region block should have 2 arguments");
+  }
+  for (BlockArgument arg : block.getArguments()) {
+    if (arg.getType() != elementType) {
+      return op->emitOpError("region block argument #")
+             << arg.getArgNumber() << " should be of type " << elementType
+             << " but got " << arg.getType();
+    }
+  }
+  auto yieldOp = cast<YieldOp>(block.getTerminator());
+  if (yieldOp.getNumOperands() != 1) {
+    return op->emitOpError("should yield exactly one operand");
+  }
+  auto ty = yieldOp.getOperand(0).getType().dyn_cast<IntegerType>();
+  if (!ty || ty.getWidth() != 1) {
+    return op->emitOpError("should yield i1 type");
+  }
+  return success();
 }
 
-void TileOp::build(mlir::OpBuilder &builder, mlir::OperationState &result,
-                   Value tileSize, ValueRange outs,
-                   TileOp::TileOpBodyBuilderFn bodyBuilder) {
-  TileOp::build(builder, result, tileSize, outs, 0, bodyBuilder);
+SmallVector<StringRef> TopkOp::getLoopIteratorTypes() {
+  // All loops except the dimension to select along are parallel.
+  SmallVector<StringRef> iteratorTypes(getInputRank(),
+                                       getParallelIteratorTypeName());
+  iteratorTypes[dimension()] = getReductionIteratorTypeName();
+  return iteratorTypes;
 }
 
-// TODO(#81): Impl me.
-LogicalResult TileOp::verify() { return success(); }
-
-void TileOp::print(OpAsmPrinter &p) {
-  p << ' ' << tile_size() << ' ';
-  if (tiled_dim() > 0)
-    p << "tiled_dim = " << tiled_dim() << ' ';
-  if (!outs().empty()) {
-    p << "outs(";
-    llvm::interleaveComma(outs(), p,
-                          [&p](Value v) { p << v << ": " << v.getType(); });
-    p << ')';
+SmallVector<Range> TopkOp::getIterationDomain(OpBuilder &builder) {
+  int64_t operandRank = getInputRank();
+  SmallVector<Range> loopBounds(operandRank);
+  Location loc = getLoc();
+  Value zero = builder.create<arith::ConstantIndexOp>(loc, 0);
+  Value one = builder.create<arith::ConstantIndexOp>(loc, 1);
+  Value source = values();
+  for (auto dim : llvm::seq<int64_t>(0, operandRank)) {
+    loopBounds[dim].offset = zero;
+    loopBounds[dim].size = getDimValue(builder, loc, source, dim);
+    loopBounds[dim].stride = one;
   }
-  p << " -> (" << getResultTypes() << ") ";
-  p.printRegion(region(),
-                /*printEntryBlockArgs=*/true,
-                /*printBlockTerminators=*/true);
-  p.printOptionalAttrDict(getOperation()->getAttrs(),
-                          /*elidedAttrs=*/{TileOp::getTiledDimAttrName()});
+  return loopBounds;
 }
 
-ParseResult TileOp::parse(OpAsmParser &parser, OperationState &result) {
-  auto &builder = parser.getBuilder();
-
-  OpAsmParser::UnresolvedOperand tileSizes;
-  // TODO: also allow tensor<..xindex> and figure out a good syntax.
-  // Type tensorOfIndexType =
-  //     RankedTensorType::get({ShapedType::kDynamicSize}, indexType);
-  Type tileSizesType = builder.getIndexType();
-  SmallVector<Type> outsTypes;
-  SmallVector<OpAsmParser::UnresolvedOperand, 4> outsOperands;
+SmallVector<unsigned>
+TopkOp::getPartitionableLoops(unsigned maxNumParallelDims) {
+  auto range = llvm::seq<unsigned>(0, getInputRank());
+  SmallVector<unsigned> partitionableLoops(range.begin(), range.end());
+  partitionableLoops.erase(std::next(partitionableLoops.begin(), dimension()));
+  if (partitionableLoops.size() > maxNumParallelDims) {
+    partitionableLoops.erase(
+        partitionableLoops.begin(),
+        std::next(partitionableLoops.begin(),
+                  partitionableLoops.size() - maxNumParallelDims));
+  }
+  return partitionableLoops;
+}
 
-  llvm::SMLoc outputsOperandsLoc;
-  if (parser.parseOperand(tileSizes) ||
-      parser.resolveOperand(tileSizes, tileSizesType, result.operands))
-    return failure();
+Operation *TopkOp::getTiledImplementation(OpBuilder &builder,
+                                          ValueRange outputs,
+                                          ArrayRef<OpFoldResult> offsets,
+                                          ArrayRef<OpFoldResult> sizes,
+                                          SmallVectorImpl<Value> &results) {
+  assert(outputs.size() == this->outputs().size());
+  int64_t rank = getInputRank();
+  assert(offsets.size() == static_cast<size_t>(rank) &&
+         sizes.size() == static_cast<size_t>(rank));
+  auto oneAttr = builder.getI64IntegerAttr(1);
+  SmallVector<OpFoldResult> strides(rank, oneAttr);
+  Location loc = getLoc();
 
-  // Parse the `tiled_dim` attribute or set it to 0 implicitly when elided.
-  if (succeeded(parser.parseOptionalKeyword(TileOp::getTiledDimAttrName()))) {
-    outputsOperandsLoc = parser.getCurrentLocation();
-    Attribute valueAttr;
-    parser.parseAttribute(valueAttr, TileOp::getTiledDimAttrName(),
-                          result.attributes);
-  } else {
-    result.attributes.append(TileOp::getTiledDimAttrName(),
-                             parser.getBuilder().getI64IntegerAttr(0));
+  SmallVector<Value> tiledOperands;
+  for (OpOperand *input : getInputOperands()) {
+    tiledOperands.push_back(
+        getSlice(builder, loc, input->get(), offsets, sizes, strides));
   }
 
-  if (succeeded(parser.parseOptionalKeyword("outs"))) {
-    bool _1;
-    SmallVector<NamedAttrList> _2;
-    SmallVector<Location> _3;
-    outputsOperandsLoc = parser.getCurrentLocation();
-    if (mlir::function_interface_impl::parseFunctionArgumentList(
-            parser,
-            /*allowAttributes=*/false,
-            /*allowVariadic=*/false, outsOperands, outsTypes, /*argAttrs=*/_2,
-            /*argLocations=*/_3,
-            /*isVariadic=*/_1) ||
-        parser.resolveOperands(outsOperands, outsTypes, outputsOperandsLoc,
-                               result.operands))
-      return failure();
+  // The outputs only hold `k` elements along the top-k dimension: every tile
+  // of the input merges into the whole running top-k of its batch.
+  int64_t topkDim = dimension();
+  SmallVector<OpFoldResult> outputOffsets(offsets.begin(), offsets.end());
+  SmallVector<OpFoldResult> outputSizes(sizes.begin(), sizes.end());
+  outputOffsets[topkDim] = builder.getI64IntegerAttr(0);
+  outputSizes[topkDim] = getDim(builder, loc, outputs[0], topkDim);
+  for (Value output : outputs) {
+    tiledOperands.push_back(getSlice(builder, loc, output, outputOffsets,
+                                     outputSizes, strides));
   }
-  if (parser.parseArrowTypeList(result.types))
-    return failure();
 
-  SmallVector<OpAsmParser::UnresolvedOperand, 8> regionOperands;
-  std::unique_ptr<Region> region = std::make_unique<Region>();
-  SmallVector<Type, 8> operandTypes, regionTypes;
-  if (parser.parseRegion(*region, regionOperands, regionTypes))
-    return failure();
-
-  // Parse the optional attribute list.
-  if (parser.parseOptionalAttrDict(result.attributes))
-    return failure();
+  SmallVector<Type, 4> resultTypes;
+  if (hasTensorSemantics()) {
+    for (Value tiledOutput : ArrayRef<Value>(tiledOperands).take_back(2))
+      resultTypes.push_back(tiledOutput.getType());
+  }
 
-  TileOp::ensureTerminator(*region, builder, result.location);
-  result.addRegion(std::move(region));
+  Operation *tiledTopkOp = cast<LinalgExtOp>(getOperation())
+                               .clone(builder, loc, resultTypes, tiledOperands);
+  for (auto result : llvm::enumerate(tiledTopkOp->getResults())) {
+    auto insertSliceOp = builder.create<tensor::InsertSliceOp>(
+        loc, result.value(), outputs[result.index()], outputOffsets,
+        outputSizes, strides);
+    results.push_back(insertSliceOp.getResult());
+  }
+  return tiledTopkOp;
+}
 
-  return success();
+/// Returns true if the comparator of `op` can be evaluated on vectors of
+/// elements, i.e. it only contains elementwise mappable ops and constants.
+static bool hasVectorizableComparator(TopkOp op) {
+  if (!VectorType::isValidElementType(op.getInputType().getElementType()))
+    return false;
+  return llvm::all_of(
+      op.region().front().without_terminator(), [](Operation &blockOp) {
+        return isa<arith::ConstantOp>(blockOp) ||
+               (OpTrait::hasElementwiseMappableTraits(&blockOp) &&
+                blockOp.getNumRegions() == 0);
+      });
 }
 
-//===----------------------------------------------------------------------===//
-// InParallelOp
-//===----------------------------------------------------------------------===//
+/// Clones the comparator region of `op` at the insertion point of `b` with
+/// its arguments bound to `lhs` and `rhs` and returns the yielded condition.
+/// If the operands are vectors, the region ops are cloned with vector result
+/// types and scalar constants are broadcast.
+static Value buildTopkComparison(OpBuilder &b, Location loc, TopkOp op,
+                                 Value lhs, Value rhs) {
+  Block &srcBlock = op.region().front();
+  auto vectorType = lhs.getType().dyn_cast<VectorType>();
+  BlockAndValueMapping bvm;
+  bvm.map(srcBlock.getArgument(0), lhs);
+  bvm.map(srcBlock.getArgument(1), rhs);
+  for (Operation &blockOp : srcBlock.without_terminator()) {
+    Operation *clonedOp = b.clone(blockOp, bvm);
+    if (!vectorType)
+      continue;
+    for (auto it : llvm::zip(blockOp.getResults(), clonedOp->getResults())) {
+      Value clonedResult = std::get<1>(it);
+      auto resultType =
+          VectorType::get(vectorType.getShape(), clonedResult.getType());
+      if (isa<arith::ConstantOp>(blockOp)) {
+        bvm.map(std::get<0>(it),
+                b.create<vector::BroadcastOp>(loc, resultType, clonedResult));
+      } else {
+        clonedResult.setType(resultType);
+      }
+    }
+  }
+  return bvm.lookupOrDefault(srcBlock.getTerminator()->getOperand(0));
+}
+
+/// Returns an i1 (or a vector of i1) that is true if the element `(lhs,
+/// lhsIndex)` goes before `(rhs, rhsIndex)` in the top-k order, i.e. it is
+/// strictly better according to the comparator or it compares equal and has a
+/// smaller index.
+static Value buildTopkPrecedes(OpBuilder &b, Location loc, TopkOp op, Value lhs,
+                               Value lhsIndex, Value rhs, Value rhsIndex) {
+  Value better = buildTopkComparison(b, loc, op, lhs, rhs);
+  Value worse = buildTopkComparison(b, loc, op, rhs, lhs);
+  Value equal =
+      b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::eq, better, worse);
+  Value firstIndex = b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::slt,
+                                             lhsIndex, rhsIndex);
+  Value tieBreak = b.create<arith::AndIOp>(loc, equal, firstIndex);
+  return b.create<arith::OrIOp>(loc, better, tieBreak);
+}
+
+// Generates the insertion of one input element into the running top-k, which
+// is kept sorted from best to worst. In pseudo code:
+//   (v, i) = (values[ivs], indices[ivs])
+//   for (j = 0; j < k; ++j)
+//     if (precedes((v, i), out[j]))
+//       swap((v, i), out[j])
+// If `k` is static and small, the running top-k is instead read as a vector
+// and the element is inserted into it with shuffles and selects:
+//   p = precedes(splat(v, i), out)      // p = [0, .., 0, 1, .., 1]
+//   shifted = [(v, i), out[0], .., out[k - 2]]
+//   out = select(p, select(shift(p), shifted, splat(v, i)), out)
+LogicalResult TopkOp::generateScalarImplementation(OpBuilder &b, Location loc,
+                                                   ValueRange ivs) {
+  int64_t topkDim = dimension();
+  Value zero = b.create<arith::ConstantIndexOp>(loc, 0);
+  Value value = b.create<memref::LoadOp>(loc, values(), ivs);
+  // If no indices are provided, the position along the top-k dimension is the
+  // index of the element.
+  Value index;
+  if (Value inputIndices = indices()) {
+    index = b.create<memref::LoadOp>(loc, inputIndices, ivs);
+  } else {
+    index = b.create<arith::IndexCastOp>(loc, b.getI32Type(), ivs[topkDim]);
+  }
+
+  int64_t k = getOutputType().getDimSize(topkDim);
+  if (k != ShapedType::kDynamicSize && k <= kMaxVectorizedTopkSize &&
+      hasVectorizableComparator(*this)) {
+    SmallVector<Value> bestOffsets(ivs.begin(), ivs.end());
+    bestOffsets[topkDim] = zero;
+    AffineMap map = AffineMap::get(getInputRank(), /*symbolCount=*/0,
+                                   b.getAffineDimExpr(topkDim));
+    bool inBounds[] = {true};
+    auto valuesType = VectorType::get({k}, getOutputType().getElementType());
+    auto indicesType = VectorType::get({k}, b.getI32Type());
+    auto maskType = VectorType::get({k}, b.getI1Type());
+    Value bestValues = b.create<vector::TransferReadOp>(
+        loc, valuesType, outputValues(), bestOffsets, map,
+        llvm::makeArrayRef(inBounds));
+    Value bestIndices = b.create<vector::TransferReadOp>(
+        loc, indicesType, outputIndices(), bestOffsets, map,
+        llvm::makeArrayRef(inBounds));
+    Value valueSplat = b.create<vector::BroadcastOp>(loc, valuesType, value);
+    Value indexSplat = b.create<vector::BroadcastOp>(loc, indicesType, index);
+    Value precedes = buildTopkPrecedes(b, loc, *this, valueSplat, indexSplat,
+                                       bestValues, bestIndices);
+
+    // Shift every lane down by one, moving the new element into lane 0.
+    SmallVector<int64_t> shiftMask = {0};
+    for (int64_t lane = 0; lane < k - 1; ++lane)
+      shiftMask.push_back(k + lane);
+    Value falseSplat = b.create<arith::ConstantOp>(
+        loc, DenseElementsAttr::get(maskType, false));
+    Value shiftedPrecedes =
+        b.create<vector::ShuffleOp>(loc, falseSplat, precedes, shiftMask);
+    auto insert = [&](Value splat, Value best) -> Value {
+      Value shifted = b.create<vector::ShuffleOp>(loc, splat, best, shiftMask);
+      Value inserted =
+          b.create<arith::SelectOp>(loc, shiftedPrecedes, shifted, splat);
+      return b.create<arith::SelectOp>(loc, precedes, inserted, best);
+    };
+    b.create<vector::TransferWriteOp>(loc, insert(valueSplat, bestValues),
+                                      outputValues(), bestOffsets, map,
+                                      llvm::makeArrayRef(inBounds));
+    b.create<vector::TransferWriteOp>(loc, insert(indexSplat, bestIndices),
+                                      outputIndices(), bestOffsets, map,
+                                      llvm::makeArrayRef(inBounds));
+    return success();
+  }
+
+  Value one = b.create<arith::ConstantIndexOp>(loc, 1);
+  Value ub = getDimValue(b, loc, outputValues(), topkDim);
+  b.create<scf::ForOp>(
+      loc, zero, ub, one, ValueRange{value, index},
+      [&](OpBuilder &b, Location loc, Value iv, ValueRange iters) {
+        SmallVector<Value> indices(ivs);
+        indices[topkDim] = iv;
+        Value bestValue =
+            b.create<memref::LoadOp>(loc, outputValues(), indices);
+        Value bestIndex =
+            b.create<memref::LoadOp>(loc, outputIndices(), indices);
+        Value precedes = buildTopkPrecedes(b, loc, *this, iters[0], iters[1],
+                                           bestValue, bestIndex);
+        b.create<memref::StoreOp>(
+            loc, b.create<arith::SelectOp>(loc, precedes, iters[0], bestValue),
+            outputValues(), indices);
+        b.create<memref::StoreOp>(
+            loc, b.create<arith::SelectOp>(loc, precedes, iters[1], bestIndex),
+            outputIndices(), indices);
+        // Keep inserting the element that was displaced.
+        Value nextValue =
+            b.create<arith::SelectOp>(loc, precedes, bestValue, iters[0]);
+        Value nextIndex =
+            b.create<arith::SelectOp>(loc, precedes, bestIndex, iters[1]);
+        b.create<scf::YieldOp>(loc, ValueRange{nextValue, nextIndex});
+      });
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// SoftmaxOp
+//===----------------------------------------------------------------------===//
+
+LogicalResult SoftmaxOp::verify() {
+  Operation *op = getOperation();
+  if (getNumInputs() != 1) {
+    return op->emitOpError("expected exactly one input");
+  }
+  if (getNumOutputs() != 1) {
+    return op->emitOpError("expected exactly one output");
+  }
+  int64_t rank = getOperandRank();
+  if (dimension() < 0 || dimension() >= rank) {
+    return op->emitOpError("dimension must be within [0, ") << rank << ")";
+  }
+  auto inputType = input().getType().cast<ShapedType>();
+  auto outputType = output().getType().cast<ShapedType>();
+  if (!inputType.getElementType().isa<FloatType>()) {
+    return op->emitOpError("expected input element type to be a float type");
+  }
+  if (inputType.getElementType() != outputType.getElementType()) {
+    return op->emitOpError(
+        "expected input/output element types to be identical");
+  }
+  ArrayRef<int64_t> inputShapes = inputType.getShape();
+  ArrayRef<int64_t> outputShapes = outputType.getShape();
+  if (inputShapes.size() != outputShapes.size()) {
+    return op->emitOpError("expected input/output to have identical ranks");
+  }
+  if (llvm::any_of(llvm::zip(inputShapes, outputShapes),
+                   [](std::tuple<int64_t, int64_t> s) {
+                     return std::get<0>(s) != ShapedType::kDynamicSize &&
+                            std::get<1>(s) != ShapedType::kDynamicSize &&
+                            std::get<0>(s) != std::get<1>(s);
+                   })) {
+    return op->emitOpError("incompatible input/output shapes");
+  }
+  return success();
+}
+
+SmallVector<StringRef> SoftmaxOp::getLoopIteratorTypes() {
+  SmallVector<StringRef> iteratorTypes(getOperandRank(),
+                                       getParallelIteratorTypeName());
+  iteratorTypes[dimension()] = getReductionIteratorTypeName();
+  return iteratorTypes;
+}
+
+SmallVector<Range> SoftmaxOp::getIterationDomain(OpBuilder &builder) {
+  int64_t operandRank = getOperandRank();
+  SmallVector<Range> loopBounds(operandRank);
+  Location loc = getLoc();
+  Value zero = builder.create<arith::ConstantIndexOp>(loc, 0);
+  Value one = builder.create<arith::ConstantIndexOp>(loc, 1);
+  Value source = input();
+  for (auto dim : llvm::seq<int64_t>(0, operandRank)) {
+    loopBounds[dim].offset = zero;
+    loopBounds[dim].size = getDimValue(builder, loc, source, dim);
+    loopBounds[dim].stride = one;
+  }
+  return loopBounds;
+}
+
+SmallVector<unsigned>
+SoftmaxOp::getPartitionableLoops(unsigned maxNumParallelDims) {
+  auto range = llvm::seq<unsigned>(0, getOperandRank());
+  SmallVector<unsigned> partitionableLoops(range.begin(), range.end());
+  partitionableLoops.erase(std::next(partitionableLoops.begin(), dimension()));
+  if (partitionableLoops.size() > maxNumParallelDims) {
+    partitionableLoops.erase(
+        partitionableLoops.begin(),
+        std::next(partitionableLoops.begin(),
+                  partitionableLoops.size() - maxNumParallelDims));
+  }
+  return partitionableLoops;
+}
+
+Operation *SoftmaxOp::getTiledImplementation(OpBuilder &builder,
+                                             ValueRange outputs,
+                                             ArrayRef<OpFoldResult> offsets,
+                                             ArrayRef<OpFoldResult> sizes,
+                                             SmallVectorImpl<Value> &results) {
+  assert(outputs.size() == this->outputs().size());
+  int64_t rank = getOperandRank();
+  assert(offsets.size() == static_cast<size_t>(rank) &&
+         sizes.size() == static_cast<size_t>(rank));
+  auto oneAttr = builder.getI64IntegerAttr(1);
+  SmallVector<OpFoldResult> strides(rank, oneAttr);
+  Location loc = getLoc();
+  SmallVector<Value> tiledOperands;
+  tiledOperands.emplace_back(
+      getSlice(builder, loc, input(), offsets, sizes, strides));
+  tiledOperands.emplace_back(
+      getSlice(builder, loc, outputs[0], offsets, sizes, strides));
+
+  SmallVector<Type, 4> resultTypes;
+  if (hasTensorSemantics()) {
+    resultTypes.push_back(tiledOperands[1].getType());
+  }
+
+  Operation *tiledSoftmaxOp =
+      cast<LinalgExtOp>(getOperation())
+          .clone(builder, loc, resultTypes, tiledOperands);
+  for (auto result : llvm::enumerate(tiledSoftmaxOp->getResults())) {
+    auto insertSliceOp = builder.create<tensor::InsertSliceOp>(
+        loc, result.value(), outputs[result.index()], offsets, sizes, strides);
+    results.push_back(insertSliceOp.getResult());
+  }
+  return tiledSoftmaxOp;
+}
+
+// Both passes over `dimension` are emitted by the scalar implementation, the
+// loop nest around it only iterates over the other dimensions.
+SmallVector<unsigned> SoftmaxOp::getLoopsInScalarImplementation() {
+  return {static_cast<unsigned>(dimension())};
+}
+
+// Generates the online normalization of a whole row:
+//     max, sum = -inf, 0
+//     for i:
+//       max' = max(max, x[i])
+//       sum' = max' == -inf ? 0 : sum * exp(max - max') + exp(x[i] - max')
+//     for i:
+//       output[i] = exp(x[i] - max) / sum
+// The row is only read twice instead of the four times of the
+// max / exp / sum / div decomposition. The guard keeps the leading -inf
+// elements of a row, e.g. masked scores, from computing exp(-inf - -inf).
+LogicalResult SoftmaxOp::generateScalarImplementation(OpBuilder &b,
+                                                      Location loc,
+                                                      ValueRange ivs) {
+  int64_t softmaxDim = dimension();
+  auto elementType = getOperandType().getElementType().cast<FloatType>();
+  Value zero = b.create<arith::ConstantIndexOp>(loc, 0);
+  Value one = b.create<arith::ConstantIndexOp>(loc, 1);
+  Value size = getDimValue(b, loc, input(), softmaxDim);
+  Value negInf = b.create<arith::ConstantOp>(
+      loc, b.getFloatAttr(elementType,
+                          APFloat::getInf(elementType.getFloatSemantics(),
+                                          /*Negative=*/true)));
+  Value zeroF = b.create<arith::ConstantOp>(loc, b.getZeroAttr(elementType));
+
+  auto statsLoop = b.create<scf::ForOp>(
+      loc, zero, size, one, ValueRange{negInf, zeroF},
+      [&](OpBuilder &b, Location loc, Value iv, ValueRange iters) {
+        SmallVector<Value> indices(ivs.begin(), ivs.end());
+        indices[softmaxDim] = iv;
+        Value x = b.create<memref::LoadOp>(loc, input(), indices);
+        Value max = b.create<arith::MaxFOp>(loc, iters[0], x);
+        Value rescale = b.create<math::ExpOp>(
+            loc, b.create<arith::SubFOp>(loc, iters[0], max));
+        Value term =
+            b.create<math::ExpOp>(loc, b.create<arith::SubFOp>(loc, x, max));
+        Value sum = b.create<arith::AddFOp>(
+            loc, b.create<arith::MulFOp>(loc, iters[1], rescale), term);
+        Value allNegInf = b.create<arith::CmpFOp>(
+            loc, arith::CmpFPredicate::OEQ, max, negInf);
+        sum = b.create<arith::SelectOp>(loc, allNegInf, zeroF, sum);
+        b.create<scf::YieldOp>(loc, ValueRange{max, sum});
+      });
+  Value max = statsLoop.getResult(0);
+  Value sum = statsLoop.getResult(1);
+
+  b.create<scf::ForOp>(
+      loc, zero, size, one, ValueRange{},
+      [&](OpBuilder &b, Location loc, Value iv, ValueRange iters) {
+        SmallVector<Value> indices(ivs.begin(), ivs.end());
+        indices[softmaxDim] = iv;
+        Value x = b.create<memref::LoadOp>(loc, input(), indices);
+        Value exp =
+            b.create<math::ExpOp>(loc, b.create<arith::SubFOp>(loc, x, max));
+        Value normalized = b.create<arith::DivFOp>(loc, exp, sum);
+        b.create<memref::StoreOp>(loc, normalized, output(), indices);
+        b.create<scf::YieldOp>(loc);
+      });
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// Winograd ops
+//===----------------------------------------------------------------------===//
+
+// Transform matrices of F(2 x 2, 3 x 3) and F(4 x 4, 3 x 3) stored row-major,
+// see "Fast Algorithms for Convolutional Neural Networks" (Lavin and Gray).
+// The input, filter and output transforms respectively compute B^T d B,
+// G g G^T and A^T m A.
+// clang-format off
+static const double kBT2x2[] = {
+    1,  0, -1,  0,
+    0,  1,  1,  0,
+    0, -1,  1,  0,
+    0,  1,  0, -1};
+static const double kG2x2[] = {
+    1,    0,    0,
+    0.5,  0.5,  0.5,
+    0.5, -0.5,  0.5,
+    0,    0,    1};
+static const double kAT2x2[] = {
+    1,  1,  1,  0,
+    0,  1, -1, -1};
+static const double kBT4x4[] = {
+    4,  0, -5,  0,  1,  0,
+    0, -4, -4,  1,  1,  0,
+    0,  4, -4, -1,  1,  0,
+    0, -2, -1,  2,  1,  0,
+    0,  2, -1, -2,  1,  0,
+    0,  4,  0, -5,  0,  1};
+static const double kG4x4[] = {
+     1. / 4,       0,      0,
+    -1. / 6, -1. / 6, -1. / 6,
+    -1. / 6,  1. / 6, -1. / 6,
+     1. / 24, 1. / 12, 1. / 6,
+     1. / 24, -1. / 12, 1. / 6,
+     0,        0,      1};
+static const double kAT4x4[] = {
+    1,  1,  1,  1,  1,  0,
+    0,  1, -1,  2, -2,  0,
+    0,  1,  1,  4,  4,  0,
+    0,  1, -1,  8, -8,  1};
+// clang-format on
+
+/// Returns the number of tiles of size `outputTileSize` needed to cover the
+/// output of a 3 x 3 convolution of an input of size `inputSize`.
+static int64_t getNumWinogradTiles(int64_t inputSize, int64_t outputTileSize) {
+  if (inputSize == ShapedType::kDynamicSize)
+    return ShapedType::kDynamicSize;
+  return (inputSize - 2 + outputTileSize - 1) / outputTileSize;
+}
+
+/// Returns true if the static sizes of `lhs` and `rhs` differ.
+static bool isIncompatibleSize(int64_t lhs, int64_t rhs) {
+  return lhs != ShapedType::kDynamicSize && rhs != ShapedType::kDynamicSize &&
+         lhs != rhs;
+}
+
+/// Verifies the properties shared by the Winograd ops: one input and one
+/// output of identical float element types and the given ranks, and a
+/// supported output tile size.
+static LogicalResult verifyWinogradOp(Operation *op, int64_t numInputs,
+                                      int64_t numOutputs, ShapedType inputType,
+                                      ShapedType outputType,
+                                      int64_t outputTileSize, int64_t inputRank,
+                                      int64_t outputRank) {
+  if (numInputs != 1) {
+    return op->emitOpError("expected exactly one input");
+  }
+  if (numOutputs != 1) {
+    return op->emitOpError("expected exactly one output");
+  }
+  if (outputTileSize != 2 && outputTileSize != 4) {
+    return op->emitOpError("expected output_tile_size to be 2 or 4");
+  }
+  if (!inputType.getElementType().isa<FloatType>()) {
+    return op->emitOpError("expected input element type to be a float type");
+  }
+  if (inputType.getElementType() != outputType.getElementType()) {
+    return op->emitOpError(
+        "expected input/output element types to be identical");
+  }
+  if (inputType.getRank() != inputRank) {
+    return op->emitOpError("expected input to be of rank ") << inputRank;
+  }
+  if (outputType.getRank() != outputRank) {
+    return op->emitOpError("expected output to be of rank ") << outputRank;
+  }
+  return success();
+}
+
+/// Returns the iteration domain made of the dimensions `dims` of `source`.
+static SmallVector<Range> getWinogradIterationDomain(OpBuilder &builder,
+                                                     Location loc, Value source,
+                                                     ArrayRef<int64_t> dims) {
+  Value zero = builder.create<arith::ConstantIndexOp>(loc, 0);
+  Value one = builder.create<arith::ConstantIndexOp>(loc, 1);
+  SmallVector<Range> loopBounds(dims.size());
+  for (auto dim : llvm::enumerate(dims)) {
+    loopBounds[dim.index()].offset = zero;
+    loopBounds[dim.index()].size =
+        getDimValue(builder, loc, source, dim.value());
+    loopBounds[dim.index()].stride = one;
+  }
+  return loopBounds;
+}
+
+/// Returns the innermost `maxNumParallelDims` loops of the `numLoops` parallel
+/// loops of a Winograd op.
+static SmallVector<unsigned>
+getWinogradPartitionableLoops(unsigned numLoops, unsigned maxNumParallelDims) {
+  auto range = llvm::seq<unsigned>(0, numLoops);
+  SmallVector<unsigned> partitionableLoops(range.begin(), range.end());
+  if (partitionableLoops.size() > maxNumParallelDims) {
+    partitionableLoops.erase(
+        partitionableLoops.begin(),
+        std::next(partitionableLoops.begin(),
+                  partitionableLoops.size() - maxNumParallelDims));
+  }
+  return partitionableLoops;
+}
+
+/// Returns `sum_k coeffs[k] * values[k]`, skipping the zero coefficients and
+/// the multiplications by +/-1 that make most of the Winograd transforms.
+static Value buildLinearCombination(OpBuilder &b, Location loc,
+                                    ArrayRef<double> coeffs,
+                                    ArrayRef<Value> values, Type elementType) {
+  Value result;
+  for (auto it : llvm::zip(coeffs, values)) {
+    double coeff = std::get<0>(it);
+    Value value = std::get<1>(it);
+    if (coeff == 0.0)
+      continue;
+    bool negate = coeff < 0.0;
+    if (std::abs(coeff) != 1.0) {
+      Value cst = b.create<arith::ConstantOp>(
+          loc, b.getFloatAttr(elementType, std::abs(coeff)));
+      value = b.create<arith::MulFOp>(loc, cst, value);
+    }
+    if (!result) {
+      result = negate ? b.create<arith::NegFOp>(loc, value).getResult() : value;
+      continue;
+    }
+    result = negate ? b.create<arith::SubFOp>(loc, result, value).getResult()
+                    : b.create<arith::AddFOp>(loc, result, value).getResult();
+  }
+  if (!result) {
+    result = b.create<arith::ConstantOp>(loc, b.getZeroAttr(elementType));
+  }
+  return result;
+}
+
+/// Returns M x M^T where M is the `rows` x `cols` row-major constant matrix
+/// `matrix` and x is the `cols` x `cols` matrix of scalars `x`.
+static SmallVector<SmallVector<Value>>
+buildWinogradTransform(OpBuilder &b, Location loc, ArrayRef<double> matrix,
+                       int64_t rows, int64_t cols,
+                       ArrayRef<SmallVector<Value>> x, Type elementType) {
+  assert(matrix.size() == static_cast<size_t>(rows * cols) &&
+         x.size() == static_cast<size_t>(cols) && "unexpected matrix sizes");
+  // tmp = M x, of size rows x cols.
+  SmallVector<SmallVector<Value>> tmp(rows, SmallVector<Value>(cols));
+  for (int64_t i = 0; i < rows; ++i) {
+    ArrayRef<double> row = matrix.slice(i * cols, cols);
+    for (int64_t j = 0; j < cols; ++j) {
+      SmallVector<Value> column;
+      for (int64_t k = 0; k < cols; ++k)
+        column.push_back(x[k][j]);
+      tmp[i][j] = buildLinearCombination(b, loc, row, column, elementType);
+    }
+  }
+  // result = tmp M^T, of size rows x rows.
+  SmallVector<SmallVector<Value>> result(rows, SmallVector<Value>(rows));
+  for (int64_t i = 0; i < rows; ++i) {
+    for (int64_t j = 0; j < rows; ++j) {
+      ArrayRef<double> row = matrix.slice(j * cols, cols);
+      result[i][j] = buildLinearCombination(b, loc, row, tmp[i], elementType);
+    }
+  }
+  return result;
+}
+
+/// Returns the `tile * outputTileSize + offset` index.
+static Value getWinogradIndex(OpBuilder &b, Location loc, Value tile,
+                              int64_t outputTileSize, int64_t offset) {
+  Value base = b.create<arith::MulIOp>(
+      loc, tile, b.create<arith::ConstantIndexOp>(loc, outputTileSize));
+  return b.create<arith::AddIOp>(
+      loc, base, b.create<arith::ConstantIndexOp>(loc, offset));
+}
+
+//===----------------------------------------------------------------------===//
+// WinogradInputTransformOp
+//===----------------------------------------------------------------------===//
+
+LogicalResult WinogradInputTransformOp::verify() {
+  Operation *op = getOperation();
+  if (failed(verifyWinogradOp(op, getNumInputs(), getNumOutputs(),
+                              getInputOperandType(), getOutputOperandType(),
+                              output_tile_size(), /*inputRank=*/4,
+                              /*outputRank=*/6))) {
+    return failure();
+  }
+  ArrayRef<int64_t> inputShape = getInputOperandType().getShape();
+  ArrayRef<int64_t> outputShape = getOutputOperandType().getShape();
+  int64_t inputTileSize = getInputTileSize();
+  if (isIncompatibleSize(outputShape[0], inputTileSize) ||
+      isIncompatibleSize(outputShape[1], inputTileSize)) {
+    return op->emitOpError("expected the two leading output dimensions to be ")
+           << inputTileSize;
+  }
+  if (isIncompatibleSize(outputShape[2], inputShape[0]) ||
+      isIncompatibleSize(
+          outputShape[3],
+          getNumWinogradTiles(inputShape[1], output_tile_size())) ||
+      isIncompatibleSize(
+          outputShape[4],
+          getNumWinogradTiles(inputShape[2], output_tile_size())) ||
+      isIncompatibleSize(outputShape[5], inputShape[3])) {
+    return op->emitOpError("incompatible input/output shapes");
+  }
+  return success();
+}
+
+SmallVector<StringRef> WinogradInputTransformOp::getLoopIteratorTypes() {
+  return SmallVector<StringRef>(4, getParallelIteratorTypeName());
+}
+
+SmallVector<Range>
+WinogradInputTransformOp::getIterationDomain(OpBuilder &builder) {
+  return getWinogradIterationDomain(builder, getLoc(), output(), {2, 3, 4, 5});
+}
+
+SmallVector<unsigned> WinogradInputTransformOp::getPartitionableLoops(
+    unsigned maxNumParallelDims) {
+  return getWinogradPartitionableLoops(4, maxNumParallelDims);
+}
+
+Operation *WinogradInputTransformOp::getTiledImplementation(
+    OpBuilder &builder, ValueRange outputs, ArrayRef<OpFoldResult> offsets,
+    ArrayRef<OpFoldResult> sizes, SmallVectorImpl<Value> &results) {
+  assert(outputs.size() == this->outputs().size());
+  assert(offsets.size() == 4 && sizes.size() == 4);
+  Location loc = getLoc();
+  auto zeroAttr = builder.getI64IntegerAttr(0);
+  auto oneAttr = builder.getI64IntegerAttr(1);
+  auto inputTileSizeAttr = builder.getI64IntegerAttr(getInputTileSize());
+
+  // The input tiles overlap: tile `t` reads [t * m, t * m + m + 2).
+  auto hSlice = getSliceOfTiles(
+      builder, loc, offsets[1], sizes[1], getDimValue(builder, loc, input(), 1),
+      output_tile_size(), getKernelSize() - 1);
+  auto wSlice = getSliceOfTiles(
+      builder, loc, offsets[2], sizes[2], getDimValue(builder, loc, input(), 2),
+      output_tile_size(), getKernelSize() - 1);
+  SmallVector<OpFoldResult> inputOffsets = {offsets[0], hSlice.first,
+                                            wSlice.first, offsets[3]};
+  SmallVector<OpFoldResult> inputSizes = {sizes[0], hSlice.second,
+                                          wSlice.second, sizes[3]};
+  SmallVector<OpFoldResult> inputStrides(4, oneAttr);
+
+  SmallVector<OpFoldResult> outputOffsets = {zeroAttr, zeroAttr};
+  outputOffsets.append(offsets.begin(), offsets.end());
+  SmallVector<OpFoldResult> outputSizes = {inputTileSizeAttr,
+                                           inputTileSizeAttr};
+  outputSizes.append(sizes.begin(), sizes.end());
+  SmallVector<OpFoldResult> outputStrides(6, oneAttr);
+
+  SmallVector<Value> tiledOperands;
+  tiledOperands.emplace_back(getSlice(builder, loc, input(), inputOffsets,
+                                      inputSizes, inputStrides));
+  tiledOperands.emplace_back(getSlice(builder, loc, outputs[0], outputOffsets,
+                                      outputSizes, outputStrides));
+
+  SmallVector<Type, 4> resultTypes;
+  if (hasTensorSemantics()) {
+    resultTypes.push_back(tiledOperands[1].getType());
+  }
+
+  Operation *tiledOp = cast<LinalgExtOp>(getOperation())
+                           .clone(builder, loc, resultTypes, tiledOperands);
+  for (auto result : llvm::enumerate(tiledOp->getResults())) {
+    auto insertSliceOp = builder.create<tensor::InsertSliceOp>(
+        loc, result.value(), outputs[result.index()], outputOffsets,
+        outputSizes, outputStrides);
+    results.push_back(insertSliceOp.getResult());
+  }
+  return tiledOp;
+}
+
+// Loads the (m + 2) x (m + 2) input tile at (ivs[1] * m, ivs[2] * m), zero
+// padded past the input, and stores B^T d B into the output.
+LogicalResult WinogradInputTransformOp::generateScalarImplementation(
+    OpBuilder &b, Location loc, ValueRange ivs) {
+  Type elementType = getInputOperandType().getElementType();
+  int64_t m = output_tile_size();
+  int64_t inputTileSize = getInputTileSize();
+  Value zeroF = b.create<arith::ConstantOp>(loc, b.getZeroAttr(elementType));
+  Value one = b.create<arith::ConstantIndexOp>(loc, 1);
+  Value height = getDimValue(b, loc, input(), 1);
+  Value width = getDimValue(b, loc, input(), 2);
+  Value lastH = b.create<arith::SubIOp>(loc, height, one);
+  Value lastW = b.create<arith::SubIOp>(loc, width, one);
+
+  SmallVector<SmallVector<Value>> d(inputTileSize,
+                                    SmallVector<Value>(inputTileSize));
+  for (int64_t i = 0; i < inputTileSize; ++i) {
+    Value h = getWinogradIndex(b, loc, ivs[1], m, i);
+    Value hInBounds =
+        b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::slt, h, height);
+    Value clampedH = b.create<arith::MinSIOp>(loc, h, lastH);
+    for (int64_t j = 0; j < inputTileSize; ++j) {
+      Value w = getWinogradIndex(b, loc, ivs[2], m, j);
+      Value wInBounds =
+          b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::slt, w, width);
+      Value clampedW = b.create<arith::MinSIOp>(loc, w, lastW);
+      Value x = b.create<memref::LoadOp>(
+          loc, input(), ValueRange{ivs[0], clampedH, clampedW, ivs[3]});
+      Value inBounds = b.create<arith::AndIOp>(loc, hInBounds, wInBounds);
+      d[i][j] = b.create<arith::SelectOp>(loc, inBounds, x, zeroF);
+    }
+  }
+
+  ArrayRef<double> bt = m == 2 ? makeArrayRef(kBT2x2) : makeArrayRef(kBT4x4);
+  SmallVector<SmallVector<Value>> v = buildWinogradTransform(
+      b, loc, bt, inputTileSize, inputTileSize, d, elementType);
+  for (int64_t i = 0; i < inputTileSize; ++i) {
+    for (int64_t j = 0; j < inputTileSize; ++j) {
+      SmallVector<Value> indices = {b.create<arith::ConstantIndexOp>(loc, i),
+                                    b.create<arith::ConstantIndexOp>(loc, j)};
+      indices.append(ivs.begin(), ivs.end());
+      b.create<memref::StoreOp>(loc, v[i][j], output(), indices);
+    }
+  }
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// WinogradFilterTransformOp
+//===----------------------------------------------------------------------===//
+
+LogicalResult WinogradFilterTransformOp::verify() {
+  Operation *op = getOperation();
+  if (failed(verifyWinogradOp(op, getNumInputs(), getNumOutputs(),
+                              getInputOperandType(), getOutputOperandType(),
+                              output_tile_size(), /*inputRank=*/4,
+                              /*outputRank=*/4))) {
+    return failure();
+  }
+  ArrayRef<int64_t> inputShape = getInputOperandType().getShape();
+  ArrayRef<int64_t> outputShape = getOutputOperandType().getShape();
+  if (inputShape[0] != getKernelSize() || inputShape[1] != getKernelSize()) {
+    return op->emitOpError("expected a static ")
+           << getKernelSize() << "x" << getKernelSize() << " kernel";
+  }
+  int64_t inputTileSize = getInputTileSize();
+  if (isIncompatibleSize(outputShape[0], inputTileSize) ||
+      isIncompatibleSize(outputShape[1], inputTileSize)) {
+    return op->emitOpError("expected the two leading output dimensions to be ")
+           << inputTileSize;
+  }
+  if (isIncompatibleSize(outputShape[2], inputShape[2]) ||
+      isIncompatibleSize(outputShape[3], inputShape[3])) {
+    return op->emitOpError("incompatible input/output shapes");
+  }
+  return success();
+}
+
+SmallVector<StringRef> WinogradFilterTransformOp::getLoopIteratorTypes() {
+  return SmallVector<StringRef>(2, getParallelIteratorTypeName());
+}
+
+SmallVector<Range>
+WinogradFilterTransformOp::getIterationDomain(OpBuilder &builder) {
+  return getWinogradIterationDomain(builder, getLoc(), output(), {2, 3});
+}
+
+SmallVector<unsigned> WinogradFilterTransformOp::getPartitionableLoops(
+    unsigned maxNumParallelDims) {
+  return getWinogradPartitionableLoops(2, maxNumParallelDims);
+}
+
+Operation *WinogradFilterTransformOp::getTiledImplementation(
+    OpBuilder &builder, ValueRange outputs, ArrayRef<OpFoldResult> offsets,
+    ArrayRef<OpFoldResult> sizes, SmallVectorImpl<Value> &results) {
+  assert(outputs.size() == this->outputs().size());
+  assert(offsets.size() == 2 && sizes.size() == 2);
+  Location loc = getLoc();
+  auto zeroAttr = builder.getI64IntegerAttr(0);
+  auto oneAttr = builder.getI64IntegerAttr(1);
+  auto kernelSizeAttr = builder.getI64IntegerAttr(getKernelSize());
+  auto inputTileSizeAttr = builder.getI64IntegerAttr(getInputTileSize());
+  SmallVector<OpFoldResult> strides(4, oneAttr);
+
+  SmallVector<OpFoldResult> tileOffsets = {zeroAttr, zeroAttr};
+  tileOffsets.append(offsets.begin(), offsets.end());
+  SmallVector<OpFoldResult> inputSizes = {kernelSizeAttr, kernelSizeAttr};
+  inputSizes.append(sizes.begin(), sizes.end());
+  SmallVector<OpFoldResult> outputSizes = {inputTileSizeAttr,
+                                           inputTileSizeAttr};
+  outputSizes.append(sizes.begin(), sizes.end());
+
+  SmallVector<Value> tiledOperands;
+  tiledOperands.emplace_back(
+      getSlice(builder, loc, input(), tileOffsets, inputSizes, strides));
+  tiledOperands.emplace_back(
+      getSlice(builder, loc, outputs[0], tileOffsets, outputSizes, strides));
+
+  SmallVector<Type, 4> resultTypes;
+  if (hasTensorSemantics()) {
+    resultTypes.push_back(tiledOperands[1].getType());
+  }
+
+  Operation *tiledOp = cast<LinalgExtOp>(getOperation())
+                           .clone(builder, loc, resultTypes, tiledOperands);
+  for (auto result : llvm::enumerate(tiledOp->getResults())) {
+    auto insertSliceOp = builder.create<tensor::InsertSliceOp>(
+        loc, result.value(), outputs[result.index()], tileOffsets, outputSizes,
+        strides);
+    results.push_back(insertSliceOp.getResult());
+  }
+  return tiledOp;
+}
+
+// Loads the 3 x 3 kernel g of (ivs[0], ivs[1]) and stores G g G^T into the
+// output.
+LogicalResult WinogradFilterTransformOp::generateScalarImplementation(
+    OpBuilder &b, Location loc, ValueRange ivs) {
+  Type elementType = getInputOperandType().getElementType();
+  int64_t kernelSize = getKernelSize();
+  int64_t inputTileSize = getInputTileSize();
+
+  SmallVector<SmallVector<Value>> g(kernelSize, SmallVector<Value>(kernelSize));
+  for (int64_t i = 0; i < kernelSize; ++i) {
+    for (int64_t j = 0; j < kernelSize; ++j) {
+      g[i][j] = b.create<memref::LoadOp>(
+          loc, input(),
+          ValueRange{b.create<arith::ConstantIndexOp>(loc, i),
+                     b.create<arith::ConstantIndexOp>(loc, j), ivs[0], ivs[1]});
+    }
+  }
+
+  ArrayRef<double> gMatrix =
+      output_tile_size() == 2 ? makeArrayRef(kG2x2) : makeArrayRef(kG4x4);
+  SmallVector<SmallVector<Value>> u = buildWinogradTransform(
+      b, loc, gMatrix, inputTileSize, kernelSize, g, elementType);
+  for (int64_t i = 0; i < inputTileSize; ++i) {
+    for (int64_t j = 0; j < inputTileSize; ++j) {
+      b.create<memref::StoreOp>(
+          loc, u[i][j], output(),
+          ValueRange{b.create<arith::ConstantIndexOp>(loc, i),
+                     b.create<arith::ConstantIndexOp>(loc, j), ivs[0], ivs[1]});
+    }
+  }
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// WinogradOutputTransformOp
+//===----------------------------------------------------------------------===//
+
+LogicalResult WinogradOutputTransformOp::verify() {
+  Operation *op = getOperation();
+  if (failed(verifyWinogradOp(op, getNumInputs(), getNumOutputs(),
+                              getInputOperandType(), getOutputOperandType(),
+                              output_tile_size(), /*inputRank=*/6,
+                              /*outputRank=*/4))) {
+    return failure();
+  }
+  ArrayRef<int64_t> inputShape = getInputOperandType().getShape();
+  ArrayRef<int64_t> outputShape = getOutputOperandType().getShape();
+  int64_t inputTileSize = getInputTileSize();
+  if (isIncompatibleSize(inputShape[0], inputTileSize) ||
+      isIncompatibleSize(inputShape[1], inputTileSize)) {
+    return op->emitOpError("expected the two leading input dimensions to be ")
+           << inputTileSize;
+  }
+  // The output is that of the convolution of an input of size `size + 2`.
+  auto getNumTiles = [&](int64_t size) {
+    if (size == ShapedType::kDynamicSize)
+      return size;
+    return getNumWinogradTiles(size + getKernelSize() - 1, output_tile_size());
+  };
+  if (isIncompatibleSize(inputShape[2], outputShape[0]) ||
+      isIncompatibleSize(inputShape[3], getNumTiles(outputShape[1])) ||
+      isIncompatibleSize(inputShape[4], getNumTiles(outputShape[2])) ||
+      isIncompatibleSize(inputShape[5], outputShape[3])) {
+    return op->emitOpError("incompatible input/output shapes");
+  }
+  return success();
+}
+
+SmallVector<StringRef> WinogradOutputTransformOp::getLoopIteratorTypes() {
+  return SmallVector<StringRef>(4, getParallelIteratorTypeName());
+}
+
+SmallVector<Range>
+WinogradOutputTransformOp::getIterationDomain(OpBuilder &builder) {
+  return getWinogradIterationDomain(builder, getLoc(), input(), {2, 3, 4, 5});
+}
+
+SmallVector<unsigned> WinogradOutputTransformOp::getPartitionableLoops(
+    unsigned maxNumParallelDims) {
+  return getWinogradPartitionableLoops(4, maxNumParallelDims);
+}
+
+Operation *WinogradOutputTransformOp::getTiledImplementation(
+    OpBuilder &builder, ValueRange outputs, ArrayRef<OpFoldResult> offsets,
+    ArrayRef<OpFoldResult> sizes, SmallVectorImpl<Value> &results) {
+  assert(outputs.size() == this->outputs().size());
+  assert(offsets.size() == 4 && sizes.size() == 4);
+  Location loc = getLoc();
+  auto zeroAttr = builder.getI64IntegerAttr(0);
+  auto oneAttr = builder.getI64IntegerAttr(1);
+  auto inputTileSizeAttr = builder.getI64IntegerAttr(getInputTileSize());
+
+  SmallVector<OpFoldResult> inputOffsets = {zeroAttr, zeroAttr};
+  inputOffsets.append(offsets.begin(), offsets.end());
+  SmallVector<OpFoldResult> inputSizes = {inputTileSizeAttr, inputTileSizeAttr};
+  inputSizes.append(sizes.begin(), sizes.end());
+  SmallVector<OpFoldResult> inputStrides(6, oneAttr);
+
+  // The output tiles do not overlap: tile `t` writes the output at
+  // [t * m, t * m + m).
+  auto hSlice = getSliceOfTiles(
+      builder, loc, offsets[1], sizes[1],
+      getDimValue(builder, loc, outputs[0], 1), output_tile_size(),
+      /*halo=*/0);
+  auto wSlice = getSliceOfTiles(
+      builder, loc, offsets[2], sizes[2],
+      getDimValue(builder, loc, outputs[0], 2), output_tile_size(),
+      /*halo=*/0);
+  SmallVector<OpFoldResult> outputOffsets = {offsets[0], hSlice.first,
+                                             wSlice.first, offsets[3]};
+  SmallVector<OpFoldResult> outputSizes = {sizes[0], hSlice.second,
+                                           wSlice.second, sizes[3]};
+  SmallVector<OpFoldResult> outputStrides(4, oneAttr);
+
+  SmallVector<Value> tiledOperands;
+  tiledOperands.emplace_back(getSlice(builder, loc, input(), inputOffsets,
+                                      inputSizes, inputStrides));
+  tiledOperands.emplace_back(getSlice(builder, loc, outputs[0], outputOffsets,
+                                      outputSizes, outputStrides));
+
+  SmallVector<Type, 4> resultTypes;
+  if (hasTensorSemantics()) {
+    resultTypes.push_back(tiledOperands[1].getType());
+  }
+
+  Operation *tiledOp = cast<LinalgExtOp>(getOperation())
+                           .clone(builder, loc, resultTypes, tiledOperands);
+  for (auto result : llvm::enumerate(tiledOp->getResults())) {
+    auto insertSliceOp = builder.create<tensor::InsertSliceOp>(
+        loc, result.value(), outputs[result.index()], outputOffsets,
+        outputSizes, outputStrides);
+    results.push_back(insertSliceOp.getResult());
+  }
+  return tiledOp;
+}
+
+// Loads the (m + 2) x (m + 2) tile of (ivs[1], ivs[2]) and accumulates
+// A^T m A into the m x m output tile at (ivs[1] * m, ivs[2] * m). The elements
+// of the last tiles that fall outside of the output are dropped.
+LogicalResult WinogradOutputTransformOp::generateScalarImplementation(
+    OpBuilder &b, Location loc, ValueRange ivs) {
+  Type elementType = getInputOperandType().getElementType();
+  int64_t m = output_tile_size();
+  int64_t inputTileSize = getInputTileSize();
+
+  SmallVector<SmallVector<Value>> tile(inputTileSize,
+                                       SmallVector<Value>(inputTileSize));
+  for (int64_t i = 0; i < inputTileSize; ++i) {
+    for (int64_t j = 0; j < inputTileSize; ++j) {
+      SmallVector<Value> indices = {b.create<arith::ConstantIndexOp>(loc, i),
+                                    b.create<arith::ConstantIndexOp>(loc, j)};
+      indices.append(ivs.begin(), ivs.end());
+      tile[i][j] = b.create<memref::LoadOp>(loc, input(), indices);
+    }
+  }
+
+  ArrayRef<double> at = m == 2 ? makeArrayRef(kAT2x2) : makeArrayRef(kAT4x4);
+  SmallVector<SmallVector<Value>> y =
+      buildWinogradTransform(b, loc, at, m, inputTileSize, tile, elementType);
+
+  Value height = getDimValue(b, loc, output(), 1);
+  Value width = getDimValue(b, loc, output(), 2);
+  for (int64_t i = 0; i < m; ++i) {
+    Value h = getWinogradIndex(b, loc, ivs[1], m, i);
+    Value hInBounds =
+        b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::slt, h, height);
+    for (int64_t j = 0; j < m; ++j) {
+      Value w = getWinogradIndex(b, loc, ivs[2], m, j);
+      Value wInBounds =
+          b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::slt, w, width);
+      Value inBounds = b.create<arith::AndIOp>(loc, hInBounds, wInBounds);
+      Value value = y[i][j];
+      b.create<scf::IfOp>(
+          loc, TypeRange{}, inBounds, [&](OpBuilder &b, Location loc) {
+            SmallVector<Value> indices = {ivs[0], h, w, ivs[3]};
+            Value acc = b.create<memref::LoadOp>(loc, output(), indices);
+            Value sum = b.create<arith::AddFOp>(loc, acc, value);
+            b.create<memref::StoreOp>(loc, sum, output(), indices);
+            b.create<scf::YieldOp>(loc);
+          });
+    }
+  }
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// PackOp and UnPackOp
+//===----------------------------------------------------------------------===//
+
+/// Returns the position of every unpacked dimension among the outer
+/// dimensions of the packed operand, i.e. the inverse of `outerDimsPerm`.
+static SmallVector<int64_t> getPackedOuterDimsPos(ArrayRef<int64_t> perm) {
+  SmallVector<int64_t> pos(perm.size());
+  for (auto dim : llvm::enumerate(perm))
+    pos[dim.value()] = dim.index();
+  return pos;
+}
+
+/// Returns the shape of `unpackedShape` packed with `innerTiles` along
+/// `innerDimsPos` and permuted by `outerDimsPerm`.
+static SmallVector<int64_t> getPackedShape(ArrayRef<int64_t> unpackedShape,
+                                           ArrayRef<int64_t> innerDimsPos,
+                                           ArrayRef<int64_t> innerTiles,
+                                           ArrayRef<int64_t> outerDimsPerm) {
+  SmallVector<int64_t> outerShape(unpackedShape.begin(), unpackedShape.end());
+  for (auto it : llvm::zip(innerDimsPos, innerTiles)) {
+    int64_t &size = outerShape[std::get<0>(it)];
+    if (size != ShapedType::kDynamicSize)
+      size = llvm::divideCeil(size, std::get<1>(it));
+  }
+  SmallVector<int64_t> packedShape;
+  for (int64_t dim : outerDimsPerm)
+    packedShape.push_back(outerShape[dim]);
+  packedShape.append(innerTiles.begin(), innerTiles.end());
+  return packedShape;
+}
+
+/// Verifies the properties shared by the pack and unpack ops.
+static LogicalResult verifyPackLikeOp(Operation *op, ShapedType unpackedType,
+                                      ShapedType packedType,
+                                      ArrayRef<int64_t> innerDimsPos,
+                                      ArrayRef<int64_t> innerTiles,
+                                      ArrayRef<int64_t> outerDimsPerm) {
+  int64_t rank = unpackedType.getRank();
+  if (innerDimsPos.size() != innerTiles.size()) {
+    return op->emitOpError(
+        "expected as many inner tiles as inner dimension positions");
+  }
+  llvm::SmallSet<int64_t, 4> innerDims;
+  for (int64_t dim : innerDimsPos) {
+    if (dim < 0 || dim >= rank || !innerDims.insert(dim).second) {
+      return op->emitOpError("expected inner_dims_pos to be unique dimensions "
+                             "of the unpacked operand");
+    }
+  }
+  if (llvm::any_of(innerTiles, [](int64_t tile) { return tile <= 0; })) {
+    return op->emitOpError("expected inner tiles to be positive");
+  }
+  SmallVector<int64_t> sortedPerm(outerDimsPerm.begin(), outerDimsPerm.end());
+  llvm::sort(sortedPerm);
+  auto identity = llvm::seq<int64_t>(0, rank);
+  if (sortedPerm.size() != static_cast<size_t>(rank) ||
+      !std::equal(sortedPerm.begin(), sortedPerm.end(), identity.begin())) {
+    return op->emitOpError("expected outer_dims_perm to be a permutation of "
+                           "the unpacked dimensions");
+  }
+  if (unpackedType.getElementType() != packedType.getElementType()) {
+    return op->emitOpError(
+        "expected input/output element types to be identical");
+  }
+  int64_t packedRank = rank + static_cast<int64_t>(innerTiles.size());
+  if (packedType.getRank() != packedRank) {
+    return op->emitOpError("expected packed operand to be of rank ")
+           << packedRank;
+  }
+  SmallVector<int64_t> expectedShape = getPackedShape(
+      unpackedType.getShape(), innerDimsPos, innerTiles, outerDimsPerm);
+  if (llvm::any_of(llvm::zip(expectedShape, packedType.getShape()),
+                   [](std::tuple<int64_t, int64_t> s) {
+                     return isIncompatibleSize(std::get<0>(s), std::get<1>(s));
+                   })) {
+    return op->emitOpError("incompatible packed/unpacked shapes");
+  }
+  return success();
+}
+
+/// Returns the partitionable loops of the pack and unpack ops: the innermost
+/// `maxNumParallelDims` outer dimensions of the packed operand.
+static SmallVector<unsigned>
+getPackLikePartitionableLoops(int64_t rank, unsigned maxNumParallelDims) {
+  auto range = llvm::seq<unsigned>(0, rank);
+  SmallVector<unsigned> partitionableLoops(range.begin(), range.end());
+  if (partitionableLoops.size() > maxNumParallelDims) {
+    partitionableLoops.erase(
+        partitionableLoops.begin(),
+        std::next(partitionableLoops.begin(),
+                  partitionableLoops.size() - maxNumParallelDims));
+  }
+  return partitionableLoops;
+}
+
+/// Returns the iteration domain of the pack and unpack ops: the outer
+/// dimensions of the `packed` operand.
+static SmallVector<Range> getPackLikeIterationDomain(OpBuilder &builder,
+                                                     Location loc, Value packed,
+                                                     int64_t rank) {
+  Value zero = builder.create<arith::ConstantIndexOp>(loc, 0);
+  Value one = builder.create<arith::ConstantIndexOp>(loc, 1);
+  SmallVector<Range> loopBounds(rank);
+  for (auto dim : llvm::seq<int64_t>(0, rank)) {
+    loopBounds[dim].offset = zero;
+    loopBounds[dim].size = getDimValue(builder, loc, packed, dim);
+    loopBounds[dim].stride = one;
+  }
+  return loopBounds;
+}
+
+/// Computes the slices of the `unpacked` and `packed` operands of the pack and
+/// unpack ops that correspond to the `offsets` and `sizes` of the outer
+/// dimensions of the packed operand.
+static void getPackLikeSlices(
+    OpBuilder &b, Location loc, Value unpacked, ArrayRef<int64_t> innerDimsPos,
+    ArrayRef<int64_t> innerTiles, ArrayRef<int64_t> outerDimsPerm,
+    ArrayRef<OpFoldResult> offsets, ArrayRef<OpFoldResult> sizes,
+    SmallVectorImpl<OpFoldResult> &unpackedOffsets,
+    SmallVectorImpl<OpFoldResult> &unpackedSizes,
+    SmallVectorImpl<OpFoldResult> &packedOffsets,
+    SmallVectorImpl<OpFoldResult> &packedSizes) {
+  int64_t rank = outerDimsPerm.size();
+  SmallVector<int64_t> outerDimsPos = getPackedOuterDimsPos(outerDimsPerm);
+  unpackedOffsets.resize(rank);
+  unpackedSizes.resize(rank);
+  for (auto dim : llvm::seq<int64_t>(0, rank)) {
+    unpackedOffsets[dim] = offsets[outerDimsPos[dim]];
+    unpackedSizes[dim] = sizes[outerDimsPos[dim]];
+  }
+  // The tiles of the packed operand cover `tile` elements of the unpacked
+  // operand, except for the last partial tile.
+  for (auto it : llvm::zip(innerDimsPos, innerTiles)) {
+    int64_t dim = std::get<0>(it);
+    std::tie(unpackedOffsets[dim], unpackedSizes[dim]) = getSliceOfTiles(
+        b, loc, unpackedOffsets[dim], unpackedSizes[dim],
+        getDimValue(b, loc, unpacked, dim), std::get<1>(it), /*halo=*/0);
+  }
+  packedOffsets.assign(offsets.begin(), offsets.end());
+  packedOffsets.append(innerTiles.size(), b.getI64IntegerAttr(0));
+  packedSizes.assign(sizes.begin(), sizes.end());
+  for (int64_t tile : innerTiles)
+    packedSizes.push_back(b.getI64IntegerAttr(tile));
+}
+
+/// Builds the loop nest over the inner tiles of the pack and unpack ops at the
+/// outer indices `ivs` of the packed operand. `bodyBuilder` is called with the
+/// indices of the packed operand, the indices of the unpacked operand and the
+/// condition for the latter to be within `unpacked`.
+static void buildPackLikeLoopNest(
+    OpBuilder &b, Location loc, ValueRange ivs, Value unpacked,
+    ArrayRef<int64_t> innerDimsPos, ArrayRef<int64_t> innerTiles,
+    ArrayRef<int64_t> outerDimsPerm,
+    function_ref<void(OpBuilder &, Location, ValueRange, ValueRange, Value)>
+        bodyBuilder) {
+  Value zero = b.create<arith::ConstantIndexOp>(loc, 0);
+  Value one = b.create<arith::ConstantIndexOp>(loc, 1);
+  SmallVector<Value> lbs(innerTiles.size(), zero);
+  SmallVector<Value> steps(innerTiles.size(), one);
+  SmallVector<Value> ubs;
+  for (int64_t tile : innerTiles)
+    ubs.push_back(b.create<arith::ConstantIndexOp>(loc, tile));
+  SmallVector<int64_t> outerDimsPos = getPackedOuterDimsPos(outerDimsPerm);
+  scf::buildLoopNest(
+      b, loc, lbs, ubs, steps,
+      [&](OpBuilder &b, Location loc, ValueRange innerIvs) {
+        SmallVector<Value> packedIndices(ivs.begin(), ivs.end());
+        packedIndices.append(innerIvs.begin(), innerIvs.end());
+        SmallVector<Value> unpackedIndices;
+        for (int64_t pos : outerDimsPos)
+          unpackedIndices.push_back(ivs[pos]);
+        Value inBounds = b.create<arith::ConstantIntOp>(loc, 1, 1);
+        for (auto it : llvm::enumerate(llvm::zip(innerDimsPos, innerTiles))) {
+          int64_t dim = std::get<0>(it.value());
+          Value tile =
+              b.create<arith::ConstantIndexOp>(loc, std::get<1>(it.value()));
+          Value index = b.create<arith::AddIOp>(
+              loc, b.create<arith::MulIOp>(loc, unpackedIndices[dim], tile),
+              innerIvs[it.index()]);
+          unpackedIndices[dim] = index;
+          Value dimInBounds = b.create<arith::CmpIOp>(
+              loc, arith::CmpIPredicate::slt, index,
+              getDimValue(b, loc, unpacked, dim));
+          inBounds = b.create<arith::AndIOp>(loc, inBounds, dimInBounds);
+        }
+        bodyBuilder(b, loc, packedIndices, unpackedIndices, inBounds);
+      });
+}
+
+LogicalResult PackOp::verify() {
+  Operation *op = getOperation();
+  if (getNumInputs() != 1 && getNumInputs() != 2) {
+    return op->emitOpError("expected one input and an optional padding value");
+  }
+  if (getNumOutputs() != 1) {
+    return op->emitOpError("expected exactly one output");
+  }
+  if (!input().getType().isa<ShapedType>()) {
+    return op->emitOpError("expected a shaped input");
+  }
+  if (Value padding = paddingValue()) {
+    if (padding.getType() != getInputOperandType().getElementType()) {
+      return op->emitOpError(
+          "expected padding value to be a scalar of the input element type");
+    }
+  }
+  SmallVector<int64_t> innerDimsPos = getInnerDimsPos();
+  SmallVector<int64_t> innerTiles = getInnerTiles();
+  if (failed(verifyPackLikeOp(op, getUnpackedType(), getPackedType(),
+                              innerDimsPos, innerTiles, getOuterDimsPerm()))) {
+    return failure();
+  }
+  if (!paddingValue()) {
+    ArrayRef<int64_t> shape = getUnpackedType().getShape();
+    for (auto it : llvm::zip(innerDimsPos, innerTiles)) {
+      int64_t size = shape[std::get<0>(it)];
+      if (size != ShapedType::kDynamicSize && size % std::get<1>(it) != 0) {
+        return op->emitOpError("expected a padding value when the inner tiles "
+                               "do not divide the input");
+      }
+    }
+  }
+  return success();
+}
+
+SmallVector<StringRef> PackOp::getLoopIteratorTypes() {
+  return SmallVector<StringRef>(getUnpackedType().getRank(),
+                                getParallelIteratorTypeName());
+}
+
+SmallVector<Range> PackOp::getIterationDomain(OpBuilder &builder) {
+  return getPackLikeIterationDomain(builder, getLoc(), output(),
+                                    getUnpackedType().getRank());
+}
+
+SmallVector<unsigned>
+PackOp::getPartitionableLoops(unsigned maxNumParallelDims) {
+  return getPackLikePartitionableLoops(getUnpackedType().getRank(),
+                                       maxNumParallelDims);
+}
+
+Operation *PackOp::getTiledImplementation(OpBuilder &builder,
+                                          ValueRange outputs,
+                                          ArrayRef<OpFoldResult> offsets,
+                                          ArrayRef<OpFoldResult> sizes,
+                                          SmallVectorImpl<Value> &results) {
+  assert(outputs.size() == this->outputs().size());
+  Location loc = getLoc();
+  SmallVector<OpFoldResult> inputOffsets, inputSizes, outputOffsets,
+      outputSizes;
+  getPackLikeSlices(builder, loc, input(), getInnerDimsPos(), getInnerTiles(),
+                    getOuterDimsPerm(), offsets, sizes, inputOffsets,
+                    inputSizes, outputOffsets, outputSizes);
+  auto oneAttr = builder.getI64IntegerAttr(1);
+  SmallVector<OpFoldResult> inputStrides(inputOffsets.size(), oneAttr);
+  SmallVector<OpFoldResult> outputStrides(outputOffsets.size(), oneAttr);
+
+  SmallVector<Value> tiledOperands;
+  tiledOperands.emplace_back(getSlice(builder, loc, input(), inputOffsets,
+                                      inputSizes, inputStrides));
+  if (Value padding = paddingValue())
+    tiledOperands.push_back(padding);
+  tiledOperands.emplace_back(getSlice(builder, loc, outputs[0], outputOffsets,
+                                      outputSizes, outputStrides));
+
+  SmallVector<Type, 4> resultTypes;
+  if (hasTensorSemantics()) {
+    resultTypes.push_back(tiledOperands.back().getType());
+  }
+
+  Operation *tiledPackOp = cast<LinalgExtOp>(getOperation())
+                               .clone(builder, loc, resultTypes, tiledOperands);
+  for (auto result : llvm::enumerate(tiledPackOp->getResults())) {
+    auto insertSliceOp = builder.create<tensor::InsertSliceOp>(
+        loc, result.value(), outputs[result.index()], outputOffsets,
+        outputSizes, outputStrides);
+    results.push_back(insertSliceOp.getResult());
+  }
+  return tiledPackOp;
+}
+
+// Copies the inner tile at the outer indices `ivs` of the output from the
+// input, reading the padding value past the input.
+LogicalResult PackOp::generateScalarImplementation(OpBuilder &b, Location loc,
+                                                   ValueRange ivs) {
+  Value padding = paddingValue();
+  buildPackLikeLoopNest(
+      b, loc, ivs, input(), getInnerDimsPos(), getInnerTiles(),
+      getOuterDimsPerm(),
+      [&](OpBuilder &b, Location loc, ValueRange packedIndices,
+          ValueRange unpackedIndices, Value inBounds) {
+        if (!padding) {
+          Value value = b.create<memref::LoadOp>(loc, input(), unpackedIndices);
+          b.create<memref::StoreOp>(loc, value, output(), packedIndices);
+          return;
+        }
+        // Clamp the indices so that the load stays within the input.
+        SmallVector<Value> clampedIndices(unpackedIndices.begin(),
+                                          unpackedIndices.end());
+        Value one = b.create<arith::ConstantIndexOp>(loc, 1);
+        for (int64_t dim : getInnerDimsPos()) {
+          Value last = b.create<arith::SubIOp>(
+              loc, getDimValue(b, loc, input(), dim), one);
+          clampedIndices[dim] =
+              b.create<arith::MinSIOp>(loc, clampedIndices[dim], last);
+        }
+        Value value = b.create<memref::LoadOp>(loc, input(), clampedIndices);
+        value = b.create<arith::SelectOp>(loc, inBounds, value, padding);
+        b.create<memref::StoreOp>(loc, value, output(), packedIndices);
+      });
+  return success();
+}
+
+LogicalResult UnPackOp::verify() {
+  Operation *op = getOperation();
+  if (getNumInputs() != 1) {
+    return op->emitOpError("expected exactly one input");
+  }
+  if (getNumOutputs() != 1) {
+    return op->emitOpError("expected exactly one output");
+  }
+  return verifyPackLikeOp(op, getUnpackedType(), getPackedType(),
+                          getInnerDimsPos(), getInnerTiles(),
+                          getOuterDimsPerm());
+}
+
+SmallVector<StringRef> UnPackOp::getLoopIteratorTypes() {
+  return SmallVector<StringRef>(getUnpackedType().getRank(),
+                                getParallelIteratorTypeName());
+}
+
+SmallVector<Range> UnPackOp::getIterationDomain(OpBuilder &builder) {
+  return getPackLikeIterationDomain(builder, getLoc(), input(),
+                                    getUnpackedType().getRank());
+}
+
+SmallVector<unsigned>
+UnPackOp::getPartitionableLoops(unsigned maxNumParallelDims) {
+  return getPackLikePartitionableLoops(getUnpackedType().getRank(),
+                                       maxNumParallelDims);
+}
+
+Operation *UnPackOp::getTiledImplementation(OpBuilder &builder,
+                                            ValueRange outputs,
+                                            ArrayRef<OpFoldResult> offsets,
+                                            ArrayRef<OpFoldResult> sizes,
+                                            SmallVectorImpl<Value> &results) {
+  assert(outputs.size() == this->outputs().size());
+  Location loc = getLoc();
+  SmallVector<OpFoldResult> outputOffsets, outputSizes, inputOffsets,
+      inputSizes;
+  getPackLikeSlices(builder, loc, outputs[0], getInnerDimsPos(),
+                    getInnerTiles(), getOuterDimsPerm(), offsets, sizes,
+                    outputOffsets, outputSizes, inputOffsets, inputSizes);
+  auto oneAttr = builder.getI64IntegerAttr(1);
+  SmallVector<OpFoldResult> inputStrides(inputOffsets.size(), oneAttr);
+  SmallVector<OpFoldResult> outputStrides(outputOffsets.size(), oneAttr);
+
+  SmallVector<Value> tiledOperands;
+  tiledOperands.emplace_back(getSlice(builder, loc, input(), inputOffsets,
+                                      inputSizes, inputStrides));
+  tiledOperands.emplace_back(getSlice(builder, loc, outputs[0], outputOffsets,
+                                      outputSizes, outputStrides));
+
+  SmallVector<Type, 4> resultTypes;
+  if (hasTensorSemantics()) {
+    resultTypes.push_back(tiledOperands[1].getType());
+  }
+
+  Operation *tiledUnPackOp =
+      cast<LinalgExtOp>(getOperation())
+          .clone(builder, loc, resultTypes, tiledOperands);
+  for (auto result : llvm::enumerate(tiledUnPackOp->getResults())) {
+    auto insertSliceOp = builder.create<tensor::InsertSliceOp>(
+        loc, result.value(), outputs[result.index()], outputOffsets,
+        outputSizes, outputStrides);
+    results.push_back(insertSliceOp.getResult());
+  }
+  return tiledUnPackOp;
+}
+
+// Copies the inner tile at the outer indices `ivs` of the input to the output,
+// dropping the padding past the output.
+LogicalResult UnPackOp::generateScalarImplementation(OpBuilder &b,
+                                                     Location loc,
+                                                     ValueRange ivs) {
+  buildPackLikeLoopNest(
+      b, loc, ivs, output(), getInnerDimsPos(), getInnerTiles(),
+      getOuterDimsPerm(),
+      [&](OpBuilder &b, Location loc, ValueRange packedIndices,
+          ValueRange unpackedIndices, Value inBounds) {
+        b.create<scf::IfOp>(
+            loc, TypeRange{}, inBounds, [&](OpBuilder &b, Location loc) {
+              Value value =
+                  b.create<memref::LoadOp>(loc, input(), packedIndices);
+              b.create<memref::StoreOp>(loc, value, output(), unpackedIndices);
+              b.create<scf::YieldOp>(loc);
+            });
+      });
+  return success();
+}
+
+#define DEFINE_OP_GET_EFFECTS(OP_NAME)                                         \
+  void OP_NAME::getEffects(                                                    \
+      SmallVectorImpl<SideEffects::EffectInstance<MemoryEffects::Effect>>      \
+          &effects) {                                                          \
+    SmallVector<Value> inputBuffers = getInputBufferOperands();                \
+    SmallVector<Value> outputBuffers = getOutputBufferOperands();              \
+    getEffectsImpl(effects, getOperation()->getResults(), inputBuffers,        \
+                   outputBuffers);                                             \
+  }
+
+DEFINE_OP_GET_EFFECTS(ScatterOp)
+DEFINE_OP_GET_EFFECTS(SortOp)
+DEFINE_OP_GET_EFFECTS(FftOp)
+DEFINE_OP_GET_EFFECTS(ReverseOp)
+DEFINE_OP_GET_EFFECTS(ScanOp)
+DEFINE_OP_GET_EFFECTS(TopkOp)
+DEFINE_OP_GET_EFFECTS(SoftmaxOp)
+DEFINE_OP_GET_EFFECTS(WinogradInputTransformOp)
+DEFINE_OP_GET_EFFECTS(WinogradFilterTransformOp)
+DEFINE_OP_GET_EFFECTS(WinogradOutputTransformOp)
+DEFINE_OP_GET_EFFECTS(PackOp)
+DEFINE_OP_GET_EFFECTS(UnPackOp)
+
+namespace {
+/// This is derived from mlir/lib/Dialect/Linalg/IR/LinalgOps.cpp without any
+/// changes.
+struct FoldTensorCastOp : public OpInterfaceRewritePattern<LinalgExtOp> {
+  using OpInterfaceRewritePattern<LinalgExtOp>::OpInterfaceRewritePattern;
+
+  LogicalResult matchAndRewrite(LinalgExtOp op,
+                                PatternRewriter &rewriter) const override {
+    // If no operand comes from a tensor::CastOp and can be folded then fail.
+    bool hasTensorCastOperand =
+        llvm::any_of(op.getInputAndOutputOperands(), [&](OpOperand *opOperand) {
+          if (opOperand->get().isa<BlockArgument>())
+            return false;
+          auto castOp = opOperand->get().getDefiningOp<tensor::CastOp>();
+          return castOp && canFoldIntoConsumerOp(castOp);
+        });
+    if (!hasTensorCastOperand)
+      return failure();
+
+    SmallVector<Type, 4> newResultTypes;
+    newResultTypes.reserve(op->getNumResults());
+    SmallVector<Value, 4> newOperands;
+    newOperands.reserve(op->getNumOperands());
+    // Inputs may fold.
+    for (OpOperand *opOperand : op.getInputOperands()) {
+      auto tensorCastOp = opOperand->get().getDefiningOp<tensor::CastOp>();
+      newOperands.push_back(canFoldIntoConsumerOp(tensorCastOp)
+                                ? tensorCastOp.source()
+                                : opOperand->get());
+    }
+    // Init tensors may fold, in which case the resultType must also change.
+    for (OpOperand *opOperand : op.getOutputOperands()) {
+      auto tensorCastOp = opOperand->get().getDefiningOp<tensor::CastOp>();
+      bool fold = canFoldIntoConsumerOp(tensorCastOp);
+      newOperands.push_back(fold ? tensorCastOp.getOperand()
+                                 : opOperand->get());
+      newResultTypes.push_back(newOperands.back().getType());
+    }
+    // Clone op.
+    Operation *newOp =
+        op.clone(rewriter, op->getLoc(), newResultTypes, newOperands);
+    SmallVector<Value, 4> replacements;
+    replacements.reserve(newOp->getNumResults());
+    for (auto result : llvm::zip(op->getResults(), newOp->getResults())) {
+      Value oldResult = std::get<0>(result);
+      Value newResult = std::get<1>(result);
+      if (newResult.getType() != oldResult.getType()) {
+        replacements.push_back(rewriter.create<tensor::CastOp>(
+            op->getLoc(), oldResult.getType(), newResult));
+      } else {
+        replacements.push_back(newResult);
+      }
+    }
+    rewriter.replaceOp(op, replacements);
+
+    return success();
+  }
+};
+} // namespace
+
+//===----------------------------------------------------------------------===//
+// TileOp
+//===----------------------------------------------------------------------===//
+
+void TileOp::build(mlir::OpBuilder &builder, mlir::OperationState &result,
+                   Value tileSize, ValueRange outs, int64_t tiledDim,
+                   TileOp::TileOpBodyBuilderFn bodyBuilder) {
+  result.addOperands(tileSize);
+  result.addOperands(outs);
+  result.addAttribute(TileOp::getTiledDimAttrName(),
+                      builder.getI64IntegerAttr(tiledDim));
+  result.addTypes(outs.getType());
+
+  Region *bodyRegion = result.addRegion();
+  bodyRegion->push_back(new Block);
+  Block &bodyBlock = bodyRegion->front();
+  // TODO: Pass a better location here.
+  Location loc = tileSize.getLoc();
+  bodyBlock.addArgument(builder.getIndexType(), loc);
+  bodyBlock.addArgument(builder.getIndexType(), loc);
+  // Handle the sliced out types in a conservative fashion: all dimensions
+  // become dynamic and a later canonicalization is expected to recover static
+  // types.
+  // TODO: should we relax this and use something less strict?
+  auto dynamicTypes =
+      llvm::to_vector(llvm::map_range(outs.getTypes(), [](Type t) -> Type {
+        auto rankedTensorType = t.cast<RankedTensorType>();
+        RankedTensorType::Builder rttb(rankedTensorType);
+        SmallVector<int64_t> dynamicShape(rankedTensorType.getRank(),
+                                          ShapedType::kDynamicSize);
+        return rttb.setShape(dynamicShape);
+      }));
+  SmallVector<Location> locs(dynamicTypes.size(), loc);
+  bodyBlock.addArguments(dynamicTypes, locs);
+
+  OpBuilder::InsertionGuard guard(builder);
+  builder.setInsertionPointToStart(&bodyBlock);
+  bodyBuilder(builder, result.location, bodyBlock.getArgument(0),
+              bodyBlock.getArgument(1), bodyBlock.getArguments().drop_front(2));
+}
+
+void TileOp::build(mlir::OpBuilder &builder, mlir::OperationState &result,
+                   Value tileSize, ValueRange outs,
+                   TileOp::TileOpBodyBuilderFn bodyBuilder) {
+  TileOp::build(builder, result, tileSize, outs, 0, bodyBuilder);
+}
+
+// TODO(#81): Impl me.
+LogicalResult TileOp::verify() { return success(); }
+
+void TileOp::print(OpAsmPrinter &p) {
+  p << ' ' << tile_size() << ' ';
+  if (tiled_dim() > 0)
+    p << "tiled_dim = " << tiled_dim() << ' ';
+  if (!outs().empty()) {
+    p << "outs(";
+    llvm::interleaveComma(outs(), p,
+                          [&p](Value v) { p << v << ": " << v.getType(); });
+    p << ')';
+  }
+  p << " -> (" << getResultTypes() << ") ";
+  p.printRegion(region(),
+                /*printEntryBlockArgs=*/true,
+                /*printBlockTerminators=*/true);
+  p.printOptionalAttrDict(getOperation()->getAttrs(),
+                          /*elidedAttrs=*/{TileOp::getTiledDimAttrName()});
+}
+
+ParseResult TileOp::parse(OpAsmParser &parser, OperationState &result) {
+  auto &builder = parser.getBuilder();
+
+  OpAsmParser::UnresolvedOperand tileSizes;
+  // TODO: also allow tensor<..xindex> and figure out a good syntax.
+  // Type tensorOfIndexType =
+  //     RankedTensorType::get({ShapedType::kDynamicSize}, indexType);
+  Type tileSizesType = builder.getIndexType();
+  SmallVector<Type> outsTypes;
+  SmallVector<OpAsmParser::UnresolvedOperand, 4> outsOperands;
+
+  llvm::SMLoc outputsOperandsLoc;
+  if (parser.parseOperand(tileSizes) ||
+      parser.resolveOperand(tileSizes, tileSizesType, result.operands))
+    return failure();
+
+  // Parse the `tiled_dim` attribute or set it to 0 implicitly when elided.
+  if (succeeded(parser.parseOptionalKeyword(TileOp::getTiledDimAttrName()))) {
+    outputsOperandsLoc = parser.getCurrentLocation();
+    Attribute valueAttr;
+    parser.parseAttribute(valueAttr, TileOp::getTiledDimAttrName(),
+                          result.attributes);
+  } else {
+    result.attributes.append(TileOp::getTiledDimAttrName(),
+                             parser.getBuilder().getI64IntegerAttr(0));
+  }
+
+  if (succeeded(parser.parseOptionalKeyword("outs"))) {
+    bool _1;
+    SmallVector<NamedAttrList> _2;
+    SmallVector<Location> _3;
+    outputsOperandsLoc = parser.getCurrentLocation();
+    if (mlir::function_interface_impl::parseFunctionArgumentList(
+            parser,
+            /*allowAttributes=*/false,
+            /*allowVariadic=*/false, outsOperands, outsTypes, /*argAttrs=*/_2,
+            /*argLocations=*/_3,
+            /*isVariadic=*/_1) ||
+        parser.resolveOperands(outsOperands, outsTypes, outputsOperandsLoc,
+                               result.operands))
+      return failure();
+  }
+  if (parser.parseArrowTypeList(result.types))
+    return failure();
+
+  SmallVector<OpAsmParser::UnresolvedOperand, 8> regionOperands;
+  std::unique_ptr<Region> region = std::make_unique<Region>();
+  SmallVector<Type, 8> operandTypes, regionTypes;
+  if (parser.parseRegion(*region, regionOperands, regionTypes))
+    return failure();
+
+  // Parse the optional attribute list.
+  if (parser.parseOptionalAttrDict(result.attributes))
+    return failure();
+
+  TileOp::ensureTerminator(*region, builder, result.location);
+  result.addRegion(std::move(region));
+
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// InParallelOp
+//===----------------------------------------------------------------------===//
 
 LogicalResult InParallelOp::verify() {
   // Check that the body defines as single block argument for the thread index.
@@ -1416,9 +2962,21 @@ LogicalResult InParallelOp::verify() {
     i++;
   }
 
+  if (!isValidSchedule(schedule()))
+    return emitOpError("expected schedule to be one of 'static', 'dynamic' "
+                       "or 'guided', got '")
+           << schedule() << "'";
+  if (schedule() == "static" && (*this)->hasAttr(chunk_sizeAttrName()))
+    return emitOpError("expected chunk_size to only be specified with the "
+                       "'dynamic' or 'guided' schedules");
+
   return success();
 }
 
+bool InParallelOp::isValidSchedule(StringRef schedule) {
+  return schedule == "static" || schedule == "dynamic" || schedule == "guided";
+}
+
 void InParallelOp::print(OpAsmPrinter &p) {
   p << ' ' << num_threads() << ' ';
   p << " -> (" << getResultTypes() << ") ";
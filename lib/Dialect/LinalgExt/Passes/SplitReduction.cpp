@@ -0,0 +1,88 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "Dialect/LinalgExt/IR/LinalgExtDialect.h"
+#include "Dialect/LinalgExt/IR/LinalgExtOps.h"
+#include "Dialect/LinalgExt/Passes/PassDetail.h"
+#include "Dialect/LinalgExt/Passes/Passes.h"
+#include "Dialect/LinalgExt/Transforms/Transforms.h"
+#include "mlir/Dialect/Arithmetic/IR/Arithmetic.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+using namespace mlir;
+namespace IREE = mlir::iree_compiler::IREE;
+using namespace IREE::LinalgExt;
+
+/// Marker set on the topk ops created by the split to avoid splitting them
+/// again.
+static constexpr StringLiteral kSplitReductionMarker =
+    "__internal_topk_split_reduction__";
+
+namespace {
+
+/// Splits the topk ops with TopkOpSplitReductionRewriter and marks the topk
+/// ops it creates, such that the merging topk is not split again.
+struct TopkOpSplitReduction : public TopkOpSplitReductionRewriter {
+  using TopkOpSplitReductionRewriter::TopkOpSplitReductionRewriter;
+
+  LogicalResult matchAndRewrite(TopkOp topkOp,
+                                PatternRewriter &rewriter) const override {
+    if (topkOp->hasAttr(kSplitReductionMarker))
+      return failure();
+    FailureOr<TopkSplitReductionResult> result =
+        returningMatchAndRewrite(topkOp, rewriter);
+    if (failed(result))
+      return failure();
+    rewriter.updateRootInPlace(result->splitTopkOp, [&]() {
+      result->splitTopkOp->setAttr(kSplitReductionMarker,
+                                   rewriter.getUnitAttr());
+    });
+    rewriter.updateRootInPlace(result->mergeTopkOp, [&]() {
+      result->mergeTopkOp->setAttr(kSplitReductionMarker,
+                                   rewriter.getUnitAttr());
+    });
+    return success();
+  }
+};
+
+} // namespace
+
+//===----------------------------------------------------------------------===//
+// Pass
+//===----------------------------------------------------------------------===//
+
+namespace {
+struct TopkSplitReductionPass
+    : public TopkSplitReductionBase<TopkSplitReductionPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<linalg::LinalgDialect, mlir::arith::ArithmeticDialect,
+                    tensor::TensorDialect>();
+  }
+
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+
+    RewritePatternSet patterns(context);
+    patterns.insert<TopkOpSplitReduction>(context, splitRatio);
+    if (failed(applyPatternsAndFoldGreedily(getOperation(),
+                                            std::move(patterns)))) {
+      return signalPassFailure();
+    }
+    getOperation().walk(
+        [](TopkOp topkOp) { topkOp->removeAttr(kSplitReductionMarker); });
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+IREE::LinalgExt::createTopkSplitReductionPass() {
+  return std::make_unique<TopkSplitReductionPass>();
+}
@@ -0,0 +1,128 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "Dialect/LinalgExt/IR/LinalgExtOps.h"
+#include "Dialect/LinalgExt/Transforms/Transforms.h"
+#include "mlir/Dialect/Arithmetic/IR/Arithmetic.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/PatternMatch.h"
+
+using namespace mlir;
+using namespace mlir::iree_compiler::IREE::LinalgExt;
+
+static bool hasAllOneValues(DenseIntElementsAttr attr) {
+  return llvm::all_of(attr.getValues<int64_t>(),
+                      [](int64_t value) { return value == 1; });
+}
+
+/// Rewrites a static 3x3 stride-1 linalg.conv_2d_nhwc_hwcf on tensors with the
+/// Winograd algorithm F(m x m, 3 x 3), where m is `outputTileSize`, into:
+///   1. the filter transform U of shape [m + 2, m + 2, C, F],
+///   2. the input transform V of shape [m + 2, m + 2, N, tH, tW, C],
+///   3. a linalg.batch_matmul of V and U, collapsed to
+///      [(m + 2)^2, N * tH * tW, C] and [(m + 2)^2, C, F],
+///   4. the output transform of the expanded product, accumulated into the
+///      output of the convolution.
+/// The multiplications of the convolution are reduced by 9m^2 / (m + 2)^2,
+/// i.e. 2.25x for F(2x2, 3x3) and 4x for F(4x4, 3x3), and moved into a batched
+/// matmul that the matmul strategies already handle.
+FailureOr<linalg::BatchMatmulOp> mlir::iree_compiler::IREE::LinalgExt::
+    ConvOpToWinogradRewriter::returningMatchAndRewrite(
+        linalg::Conv2DNhwcHwcfOp convOp, PatternRewriter &rewriter) const {
+  if (!convOp.hasTensorSemantics())
+    return rewriter.notifyMatchFailure(convOp, "expected tensor semantics");
+  if (outputTileSize != 2 && outputTileSize != 4)
+    return rewriter.notifyMatchFailure(convOp,
+                                       "expected output tile size 2 or 4");
+  if (!hasAllOneValues(convOp.strides()) ||
+      !hasAllOneValues(convOp.dilations()))
+    return rewriter.notifyMatchFailure(convOp,
+                                       "expected unit strides and dilations");
+
+  Value input = convOp.getInputOperand(0)->get();
+  Value filter = convOp.getInputOperand(1)->get();
+  Value output = convOp.getOutputOperand(0)->get();
+  auto inputType = input.getType().cast<ShapedType>();
+  auto filterType = filter.getType().cast<ShapedType>();
+  auto outputType = output.getType().cast<ShapedType>();
+  if (!inputType.hasStaticShape() || !filterType.hasStaticShape() ||
+      !outputType.hasStaticShape())
+    return rewriter.notifyMatchFailure(convOp, "expected static shapes");
+  Type elementType = inputType.getElementType();
+  if (!elementType.isa<FloatType>() ||
+      filterType.getElementType() != elementType ||
+      outputType.getElementType() != elementType)
+    return rewriter.notifyMatchFailure(convOp,
+                                       "expected identical float types");
+  int64_t kernelSize = WinogradFilterTransformOp::getKernelSize();
+  if (filterType.getDimSize(0) != kernelSize ||
+      filterType.getDimSize(1) != kernelSize)
+    return rewriter.notifyMatchFailure(convOp, "expected a 3x3 kernel");
+  // The transforms assume a valid convolution, whose output is kernelSize - 1
+  // smaller than its input along H and W: a larger input would be partially
+  // ignored and a smaller one read out of bounds.
+  if (outputType.getDimSize(1) != inputType.getDimSize(1) - kernelSize + 1 ||
+      outputType.getDimSize(2) != inputType.getDimSize(2) - kernelSize + 1)
+    return rewriter.notifyMatchFailure(
+        convOp, "expected the output to be kernel size - 1 smaller than the "
+                "input along H and W");
+
+  int64_t n = inputType.getDimSize(0);
+  int64_t c = inputType.getDimSize(3);
+  int64_t f = filterType.getDimSize(3);
+  int64_t tileH = (outputType.getDimSize(1) + outputTileSize - 1) /
+                  outputTileSize;
+  int64_t tileW = (outputType.getDimSize(2) + outputTileSize - 1) /
+                  outputTileSize;
+  int64_t t = outputTileSize + kernelSize - 1;
+
+  Location loc = convOp.getLoc();
+  auto tileSizeAttr = rewriter.getI64IntegerAttr(outputTileSize);
+  Value filterInit = rewriter.create<linalg::InitTensorOp>(
+      loc, ArrayRef<int64_t>{t, t, c, f}, elementType);
+  Value transformedFilter =
+      rewriter
+          .create<WinogradFilterTransformOp>(loc, filterInit.getType(), filter,
+                                             filterInit, tileSizeAttr)
+          .getResult(0);
+  Value inputInit = rewriter.create<linalg::InitTensorOp>(
+      loc, ArrayRef<int64_t>{t, t, n, tileH, tileW, c}, elementType);
+  Value transformedInput =
+      rewriter
+          .create<WinogradInputTransformOp>(loc, inputInit.getType(), input,
+                                            inputInit, tileSizeAttr)
+          .getResult(0);
+
+  // Every one of the (m + 2)^2 points of the transformed tiles is an
+  // independent [N * tH * tW, C] x [C, F] matmul.
+  SmallVector<ReassociationIndices> filterReassociation = {{0, 1}, {2}, {3}};
+  SmallVector<ReassociationIndices> tilesReassociation = {
+      {0, 1}, {2, 3, 4}, {5}};
+  Value lhs = rewriter.create<tensor::CollapseShapeOp>(loc, transformedInput,
+                                                       tilesReassociation);
+  Value rhs = rewriter.create<tensor::CollapseShapeOp>(loc, transformedFilter,
+                                                       filterReassociation);
+  Value zero = rewriter.create<arith::ConstantOp>(
+      loc, rewriter.getZeroAttr(elementType));
+  Value matmulInit = rewriter.create<linalg::InitTensorOp>(
+      loc, ArrayRef<int64_t>{t * t, n * tileH * tileW, f}, elementType);
+  Value matmulFill = rewriter
+                         .create<linalg::FillOp>(loc, ValueRange{zero},
+                                                 ValueRange{matmulInit})
+                         .getResult(0);
+  auto matmulOp = rewriter.create<linalg::BatchMatmulOp>(
+      loc, matmulFill.getType(), ValueRange{lhs, rhs}, matmulFill);
+  auto productType =
+      RankedTensorType::get({t, t, n, tileH, tileW, f}, elementType);
+  Value product = rewriter.create<tensor::ExpandShapeOp>(
+      loc, productType, matmulOp.getResult(0), tilesReassociation);
+
+  rewriter.replaceOpWithNewOp<WinogradOutputTransformOp>(
+      convOp, convOp->getResultTypes(), product, output, tileSizeAttr);
+  return matmulOp;
+}
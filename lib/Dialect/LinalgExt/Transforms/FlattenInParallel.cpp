@@ -0,0 +1,107 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "Dialect/LinalgExt/IR/LinalgExtOps.h"
+#include "Dialect/LinalgExt/Transforms/Transforms.h"
+#include "mlir/Dialect/Arithmetic/IR/Arithmetic.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "llvm/ADT/STLExtras.h"
+
+using namespace mlir;
+using namespace mlir::iree_compiler::IREE::LinalgExt;
+
+/// Returns true if `value` is defined above the region of `op`.
+static bool isDefinedAbove(Value value, InParallelOp op) {
+  return !op.region().isAncestor(value.getParentRegion());
+}
+
+/// Flattens a bufferized InParallelOp into its parent InParallelOp, in place:
+///   1. the parent iterates over the product of the numbers of threads,
+///   2. its thread index is delinearized into the thread indices of the two
+///      levels,
+///   3. the body of the nested InParallelOp is inlined into the parent body.
+/// The other ops of the parent body are thus executed once per thread of the
+/// flattened op and must be side-effect free. The number of threads of the
+/// nested op must be defined above the parent. Both ops must have the static
+/// schedule: the chunks claimed by a dynamic or guided schedule are ranges of
+/// thread indices of one level, the flattened op would claim ranges of the
+/// product instead and lose the chunk size. The flattened parent op is
+/// returned, it may itself be flattened into its own parent.
+FailureOr<InParallelOp> mlir::iree_compiler::IREE::LinalgExt::
+    InParallelOpFlatteningRewriter::returningMatchAndRewrite(
+        iree_compiler::IREE::LinalgExt::InParallelOp inParallelOp,
+        PatternRewriter &rewriter) const {
+  auto parentOp = dyn_cast_or_null<InParallelOp>(inParallelOp->getParentOp());
+  if (!parentOp) {
+    return rewriter.notifyMatchFailure(inParallelOp,
+                                       "expected a parent InParallelOp");
+  }
+  if (inParallelOp.getNumResults() != 0 || parentOp.getNumResults() != 0) {
+    return rewriter.notifyMatchFailure(inParallelOp,
+                                       "expected bufferized InParallelOps");
+  }
+  if (inParallelOp.schedule() != "static" || parentOp.schedule() != "static") {
+    return rewriter.notifyMatchFailure(
+        inParallelOp, "expected static schedules on both InParallelOps");
+  }
+  Value innerNumThreads = inParallelOp.num_threads();
+  if (!isDefinedAbove(innerNumThreads, parentOp)) {
+    return rewriter.notifyMatchFailure(
+        inParallelOp, "expected the number of threads to be defined above the "
+                      "parent InParallelOp");
+  }
+  for (Operation &op : parentOp.getBody()->without_terminator()) {
+    if (&op != inParallelOp.getOperation() && !wouldOpBeTriviallyDead(&op)) {
+      return rewriter.notifyMatchFailure(
+          inParallelOp, "expected the parent InParallelOp to only contain "
+                        "side-effect free ops besides the nested one");
+    }
+  }
+
+  // Compute the flattened number of threads above the outermost InParallelOp
+  // it can be hoisted out of, so that it remains defined above the ancestors
+  // the parent may be flattened into.
+  Value outerNumThreads = parentOp.num_threads();
+  Operation *insertionPoint = parentOp;
+  while (auto ancestor = insertionPoint->getParentOfType<InParallelOp>()) {
+    if (!isDefinedAbove(outerNumThreads, ancestor) ||
+        !isDefinedAbove(innerNumThreads, ancestor))
+      break;
+    insertionPoint = ancestor;
+  }
+  Location loc = parentOp.getLoc();
+  OpBuilder::InsertionGuard g(rewriter);
+  rewriter.setInsertionPoint(insertionPoint);
+  Value numThreads =
+      rewriter.create<arith::MulIOp>(loc, outerNumThreads, innerNumThreads);
+  rewriter.updateRootInPlace(
+      parentOp, [&]() { parentOp.num_threadsMutable().assign(numThreads); });
+
+  // Delinearize the flattened thread index.
+  rewriter.setInsertionPointToStart(parentOp.getBody());
+  Value threadIndex = parentOp.getThreadIndex();
+  auto outerIndex =
+      rewriter.create<arith::DivUIOp>(loc, threadIndex, innerNumThreads);
+  auto innerIndex =
+      rewriter.create<arith::RemUIOp>(loc, threadIndex, innerNumThreads);
+  for (OpOperand &use : llvm::make_early_inc_range(threadIndex.getUses())) {
+    Operation *owner = use.getOwner();
+    if (owner == outerIndex.getOperation() ||
+        owner == innerIndex.getOperation())
+      continue;
+    rewriter.updateRootInPlace(owner,
+                               [&]() { use.set(outerIndex.getResult()); });
+  }
+
+  // Inline the nested body and drop its terminator.
+  rewriter.mergeBlockBefore(inParallelOp.getBody(), inParallelOp,
+                            ValueRange{innerIndex.getResult()});
+  rewriter.eraseOp(inParallelOp->getPrevNode());
+  rewriter.eraseOp(inParallelOp);
+  return parentOp;
+}
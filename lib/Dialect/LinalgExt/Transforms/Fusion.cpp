@@ -11,6 +11,7 @@
 #include "mlir/Dialect/Linalg/Transforms/Transforms.h"
 #include "mlir/Dialect/Linalg/Utils/Utils.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
 #include "mlir/IR/Operation.h"
 #include "mlir/IR/OperationSupport.h"
 #include "mlir/IR/PatternMatch.h"
@@ -117,3 +118,262 @@ FailureOr<FusionResult> LinalgExtFusionPattern::returningMatchAndRewrite(
 
   return FusionResult{consumerOp, fusedOps};
 }
+
+/// Returns true if the tiles of `consumerOp` can be computed from the tiles of
+/// its `fusedOperand`, i.e. if it is elementwise, has a single output and both
+/// the fused operand and the output are indexed by permutations.
+static bool isFusableConsumer(linalg::LinalgOp consumerOp,
+                              OpOperand *fusedOperand) {
+  if (!consumerOp.hasTensorSemantics() || consumerOp.getNumOutputs() != 1 ||
+      consumerOp.getNumParallelLoops() != consumerOp.getNumLoops() ||
+      consumerOp.hasIndexSemantics())
+    return false;
+  if (!llvm::all_of(consumerOp.getIndexingMaps(), [](AffineMap map) {
+        return map.isProjectedPermutation();
+      }))
+    return false;
+  OpOperand *outputOperand = consumerOp.getOutputOperand(0);
+  return consumerOp.getTiedIndexingMap(fusedOperand).isPermutation() &&
+         consumerOp.getTiedIndexingMap(outputOperand).isPermutation();
+}
+
+/// Returns true if all the uses of the results of `loopOp` but `consumerOp`
+/// come after `consumerOp`, so that the loop can be recreated at its position.
+static bool canMoveLoopToConsumer(Operation *loopOp, Operation *consumerOp) {
+  Block *block = consumerOp->getBlock();
+  if (loopOp->getBlock() != block)
+    return false;
+  return llvm::all_of(loopOp->getUsers(), [&](Operation *user) {
+    Operation *ancestor = block->findAncestorOpInBlock(*user);
+    return ancestor == consumerOp || consumerOp->isBeforeInBlock(ancestor);
+  });
+}
+
+/// Returns the offsets and sizes of the `consumerOp` loops given the `offsets`
+/// and `sizes` of the tile of its `fusedOperand`.
+static void getLoopTile(linalg::LinalgOp consumerOp, OpOperand *fusedOperand,
+                        ArrayRef<OpFoldResult> offsets,
+                        ArrayRef<OpFoldResult> sizes,
+                        SmallVectorImpl<OpFoldResult> &loopOffsets,
+                        SmallVectorImpl<OpFoldResult> &loopSizes) {
+  AffineMap fusedMap = consumerOp.getTiedIndexingMap(fusedOperand);
+  loopOffsets.resize(fusedMap.getNumDims());
+  loopSizes.resize(fusedMap.getNumDims());
+  for (unsigned i = 0, e = fusedMap.getNumResults(); i < e; ++i) {
+    loopOffsets[fusedMap.getDimPosition(i)] = offsets[i];
+    loopSizes[fusedMap.getDimPosition(i)] = sizes[i];
+  }
+}
+
+/// Returns the offsets and sizes of the `opOperand` tile given the offsets and
+/// sizes of the `consumerOp` loops.
+static void getOperandTile(linalg::LinalgOp consumerOp, OpOperand *opOperand,
+                           ArrayRef<OpFoldResult> loopOffsets,
+                           ArrayRef<OpFoldResult> loopSizes,
+                           SmallVectorImpl<OpFoldResult> &offsets,
+                           SmallVectorImpl<OpFoldResult> &sizes) {
+  AffineMap indexingMap = consumerOp.getTiedIndexingMap(opOperand);
+  for (unsigned i = 0, e = indexingMap.getNumResults(); i < e; ++i) {
+    unsigned dim = indexingMap.getDimPosition(i);
+    offsets.push_back(loopOffsets[dim]);
+    sizes.push_back(loopSizes[dim]);
+  }
+}
+
+/// Creates the tile of `consumerOp` at `loopOffsets` and `loopSizes` that
+/// consumes the `fusedTile` of its `fusedOperand` and updates `outputTile`.
+/// The other operands are sliced to the matching tiles.
+static linalg::LinalgOp
+createTiledConsumer(OpBuilder &b, Location loc, linalg::LinalgOp consumerOp,
+                    OpOperand *fusedOperand, Value fusedTile,
+                    ArrayRef<OpFoldResult> loopOffsets,
+                    ArrayRef<OpFoldResult> loopSizes, Value outputTile) {
+  SmallVector<Value> tiledOperands;
+  for (OpOperand *opOperand : consumerOp.getInputOperands()) {
+    Value operand = opOperand->get();
+    if (opOperand == fusedOperand) {
+      tiledOperands.push_back(fusedTile);
+      continue;
+    }
+    if (!operand.getType().isa<RankedTensorType>()) {
+      tiledOperands.push_back(operand);
+      continue;
+    }
+    SmallVector<OpFoldResult> operandOffsets, operandSizes;
+    getOperandTile(consumerOp, opOperand, loopOffsets, loopSizes,
+                   operandOffsets, operandSizes);
+    SmallVector<OpFoldResult> strides(operandOffsets.size(), b.getIndexAttr(1));
+    tiledOperands.push_back(b.create<tensor::ExtractSliceOp>(
+        loc, operand, operandOffsets, operandSizes, strides));
+  }
+  tiledOperands.push_back(outputTile);
+  return cast<linalg::LinalgOp>(consumerOp.clone(
+      b, loc, TypeRange{outputTile.getType()}, tiledOperands));
+}
+
+/// Fuses `consumerOp` into the `tileOp` producing its `fusedOperand`. The
+/// consumer output becomes an additional `outs` operand of the loop.
+static FailureOr<Operation *>
+fuseConsumerIntoTileOp(PatternRewriter &rewriter, TileOp tileOp,
+                       linalg::LinalgOp consumerOp, OpOperand *fusedOperand) {
+  // The yielded tiles are concatenated along the tiled dimension, which must
+  // thus index the same loop of the consumer in its output and in the fused
+  // operand.
+  int64_t tiledDim = tileOp.tiled_dim();
+  AffineMap fusedMap = consumerOp.getTiedIndexingMap(fusedOperand);
+  AffineMap outputMap =
+      consumerOp.getTiedIndexingMap(consumerOp.getOutputOperand(0));
+  if (tiledDim >= fusedMap.getNumResults() ||
+      fusedMap.getDimPosition(tiledDim) != outputMap.getDimPosition(tiledDim))
+    return failure();
+
+  // Recreate the loop at the position of the consumer with the consumer output
+  // as an additional `outs` operand and move the body into it.
+  Location loc = consumerOp.getLoc();
+  rewriter.setInsertionPoint(consumerOp);
+  SmallVector<Value> outs = llvm::to_vector(tileOp.outs());
+  outs.push_back(consumerOp.getOutputOperand(0)->get());
+  auto fusedTileOp = rewriter.create<TileOp>(
+      loc, tileOp.tile_size(), outs, tiledDim,
+      [](OpBuilder &, Location, Value, Value, ValueRange) {});
+  Block *body = fusedTileOp.getBody();
+  rewriter.mergeBlocks(tileOp.getBody(), body,
+                       body->getArguments().drop_back());
+
+  // Apply the consumer to the yielded tile of the fused operand, which has the
+  // full size along all dimensions but the tiled one.
+  auto yieldOp = cast<TileYieldOp>(body->getTerminator());
+  rewriter.setInsertionPoint(yieldOp);
+  auto fusedResult = fusedOperand->get().cast<OpResult>();
+  Value fusedTile = yieldOp.getOperand(fusedResult.getResultNumber());
+  SmallVector<OpFoldResult> offsets, sizes;
+  for (int64_t dim = 0, e = fusedMap.getNumResults(); dim < e; ++dim) {
+    if (dim == tiledDim) {
+      offsets.push_back(body->getArgument(0));
+      sizes.push_back(body->getArgument(1));
+      continue;
+    }
+    offsets.push_back(rewriter.getIndexAttr(0));
+    sizes.push_back(getDim(rewriter, loc, fusedTile, dim));
+  }
+  SmallVector<OpFoldResult> loopOffsets, loopSizes;
+  getLoopTile(consumerOp, fusedOperand, offsets, sizes, loopOffsets, loopSizes);
+  linalg::LinalgOp tiledConsumerOp = createTiledConsumer(
+      rewriter, loc, consumerOp, fusedOperand, fusedTile, loopOffsets,
+      loopSizes, body->getArguments().back());
+  SmallVector<Value> yieldedValues = llvm::to_vector(yieldOp.getOperands());
+  yieldedValues.push_back(tiledConsumerOp->getResult(0));
+  rewriter.replaceOpWithNewOp<TileYieldOp>(yieldOp, yieldedValues);
+
+  rewriter.replaceOp(consumerOp, fusedTileOp->getResults().back());
+  rewriter.replaceOp(tileOp, fusedTileOp->getResults().drop_back());
+  return fusedTileOp.getOperation();
+}
+
+/// Fuses `consumerOp` into the `inParallelOp` producing its `fusedOperand`.
+/// Every thread applies the consumer to the slice it inserts into the fused
+/// operand and inserts the result into the consumer output.
+static FailureOr<Operation *>
+fuseConsumerIntoInParallelOp(PatternRewriter &rewriter,
+                             InParallelOp inParallelOp,
+                             linalg::LinalgOp consumerOp,
+                             OpOperand *fusedOperand) {
+  auto fusedResult = fusedOperand->get().cast<OpResult>();
+  PerformConcurrentlyOp performOp = inParallelOp.getTerminator();
+  ParallelInsertSliceOp insertOp =
+      performOp.yieldingOps()[fusedResult.getResultNumber()];
+  auto destType = insertOp.dest().getType().cast<RankedTensorType>();
+  if (insertOp.getSourceType().getRank() != destType.getRank() ||
+      !llvm::all_of(insertOp.getMixedStrides(), [](OpFoldResult stride) {
+        return isConstantIntValue(stride, 1);
+      }))
+    return failure();
+
+  // The fused result is dropped if the consumer is its only use.
+  bool keepFusedResult = !fusedResult.hasOneUse();
+  SmallVector<Type> resultTypes;
+  for (OpResult result : inParallelOp->getResults()) {
+    if (result != fusedResult || keepFusedResult)
+      resultTypes.push_back(result.getType());
+  }
+  resultTypes.push_back(consumerOp->getResult(0).getType());
+
+  // Recreate the loop at the position of the consumer and move the body into
+  // it.
+  Location loc = consumerOp.getLoc();
+  rewriter.setInsertionPoint(consumerOp);
+  auto fusedInParallelOp = rewriter.create<InParallelOp>(
+      loc, resultTypes, inParallelOp.num_threads());
+  fusedInParallelOp->setAttrs(inParallelOp->getAttrs());
+  rewriter.eraseOp(fusedInParallelOp.getTerminator());
+  rewriter.mergeBlocks(inParallelOp.getBody(), fusedInParallelOp.getBody(),
+                       {fusedInParallelOp.getThreadIndex()});
+
+  // Apply the consumer to the inserted slice and insert the result into the
+  // consumer output.
+  rewriter.setInsertionPoint(performOp);
+  SmallVector<OpFoldResult> offsets = insertOp.getMixedOffsets();
+  SmallVector<OpFoldResult> sizes = insertOp.getMixedSizes();
+  SmallVector<OpFoldResult> loopOffsets, loopSizes;
+  getLoopTile(consumerOp, fusedOperand, offsets, sizes, loopOffsets, loopSizes);
+  OpOperand *outputOperand = consumerOp.getOutputOperand(0);
+  SmallVector<OpFoldResult> outputOffsets, outputSizes;
+  getOperandTile(consumerOp, outputOperand, loopOffsets, loopSizes,
+                 outputOffsets, outputSizes);
+  SmallVector<OpFoldResult> strides(outputOffsets.size(),
+                                    rewriter.getIndexAttr(1));
+  Value outputTile = rewriter.create<tensor::ExtractSliceOp>(
+      loc, outputOperand->get(), outputOffsets, outputSizes, strides);
+  linalg::LinalgOp tiledConsumerOp =
+      createTiledConsumer(rewriter, loc, consumerOp, fusedOperand,
+                          insertOp.source(), loopOffsets, loopSizes,
+                          outputTile);
+  rewriter.setInsertionPoint(performOp.getBody()->getTerminator());
+  rewriter.create<ParallelInsertSliceOp>(loc, tiledConsumerOp->getResult(0),
+                                         outputOperand->get(), outputOffsets,
+                                         outputSizes, strides);
+
+  // Replace the consumer and the results of the original loop. The dropped
+  // result has no use left once the consumer is replaced, it is replaced by
+  // the tensor it was inserted into.
+  rewriter.replaceOp(consumerOp, fusedInParallelOp->getResults().back());
+  SmallVector<Value> replacements;
+  unsigned resultNumber = 0;
+  for (OpResult result : inParallelOp->getResults()) {
+    if (result == fusedResult && !keepFusedResult) {
+      replacements.push_back(insertOp.dest());
+      continue;
+    }
+    replacements.push_back(fusedInParallelOp->getResult(resultNumber++));
+  }
+  if (!keepFusedResult)
+    rewriter.eraseOp(insertOp);
+  rewriter.replaceOp(inParallelOp, replacements);
+  return fusedInParallelOp.getOperation();
+}
+
+FailureOr<Operation *> LinalgExtConsumerFusionPattern::returningMatchAndRewrite(
+    linalg::LinalgOp consumerOp, PatternRewriter &rewriter) const {
+  // Check the operand to fuse is a result of a TileOp or an InParallelOp.
+  if (operandToFuse >= consumerOp.getNumInputs())
+    return failure();
+  OpOperand *fusedOperand = consumerOp.getInputOperand(operandToFuse);
+  Operation *loopOp = fusedOperand->get().getDefiningOp();
+  if (!loopOp || !isa<TileOp, InParallelOp>(loopOp) ||
+      !isFusableConsumer(consumerOp, fusedOperand) ||
+      !canMoveLoopToConsumer(loopOp, consumerOp))
+    return failure();
+
+  // The other operands are used inside the fused loop and can thus not be
+  // produced by the loop.
+  if (llvm::any_of(consumerOp->getOpOperands(), [&](OpOperand &opOperand) {
+        return &opOperand != fusedOperand &&
+               opOperand.get().getDefiningOp() == loopOp;
+      }))
+    return failure();
+
+  if (auto tileOp = dyn_cast<TileOp>(loopOp))
+    return fuseConsumerIntoTileOp(rewriter, tileOp, consumerOp, fusedOperand);
+  return fuseConsumerIntoInParallelOp(rewriter, cast<InParallelOp>(loopOp),
+                                      consumerOp, fusedOperand);
+}
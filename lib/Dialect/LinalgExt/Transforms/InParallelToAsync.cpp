@@ -13,6 +13,8 @@
 #include "mlir/Dialect/Arithmetic/IR/Arithmetic.h"
 #include "mlir/Dialect/Async/IR/Async.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/SCF/SCF.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/IR/AffineExpr.h"
@@ -26,6 +28,94 @@
 using namespace mlir;
 using namespace mlir::iree_compiler::IREE::LinalgExt;
 
+/// Creates an empty async::ExecuteOp whose body is built by `bodyBuilder`
+/// and adds its token to `asyncGroup`.
+static void
+buildExecuteInGroup(OpBuilder &b, Location loc, Value asyncGroup,
+                    function_ref<void(OpBuilder &, Location)> bodyBuilder) {
+  auto executeOp = b.create<async::ExecuteOp>(
+      loc, /*resultTypes=*/TypeRange(),
+      /*dependencies=*/ValueRange(), /*operands=*/ValueRange(),
+      [&](OpBuilder &b, Location loc, ValueRange executeArgs) {
+        bodyBuilder(b, loc);
+        b.create<async::YieldOp>(loc, ValueRange{});
+      });
+  b.create<async::AddToGroupOp>(loc, b.getIndexType(), executeOp.token(),
+                                asyncGroup);
+}
+
+/// Builds a loop that claims chunks of the iterations [0, numThreads) from the
+/// shared `counter` until all of them are claimed, and returns the scf.for
+/// iterating over every claimed chunk. With the dynamic schedule, the chunks
+/// have `chunkSize` iterations and are claimed by an atomic add. With the
+/// guided schedule, a chunk has 1/numTasks of the remaining iterations and at
+/// least `chunkSize` of them, it is claimed by a compare-and-swap loop.
+static scf::ForOp buildClaimLoop(OpBuilder &b, Location loc, Value counter,
+                                 Value numThreads, Value numTasks, bool guided,
+                                 int64_t chunkSize) {
+  Type i64Type = b.getI64Type();
+  Value one = b.create<arith::ConstantIndexOp>(loc, 1);
+  Value numThreadsI64 = b.create<arith::IndexCastOp>(loc, i64Type, numThreads);
+  Value numTasksI64 = b.create<arith::IndexCastOp>(loc, i64Type, numTasks);
+  Value chunkSizeI64 = b.create<arith::ConstantIntOp>(loc, chunkSize, 64);
+  // Returns the end of the chunk starting at `begin`. The guided counter thus
+  // never exceeds `numThreads`.
+  auto buildChunkEnd = [&](OpBuilder &b, Location loc, Value begin) -> Value {
+    Value size = chunkSizeI64;
+    if (guided) {
+      Value remaining = b.create<arith::SubIOp>(loc, numThreadsI64, begin);
+      size = b.create<arith::MaxSIOp>(
+          loc, b.create<arith::CeilDivSIOp>(loc, remaining, numTasksI64),
+          chunkSizeI64);
+    }
+    return b.create<arith::MinSIOp>(
+        loc, b.create<arith::AddIOp>(loc, begin, size), numThreadsI64);
+  };
+
+  SmallVector<Type> types(2, i64Type);
+  SmallVector<Location> locs(2, loc);
+  auto whileOp = b.create<scf::WhileOp>(loc, types, ValueRange{});
+  OpBuilder::InsertionGuard g(b);
+  b.createBlock(&whileOp.getBefore());
+  Value begin;
+  if (guided) {
+    auto claimOp =
+        b.create<memref::GenericAtomicRMWOp>(loc, counter, ValueRange{});
+    {
+      OpBuilder::InsertionGuard g(b);
+      Value current = claimOp.getCurrentValue();
+      b.setInsertionPointToStart(current.getParentBlock());
+      b.create<memref::AtomicYieldOp>(loc, buildChunkEnd(b, loc, current));
+    }
+    begin = claimOp.getResult();
+  } else {
+    begin = b.create<memref::AtomicRMWOp>(loc, i64Type,
+                                          arith::AtomicRMWKind::addi,
+                                          chunkSizeI64, counter, ValueRange{});
+  }
+  Value claimed = b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::slt,
+                                          begin, numThreadsI64);
+  b.create<scf::ConditionOp>(
+      loc, claimed, ValueRange{begin, buildChunkEnd(b, loc, begin)});
+
+  Block *after = b.createBlock(&whileOp.getAfter(), {}, types, locs);
+  Type indexType = b.getIndexType();
+  auto forOp = b.create<scf::ForOp>(
+      loc, b.create<arith::IndexCastOp>(loc, indexType, after->getArgument(0)),
+      b.create<arith::IndexCastOp>(loc, indexType, after->getArgument(1)), one);
+  b.create<scf::YieldOp>(loc);
+  return forOp;
+}
+
+/// Rewrites a bufferized InParallelOp into async tasks. With the static
+/// schedule, each task executes a contiguous block of `blockSize` iterations
+/// of the InParallelOp in a sequential scf.for. With the dynamic and guided
+/// schedules, there are as many tasks but they claim chunks of iterations
+/// from a shared atomic counter until all of them are claimed, see
+/// `buildClaimLoop`. The tasks are spawned by a two-level tree: the caller
+/// spawns ceil(sqrt(numBlocks)) spawner tasks, each of which spawns up to
+/// ceil(sqrt(numBlocks)) block tasks. Task submission thus runs in parallel
+/// and takes O(sqrt(numBlocks)) sequential steps instead of O(numThreads).
 FailureOr<Operation *> mlir::iree_compiler::IREE::LinalgExt::
     InParallelOpToAsyncRewriter::returningMatchAndRewrite(
         iree_compiler::IREE::LinalgExt::InParallelOp inParallelOp,
@@ -33,57 +123,133 @@ FailureOr<Operation *> mlir::iree_compiler::IREE::LinalgExt::
   assert(inParallelOp.getNumResults() == 0 &&
          "expected bufferized InParallelOp");
 
-  // Only consider the top level InParallelOp op and skip if it already
-  // contains an ExecuteOp.
-  if (inParallelOp
-          ->getParentOfType<iree_compiler::IREE::LinalgExt::InParallelOp>() ||
-      llvm::any_of(inParallelOp.getBody()->getOperations(),
+  // Flatten a nested InParallelOp into its parent so that all the levels of
+  // parallelism contribute tasks once the parent is rewritten. Dynamic and
+  // guided schedules do not flatten: such a nested InParallelOp is rewritten
+  // on its own, its tasks are spawned by the tasks of its parent.
+  auto parentOp =
+      inParallelOp
+          ->getParentOfType<iree_compiler::IREE::LinalgExt::InParallelOp>();
+  if (parentOp && inParallelOp.schedule() == "static" &&
+      parentOp.schedule() == "static") {
+    FailureOr<InParallelOp> flattened =
+        InParallelOpFlatteningRewriter(getContext())
+            .returningMatchAndRewrite(inParallelOp, rewriter);
+    if (failed(flattened))
+      return failure();
+    return flattened->getOperation();
+  }
+  // Skip if it already contains an ExecuteOp.
+  if (llvm::any_of(inParallelOp.getBody()->getOperations(),
                    [](Operation &op) { return isa<async::ExecuteOp>(&op); }))
     return failure();
+  if (blockSize < 1)
+    return rewriter.notifyMatchFailure(inParallelOp,
+                                       "expected a positive block size");
 
   auto *ctx = inParallelOp.getContext();
   Location loc = inParallelOp.getLoc();
   Value zero = rewriter.create<arith::ConstantIndexOp>(loc, 0);
   Value one = rewriter.create<arith::ConstantIndexOp>(loc, 1);
+  Value blockSizeValue =
+      rewriter.create<arith::ConstantIndexOp>(loc, blockSize);
   Value numThreads = inParallelOp.num_threads();
 
-  // Wrap the linalg_ext.in_parallel into an async::ExecuteOp.
-  // 1. Create the async::GroupType object on which we synchronize.
+  using AV = AffineValueExpr;
+  AffineBuilder ab(rewriter, loc);
+  AffineExpr i, j, M;
+  bindDims(ctx, i, j);
+  bindSymbols(ctx, M);
+
+  // 1. Compute the number of blocks and the fan-out of the spawn tree:
+  // fanOut = max(ceil(sqrt(numBlocks)), 1).
+  Value numBlocks =
+      ab.ceil(AV(i).bind(numThreads), AV(M).bind(blockSizeValue));
+  Value numBlocksF64 = rewriter.create<arith::SIToFPOp>(
+      loc, rewriter.getF64Type(),
+      rewriter.create<arith::IndexCastOp>(loc, rewriter.getI64Type(),
+                                          numBlocks));
+  Value fanOut = rewriter.create<arith::IndexCastOp>(
+      loc, rewriter.getIndexType(),
+      rewriter.create<arith::FPToSIOp>(
+          loc, rewriter.getI64Type(),
+          rewriter.create<math::CeilOp>(
+              loc, rewriter.create<math::SqrtOp>(loc, numBlocksF64))));
+  fanOut = rewriter.create<arith::MaxSIOp>(loc, fanOut, one);
+  Value numSpawners = ab.ceil(AV(i).bind(numBlocks), AV(M).bind(fanOut));
+
+  // 2. Create the async::GroupType object on which we synchronize, it
+  // receives the tokens of the spawner and of the block tasks.
   Value asyncGroup = rewriter.create<async::CreateGroupOp>(
-      loc, async::GroupType::get(ctx), numThreads);
-
-  // 2. Create a bodyless forOp.
-  scf::ForOp forOp = rewriter.create<scf::ForOp>(loc, zero, numThreads, one);
-  rewriter.setInsertionPointToStart(forOp.getBody());
-
-  // 3. Create an empty executeOp, nested within the forOp.
-  auto noopExec = [&](OpBuilder &executeBuilder, Location executeLoc,
-                      ValueRange executeArgs) {};
-  auto executeOp =
-      rewriter.create<async::ExecuteOp>(loc, /*resultTypes=*/TypeRange(),
-                                        /*dependencies=*/ValueRange(),
-                                        /*operands=*/ValueRange(), noopExec);
-
-  // 3. Steal the iree_compiler::IREE::LinalgExt::InParallel ops, except the
-  // terminator, into the body of the async::ExecuteOp, just before the
+      loc, async::GroupType::get(ctx),
+      ab.add(AV(i).bind(numBlocks), AV(j).bind(numSpawners)));
+
+  // 2.b. With a dynamic or guided schedule, allocate the counter of the
+  // claimed iterations.
+  StringRef schedule = inParallelOp.schedule();
+  int64_t chunkSize = inParallelOp.chunk_size();
+  Value counter;
+  if (schedule != "static") {
+    counter = rewriter.create<memref::AllocOp>(
+        loc, MemRefType::get({}, rewriter.getI64Type()));
+    rewriter.create<memref::StoreOp>(
+        loc, rewriter.create<arith::ConstantIntOp>(loc, 0, 64), counter);
+  }
+
+  // 3. Spawn the tree of tasks, the innermost scf.for iterates over the
+  // iterations of the block and receives the body of the InParallelOp.
+  scf::ForOp threadForOp;
+  rewriter.create<scf::ForOp>(
+      loc, zero, numSpawners, one, ValueRange{},
+      [&](OpBuilder &b, Location loc, Value spawnerIndex, ValueRange) {
+        buildExecuteInGroup(b, loc, asyncGroup, [&](OpBuilder &b,
+                                                    Location loc) {
+          AffineBuilder ab(b, loc);
+          Value blockBegin =
+              ab.mul(AV(i).bind(spawnerIndex), AV(M).bind(fanOut));
+          Value blockEnd = ab.min(ValueRange{
+              ab.add(AV(i).bind(blockBegin), AV(j).bind(fanOut)), numBlocks});
+          b.create<scf::ForOp>(
+              loc, blockBegin, blockEnd, one, ValueRange{},
+              [&](OpBuilder &b, Location loc, Value blockIndex, ValueRange) {
+                buildExecuteInGroup(b, loc, asyncGroup, [&](OpBuilder &b,
+                                                            Location loc) {
+                  if (counter) {
+                    threadForOp =
+                        buildClaimLoop(b, loc, counter, numThreads, numBlocks,
+                                       schedule == "guided", chunkSize);
+                    return;
+                  }
+                  AffineBuilder ab(b, loc);
+                  Value begin = ab.mul(AV(i).bind(blockIndex),
+                                       AV(M).bind(blockSizeValue));
+                  Value end = ab.min(
+                      ValueRange{ab.add(AV(i).bind(begin),
+                                        AV(j).bind(blockSizeValue)),
+                                 numThreads});
+                  threadForOp = b.create<scf::ForOp>(loc, begin, end, one);
+                });
+                b.create<scf::YieldOp>(loc);
+              });
+        });
+        b.create<scf::YieldOp>(loc);
+      });
+
+  // 4. Steal the iree_compiler::IREE::LinalgExt::InParallel ops, except the
+  // terminator, into the body of the innermost scf.for, just before its
   // terminator.
-  SmallVector<Value> bbArgsTranslated{forOp.getInductionVar()};
-  rewriter.mergeBlocks(&inParallelOp.region().front(), executeOp.getBody(),
-                       bbArgsTranslated);
-  // 3.b. Erase the terminator stolen from inParallelOp.
-  rewriter.eraseOp(&executeOp.getBody()->back());
-  // 3.c. Erase inParallelOp.
+  Operation *threadForTerminator = threadForOp.getBody()->getTerminator();
+  rewriter.mergeBlockBefore(&inParallelOp.region().front(), threadForTerminator,
+                            ValueRange{threadForOp.getInductionVar()});
+  // 4.b. Erase the terminator stolen from inParallelOp.
+  rewriter.eraseOp(threadForTerminator->getPrevNode());
+  // 4.c. Erase inParallelOp.
   rewriter.eraseOp(inParallelOp);
-  // 3.d. Add ExecuteOp terminator.
-  rewriter.setInsertionPointToEnd(executeOp.getBody());
-  rewriter.create<async::YieldOp>(loc, ValueRange{});
-  // 3.e. Add to group within the loop.
-  rewriter.setInsertionPoint(forOp.getBody()->getTerminator());
-  rewriter.create<async::AddToGroupOp>(loc, rewriter.getIndexType(),
-                                       executeOp.token(), asyncGroup);
-
-  // 4. After the iree_compiler::IREE::LinalgExt::InParallel, await all async
+
+  // 5. After the iree_compiler::IREE::LinalgExt::InParallel, await all async
   // tasks in `asyncGroup`.
-  rewriter.setInsertionPointAfter(forOp);
-  return rewriter.create<async::AwaitAllOp>(loc, asyncGroup).getOperation();
+  auto awaitAllOp = rewriter.create<async::AwaitAllOp>(loc, asyncGroup);
+  if (counter)
+    rewriter.create<memref::DeallocOp>(loc, counter);
+  return awaitAllOp.getOperation();
 }
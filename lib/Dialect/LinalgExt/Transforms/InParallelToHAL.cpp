@@ -102,6 +102,11 @@ FailureOr<SmallVector<Operation *>> mlir::iree_compiler::IREE::LinalgExt::
 
   Location loc = inParallelOp.getLoc();
 
+  // Every iteration becomes a workgroup and the device dispatches the
+  // workgroups to its compute units as they become idle: the schedule of the
+  // InParallelOp is dynamic with chunks of one iteration, whatever its
+  // schedule attribute.
+
   // #of enclosing InParallelOp determine the #idx in:
   //   hal.interface.workgroup.id[#idx] : index
   //   hal.interface.workgroup.count[#idx] : index
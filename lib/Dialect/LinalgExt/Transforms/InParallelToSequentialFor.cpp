@@ -35,6 +35,8 @@ SmallVector<Value> getValuesToYield(PerformConcurrentlyOp op) {
 FailureOr<scf::ForOp> InParallelOpToScfForRewriter::returningMatchAndRewrite(
     InParallelOp inParallelOp, PatternRewriter &rewriter) const {
   // Construct the loop bounds based on the canonical arithmetic progression.
+  // A single thread runs all the iterations in order, whatever the schedule:
+  // there is nothing to balance.
   Location loc = inParallelOp.getLoc();
   Value zero = rewriter.create<arith::ConstantIndexOp>(loc, 0);
   Value one = rewriter.create<arith::ConstantIndexOp>(loc, 1);
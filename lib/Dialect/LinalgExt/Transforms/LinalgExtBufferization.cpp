@@ -314,6 +314,142 @@ struct ParallelInsertSliceOpInterface
     return false;
   }
 };
+
+/// Bufferization of SoftmaxOp. The output is the destination of the op and
+/// bufferizes in-place with its result. It is entirely overwritten, so only the
+/// input is read.
+struct SoftmaxOpInterface
+    : public BufferizableOpInterface::ExternalModel<SoftmaxOpInterface,
+                                                    SoftmaxOp> {
+  bool bufferizesToMemoryRead(Operation *op, OpOperand &opOperand,
+                              const AnalysisState &state) const {
+    return cast<SoftmaxOp>(op).isInputTensor(&opOperand);
+  }
+
+  bool bufferizesToMemoryWrite(Operation *op, OpOperand &opOperand,
+                               const AnalysisState &state) const {
+    return cast<SoftmaxOp>(op).isOutputTensor(&opOperand);
+  }
+
+  SmallVector<OpOperand *>
+  getAliasingOpOperand(Operation *op, OpResult opResult,
+                       const AnalysisState &state) const {
+    return {cast<SoftmaxOp>(op).getOutputOperand(0)};
+  }
+
+  SmallVector<OpResult> getAliasingOpResult(Operation *op, OpOperand &opOperand,
+                                            const AnalysisState &state) const {
+    if (!cast<SoftmaxOp>(op).isOutputTensor(&opOperand))
+      return {};
+    return {op->getOpResult(0)};
+  }
+
+  BufferRelation bufferRelation(Operation *op, OpResult opResult,
+                                const AnalysisState &state) const {
+    return BufferRelation::Equivalent;
+  }
+
+  LogicalResult bufferize(Operation *op, RewriterBase &b,
+                          BufferizationState &state) const {
+    OpBuilder::InsertionGuard g(b);
+    auto softmaxOp = cast<SoftmaxOp>(op);
+    if (!softmaxOp.hasTensorSemantics())
+      return op->emitError("expected op with tensor semantics");
+
+    FailureOr<Value> inputBuffer =
+        state.getBuffer(b, *softmaxOp.getInputOperand(0),
+                        /*forceInPlace=*/true);
+    if (failed(inputBuffer))
+      return failure();
+    FailureOr<Value> outputBuffer =
+        state.getBuffer(b, *softmaxOp.getOutputOperand(0));
+    if (failed(outputBuffer))
+      return failure();
+
+    // Create a new SoftmaxOp without any results.
+    b.setInsertionPoint(op);
+    cast<LinalgExtOp>(op).clone(b, op->getLoc(), /*resultTypes=*/TypeRange{},
+                                ValueRange{*inputBuffer, *outputBuffer});
+
+    // Replace the op.
+    replaceOpWithBufferizedValues(b, op, *outputBuffer);
+
+    return success();
+  }
+};
+
+/// Bufferization of PackOp and UnPackOp. The output is the destination of the
+/// op and bufferizes in-place with its result. It is entirely overwritten,
+/// padding included, so only the tensor input is read.
+template <typename OpTy>
+struct PackLikeOpInterface
+    : public BufferizableOpInterface::ExternalModel<PackLikeOpInterface<OpTy>,
+                                                    OpTy> {
+  bool bufferizesToMemoryRead(Operation *op, OpOperand &opOperand,
+                              const AnalysisState &state) const {
+    return cast<OpTy>(op).isInputTensor(&opOperand);
+  }
+
+  bool bufferizesToMemoryWrite(Operation *op, OpOperand &opOperand,
+                               const AnalysisState &state) const {
+    return cast<OpTy>(op).isOutputTensor(&opOperand);
+  }
+
+  SmallVector<OpOperand *>
+  getAliasingOpOperand(Operation *op, OpResult opResult,
+                       const AnalysisState &state) const {
+    return {cast<OpTy>(op).getOutputOperand(0)};
+  }
+
+  SmallVector<OpResult> getAliasingOpResult(Operation *op, OpOperand &opOperand,
+                                            const AnalysisState &state) const {
+    if (!cast<OpTy>(op).isOutputTensor(&opOperand))
+      return {};
+    return {op->getOpResult(0)};
+  }
+
+  BufferRelation bufferRelation(Operation *op, OpResult opResult,
+                                const AnalysisState &state) const {
+    return BufferRelation::Equivalent;
+  }
+
+  LogicalResult bufferize(Operation *op, RewriterBase &b,
+                          BufferizationState &state) const {
+    OpBuilder::InsertionGuard g(b);
+    auto packLikeOp = cast<OpTy>(op);
+    if (!packLikeOp.hasTensorSemantics())
+      return op->emitError("expected op with tensor semantics");
+
+    // The padding value of a PackOp is a scalar input and is kept as is.
+    SmallVector<Value> newOperands;
+    for (OpOperand *opOperand : packLikeOp.getInputOperands()) {
+      if (packLikeOp.isScalar(opOperand)) {
+        newOperands.push_back(opOperand->get());
+        continue;
+      }
+      FailureOr<Value> buffer =
+          state.getBuffer(b, *opOperand, /*forceInPlace=*/true);
+      if (failed(buffer))
+        return failure();
+      newOperands.push_back(*buffer);
+    }
+    FailureOr<Value> outputBuffer =
+        state.getBuffer(b, *packLikeOp.getOutputOperand(0));
+    if (failed(outputBuffer))
+      return failure();
+    newOperands.push_back(*outputBuffer);
+
+    // Create a new op without any results.
+    b.setInsertionPoint(op);
+    cast<LinalgExtOp>(op).clone(b, op->getLoc(), /*resultTypes=*/TypeRange{},
+                                newOperands);
+
+    // Replace the op.
+    replaceOpWithBufferizedValues(b, op, *outputBuffer);
+
+    return success();
+  }
+};
 } // namespace LinalgExt
 } // namespace IREE
 } // namespace iree_compiler
@@ -328,5 +464,8 @@ void mlir::iree_compiler::IREE::LinalgExt::
             *ctx);
         ParallelInsertSliceOp::attachInterface<ParallelInsertSliceOpInterface>(
             *ctx);
+        SoftmaxOp::attachInterface<SoftmaxOpInterface>(*ctx);
+        PackOp::attachInterface<PackLikeOpInterface<PackOp>>(*ctx);
+        UnPackOp::attachInterface<PackLikeOpInterface<UnPackOp>>(*ctx);
       });
 }
@@ -0,0 +1,186 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "Dialect/LinalgExt/IR/LinalgExtOps.h"
+#include "Dialect/LinalgExt/Transforms/Transforms.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Tensor/Utils/Utils.h"
+#include "mlir/IR/AffineMap.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/PatternMatch.h"
+
+using namespace mlir;
+using namespace mlir::iree_compiler::IREE::LinalgExt;
+
+namespace {
+/// Layout of the unpacked operand of a pack or unpack op once its tiled
+/// dimensions are split into (number of tiles, tile) dimension pairs.
+struct ExpandedLayout {
+  /// Shape of the unpacked operand padded to a multiple of the inner tiles.
+  SmallVector<int64_t> paddedShape;
+  /// Shape of the padded unpacked operand with the tiled dimensions split.
+  SmallVector<int64_t> expandedShape;
+  /// Reassociation between the padded and the expanded shapes.
+  SmallVector<ReassociationIndices> reassociation;
+  /// Map from the dimensions of the packed operand to the dimensions of the
+  /// expanded shape, i.e. the transposition performed by the pack op.
+  AffineMap packedToExpanded;
+};
+} // namespace
+
+/// Returns the ExpandedLayout of the static `unpackedShape`.
+template <typename OpTy>
+static ExpandedLayout getExpandedLayout(OpTy op,
+                                        ArrayRef<int64_t> unpackedShape,
+                                        MLIRContext *context) {
+  SmallVector<int64_t> innerDimsPos = op.getInnerDimsPos();
+  SmallVector<int64_t> innerTiles = op.getInnerTiles();
+  SmallVector<int64_t> outerDimsPerm = op.getOuterDimsPerm();
+  int64_t rank = unpackedShape.size();
+
+  // Position of every unpacked dimension among the outer packed dimensions,
+  // and position of the tile of the tiled ones among the inner dimensions.
+  SmallVector<int64_t> outerPos(rank);
+  for (auto dim : llvm::enumerate(outerDimsPerm))
+    outerPos[dim.value()] = dim.index();
+  SmallVector<Optional<int64_t>> innerPos(rank);
+  for (auto dim : llvm::enumerate(innerDimsPos))
+    innerPos[dim.value()] = rank + dim.index();
+
+  ExpandedLayout layout;
+  SmallVector<AffineExpr> exprs;
+  for (int64_t dim = 0; dim < rank; ++dim) {
+    int64_t size = unpackedShape[dim];
+    int64_t expandedDim = layout.expandedShape.size();
+    exprs.push_back(getAffineDimExpr(outerPos[dim], context));
+    if (!innerPos[dim]) {
+      layout.paddedShape.push_back(size);
+      layout.expandedShape.push_back(size);
+      layout.reassociation.push_back({expandedDim});
+      continue;
+    }
+    int64_t tile = innerTiles[*innerPos[dim] - rank];
+    int64_t numTiles = llvm::divideCeil(size, tile);
+    layout.paddedShape.push_back(numTiles * tile);
+    layout.expandedShape.append({numTiles, tile});
+    layout.reassociation.push_back({expandedDim, expandedDim + 1});
+    exprs.push_back(getAffineDimExpr(*innerPos[dim], context));
+  }
+  layout.packedToExpanded =
+      AffineMap::get(rank + innerTiles.size(), 0, exprs, context);
+  return layout;
+}
+
+/// Rewrites a static PackOp on tensors into:
+///   1. a tensor.pad of the input to a multiple of the inner tiles, if needed,
+///   2. a tensor.expand_shape splitting the tiled dimensions,
+///   3. a parallel linalg.generic transposing the expanded input into the
+///      output.
+/// The linalg.generic vectorizes to transposing transfers that lower to
+/// vector.transpose.
+FailureOr<linalg::GenericOp>
+mlir::iree_compiler::IREE::LinalgExt::PackOpToLinalgRewriter::
+    returningMatchAndRewrite(iree_compiler::IREE::LinalgExt::PackOp packOp,
+                             PatternRewriter &rewriter) const {
+  if (!packOp.hasTensorSemantics())
+    return rewriter.notifyMatchFailure(packOp, "expected tensor semantics");
+  ShapedType inputType = packOp.getInputOperandType();
+  if (!inputType.hasStaticShape() ||
+      !packOp.getOutputOperandType().hasStaticShape())
+    return rewriter.notifyMatchFailure(packOp, "expected static shapes");
+
+  Location loc = packOp.getLoc();
+  ExpandedLayout layout =
+      getExpandedLayout(packOp, inputType.getShape(), rewriter.getContext());
+  Value input = packOp.input();
+  if (ArrayRef<int64_t>(layout.paddedShape) != inputType.getShape()) {
+    Value padding = packOp.paddingValue();
+    if (!padding)
+      return rewriter.notifyMatchFailure(packOp, "expected a padding value");
+    auto paddedType =
+        RankedTensorType::get(layout.paddedShape, inputType.getElementType());
+    input = tensor::createPadHighOp(paddedType, input, padding,
+                                    /*nofold=*/false, loc, rewriter);
+  }
+  auto expandedType =
+      RankedTensorType::get(layout.expandedShape, inputType.getElementType());
+  Value expanded = rewriter.create<tensor::ExpandShapeOp>(
+      loc, expandedType, input, layout.reassociation);
+
+  int64_t packedRank = packOp.getPackedType().getRank();
+  SmallVector<StringRef> iteratorTypes(packedRank,
+                                       getParallelIteratorTypeName());
+  auto transposeOp = rewriter.create<linalg::GenericOp>(
+      loc, packOp.output().getType(), expanded, packOp.output(),
+      ArrayRef<AffineMap>{layout.packedToExpanded,
+                          rewriter.getMultiDimIdentityMap(packedRank)},
+      iteratorTypes, [](OpBuilder &b, Location loc, ValueRange args) {
+        b.create<linalg::YieldOp>(loc, args[0]);
+      });
+  rewriter.replaceOp(packOp, transposeOp->getResults());
+  return transposeOp;
+}
+
+/// Rewrites a static UnPackOp on tensors into:
+///   1. a parallel linalg.generic transposing the input into the output with
+///      its dimensions split, or into a padded temporary if the inner tiles do
+///      not divide the output,
+///   2. a tensor.collapse_shape merging back the split dimensions,
+///   3. a tensor.extract_slice dropping the padding, if needed.
+FailureOr<linalg::GenericOp>
+mlir::iree_compiler::IREE::LinalgExt::UnPackOpToLinalgRewriter::
+    returningMatchAndRewrite(iree_compiler::IREE::LinalgExt::UnPackOp unpackOp,
+                             PatternRewriter &rewriter) const {
+  if (!unpackOp.hasTensorSemantics())
+    return rewriter.notifyMatchFailure(unpackOp, "expected tensor semantics");
+  ShapedType outputType = unpackOp.getOutputOperandType();
+  if (!outputType.hasStaticShape() ||
+      !unpackOp.getInputOperandType().hasStaticShape())
+    return rewriter.notifyMatchFailure(unpackOp, "expected static shapes");
+
+  Location loc = unpackOp.getLoc();
+  ExpandedLayout layout =
+      getExpandedLayout(unpackOp, outputType.getShape(), rewriter.getContext());
+  bool isPadded =
+      ArrayRef<int64_t>(layout.paddedShape) != outputType.getShape();
+  auto expandedType =
+      RankedTensorType::get(layout.expandedShape, outputType.getElementType());
+  Value init;
+  if (isPadded) {
+    init = rewriter.create<linalg::InitTensorOp>(loc, layout.expandedShape,
+                                                 outputType.getElementType());
+  } else {
+    init = rewriter.create<tensor::ExpandShapeOp>(
+        loc, expandedType, unpackOp.output(), layout.reassociation);
+  }
+
+  int64_t packedRank = unpackOp.getPackedType().getRank();
+  SmallVector<StringRef> iteratorTypes(packedRank,
+                                       getParallelIteratorTypeName());
+  auto transposeOp = rewriter.create<linalg::GenericOp>(
+      loc, expandedType, unpackOp.input(), init,
+      ArrayRef<AffineMap>{rewriter.getMultiDimIdentityMap(packedRank),
+                          layout.packedToExpanded},
+      iteratorTypes, [](OpBuilder &b, Location loc, ValueRange args) {
+        b.create<linalg::YieldOp>(loc, args[0]);
+      });
+  Value result = rewriter.create<tensor::CollapseShapeOp>(
+      loc, transposeOp.getResult(0), layout.reassociation);
+  if (isPadded) {
+    SmallVector<OpFoldResult> offsets(outputType.getRank(),
+                                      rewriter.getI64IntegerAttr(0));
+    SmallVector<OpFoldResult> strides(outputType.getRank(),
+                                      rewriter.getI64IntegerAttr(1));
+    SmallVector<OpFoldResult> sizes;
+    for (int64_t size : outputType.getShape())
+      sizes.push_back(rewriter.getI64IntegerAttr(size));
+    result = rewriter.create<tensor::ExtractSliceOp>(loc, result, offsets,
+                                                     sizes, strides);
+  }
+  rewriter.replaceOp(unpackOp, result);
+  return transposeOp;
+}
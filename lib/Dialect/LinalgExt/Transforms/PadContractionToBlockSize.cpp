@@ -0,0 +1,240 @@
+// Copyright 2021 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "Dialect/LinalgExt/Transforms/Transforms.h"
+#include "mlir/Dialect/Arithmetic/IR/Arithmetic.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/SCF/SCF.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Tensor/Utils/Utils.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/TypeUtilities.h"
+
+using namespace mlir;
+using namespace mlir::iree_compiler::IREE::LinalgExt;
+
+static Value sliceTensor(Location loc, Value expanded, Value original,
+                         OpBuilder &builder) {
+  auto originalType = original.getType().cast<RankedTensorType>();
+  auto rank = originalType.getRank();
+  SmallVector<OpFoldResult> offsets(rank, builder.getI64IntegerAttr(0));
+  SmallVector<OpFoldResult> strides(rank, builder.getI64IntegerAttr(1));
+  SmallVector<OpFoldResult> sizes(rank);
+  for (int i = 0, e = rank; i < e; ++i) {
+    if (!originalType.isDynamicDim(i)) {
+      sizes[i] = builder.getI64IntegerAttr(originalType.getDimSize(i));
+    } else {
+      sizes[i] = builder.create<tensor::DimOp>(loc, original, i).getResult();
+    }
+  }
+
+  return builder.create<tensor::ExtractSliceOp>(loc, expanded, offsets, sizes,
+                                                strides);
+}
+
+/// Returns `original` padded with zeros to multiples of the power-of-two
+/// `alignments`, or a null value if it is statically aligned already.
+static Value padTensor(Location loc, Value original,
+                       ArrayRef<int64_t> alignments, OpBuilder &builder) {
+  auto type = original.getType().cast<RankedTensorType>();
+  ArrayRef<int64_t> shape = type.getShape();
+  assert(shape.size() == alignments.size() &&
+         "expected shape and alignments to match");
+
+  // New dimensions.
+  SmallVector<int64_t> newStaticDims;
+  newStaticDims.resize(shape.size(), -1);
+  SmallVector<OpFoldResult> newPaddingSizes(shape.size(),
+                                            builder.getI64IntegerAttr(0));
+
+  // Compute padded dims.
+  bool needsPad = false;
+  for (int i = 0, e = shape.size(); i < e; ++i) {
+    auto inputDim = shape[i];
+    auto alignment = alignments[i];
+    if (inputDim >= 0) {
+      // Static dim.
+      if ((inputDim % alignment) == 0) {
+        newStaticDims[i] = inputDim;
+        continue;
+      }
+      int64_t alignedDim = (inputDim + (alignment - 1)) & ~(alignment - 1);
+      newStaticDims[i] = alignedDim;
+      newPaddingSizes[i] = builder.getI64IntegerAttr(alignedDim - inputDim);
+      needsPad = true;
+    } else {
+      // Dynamic dim, aligned to (dim + alignment - 1) & -alignment.
+      Value inputDimValue = builder.create<tensor::DimOp>(loc, original, i);
+      Value bias = builder.create<arith::ConstantIndexOp>(loc, alignment - 1);
+      Value mask = builder.create<arith::ConstantIndexOp>(loc, -alignment);
+      Value alignedDim = builder.create<arith::AndIOp>(
+          loc, builder.create<arith::AddIOp>(loc, inputDimValue, bias), mask);
+      newPaddingSizes[i] =
+          builder.create<arith::SubIOp>(loc, alignedDim, inputDimValue)
+              .getResult();
+      needsPad = true;
+    }
+  }
+  if (!needsPad)
+    return {};
+
+  auto resultType = RankedTensorType::get(newStaticDims, type.getElementType());
+  Value zeroConstant = builder.create<arith::ConstantOp>(
+      loc, builder.getZeroAttr(type.getElementType()));
+  SmallVector<OpFoldResult> zeroStaticLow(shape.size(),
+                                          builder.getI64IntegerAttr(0));
+  return tensor::createPadScalarOp(resultType, original, zeroConstant,
+                                   zeroStaticLow, newPaddingSizes, false, loc,
+                                   builder);
+}
+
+/// Creates a copy of the row-major matmul `linalgOp` on operands padded to the
+/// given alignments of its M, N and K dimensions. Returns the copy and the
+/// unpadded slice of its result in `result`.
+static linalg::LinalgOp padMatmul(Location loc, linalg::LinalgOp linalgOp,
+                                  int64_t mAlignment, int64_t nAlignment,
+                                  int64_t kAlignment, Value &result,
+                                  OpBuilder &builder) {
+  Value lhs = linalgOp.getInputOperand(0)->get();
+  Value rhs = linalgOp.getInputOperand(1)->get();
+  Value output = linalgOp.getOutputOperand(0)->get();
+
+  Value paddedLhs = padTensor(loc, lhs, {mAlignment, kAlignment}, builder);
+  Value paddedRhs = padTensor(loc, rhs, {kAlignment, nAlignment}, builder);
+  Value paddedOutput =
+      padTensor(loc, output, {mAlignment, nAlignment}, builder);
+  SmallVector<Value> operands = {paddedLhs ? paddedLhs : lhs,
+                                 paddedRhs ? paddedRhs : rhs,
+                                 paddedOutput ? paddedOutput : output};
+  auto paddedOp = cast<linalg::LinalgOp>(linalgOp.clone(
+      builder, loc, operands.back().getType(), operands));
+  result = paddedOp->getResult(0);
+
+  // Insert an appropriate extract.
+  if (paddedOutput)
+    result = sliceTensor(loc, result, output, builder);
+  return paddedOp;
+}
+
+/// Returns true if some dimension of `value` with a non-unit alignment is
+/// static and misaligned, in which case the value is padded whatever the
+/// dynamic dimensions.
+static bool hasMisalignedStaticDim(Value value, ArrayRef<int64_t> alignments) {
+  ArrayRef<int64_t> shape = value.getType().cast<RankedTensorType>().getShape();
+  for (auto it : llvm::zip(shape, alignments)) {
+    int64_t dim = std::get<0>(it);
+    if (!ShapedType::isDynamic(dim) && dim % std::get<1>(it) != 0)
+      return true;
+  }
+  return false;
+}
+
+/// Returns an i1 value that is true if all the dynamic dimensions of `value`
+/// are multiples of their power-of-two alignment, or null if there is no
+/// dynamic dimension with a non-unit alignment.
+static Value buildIsAligned(Location loc, Value value,
+                            ArrayRef<int64_t> alignments, Value isAligned,
+                            OpBuilder &builder) {
+  auto type = value.getType().cast<RankedTensorType>();
+  for (int i = 0, e = type.getRank(); i < e; ++i) {
+    if (!type.isDynamicDim(i) || alignments[i] == 1)
+      continue;
+    Value dim = builder.create<tensor::DimOp>(loc, value, i);
+    Value mask =
+        builder.create<arith::ConstantIndexOp>(loc, alignments[i] - 1);
+    Value zero = builder.create<arith::ConstantIndexOp>(loc, 0);
+    Value isDimAligned = builder.create<arith::CmpIOp>(
+        loc, arith::CmpIPredicate::eq,
+        builder.create<arith::AndIOp>(loc, dim, mask), zero);
+    isAligned = isAligned
+                    ? builder.create<arith::AndIOp>(loc, isAligned,
+                                                    isDimAligned)
+                    : isDimAligned;
+  }
+  return isAligned;
+}
+
+/// Returns the alignment of a dimension that is the contiguous dimension of
+/// `operands`, i.e. `alignment` rounded up to a full vector of
+/// `vectorBitWidth` bits of each operand element type.
+static int64_t getVectorAlignment(int64_t alignment, int64_t vectorBitWidth,
+                                  ValueRange operands) {
+  if (vectorBitWidth <= 0)
+    return alignment;
+  for (Value operand : operands) {
+    Type elementType = getElementTypeOrSelf(operand);
+    if (!elementType.isIntOrFloat())
+      continue;
+    int64_t bitWidth = elementType.getIntOrFloatBitWidth();
+    if (vectorBitWidth % bitWidth == 0)
+      alignment = std::max<int64_t>(alignment, vectorBitWidth / bitWidth);
+  }
+  return alignment;
+}
+
+FailureOr<linalg::LinalgOp> mlir::iree_compiler::IREE::LinalgExt::
+    PadContractionToBlockSizeRewriter::returningMatchAndRewrite(
+        linalg::LinalgOp linalgOp, PatternRewriter &rewriter) const {
+  auto contractionOp =
+      dyn_cast<linalg::ContractionOpInterface>(linalgOp.getOperation());
+  if (!contractionOp || !contractionOp.isRowMajorMatmul())
+    return rewriter.notifyMatchFailure(linalgOp, "expected row-major matmul");
+  if (!linalgOp.hasTensorSemantics())
+    return rewriter.notifyMatchFailure(linalgOp, "expected tensor semantics");
+
+  Location loc = linalgOp.getLoc();
+  Value lhs = linalgOp.getInputOperand(0)->get();
+  Value rhs = linalgOp.getInputOperand(1)->get();
+  Value output = linalgOp.getOutputOperand(0)->get();
+
+  // K is contiguous in the lhs and N in the rhs and the output, align them to
+  // full vectors of the operand element types.
+  int64_t mAlignment = rowAlignment;
+  int64_t nAlignment =
+      getVectorAlignment(columnAlignment, vectorBitWidth, {rhs, output});
+  int64_t kAlignment = getVectorAlignment(rowAlignment, vectorBitWidth, {lhs});
+  SmallVector<int64_t> lhsAlignments = {mAlignment, kAlignment};
+  SmallVector<int64_t> rhsAlignments = {kAlignment, nAlignment};
+  SmallVector<int64_t> outputAlignments = {mAlignment, nAlignment};
+
+  // Pad unconditionally if a static dimension is misaligned.
+  if (hasMisalignedStaticDim(lhs, lhsAlignments) ||
+      hasMisalignedStaticDim(rhs, rhsAlignments) ||
+      hasMisalignedStaticDim(output, outputAlignments)) {
+    Value result;
+    linalg::LinalgOp paddedOp = padMatmul(loc, linalgOp, mAlignment,
+                                          nAlignment, kAlignment, result,
+                                          rewriter);
+    rewriter.replaceOp(linalgOp, result);
+    return paddedOp;
+  }
+
+  // Otherwise, only the dynamic dimensions may need padding. Check their
+  // alignment at runtime and dispatch to the unpadded op if they are all
+  // aligned, to a padded copy otherwise.
+  Value isAligned = buildIsAligned(loc, lhs, lhsAlignments, {}, rewriter);
+  isAligned = buildIsAligned(loc, rhs, rhsAlignments, isAligned, rewriter);
+  isAligned =
+      buildIsAligned(loc, output, outputAlignments, isAligned, rewriter);
+  if (!isAligned)
+    return rewriter.notifyMatchFailure(linalgOp, "already aligned");
+
+  Type resultType = linalgOp->getResult(0).getType();
+  auto ifOp = rewriter.create<scf::IfOp>(loc, resultType, isAligned,
+                                         /*withElseRegion=*/true);
+  OpBuilder thenBuilder = ifOp.getThenBodyBuilder();
+  Operation *unpaddedOp = thenBuilder.clone(*linalgOp);
+  thenBuilder.create<scf::YieldOp>(loc, unpaddedOp->getResult(0));
+
+  OpBuilder elseBuilder = ifOp.getElseBodyBuilder();
+  Value paddedResult;
+  linalg::LinalgOp paddedOp = padMatmul(loc, linalgOp, mAlignment, nAlignment,
+                                        kAlignment, paddedResult, elseBuilder);
+  elseBuilder.create<scf::YieldOp>(loc, paddedResult);
+
+  rewriter.replaceOp(linalgOp, ifOp.getResults());
+  return paddedOp;
+}
@@ -0,0 +1,106 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "Dialect/LinalgExt/IR/LinalgExtOps.h"
+#include "Dialect/LinalgExt/Transforms/Transforms.h"
+#include "mlir/Dialect/Arithmetic/IR/Arithmetic.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/AffineMap.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/PatternMatch.h"
+
+using namespace mlir;
+using namespace mlir::iree_compiler::IREE::LinalgExt;
+
+/// Rewrites a SoftmaxOp on tensors into:
+///   1. a linalg.generic reducing the input along the softmax dimension into
+///      the running max and the running sum of the online normalization:
+///        max' = max(max, x)
+///        sum' = max' == -inf ? 0 : sum * exp(max - max') + exp(x - max')
+///   2. a parallel linalg.generic computing exp(x - max) / sum.
+/// The input is thus streamed twice instead of the four times of the
+/// max-reduction, exp, sum-reduction and division sequence. The sum is kept at
+/// 0 while the row only has -inf elements, which would otherwise compute
+/// exp(-inf - -inf) = NaN.
+FailureOr<linalg::GenericOp> mlir::iree_compiler::IREE::LinalgExt::
+    SoftmaxOpToLinalgRewriter::returningMatchAndRewrite(
+        iree_compiler::IREE::LinalgExt::SoftmaxOp softmaxOp,
+        PatternRewriter &rewriter) const {
+  if (!softmaxOp.hasTensorSemantics())
+    return rewriter.notifyMatchFailure(softmaxOp, "expected tensor semantics");
+
+  Location loc = softmaxOp.getLoc();
+  Value input = softmaxOp.input();
+  int64_t rank = softmaxOp.getOperandRank();
+  int64_t softmaxDim = softmaxOp.dimension();
+  auto elementType =
+      softmaxOp.getOperandType().getElementType().cast<FloatType>();
+
+  // The row statistics have the shape of the input without the softmax
+  // dimension.
+  SmallVector<OpFoldResult> statsSizes;
+  for (int64_t dim = 0; dim < rank; ++dim) {
+    if (dim != softmaxDim)
+      statsSizes.push_back(getDim(rewriter, loc, input, dim));
+  }
+  Value init =
+      rewriter.create<linalg::InitTensorOp>(loc, statsSizes, elementType);
+  Value negInf = rewriter.create<arith::ConstantOp>(
+      loc, rewriter.getFloatAttr(
+               elementType, APFloat::getInf(elementType.getFloatSemantics(),
+                                            /*Negative=*/true)));
+  Value zero = rewriter.create<arith::ConstantOp>(
+      loc, rewriter.getZeroAttr(elementType));
+  Value maxInit = rewriter
+                      .create<linalg::FillOp>(loc, ValueRange{negInf},
+                                              ValueRange{init})
+                      .getResult(0);
+  Value sumInit = rewriter
+                      .create<linalg::FillOp>(loc, ValueRange{zero},
+                                              ValueRange{init})
+                      .getResult(0);
+
+  AffineMap identityMap = rewriter.getMultiDimIdentityMap(rank);
+  AffineMap statsMap = identityMap.dropResult(softmaxDim);
+  SmallVector<StringRef> iteratorTypes(rank, getParallelIteratorTypeName());
+  iteratorTypes[softmaxDim] = getReductionIteratorTypeName();
+  auto statsOp = rewriter.create<linalg::GenericOp>(
+      loc, TypeRange{init.getType(), init.getType()}, input,
+      ValueRange{maxInit, sumInit},
+      ArrayRef<AffineMap>{identityMap, statsMap, statsMap}, iteratorTypes,
+      [&](OpBuilder &b, Location loc, ValueRange args) {
+        Value x = args[0];
+        Value max = b.create<arith::MaxFOp>(loc, args[1], x);
+        Value rescale = b.create<math::ExpOp>(
+            loc, b.create<arith::SubFOp>(loc, args[1], max));
+        Value term =
+            b.create<math::ExpOp>(loc, b.create<arith::SubFOp>(loc, x, max));
+        Value sum = b.create<arith::AddFOp>(
+            loc, b.create<arith::MulFOp>(loc, args[2], rescale), term);
+        Value allNegInf = b.create<arith::CmpFOp>(
+            loc, arith::CmpFPredicate::OEQ, max, negInf);
+        sum = b.create<arith::SelectOp>(loc, allNegInf, zero, sum);
+        b.create<linalg::YieldOp>(loc, ValueRange{max, sum});
+      });
+
+  SmallVector<StringRef> parallelIteratorTypes(rank,
+                                               getParallelIteratorTypeName());
+  auto normalizeOp = rewriter.create<linalg::GenericOp>(
+      loc, softmaxOp.output().getType(),
+      ValueRange{input, statsOp.getResult(0), statsOp.getResult(1)},
+      softmaxOp.output(),
+      ArrayRef<AffineMap>{identityMap, statsMap, statsMap, identityMap},
+      parallelIteratorTypes, [](OpBuilder &b, Location loc, ValueRange args) {
+        Value exp = b.create<math::ExpOp>(
+            loc, b.create<arith::SubFOp>(loc, args[0], args[1]));
+        b.create<linalg::YieldOp>(
+            loc, ValueRange{b.create<arith::DivFOp>(loc, exp, args[2])});
+      });
+  rewriter.replaceOp(softmaxOp, normalizeOp->getResults());
+  return normalizeOp;
+}
@@ -0,0 +1,324 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "Dialect/LinalgExt/IR/LinalgExtOps.h"
+#include "Dialect/LinalgExt/Transforms/Transforms.h"
+#include "Dialect/LinalgExt/Transforms/Utils.h"
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arithmetic/IR/Arithmetic.h"
+#include "mlir/Dialect/Arithmetic/Utils/Utils.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/SCF/SCF.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/AffineExpr.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/PatternMatch.h"
+
+using namespace mlir;
+using namespace mlir::iree_compiler::IREE::LinalgExt;
+
+/// Clones the comparator of `sortOp` on the elements `lhs` and `rhs` of its
+/// operands and returns its result, i.e. true if `lhs` is ordered before `rhs`.
+static Value buildComparison(OpBuilder &b, SortOp sortOp, ValueRange lhs,
+                             ValueRange rhs) {
+  Block &srcBlock = sortOp.region().front();
+  BlockAndValueMapping bvm;
+  for (int64_t i = 0, e = lhs.size(); i < e; ++i) {
+    bvm.map(srcBlock.getArgument(2 * i), lhs[i]);
+    bvm.map(srcBlock.getArgument(2 * i + 1), rhs[i]);
+  }
+  for (Operation &op : srcBlock.without_terminator())
+    b.clone(op, bvm);
+  return bvm.lookupOrDefault(srcBlock.getTerminator()->getOperand(0));
+}
+
+/// Returns the elements at `index` of the 1-D `tensors`.
+static SmallVector<Value> buildExtracts(OpBuilder &b, Location loc,
+                                       ValueRange tensors, Value index) {
+  return llvm::to_vector(llvm::map_range(tensors, [&](Value tensor) -> Value {
+    return b.create<tensor::ExtractOp>(loc, tensor, index);
+  }));
+}
+
+/// Returns the number of elements of the sorted run `a` = [aBegin, aBegin +
+/// aSize) among the first `diagonal` elements of the stable merge of `a` and
+/// of the sorted run `b` = [bBegin, bBegin + bSize) of `tensors`. This is where
+/// the merge path crosses the `diagonal`: it is found by binary search without
+/// merging the preceding elements, which lets every thread start merging at
+/// an arbitrary output position.
+static Value buildMergePathSplit(OpBuilder &b, Location loc, SortOp sortOp,
+                                 ValueRange tensors, Value aBegin, Value aSize,
+                                 Value bBegin, Value bSize, Value diagonal) {
+  Value zero = b.create<arith::ConstantIndexOp>(loc, 0);
+  Value one = b.create<arith::ConstantIndexOp>(loc, 1);
+  Value two = b.create<arith::ConstantIndexOp>(loc, 2);
+  Value lo = b.create<arith::MaxSIOp>(
+      loc, zero, b.create<arith::SubIOp>(loc, diagonal, bSize));
+  Value hi = b.create<arith::MinSIOp>(loc, diagonal, aSize);
+
+  Type indexType = b.getIndexType();
+  SmallVector<Type> types(2, indexType);
+  SmallVector<Location> locs(2, loc);
+  auto whileOp = b.create<scf::WhileOp>(loc, types, ValueRange{lo, hi});
+  OpBuilder::InsertionGuard g(b);
+  Block *before = b.createBlock(&whileOp.getBefore(), {}, types, locs);
+  Value cond = b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::slt,
+                                       before->getArgument(0),
+                                       before->getArgument(1));
+  b.create<scf::ConditionOp>(loc, cond, before->getArguments());
+
+  Block *after = b.createBlock(&whileOp.getAfter(), {}, types, locs);
+  Value curLo = after->getArgument(0), curHi = after->getArgument(1);
+  Value mid = b.create<arith::DivUIOp>(
+      loc, b.create<arith::AddIOp>(loc, curLo, curHi), two);
+  // If b[diagonal - mid - 1] is strictly ordered before a[mid], fewer than
+  // mid + 1 elements of `a` precede the diagonal.
+  Value aIndex = b.create<arith::AddIOp>(loc, aBegin, mid);
+  Value bIndex = b.create<arith::SubIOp>(
+      loc,
+      b.create<arith::SubIOp>(
+          loc, b.create<arith::AddIOp>(loc, bBegin, diagonal), mid),
+      one);
+  Value bFirst =
+      buildComparison(b, sortOp, buildExtracts(b, loc, tensors, bIndex),
+                      buildExtracts(b, loc, tensors, aIndex));
+  Value nextLo = b.create<arith::SelectOp>(
+      loc, bFirst, curLo, b.create<arith::AddIOp>(loc, mid, one));
+  Value nextHi = b.create<arith::SelectOp>(loc, bFirst, mid, curHi);
+  b.create<scf::YieldOp>(loc, ValueRange{nextLo, nextHi});
+  return whileOp.getResult(0);
+}
+
+/// Merges `size` elements of the sorted runs `a` = [aBegin, aBegin + aSize)
+/// and `b` = [bBegin, bBegin + bSize) of `tensors`, starting at position
+/// `diagonal` of their stable merge, into the 1-D `outs`.
+static SmallVector<Value> buildMerge(OpBuilder &b, Location loc, SortOp sortOp,
+                                     ValueRange tensors, Value aBegin,
+                                     Value aSize, Value bBegin, Value bSize,
+                                     Value diagonal, Value size,
+                                     ValueRange outs) {
+  Value zero = b.create<arith::ConstantIndexOp>(loc, 0);
+  Value one = b.create<arith::ConstantIndexOp>(loc, 1);
+  Value aStart = buildMergePathSplit(b, loc, sortOp, tensors, aBegin, aSize,
+                                     bBegin, bSize, diagonal);
+  Value bStart = b.create<arith::SubIOp>(loc, diagonal, aStart);
+  SmallVector<Value> iterArgs{aStart, bStart};
+  llvm::append_range(iterArgs, outs);
+  SmallVector<Type> elementTypes = llvm::to_vector(
+      llvm::map_range(tensors, [](Value tensor) {
+        return tensor.getType().cast<ShapedType>().getElementType();
+      }));
+
+  auto forOp = b.create<scf::ForOp>(
+      loc, zero, size, one, iterArgs,
+      [&](OpBuilder &b, Location loc, Value iv, ValueRange iters) {
+        Value i = iters[0], j = iters[1];
+        Value aExhausted =
+            b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::sge, i, aSize);
+        Value bExhausted =
+            b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::sge, j, bSize);
+        Value aIndex = b.create<arith::AddIOp>(loc, aBegin, i);
+        Value bIndex = b.create<arith::AddIOp>(loc, bBegin, j);
+        // Ties are taken from `a` to keep the merge stable.
+        auto takeB = b.create<scf::IfOp>(
+            loc, b.getI1Type(), bExhausted,
+            [&](OpBuilder &b, Location loc) {
+              Value falseValue = b.create<arith::ConstantIntOp>(loc, 0, 1);
+              b.create<scf::YieldOp>(loc, falseValue);
+            },
+            [&](OpBuilder &b, Location loc) {
+              auto ifOp = b.create<scf::IfOp>(
+                  loc, b.getI1Type(), aExhausted,
+                  [&](OpBuilder &b, Location loc) {
+                    Value trueValue = b.create<arith::ConstantIntOp>(loc, 1, 1);
+                    b.create<scf::YieldOp>(loc, trueValue);
+                  },
+                  [&](OpBuilder &b, Location loc) {
+                    Value bFirst = buildComparison(
+                        b, sortOp, buildExtracts(b, loc, tensors, bIndex),
+                        buildExtracts(b, loc, tensors, aIndex));
+                    b.create<scf::YieldOp>(loc, bFirst);
+                  });
+              b.create<scf::YieldOp>(loc, ifOp.getResults());
+            });
+        Value takeBValue = takeB.getResult(0);
+        auto next = b.create<scf::IfOp>(
+            loc, elementTypes, takeBValue,
+            [&](OpBuilder &b, Location loc) {
+              b.create<scf::YieldOp>(loc,
+                                     buildExtracts(b, loc, tensors, bIndex));
+            },
+            [&](OpBuilder &b, Location loc) {
+              b.create<scf::YieldOp>(loc,
+                                     buildExtracts(b, loc, tensors, aIndex));
+            });
+
+        Value nextI = b.create<arith::SelectOp>(
+            loc, takeBValue, i, b.create<arith::AddIOp>(loc, i, one));
+        Value nextJ = b.create<arith::SelectOp>(
+            loc, takeBValue, b.create<arith::AddIOp>(loc, j, one), j);
+        SmallVector<Value> yields{nextI, nextJ};
+        for (auto it : llvm::zip(next.getResults(), iters.drop_front(2))) {
+          yields.push_back(b.create<tensor::InsertOp>(
+              loc, std::get<0>(it), std::get<1>(it), iv));
+        }
+        b.create<scf::YieldOp>(loc, yields);
+      });
+  return llvm::to_vector(forOp.getResults().drop_front(2));
+}
+
+/// Creates an InParallelOp over `numThreads` threads, each of which computes
+/// its `[offset, offset + size)` chunk of the 1-D `dests` with `bodyBuilder`
+/// from the slices of `dests` it overwrites.
+static InParallelOp buildInParallelChunks(
+    OpBuilder &b, Location loc, int64_t numThreads, Value totalSize,
+    Value chunkSize, ValueRange dests,
+    function_ref<SmallVector<Value>(OpBuilder &, Location, Value, Value, Value,
+                                    ValueRange)>
+        bodyBuilder) {
+  Value numThreadsValue = b.create<arith::ConstantIndexOp>(loc, numThreads);
+  auto inParallelOp =
+      b.create<InParallelOp>(loc, dests.getTypes(), numThreadsValue);
+  OpBuilder::InsertionGuard g(b);
+  b.setInsertionPointToStart(inParallelOp.getBody());
+
+  using AV = AffineValueExpr;
+  AffineBuilder ab(b, loc);
+  AffineExpr i, j, M;
+  bindDims(b.getContext(), i, j);
+  bindSymbols(b.getContext(), M);
+  Value threadIndex = inParallelOp.getThreadIndex();
+  // Trailing threads may get empty chunks when `numThreads` does not divide
+  // `totalSize`.
+  Value offset = ab.min(ValueRange{
+      ab.mul(AV(i).bind(threadIndex), AV(M).bind(chunkSize)), totalSize});
+  Value size = ab.min(ValueRange{
+      ab.sub(AV(i).bind(totalSize), AV(j).bind(offset)), chunkSize});
+
+  Value one = b.create<arith::ConstantIndexOp>(loc, 1);
+  SmallVector<Value> slices = llvm::to_vector(
+      llvm::map_range(dests, [&](Value dest) -> Value {
+        return b.create<tensor::ExtractSliceOp>(
+            loc, dest, ValueRange{offset}, ValueRange{size}, ValueRange{one});
+      }));
+  SmallVector<Value> results =
+      bodyBuilder(b, loc, threadIndex, offset, size, slices);
+
+  b.setInsertionPoint(inParallelOp.getTerminator().getBody()->getTerminator());
+  for (auto it : llvm::zip(results, dests)) {
+    b.create<ParallelInsertSliceOp>(loc, std::get<0>(it), std::get<1>(it),
+                                    ValueRange{offset}, ValueRange{size},
+                                    ValueRange{one});
+  }
+  return inParallelOp;
+}
+
+/// Rewrites a 1-D SortOp on tensors into a parallel merge sort over
+/// `numThreads` threads:
+///   1. an InParallelOp sorting the `numThreads` chunks of the operands
+///      independently,
+///   2. ceil(log2(numThreads)) InParallelOps, each of which merges the pairs
+///      of consecutive sorted runs of the previous step. Every thread produces
+///      a chunk of the merged runs: it locates the start of its chunk in the
+///      two runs by binary search along the merge path and merges from there.
+///      All the threads thus merge the same number of elements, independently
+///      of the values being sorted.
+/// The merge steps alternate between the operands and a temporary buffer.
+/// Returns the InParallelOp sorting the chunks.
+FailureOr<InParallelOp> mlir::iree_compiler::IREE::LinalgExt::
+    SortOpToParallelMergeSortRewriter::returningMatchAndRewrite(
+        iree_compiler::IREE::LinalgExt::SortOp sortOp,
+        PatternRewriter &rewriter) const {
+  if (!sortOp.hasTensorSemantics())
+    return rewriter.notifyMatchFailure(sortOp, "expected tensor semantics");
+  if (sortOp.getOperandRank() != 1)
+    return rewriter.notifyMatchFailure(sortOp, "expected a 1-D sort");
+  if (sortOp.getNumInputs() != 0)
+    return rewriter.notifyMatchFailure(sortOp, "expected no input operands");
+  if (numThreads < 1)
+    return rewriter.notifyMatchFailure(sortOp, "expected at least one thread");
+
+  Location loc = sortOp.getLoc();
+  SmallVector<Value> outputs = llvm::to_vector(sortOp.outputs());
+  Value totalSize = getValueOrCreateConstantIndexOp(
+      rewriter, loc, getDim(rewriter, loc, outputs.front(), 0));
+  using AV = AffineValueExpr;
+  AffineBuilder ab(rewriter, loc);
+  AffineExpr i, M;
+  bindDims(rewriter.getContext(), i);
+  bindSymbols(rewriter.getContext(), M);
+  Value numThreadsValue =
+      rewriter.create<arith::ConstantIndexOp>(loc, numThreads);
+  Value chunkSize =
+      ab.ceil(AV(i).bind(totalSize), AV(M).bind(numThreadsValue));
+
+  // Sort the chunks independently.
+  InParallelOp sortChunksOp = buildInParallelChunks(
+      rewriter, loc, numThreads, totalSize, chunkSize, outputs,
+      [&](OpBuilder &b, Location loc, Value threadIndex, Value offset,
+          Value size, ValueRange slices) -> SmallVector<Value> {
+        Operation *chunkSortOp =
+            cast<LinalgExtOp>(sortOp.getOperation())
+                .clone(b, loc, slices.getTypes(), slices);
+        return llvm::to_vector(chunkSortOp->getResults());
+      });
+
+  // Merge the pairs of sorted runs until a single one is left. At step `step`,
+  // the runs have 2^step chunks.
+  SmallVector<Value> temps = llvm::to_vector(
+      llvm::map_range(outputs, [&](Value output) -> Value {
+        auto type = output.getType().cast<ShapedType>();
+        return rewriter.create<linalg::InitTensorOp>(
+            loc, ArrayRef<OpFoldResult>{getDim(rewriter, loc, output, 0)},
+            type.getElementType());
+      }));
+  SmallVector<Value> sources = llvm::to_vector(sortChunksOp.getResults());
+  for (int64_t step = 0; (int64_t(1) << step) < numThreads; ++step) {
+    int64_t runChunks = int64_t(1) << step;
+    InParallelOp mergeOp = buildInParallelChunks(
+        rewriter, loc, numThreads, totalSize, chunkSize, temps,
+        [&](OpBuilder &b, Location loc, Value threadIndex, Value offset,
+            Value size, ValueRange slices) -> SmallVector<Value> {
+          AffineBuilder ab(b, loc);
+          AffineExpr x, y, c;
+          bindDims(b.getContext(), x, y);
+          bindSymbols(b.getContext(), c);
+          // The pair of runs containing the chunk of the thread starts at
+          // pairBegin, its second run starts at pairBegin + runChunks * c.
+          Value pairBegin = b.createOrFold<AffineApplyOp>(
+              loc,
+              ArrayRef<AffineExpr>{x.floorDiv(2 * runChunks) *
+                                   (2 * runChunks) * c},
+              ValueRange{threadIndex, chunkSize});
+          pairBegin = ab.min(ValueRange{pairBegin, totalSize});
+          Value bBegin = ab.min(ValueRange{
+              b.createOrFold<AffineApplyOp>(
+                  loc, ArrayRef<AffineExpr>{x + runChunks * c},
+                  ValueRange{pairBegin, chunkSize}),
+              totalSize});
+          Value bEnd = ab.min(ValueRange{
+              b.createOrFold<AffineApplyOp>(
+                  loc, ArrayRef<AffineExpr>{x + 2 * runChunks * c},
+                  ValueRange{pairBegin, chunkSize}),
+              totalSize});
+          Value aSize = b.createOrFold<AffineApplyOp>(
+              loc, ArrayRef<AffineExpr>{y - x}, ValueRange{pairBegin, bBegin});
+          Value bSize = b.createOrFold<AffineApplyOp>(
+              loc, ArrayRef<AffineExpr>{y - x}, ValueRange{bBegin, bEnd});
+          Value diagonal = b.createOrFold<AffineApplyOp>(
+              loc, ArrayRef<AffineExpr>{y - x}, ValueRange{pairBegin, offset});
+          return buildMerge(b, loc, sortOp, sources, pairBegin, aSize, bBegin,
+                            bSize, diagonal, size, slices);
+        });
+    // The sources of this step are dead past it and hold the next results.
+    temps = sources;
+    sources = mergeOp.getResults();
+  }
+
+  rewriter.replaceOp(sortOp, sources);
+  return sortChunksOp;
+}
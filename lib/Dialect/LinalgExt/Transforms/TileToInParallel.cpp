@@ -31,6 +31,11 @@ mlir::iree_compiler::IREE::LinalgExt::TileOpToInParallelRewriter::
   // TODO: verifier.
   assert(tileOp.getNumResults() > 0 &&
          tileOp.outs().size() == tileOp.getNumResults());
+  if (!InParallelOp::isValidSchedule(schedule))
+    return rewriter.notifyMatchFailure(tileOp, "unknown schedule");
+  if (chunkSize < 1)
+    return rewriter.notifyMatchFailure(tileOp,
+                                       "expected a positive chunk size");
 
   // TODO: when supported, iterate over the tensor of sizes. This will be
   // iterating through a level of indirection.
@@ -61,6 +66,10 @@ mlir::iree_compiler::IREE::LinalgExt::TileOpToInParallelRewriter::
   iree_compiler::IREE::LinalgExt::InParallelOp inParallelOp =
       rewriter.create<iree_compiler::IREE::LinalgExt::InParallelOp>(
           loc, tileOp->getResultTypes(), numThreads);
+  if (schedule != "static") {
+    inParallelOp.scheduleAttr(rewriter.getStringAttr(schedule));
+    inParallelOp.chunk_sizeAttr(rewriter.getI64IntegerAttr(chunkSize));
+  }
 
   // At the beginning of the InParallelOp, compute offset and sizes.
   rewriter.setInsertionPointToStart(inParallelOp.getBody());
@@ -0,0 +1,70 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "Dialect/LinalgExt/IR/LinalgExtOps.h"
+#include "Dialect/LinalgExt/Transforms/Transforms.h"
+#include "mlir/Dialect/SCF/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/PatternMatch.h"
+#include "llvm/ADT/STLExtras.h"
+
+using namespace mlir;
+using namespace mlir::iree_compiler::IREE::LinalgExt;
+
+/// Recursively builds the loop `loopDepth` of the nest and, once all of them
+/// are built, the scalar implementation of `tiledOp` in the innermost one. The
+/// loops iterated by the scalar implementation itself are skipped.
+static LogicalResult buildLoopNest(OpBuilder &b, TiledOpInterface tiledOp,
+                                   ArrayRef<Range> loopRanges,
+                                   ArrayRef<unsigned> scalarLoops,
+                                   unsigned loopDepth,
+                                   SmallVectorImpl<Value> &ivs,
+                                   SmallVectorImpl<scf::ForOp> &loops) {
+  Location loc = tiledOp.getLoc();
+  if (loopDepth == loopRanges.size())
+    return tiledOp.generateScalarImplementation(b, loc, ivs);
+  if (llvm::is_contained(scalarLoops, loopDepth)) {
+    ivs.push_back(loopRanges[loopDepth].offset);
+    return buildLoopNest(b, tiledOp, loopRanges, scalarLoops, loopDepth + 1,
+                         ivs, loops);
+  }
+  LogicalResult status = success();
+  auto forOp = b.create<scf::ForOp>(
+      loc, loopRanges[loopDepth].offset, loopRanges[loopDepth].size,
+      loopRanges[loopDepth].stride, ValueRange{},
+      [&](OpBuilder &b, Location loc, Value iv, ValueRange args) {
+        ivs.push_back(iv);
+        status = buildLoopNest(b, tiledOp, loopRanges, scalarLoops,
+                               loopDepth + 1, ivs, loops);
+        b.create<scf::YieldOp>(loc);
+      });
+  loops.insert(loops.begin(), forOp);
+  return status;
+}
+
+/// Lowers a TiledOpInterface op with buffer semantics to one scf.for per loop
+/// of its iteration domain, except the loops of its scalar implementation,
+/// around its scalar implementation.
+FailureOr<SmallVector<scf::ForOp>> mlir::iree_compiler::IREE::LinalgExt::
+    TiledOpInterfaceToLoopsRewriter::returningMatchAndRewrite(
+        TiledOpInterface tiledOp, PatternRewriter &rewriter) const {
+  if (llvm::any_of(tiledOp->getResults(),
+                   [](Value v) { return v.getType().isa<ShapedType>(); })) {
+    return rewriter.notifyMatchFailure(tiledOp, "expected buffer semantics");
+  }
+
+  SmallVector<Range> loopRanges = tiledOp.getIterationDomain(rewriter);
+  SmallVector<unsigned> scalarLoops = tiledOp.getLoopsInScalarImplementation();
+  SmallVector<Value> ivs;
+  SmallVector<scf::ForOp> loops;
+  if (failed(buildLoopNest(rewriter, tiledOp, loopRanges, scalarLoops, 0, ivs,
+                           loops))) {
+    return rewriter.notifyMatchFailure(
+        tiledOp, "failed to generate the scalar implementation");
+  }
+  rewriter.eraseOp(tiledOp);
+  return loops;
+}
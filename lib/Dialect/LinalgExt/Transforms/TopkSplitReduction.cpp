@@ -0,0 +1,233 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "Dialect/LinalgExt/IR/LinalgExtOps.h"
+#include "Dialect/LinalgExt/Transforms/Transforms.h"
+#include "mlir/Dialect/Arithmetic/IR/Arithmetic.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/PatternMatch.h"
+
+using namespace mlir;
+using namespace mlir::iree_compiler::IREE::LinalgExt;
+
+/// Returns the worst value for the comparator of `topkOp`, i.e. a value no
+/// element is strictly worse than, or a null attribute if the comparator is
+/// not a single arith.cmpf or arith.cmpi of its arguments.
+static Attribute getComparatorIdentity(Builder &b, TopkOp topkOp) {
+  Block &block = topkOp.region().front();
+  Operation *cmpOp = block.getTerminator()->getOperand(0).getDefiningOp();
+  if (!cmpOp || !isa<arith::CmpFOp, arith::CmpIOp>(cmpOp))
+    return {};
+  Value lhs = block.getArgument(0);
+  Value rhs = block.getArgument(1);
+  bool swapped;
+  if (cmpOp->getOperand(0) == lhs && cmpOp->getOperand(1) == rhs) {
+    swapped = false;
+  } else if (cmpOp->getOperand(0) == rhs && cmpOp->getOperand(1) == lhs) {
+    swapped = true;
+  } else {
+    return {};
+  }
+
+  Type type = lhs.getType();
+  if (auto cmpFOp = dyn_cast<arith::CmpFOp>(cmpOp)) {
+    bool largest;
+    switch (cmpFOp.getPredicate()) {
+    case arith::CmpFPredicate::OGT:
+    case arith::CmpFPredicate::OGE:
+    case arith::CmpFPredicate::UGT:
+    case arith::CmpFPredicate::UGE:
+      largest = !swapped;
+      break;
+    case arith::CmpFPredicate::OLT:
+    case arith::CmpFPredicate::OLE:
+    case arith::CmpFPredicate::ULT:
+    case arith::CmpFPredicate::ULE:
+      largest = swapped;
+      break;
+    default:
+      return {};
+    }
+    const llvm::fltSemantics &semantics =
+        type.cast<FloatType>().getFloatSemantics();
+    return b.getFloatAttr(
+        type, llvm::APFloat::getInf(semantics, /*Negative=*/largest));
+  }
+
+  unsigned width = type.getIntOrFloatBitWidth();
+  bool largest;
+  bool isSigned;
+  switch (cast<arith::CmpIOp>(cmpOp).getPredicate()) {
+  case arith::CmpIPredicate::sgt:
+  case arith::CmpIPredicate::sge:
+    largest = !swapped;
+    isSigned = true;
+    break;
+  case arith::CmpIPredicate::slt:
+  case arith::CmpIPredicate::sle:
+    largest = swapped;
+    isSigned = true;
+    break;
+  case arith::CmpIPredicate::ugt:
+  case arith::CmpIPredicate::uge:
+    largest = !swapped;
+    isSigned = false;
+    break;
+  case arith::CmpIPredicate::ult:
+  case arith::CmpIPredicate::ule:
+    largest = swapped;
+    isSigned = false;
+    break;
+  default:
+    return {};
+  }
+  if (isSigned) {
+    return b.getIntegerAttr(type, largest
+                                      ? llvm::APInt::getSignedMinValue(width)
+                                      : llvm::APInt::getSignedMaxValue(width));
+  }
+  return b.getIntegerAttr(type, largest ? llvm::APInt::getZero(width)
+                                        : llvm::APInt::getAllOnes(width));
+}
+
+/// Splits the top-k dimension of a `linalg_ext.topk` of size `n` into
+/// `splitRatio` independent chunks of size `n / splitRatio`:
+///   1. the values (and indices) are expanded to
+///      [..., splitRatio, n / splitRatio, ...],
+///   2. a parallel topk selects the `k` best elements of every chunk into
+///      outputs filled with the identity of the comparator and the largest
+///      index,
+///   3. the chunk offsets are added to the selected indices if the position
+///      along the top-k dimension was used as index,
+///   4. a final topk merges the `splitRatio * k` candidates into the original
+///      outputs.
+/// Every element of a chunk precedes the fill value, so the chunk outputs only
+/// hold elements of the chunk. The initial values of the original outputs,
+/// e.g. a running top-k, are only merged once by the final topk.
+/// The chunks are parallel in the tiling sense and can be tiled and
+/// distributed like any batch dimension.
+FailureOr<TopkSplitReductionResult> mlir::iree_compiler::IREE::LinalgExt::
+    TopkOpSplitReductionRewriter::returningMatchAndRewrite(
+        TopkOp topkOp, PatternRewriter &rewriter) const {
+  if (splitRatio <= 1)
+    return rewriter.notifyMatchFailure(topkOp, "split ratio must be > 1");
+  if (!topkOp.hasTensorSemantics())
+    return rewriter.notifyMatchFailure(topkOp, "expected tensor semantics");
+
+  int64_t topkDim = topkOp.dimension();
+  ShapedType inputType = topkOp.getInputType();
+  ShapedType outputType = topkOp.getOutputType();
+  if (!inputType.hasStaticShape() || !outputType.hasStaticShape()) {
+    return rewriter.notifyMatchFailure(topkOp,
+                                       "expected static shapes to split");
+  }
+  int64_t n = inputType.getDimSize(topkDim);
+  int64_t k = outputType.getDimSize(topkDim);
+  if (n % splitRatio != 0 || n / splitRatio < k) {
+    return rewriter.notifyMatchFailure(
+        topkOp, "expected the split ratio to divide the input into chunks "
+                "of at least k elements");
+  }
+  int64_t chunkSize = n / splitRatio;
+  Attribute identity = getComparatorIdentity(rewriter, topkOp);
+  if (!identity) {
+    return rewriter.notifyMatchFailure(
+        topkOp, "expected a comparator with a known identity");
+  }
+
+  // The chunk dimension is inserted in front of the top-k dimension.
+  int64_t rank = inputType.getRank();
+  SmallVector<ReassociationIndices> reassociation;
+  for (int64_t dim = 0; dim < rank; ++dim) {
+    int64_t expandedDim = dim > topkDim ? dim + 1 : dim;
+    if (dim == topkDim) {
+      reassociation.push_back({expandedDim, expandedDim + 1});
+    } else {
+      reassociation.push_back({expandedDim});
+    }
+  }
+  auto getExpandedShape = [&](ShapedType type, ArrayRef<int64_t> sizes) {
+    SmallVector<int64_t> shape(type.getShape().begin(), type.getShape().end());
+    shape[topkDim] = sizes[1];
+    shape.insert(shape.begin() + topkDim, sizes[0]);
+    return shape;
+  };
+
+  Location loc = topkOp.getLoc();
+  SmallVector<Value> expandedInputs;
+  for (OpOperand *input : topkOp.getInputOperands()) {
+    auto type = input->get().getType().cast<ShapedType>();
+    auto expandedType = RankedTensorType::get(
+        getExpandedShape(type, {splitRatio, chunkSize}), type.getElementType());
+    expandedInputs.push_back(rewriter.create<tensor::ExpandShapeOp>(
+        loc, expandedType, input->get(), reassociation));
+  }
+
+  // Every chunk starts from the identity of the comparator. The largest
+  // index makes the elements of the chunk precede it on ties.
+  AffineMap expandedIdentity = rewriter.getMultiDimIdentityMap(rank + 1);
+  SmallVector<StringRef> parallelIteratorTypes(rank + 1,
+                                               getParallelIteratorTypeName());
+  Value fillValues[] = {
+      rewriter.create<arith::ConstantOp>(loc, identity),
+      rewriter.create<arith::ConstantOp>(
+          loc, rewriter.getIntegerAttr(rewriter.getI32Type(),
+                                       llvm::APInt::getSignedMaxValue(32)))};
+  SmallVector<Value> chunkOutputs;
+  for (auto it : llvm::zip(topkOp.getOutputOperands(), fillValues)) {
+    auto type = std::get<0>(it)->get().getType().cast<ShapedType>();
+    Value init = rewriter.create<linalg::InitTensorOp>(
+        loc, getExpandedShape(type, {splitRatio, k}), type.getElementType());
+    chunkOutputs.push_back(
+        rewriter
+            .create<linalg::FillOp>(loc, ValueRange{std::get<1>(it)},
+                                    ValueRange{init})
+            .getResult(0));
+  }
+
+  auto chunkTopkOp = rewriter.create<TopkOp>(
+      loc, TypeRange(ValueRange(chunkOutputs)), expandedInputs, chunkOutputs,
+      rewriter.getI64IntegerAttr(topkDim + 1));
+  rewriter.cloneRegionBefore(topkOp.region(), chunkTopkOp.region(),
+                             chunkTopkOp.region().end());
+  Value chunkValues = chunkTopkOp.getResult(0);
+  Value chunkIndices = chunkTopkOp.getResult(1);
+
+  // Without input indices, the chunk topk produces positions relative to the
+  // start of each chunk.
+  if (!topkOp.indices()) {
+    auto offsetOp = rewriter.create<linalg::GenericOp>(
+        loc, chunkIndices.getType(), ValueRange{}, chunkIndices,
+        ArrayRef<AffineMap>{expandedIdentity}, parallelIteratorTypes,
+        [&](OpBuilder &b, Location loc, ValueRange args) {
+          Value chunk = b.create<linalg::IndexOp>(loc, topkDim);
+          Value chunkSizeValue =
+              b.create<arith::ConstantIndexOp>(loc, chunkSize);
+          Value offset = b.create<arith::IndexCastOp>(
+              loc, b.getI32Type(),
+              b.create<arith::MulIOp>(loc, chunk, chunkSizeValue));
+          b.create<linalg::YieldOp>(
+              loc, ValueRange{b.create<arith::AddIOp>(loc, args[0], offset)});
+        });
+    chunkIndices = offsetOp.getResult(0);
+  }
+
+  // Merge the candidates of all chunks.
+  Value candidateValues = rewriter.create<tensor::CollapseShapeOp>(
+      loc, chunkValues, reassociation);
+  Value candidateIndices = rewriter.create<tensor::CollapseShapeOp>(
+      loc, chunkIndices, reassociation);
+  auto mergeTopkOp = rewriter.create<TopkOp>(
+      loc, topkOp->getResultTypes(),
+      ValueRange{candidateValues, candidateIndices}, topkOp.outputs(),
+      topkOp.dimensionAttr());
+  rewriter.cloneRegionBefore(topkOp.region(), mergeTopkOp.region(),
+                             mergeTopkOp.region().end());
+  rewriter.replaceOp(topkOp, mergeTopkOp->getResults());
+  return TopkSplitReductionResult{chunkTopkOp, mergeTopkOp};
+}
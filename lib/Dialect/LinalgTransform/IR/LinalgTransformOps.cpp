@@ -16,6 +16,7 @@
 #include "Dialect/LinalgTransform/TransformOpInterface.h"
 #include "FunctionHelpers.h"
 #include "PDL.h"
+#include "Passes/Transforms.h"
 #include "Transforms/Listener.h"
 #include "mlir/Conversion/AffineToStandard/AffineToStandard.h"
 #include "mlir/Conversion/AsyncToLLVM/AsyncToLLVM.h"
@@ -51,6 +52,7 @@
 #include "mlir/Transforms/Passes.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/ScopeExit.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FormatVariadic.h"
@@ -222,25 +224,166 @@ LogicalResult transform::MatchOp::apply(TransformResults &results,
 // TileOp
 //===---------------------------------------------------------------------===//
 
+/// Pads the dimensions `paddingDims` of `linalgOp` with zeros to the static
+/// bounding box of its operands. Returns failure if the padding fails.
+static FailureOr<LinalgOp> padWithZeros(LinalgOp linalgOp,
+                                        ArrayRef<int64_t> paddingDims) {
+  Builder b(linalgOp->getContext());
+  SmallVector<Attribute> paddingValues;
+  for (Type type : linalgOp->getOperandTypes()) {
+    paddingValues.push_back(b.getZeroAttr(getElementTypeOrSelf(type)));
+    if (!paddingValues.back())
+      return failure();
+  }
+  LinalgPaddingOptions paddingOptions;
+  paddingOptions.setPaddingValues(paddingValues);
+  paddingOptions.setPaddingDimensions(paddingDims);
+  return functional::applyAt(linalgOp,
+                             callLinalgPattern<LinalgPaddingPattern>(
+                                 linalgOp->getContext(), paddingOptions));
+}
+
+/// Returns the copies of the `numLoops` perfectly nested tile loops found in
+/// the body of `loop`, outermost first. The result is shorter if the nest is
+/// not found, e.g. because canonicalizations folded some of the loops.
+static SmallVector<Operation *> getNestedTileLoops(scf::ForOp loop,
+                                                   unsigned numLoops) {
+  SmallVector<Operation *> loops;
+  Operation *parent = loop;
+  while (loops.size() < numLoops) {
+    auto nestedLoops = parent->getRegion(0).getOps<scf::ForOp>();
+    if (!llvm::hasSingleElement(nestedLoops))
+      break;
+    parent = *nestedLoops.begin();
+    loops.push_back(parent);
+  }
+  return loops;
+}
+
+/// Handles the partial last tiles of the loops of `tiled`, obtained by tiling
+/// an op with the static loop ranges `staticLoopRanges`, as chosen by the
+/// partial tile cost model. The loops are peeled first, from the outermost
+/// inwards, so that the padding does not extend to the peeled dimensions. A
+/// loop is peeled in the main loop nest and in all the copies of the loop nest
+/// created by peeling the outer loops. The tiled op and its copies in the
+/// peeled partial tiles are then padded. The dimensions for which masking is
+/// chosen, if `canMask` is set, are left to the masked vectorization. Returns
+/// `tiled` with the padded op, which is left unpadded if the padding fails.
+static TiledLinalgOp handlePartialTiles(TiledLinalgOp tiled,
+                                        ArrayRef<int64_t> staticLoopRanges,
+                                        ArrayRef<int64_t> tileSizes,
+                                        ArrayRef<unsigned> interchange,
+                                        bool canMask) {
+  // Compute the op dimension tiled by every loop, the loops are created in
+  // the interchanged order and only for the non-zero tile sizes.
+  SmallVector<unsigned> loopDims;
+  for (unsigned i = 0, e = tileSizes.size(); i < e; ++i) {
+    unsigned dim = interchange.empty() ? i : interchange[i];
+    if (dim < tileSizes.size() && tileSizes[dim] != 0)
+      loopDims.push_back(dim);
+  }
+  if (loopDims.size() != tiled.loops.size())
+    return tiled;
+
+  LinalgOp linalgOp = tiled.op;
+  SmallVector<int64_t> paddableDims = getZeroPaddableDims(linalgOp);
+  SmallVector<int64_t> paddingDims;
+  // Every loop nest holds the loops of a copy of the tiled op, indexed like
+  // `tiled.loops`. The loops outside of the copy are null.
+  SmallVector<SmallVector<Operation *>> loopNests;
+  loopNests.emplace_back(tiled.loops.begin(), tiled.loops.end());
+  SmallVector<Operation *> roots = {tiled.loops.front()};
+  IRRewriter rewriter(linalgOp->getContext());
+  for (unsigned i = 0, e = loopDims.size(); i < e; ++i) {
+    unsigned dim = loopDims[i];
+    bool canPad = llvm::is_contained(paddableDims, static_cast<int64_t>(dim));
+    switch (choosePartialTileStrategy(staticLoopRanges[dim], tileSizes[dim],
+                                      canPad, canMask)) {
+    case PartialTileStrategy::None:
+    case PartialTileStrategy::Mask:
+      break;
+    case PartialTileStrategy::Pad:
+      paddingDims.push_back(dim);
+      break;
+    case PartialTileStrategy::Peel: {
+      SmallVector<SmallVector<Operation *>> peeledNests;
+      for (SmallVector<Operation *> &loopNest : loopNests) {
+        auto loop = dyn_cast_or_null<scf::ForOp>(loopNest[i]);
+        scf::ForOp partialLoop;
+        if (!loop || failed(scf::peelAndCanonicalizeForLoop(rewriter, loop,
+                                                             partialLoop)))
+          continue;
+        SmallVector<Operation *> peeledNest(e, nullptr);
+        peeledNest[i] = partialLoop;
+        SmallVector<Operation *> innerLoops =
+            getNestedTileLoops(partialLoop, e - i - 1);
+        llvm::copy(innerLoops, peeledNest.begin() + i + 1);
+        peeledNests.push_back(peeledNest);
+        roots.push_back(partialLoop);
+      }
+      llvm::append_range(loopNests, peeledNests);
+      break;
+    }
+    }
+  }
+  if (paddingDims.empty())
+    return tiled;
+
+  SetVector<Operation *> opsToPad;
+  opsToPad.insert(linalgOp);
+  for (Operation *root : roots) {
+    root->walk([&](LinalgOp op) {
+      if (op->getName() == linalgOp->getName())
+        opsToPad.insert(op);
+    });
+  }
+  for (Operation *op : opsToPad) {
+    FailureOr<LinalgOp> padded = padWithZeros(cast<LinalgOp>(op), paddingDims);
+    if (succeeded(padded) && op == linalgOp)
+      tiled.op = *padded;
+  }
+  return tiled;
+}
+
 LogicalResult transform::TileOp::apply(TransformResults &transformResults,
                                        TransformState &state) {
   LinalgTilingOptions tilingOptions;
   SmallVector<int64_t> tileSizes = extractI64Array(sizes());
+  SmallVector<unsigned> tileInterchange = extractUIntArray(interchange());
 
   if (!tileSizes.empty())
     tilingOptions.setTileSizes(tileSizes);
-  tilingOptions.setInterchange(extractUIntArray(interchange()));
+  tilingOptions.setInterchange(tileInterchange);
   LinalgTilingPattern pattern(getContext(), tilingOptions);
   auto functionalTile =
       [&](LinalgOp op, PatternRewriter &rewriter) -> FailureOr<TiledLinalgOp> {
     return pattern.returningMatchAndRewrite(op, rewriter);
   };
 
-  return applyTilingToAll(getOperation(), target(), tileSizes, transformResults,
-                          state, [&](LinalgOp linalgOp) {
-                            return functional::applyAt(linalgOp,
-                                                       functionalTile);
-                          });
+  bool handlePartial = partial_tiles() != "none";
+  bool canMask = partial_tiles() == "auto_mask";
+  return applyTilingToAll(
+      getOperation(), target(), tileSizes, transformResults, state,
+      [&](LinalgOp linalgOp) -> FailureOr<TiledLinalgOp> {
+        SmallVector<int64_t> staticLoopRanges =
+            linalgOp.getStaticLoopRanges();
+        FailureOr<TiledLinalgOp> tiled =
+            functional::applyAt(linalgOp, functionalTile);
+        if (failed(tiled) || !handlePartial)
+          return tiled;
+        return handlePartialTiles(*tiled, staticLoopRanges, tileSizes,
+                                  tileInterchange, canMask);
+      });
+}
+
+LogicalResult transform::TileOp::verify() {
+  if (partial_tiles() != "none" && partial_tiles() != "auto" &&
+      partial_tiles() != "auto_mask") {
+    return emitOpError() << "expects partial_tiles to be one of 'none', "
+                            "'auto' or 'auto_mask', found '"
+                         << partial_tiles() << "'";
+  }
+  return success();
 }
 
 ParseResult transform::TileOp::parse(OpAsmParser &parser,
@@ -450,6 +593,30 @@ LogicalResult transform::InterchangeOp::verify() {
   return success();
 }
 
+//===---------------------------------------------------------------------===//
+// SplitReductionOp
+//===---------------------------------------------------------------------===//
+
+FailureOr<LinalgOp>
+transform::SplitReductionOp::applyToOne(LinalgOp target) {
+  auto functionalSplit = [&](LinalgOp op,
+                             PatternRewriter &rewriter) -> FailureOr<LinalgOp> {
+    auto genericOp = dyn_cast<GenericOp>(op.getOperation());
+    if (!genericOp)
+      return failure();
+    FailureOr<GenericOp> splitOp =
+        splitReduction(rewriter, genericOp, split_factor(), inner_parallel());
+    if (failed(splitOp))
+      return failure();
+    return cast<LinalgOp>(splitOp->getOperation());
+  };
+  auto res = functional::applyAt(target, functionalSplit);
+  if (failed(res))
+    return target->emitOpError()
+           << "failed to split the reduction of: " << target;
+  return res;
+}
+
 //===---------------------------------------------------------------------===//
 // PadOp
 //===---------------------------------------------------------------------===//
@@ -576,7 +743,7 @@ static void configureVectorizationPatterns(transform::VectorizeOp vectorizeOp,
                                                        /*benefit=*/2);
   vector::TransferReadOp::getCanonicalizationPatterns(patterns, ctx);
   vector::TransferWriteOp::getCanonicalizationPatterns(patterns, ctx);
-  if (vectorizeOp.vectorize_padding())
+  if (vectorizeOp.vectorize_padding() || vectorizeOp.vectorize_with_masking())
     linalg::populatePadOpVectorizationPatterns(patterns);
 }
 
@@ -600,6 +767,17 @@ executeTargetedVectorizeOp(LinalgOp target,
   return transform::scoped(
       target,
       [&](transform::ScopeOp scope, Operation *op) -> FailureOr<LinalgOp> {
+        // Pad to the static bounding box, the pad ops are created in the scope
+        // and fold into masked transfers when vectorizing the padding.
+        auto linalgOp = cast<LinalgOp>(op);
+        if (vectorizeOp.vectorize_with_masking() &&
+            linalgOp.hasDynamicShape()) {
+          FailureOr<LinalgOp> padded =
+              padWithZeros(linalgOp, getZeroPaddableDims(linalgOp));
+          if (failed(padded))
+            return failure();
+          op = *padded;
+        }
         if (failed(functional::applyAt(op, functionalVectorize)) ||
             failed(applyPatternsAndFoldGreedily(scope, std::move(patterns))))
           return failure();
@@ -642,6 +820,12 @@ transform::VectorizeOp::apply(transform::TransformResults &results,
   return failure(failed(applicationResult) || failed(listenerResult));
 }
 
+LogicalResult transform::VectorizeOp::verify() {
+  if (vectorize_with_masking() && !target())
+    return emitOpError() << "expects a target when vectorizing with masking";
+  return success();
+}
+
 ParseResult transform::VectorizeOp::parse(OpAsmParser &parser,
                                           OperationState &result) {
   auto operationType = pdl::OperationType::get(parser.getContext());
@@ -1077,6 +1261,20 @@ transform::TileToLinalgExtTileOp::apply(transform::TransformResults &results,
   return success();
 }
 
+FailureOr<Operation *>
+transform::FuseConsumerIntoLinalgExtLoopOp::applyToOne(LinalgOp target) {
+  LinalgExt::LinalgExtConsumerFusionPattern pattern(this->getContext(),
+                                                    operand_to_fuse());
+  auto functionalRewrite =
+      [&](LinalgOp op, PatternRewriter &rewriter) -> FailureOr<Operation *> {
+    auto result = pattern.returningMatchAndRewrite(op, rewriter);
+    if (failed(result))
+      return failure();
+    return result;
+  };
+  return functional::applyAt(target, functionalRewrite);
+}
+
 FailureOr<scf::ForOp> transform::RewriteLinalgExtTileToScfForOp::applyToOne(
     LinalgExt::TileOp target) {
   LinalgExt::TileOpToSCFRewriter pattern(this->getContext());
@@ -1094,7 +1292,8 @@ FailureOr<scf::ForOp> transform::RewriteLinalgExtTileToScfForOp::applyToOne(
 FailureOr<LinalgExt::InParallelOp>
 transform::RewriteLinalgExtTileToInParallelOp::applyToOne(
     LinalgExt::TileOp target) {
-  LinalgExt::TileOpToInParallelRewriter pattern(this->getContext());
+  LinalgExt::TileOpToInParallelRewriter pattern(this->getContext(), schedule(),
+                                                 chunk_size());
   auto functionalRewrite =
       [&](LinalgExt::TileOp op,
           PatternRewriter &rewriter) -> FailureOr<LinalgExt::InParallelOp> {
@@ -1106,10 +1305,20 @@ transform::RewriteLinalgExtTileToInParallelOp::applyToOne(
   return functional::applyAt(target, functionalRewrite);
 }
 
+LogicalResult transform::RewriteLinalgExtTileToInParallelOp::verify() {
+  if (!LinalgExt::InParallelOp::isValidSchedule(schedule())) {
+    return emitOpError() << "expects schedule to be one of 'static', "
+                            "'dynamic' or 'guided', found '"
+                         << schedule() << "'";
+  }
+  return success();
+}
+
 FailureOr<Operation *>
 transform::RewriteLinalgExtInParallelToAsyncOp::applyToOne(
     LinalgExt::InParallelOp target) {
-  LinalgExt::InParallelOpToAsyncRewriter pattern(this->getContext());
+  LinalgExt::InParallelOpToAsyncRewriter pattern(this->getContext(),
+                                                 block_size());
   auto functionalRewrite =
       [&](LinalgExt::InParallelOp op,
           PatternRewriter &rewriter) -> FailureOr<Operation *> {
@@ -1144,5 +1353,136 @@ transform::RewriteLinalgExtInParallelToScfForOp::applyToOne(
   return functional::applyAt(target, functionalRewrite);
 }
 
+FailureOr<linalg::GenericOp>
+transform::RewriteLinalgExtSoftmaxToLinalgOp::applyToOne(
+    LinalgExt::SoftmaxOp target) {
+  LinalgExt::SoftmaxOpToLinalgRewriter pattern(this->getContext());
+  auto functionalRewrite =
+      [&](LinalgExt::SoftmaxOp op,
+          PatternRewriter &rewriter) -> FailureOr<linalg::GenericOp> {
+    auto result = pattern.returningMatchAndRewrite(op, rewriter);
+    if (failed(result))
+      return failure();
+    return result;
+  };
+  return functional::applyAt(target, functionalRewrite);
+}
+
+FailureOr<linalg::GenericOp>
+transform::RewriteLinalgExtPackToLinalgOp::applyToOne(
+    LinalgExt::PackOp target) {
+  LinalgExt::PackOpToLinalgRewriter pattern(this->getContext());
+  auto functionalRewrite =
+      [&](LinalgExt::PackOp op,
+          PatternRewriter &rewriter) -> FailureOr<linalg::GenericOp> {
+    auto result = pattern.returningMatchAndRewrite(op, rewriter);
+    if (failed(result))
+      return failure();
+    return result;
+  };
+  return functional::applyAt(target, functionalRewrite);
+}
+
+FailureOr<linalg::GenericOp>
+transform::RewriteLinalgExtUnPackToLinalgOp::applyToOne(
+    LinalgExt::UnPackOp target) {
+  LinalgExt::UnPackOpToLinalgRewriter pattern(this->getContext());
+  auto functionalRewrite =
+      [&](LinalgExt::UnPackOp op,
+          PatternRewriter &rewriter) -> FailureOr<linalg::GenericOp> {
+    auto result = pattern.returningMatchAndRewrite(op, rewriter);
+    if (failed(result))
+      return failure();
+    return result;
+  };
+  return functional::applyAt(target, functionalRewrite);
+}
+
+FailureOr<LinalgExt::InParallelOp>
+transform::RewriteLinalgExtSortToParallelMergeSortOp::applyToOne(
+    LinalgExt::SortOp target) {
+  LinalgExt::SortOpToParallelMergeSortRewriter pattern(this->getContext(),
+                                                       num_threads());
+  auto functionalRewrite =
+      [&](LinalgExt::SortOp op,
+          PatternRewriter &rewriter) -> FailureOr<LinalgExt::InParallelOp> {
+    auto result = pattern.returningMatchAndRewrite(op, rewriter);
+    if (failed(result))
+      return failure();
+    return result;
+  };
+  return functional::applyAt(target, functionalRewrite);
+}
+
+FailureOr<linalg::BatchMatmulOp>
+transform::RewriteConv2DToWinogradOp::applyToOne(
+    linalg::Conv2DNhwcHwcfOp target) {
+  LinalgExt::ConvOpToWinogradRewriter pattern(this->getContext(),
+                                              output_tile_size());
+  auto functionalRewrite =
+      [&](linalg::Conv2DNhwcHwcfOp op,
+          PatternRewriter &rewriter) -> FailureOr<linalg::BatchMatmulOp> {
+    auto result = pattern.returningMatchAndRewrite(op, rewriter);
+    if (failed(result))
+      return failure();
+    return result;
+  };
+  return functional::applyAt(target, functionalRewrite);
+}
+
+FailureOr<linalg::LinalgOp>
+transform::PadContractionToBlockSizeOp::applyToOne(linalg::LinalgOp target) {
+  LinalgExt::PadContractionToBlockSizeRewriter pattern(
+      this->getContext(), row_alignment(), column_alignment(),
+      vector_bit_width());
+  auto functionalRewrite =
+      [&](linalg::LinalgOp op,
+          PatternRewriter &rewriter) -> FailureOr<linalg::LinalgOp> {
+    auto result = pattern.returningMatchAndRewrite(op, rewriter);
+    if (failed(result))
+      return failure();
+    return result;
+  };
+  return functional::applyAt(target, functionalRewrite);
+}
+
+LogicalResult transform::RewriteLinalgExtToLoopsOp::apply(
+    transform::TransformResults &results, transform::TransformState &state) {
+  LinalgExt::TiledOpInterfaceToLoopsRewriter pattern(this->getContext());
+  for (Operation *target : state.getPayloadOps(target())) {
+    auto tiledOp = dyn_cast<LinalgExt::TiledOpInterface>(target);
+    if (!tiledOp) {
+      target->emitError("Cannot lower op to loops: Not a TiledOpInterface");
+      return failure();
+    }
+    if (failed(functional::applyReturningPatternAt(pattern, tiledOp)))
+      return failure();
+  }
+  return success();
+}
+
+LogicalResult transform::RewriteLinalgExtTopkSplitReductionOp::apply(
+    transform::TransformResults &results, transform::TransformState &state) {
+  LinalgExt::TopkOpSplitReductionRewriter pattern(this->getContext(),
+                                                  split_ratio());
+  SmallVector<Operation *> splitTopkOps, mergeTopkOps;
+  for (Operation *target : state.getPayloadOps(target())) {
+    auto topkOp = dyn_cast<LinalgExt::TopkOp>(target);
+    if (!topkOp) {
+      target->emitError("Cannot split op: Not a linalg_ext.topk");
+      return failure();
+    }
+    FailureOr<LinalgExt::TopkSplitReductionResult> result =
+        functional::applyReturningPatternAt(pattern, topkOp);
+    if (failed(result))
+      return failure();
+    splitTopkOps.push_back(result->splitTopkOp);
+    mergeTopkOps.push_back(result->mergeTopkOp);
+  }
+  results.set(split_topk().cast<OpResult>(), splitTopkOps);
+  results.set(merge_topk().cast<OpResult>(), mergeTopkOps);
+  return success();
+}
+
 #define GET_OP_CLASSES
 #include "Dialect/LinalgTransform/LinalgTransformOps.cpp.inc"
@@ -245,3 +245,32 @@ void mlir::vector_ext::maskGenericOpWithSideEffects(
     }
   }
 }
+
+/// Masking strategy that masks the operations masked by
+/// `maskGenericOpWithSideEffects` and vector.fma operations. The masked-off
+/// lanes of a masked vector.fma keep the value of its accumulator, which
+/// lowers to a merge-masked FMA on targets with mask registers (e.g., AVX-512).
+void mlir::vector_ext::maskGenericOpWithSideEffectsAndFMAs(
+    OpBuilder &builder, Operation *op, Value activeMask, const WalkStage &stage,
+    SmallVectorImpl<Operation *> &erasedOps) {
+  // Nothing to do. All-ones mask to apply.
+  if (!activeMask)
+    return;
+
+  // Mask vector.fma by selecting its accumulator in the masked-off lanes.
+  auto fmaOp = dyn_cast<FMAOp>(op);
+  if (!fmaOp) {
+    maskGenericOpWithSideEffects(builder, op, activeMask, stage, erasedOps);
+    return;
+  }
+  if (!stage.isBeforeAllRegions() ||
+      activeMask.getType().cast<VectorType>().getShape() !=
+          fmaOp.getVectorType().getShape())
+    return;
+
+  OpBuilder::InsertionGuard guard(builder);
+  builder.setInsertionPointAfter(op);
+  auto selectOp = builder.create<arith::SelectOp>(
+      op->getLoc(), activeMask, fmaOp.getResult(), fmaOp.getAcc());
+  fmaOp.getResult().replaceAllUsesExcept(selectOp.getResult(), selectOp);
+}
@@ -12,6 +12,7 @@
 #include "mlir/Dialect/GPU/GPUDialect.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/SCF/SCF.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
 #include "mlir/Dialect/Vector/IR/VectorOps.h"
 #include "mlir/Dialect/Vector/Transforms/VectorTransforms.h"
 #include "mlir/Dialect/Vector/Utils/VectorUtils.h"
@@ -186,10 +187,86 @@ struct WarpOpElementwise : public OpRewritePattern<WarpExecuteOnLane0Op> {
   }
 };
 
+/// Shuffles `val` across the lanes of a GPU warp with gpu.shuffle xor ops.
+/// Vectors are shuffled one element at a time.
+static Value gpuShuffleXor(Location loc, OpBuilder &builder, Value val,
+                           int64_t offset, int64_t warpSize) {
+  auto vectorType = val.getType().dyn_cast<VectorType>();
+  if (!vectorType) {
+    return builder
+        .create<gpu::ShuffleOp>(loc, val, offset, /*width=*/warpSize,
+                                /*mode=*/gpu::ShuffleMode::XOR)
+        .result();
+  }
+  auto flatType = VectorType::get({vectorType.getNumElements()},
+                                  vectorType.getElementType());
+  Value flat = val;
+  if (flatType != vectorType)
+    flat = builder.create<vector::ShapeCastOp>(loc, flatType, val);
+  Value result =
+      builder.create<arith::ConstantOp>(loc, builder.getZeroAttr(flatType));
+  for (int64_t i = 0, e = flatType.getNumElements(); i < e; ++i) {
+    Value element = builder.create<vector::ExtractOp>(loc, flat, i);
+    Value shuffled = gpuShuffleXor(loc, builder, element, offset, warpSize);
+    result = builder.create<vector::InsertOp>(loc, shuffled, result, i);
+  }
+  if (flatType == vectorType)
+    return result;
+  return builder.create<vector::ShapeCastOp>(loc, vectorType, result);
+}
+
+/// Reduces `val` with `kind` across `size` lanes exchanging values with
+/// `shuffle`, which returns the value of the lane whose id is the id of the
+/// current lane xor the given offset. Every step combines the values of lanes
+/// distant by half the distance of the previous step, after log2(size) steps
+/// every lane holds the reduction of all the lanes.
+static Value
+buildButterflyReduction(OpBuilder &b, Location loc, vector::CombiningKind kind,
+                        Value val, int64_t size,
+                        function_ref<Value(Value, int64_t)> shuffle) {
+  for (int64_t offset = size / 2; offset > 0; offset /= 2)
+    val = makeArithReduction(b, loc, kind, val, shuffle(val, offset));
+  return val;
+}
+
+/// Base class of the patterns reducing vectors across the lanes of a warp.
+struct WarpOpReductionBase : public OpRewritePattern<WarpExecuteOnLane0Op> {
+  WarpOpReductionBase(MLIRContext *context, WarpShuffleFn shuffleFn,
+                      PatternBenefit benefit = 1)
+      : OpRewritePattern<WarpExecuteOnLane0Op>(context, benefit),
+        shuffleFn(std::move(shuffleFn)) {}
+
+protected:
+  /// Returns true if values of `type` can be shuffled across the lanes. The
+  /// default gpu.shuffle ops only support 32-bit scalars.
+  bool canShuffle(Type type) const {
+    if (shuffleFn)
+      return true;
+    Type elementType = getElementTypeOrSelf(type);
+    return elementType.isF32() || elementType.isSignlessInteger(32);
+  }
+
+  /// Reduces `val` across the `warpSize` lanes of a warp, the result is
+  /// available on all the lanes.
+  Value reduceAcrossLanes(OpBuilder &b, Location loc,
+                          vector::CombiningKind kind, Value val,
+                          int64_t warpSize) const {
+    auto shuffle = [&](Value laneVal, int64_t offset) {
+      if (shuffleFn)
+        return shuffleFn(loc, b, laneVal, offset, warpSize);
+      return gpuShuffleXor(loc, b, laneVal, offset, warpSize);
+    };
+    return buildButterflyReduction(b, loc, kind, val, warpSize, shuffle);
+  }
+
+private:
+  WarpShuffleFn shuffleFn;
+};
+
 /// A pattern that extracts vector.reduction ops from a WarpExecuteOnLane0Op.
 /// The vector is reduced in parallel. Currently limited to vector<32x...>
-/// values. Every lane reduces two scalars, 5 times in a row.
-/// E.g.:
+/// values. Every lane reduces two values with a butterfly of shuffles, 5 times
+/// in a row, after which all the lanes hold the result. E.g.:
 /// ```
 /// %r = vector_ext.warp_execute_on_lane_0(%laneid) -> (f32) {
 ///   %0 = "some_def"() : () -> (vector<32xf32>)
@@ -204,17 +281,17 @@ struct WarpOpElementwise : public OpRewritePattern<WarpExecuteOnLane0Op> {
 ///   vector_ext.yield %1 : vector<32xf32>
 /// }
 /// %a = vector.extract %0[0] : vector<1xf32>
-/// %r0, %s0 = gpu.shuffle down %e, %c16, %c32 : f32
+/// %r0, %s0 = gpu.shuffle xor %e, %c16, %c32 : f32
 /// %a0 = arith.addf %a, %r0 : f32
-/// %r1, %s1 = gpu.shuffle down %e, %c8, %c32 : f32
+/// %r1, %s1 = gpu.shuffle xor %e, %c8, %c32 : f32
 /// %a1 = arith.addf %a0, %r1 : f32
 /// ...
-/// %r4, %s4 = gpu.shuffle down %e, %c1, %c32 : f32
-/// %a4 = arith.addf %a3, %r4 : f32
-/// %r = gpu.shuffle idx %a4, %c0, %c32 : f32
+/// %r4, %s4 = gpu.shuffle xor %e, %c1, %c32 : f32
+/// %r = arith.addf %a3, %r4 : f32
 /// ```
-struct WarpOpReduction : public OpRewritePattern<WarpExecuteOnLane0Op> {
-  using OpRewritePattern<WarpExecuteOnLane0Op>::OpRewritePattern;
+/// The accumulator of the reduction, if any, is combined with the result.
+struct WarpOpReduction : public WarpOpReductionBase {
+  using WarpOpReductionBase::WarpOpReductionBase;
 
   LogicalResult matchAndRewrite(WarpExecuteOnLane0Op warpOp,
                                 PatternRewriter &rewriter) const override {
@@ -232,19 +309,25 @@ struct WarpOpReduction : public OpRewritePattern<WarpExecuteOnLane0Op> {
     // Only warp_size-sized vectors supported.
     if (static_cast<uint64_t>(vectorType.getShape()[0]) != warpOp.warp_size())
       return failure();
-    // Only f32 and i32 element types are supported.
-    if (!reductionOp.getType().isF32() &&
-        !reductionOp.getType().isSignlessInteger(32))
+    // The butterfly requires a power of two number of lanes.
+    if (!llvm::isPowerOf2_64(warpOp.warp_size()))
+      return failure();
+    if (!canShuffle(reductionOp.getType()))
       return failure();
 
     Location yieldLoc = yieldOperand->getOwner()->getLoc();
 
-    // Return vector that will be reduced from the WarpExecuteOnLane0Op.
+    // Return vector that will be reduced from the WarpExecuteOnLane0Op, and the
+    // accumulator that is uniform across the lanes.
     unsigned operandIndex = yieldOperand->getOperandNumber();
     SmallVector<Value> yieldValues;
     SmallVector<Type> retTypes;
     yieldValues.push_back(reductionOp.getVector());
     retTypes.push_back(VectorType::get({1}, reductionOp->getResultTypes()[0]));
+    if (Value acc = reductionOp.getAcc()) {
+      yieldValues.push_back(acc);
+      retTypes.push_back(acc.getType());
+    }
     WarpExecuteOnLane0Op newWarpOp = moveRegionToNewWarpOpAndAppendReturns(
         rewriter, warpOp, yieldValues, retTypes);
 
@@ -252,25 +335,92 @@ struct WarpOpReduction : public OpRewritePattern<WarpExecuteOnLane0Op> {
     Value laneValVec = newWarpOp.getResult(warpOp.getNumResults());
     Value laneVal = rewriter.create<vector::ExtractOp>(yieldLoc, laneValVec, 0);
 
-    // Parallel reduction: Every thread reduces two values. The result is
-    // stored at the lower thread. Requires log_2(warp_size) many parallel
-    // reductions.
-    for (int i = newWarpOp.warp_size() / 2; i > 0; i /= 2) {
-      Value shuffled =
-          rewriter
-              .create<gpu::ShuffleOp>(reductionOp.getLoc(), laneVal, i,
-                                      /*width=*/newWarpOp.warp_size(),
-                                      /*mode=*/gpu::ShuffleMode::DOWN)
-              .result();
-      laneVal = makeArithReduction(rewriter, reductionOp.getLoc(),
-                                   reductionOp.getKind(), laneVal, shuffled);
+    // Parallel reduction: Every lane reduces its value with the value of the
+    // lane at an xor distance. Requires log_2(warp_size) many parallel
+    // reductions and leaves the result on all the lanes.
+    laneVal = reduceAcrossLanes(rewriter, reductionOp.getLoc(),
+                                reductionOp.getKind(), laneVal,
+                                newWarpOp.warp_size());
+    if (reductionOp.getAcc()) {
+      laneVal = makeArithReduction(
+          rewriter, reductionOp.getLoc(), reductionOp.getKind(), laneVal,
+          newWarpOp.getResult(warpOp.getNumResults() + 1));
     }
+    newWarpOp.getResult(operandIndex).replaceAllUsesWith(laneVal);
+    return success();
+  }
+};
 
-    // Broadcast the result to all lanes.
-    auto shuffleOp = rewriter.create<gpu::ShuffleOp>(
-        yieldLoc, laneVal, /*offset=*/0, /*width=*/newWarpOp.warp_size(),
-        /*mode=*/gpu::ShuffleMode::IDX);
-    newWarpOp.getResult(operandIndex).replaceAllUsesWith(shuffleOp.result());
+/// A pattern that extracts vector.multi_reduction ops from a
+/// WarpExecuteOnLane0Op. The single reduction dimension is distributed across
+/// the lanes. Every lane first reduces its slice of the vector, the partial
+/// results are then reduced with a butterfly of shuffles. E.g.:
+/// ```
+/// %r = vector_ext.warp_execute_on_lane_0(%laneid) -> (vector<4xf32>) {
+///   %0 = "some_def"() : () -> (vector<4x64xf32>)
+///   %1 = vector.multi_reduction <add>, %0 [1] : vector<4x64xf32> to
+///   vector<4xf32>
+///   vector_ext.yield %1 : vector<4xf32>
+/// }
+/// ```
+/// is lowered to:
+/// ```
+/// %0 = vector_ext.warp_execute_on_lane_0(%laneid) -> (vector<4x2xf32>) {
+///   %1 = "some_def"() : () -> (vector<4x64xf32>)
+///   vector_ext.yield %1 : vector<4x64xf32>
+/// }
+/// %a = vector.multi_reduction <add>, %0 [1] : vector<4x2xf32> to
+/// vector<4xf32>
+/// // Butterfly of shuffles of %a, log_2(warp_size) steps.
+/// ...
+/// ```
+struct WarpOpMultiReduction : public WarpOpReductionBase {
+  using WarpOpReductionBase::WarpOpReductionBase;
+
+  LogicalResult matchAndRewrite(WarpExecuteOnLane0Op warpOp,
+                                PatternRewriter &rewriter) const override {
+    OpOperand *yieldOperand = getWarpResult(warpOp, [](Operation *op) {
+      return isa<vector::MultiDimReductionOp>(op);
+    });
+    if (!yieldOperand)
+      return failure();
+
+    auto reductionOp =
+        cast<vector::MultiDimReductionOp>(yieldOperand->get().getDefiningOp());
+    unsigned operandIndex = yieldOperand->getOperandNumber();
+    // The result is uniform across the lanes.
+    if (warpOp.getResult(operandIndex).getType() != reductionOp.getType())
+      return failure();
+    VectorType sourceType = reductionOp.getSourceVectorType();
+    SmallVector<bool> reductionMask = reductionOp.getReductionMask();
+    if (sourceType.getRank() < 2 || llvm::count(reductionMask, true) != 1)
+      return failure();
+    int64_t warpSize = warpOp.warp_size();
+    unsigned reductionDim = llvm::find(reductionMask, true) -
+                            reductionMask.begin();
+    if (!llvm::isPowerOf2_64(warpSize) ||
+        sourceType.getDimSize(reductionDim) % warpSize != 0)
+      return failure();
+    if (!canShuffle(reductionOp.getType()))
+      return failure();
+
+    // Every lane gets a slice of the reduction dimension.
+    SmallVector<int64_t> distributedShape(sourceType.getShape().begin(),
+                                          sourceType.getShape().end());
+    distributedShape[reductionDim] /= warpSize;
+    auto distributedType =
+        VectorType::get(distributedShape, sourceType.getElementType());
+    WarpExecuteOnLane0Op newWarpOp = moveRegionToNewWarpOpAndAppendReturns(
+        rewriter, warpOp, {reductionOp.getSource()}, {distributedType});
+
+    // Reduce the slice of every lane, then across the lanes.
+    Location loc = reductionOp.getLoc();
+    Value laneVal = rewriter.create<vector::MultiDimReductionOp>(
+        loc, newWarpOp.getResults().back(), reductionMask,
+        reductionOp.getKind());
+    laneVal = reduceAcrossLanes(rewriter, loc, reductionOp.getKind(), laneVal,
+                                warpSize);
+    newWarpOp.getResult(operandIndex).replaceAllUsesWith(laneVal);
     return success();
   }
 };
@@ -431,6 +581,89 @@ struct WarpOpBroadcast : public OpRewritePattern<WarpExecuteOnLane0Op> {
     return success();
   }
 };
+
+/// Sink out a vector.contract op feeding into a warp op yield. The contraction
+/// is distributed along the parallel dimension of the distributed result, the
+/// operands indexed by this dimension are distributed the same way while the
+/// other operands are uniform. The reduction stays local to every lane. E.g.:
+/// ```
+/// %r = vector_ext.warp_execute_on_lane_0(%laneid) -> (vector<16x2xf32>) {
+///   ...
+///   %3 = vector.contract {...} %0, %1, %2 : vector<16x8xf32>,
+///   vector<8x64xf32> into vector<16x64xf32>
+///   vector_ext.yield %3 : vector<16x64xf32>
+/// }
+/// ```
+/// To
+/// ```
+/// %r:3 = vector_ext.warp_execute_on_lane_0(%laneid) -> (vector<16x8xf32>,
+/// vector<8x2xf32>, vector<16x2xf32>) {
+///   ...
+///   vector_ext.yield %0, %1, %2 : vector<16x8xf32>, vector<8x64xf32>,
+///   vector<16x64xf32>
+/// }
+/// %3 = vector.contract {...} %r#0, %r#1, %r#2 : vector<16x8xf32>,
+/// vector<8x2xf32> into vector<16x2xf32>
+/// ```
+struct WarpOpContract : public OpRewritePattern<WarpExecuteOnLane0Op> {
+  using OpRewritePattern<WarpExecuteOnLane0Op>::OpRewritePattern;
+  LogicalResult matchAndRewrite(WarpExecuteOnLane0Op warpOp,
+                                PatternRewriter &rewriter) const override {
+    OpOperand *operand = getWarpResult(
+        warpOp, [](Operation *op) { return isa<vector::ContractionOp>(op); });
+    if (!operand)
+      return failure();
+    unsigned operandNumber = operand->getOperandNumber();
+    auto contractOp = operand->get().getDefiningOp<vector::ContractionOp>();
+    // Masked contractions are not supported.
+    if (contractOp->getNumOperands() != 3)
+      return failure();
+    Value distributedVal = warpOp.getResult(operandNumber);
+    auto distributedType = distributedVal.getType().dyn_cast<VectorType>();
+    if (!distributedType)
+      return failure();
+
+    // Only support distributing a single dimension of the result.
+    AffineMap map =
+        calculateImplicitMap(contractOp.getResult(), distributedVal);
+    if (map.getNumResults() != 1)
+      return failure();
+    unsigned resultDim = map.getDimPosition(0);
+    SmallVector<AffineMap, 4> indexingMaps = contractOp.getIndexingMaps();
+    auto iterationDimExpr =
+        indexingMaps[2].getResult(resultDim).dyn_cast<AffineDimExpr>();
+    if (!iterationDimExpr)
+      return failure();
+    unsigned iterationDim = iterationDimExpr.getPosition();
+    int64_t distributedSize = distributedType.getDimSize(resultDim);
+
+    SmallVector<Value> yieldValues;
+    SmallVector<Type> retTypes;
+    for (auto it : llvm::zip(contractOp->getOperands(), indexingMaps)) {
+      Value contractOperand = std::get<0>(it);
+      auto operandType = contractOperand.getType().cast<VectorType>();
+      SmallVector<int64_t> shape(operandType.getShape().begin(),
+                                 operandType.getShape().end());
+      for (auto expr : llvm::enumerate(std::get<1>(it).getResults())) {
+        auto dimExpr = expr.value().dyn_cast<AffineDimExpr>();
+        if (dimExpr && dimExpr.getPosition() == iterationDim)
+          shape[expr.index()] = distributedSize;
+      }
+      yieldValues.push_back(contractOperand);
+      retTypes.push_back(VectorType::get(shape, operandType.getElementType()));
+    }
+    WarpExecuteOnLane0Op newWarpOp = moveRegionToNewWarpOpAndAppendReturns(
+        rewriter, warpOp, yieldValues, retTypes);
+    SmallVector<Value> newOperands(
+        newWarpOp.getResults().take_back(yieldValues.size()));
+    Operation *newContract = cloneOpWithOperandsAndTypes(
+        rewriter, contractOp.getLoc(), contractOp, newOperands,
+        {distributedType});
+    newWarpOp->getResult(operandNumber)
+        .replaceAllUsesWith(newContract->getResult(0));
+    return success();
+  }
+};
 } // namespace
 
 /// Helper to figure out if an op has side effects or recursive side-effects.
@@ -681,11 +914,65 @@ struct WarpOpScfForOp : public OpRewritePattern<WarpExecuteOnLane0Op> {
   }
 };
 
+namespace {
+
+/// Rewrite a vector.reduction of a 1-D vector whose size is a power of two to a
+/// butterfly of in-register vector.shuffle ops. Every step combines the vector
+/// with the permutation of itself exchanging the elements at an xor distance,
+/// all the elements hold the result after log_2(size) steps. E.g.:
+/// ```
+/// %r = vector.reduction <add>, %v : vector<4xf32> into f32
+/// ```
+/// is rewritten to:
+/// ```
+/// %s0 = vector.shuffle %v, %v [2, 3, 0, 1] : vector<4xf32>, vector<4xf32>
+/// %a0 = arith.addf %v, %s0 : vector<4xf32>
+/// %s1 = vector.shuffle %a0, %a0 [1, 0, 3, 2] : vector<4xf32>, vector<4xf32>
+/// %a1 = arith.addf %a0, %s1 : vector<4xf32>
+/// %r = vector.extract %a1[0] : vector<4xf32>
+/// ```
+/// Floating-point reductions are reassociated.
+struct VectorReductionToButterflyShuffle
+    : public OpRewritePattern<vector::ReductionOp> {
+  using OpRewritePattern<vector::ReductionOp>::OpRewritePattern;
+  LogicalResult matchAndRewrite(vector::ReductionOp reductionOp,
+                                PatternRewriter &rewriter) const override {
+    auto vectorType = reductionOp.getVector().getType().cast<VectorType>();
+    if (vectorType.getRank() != 1)
+      return failure();
+    int64_t size = vectorType.getDimSize(0);
+    if (size < 2 || !llvm::isPowerOf2_64(size))
+      return failure();
+
+    Location loc = reductionOp.getLoc();
+    auto shuffle = [&](Value val, int64_t offset) -> Value {
+      SmallVector<int64_t> mask;
+      for (int64_t i = 0; i < size; ++i)
+        mask.push_back(i ^ offset);
+      return rewriter.create<vector::ShuffleOp>(loc, val, val, mask);
+    };
+    Value result = buildButterflyReduction(rewriter, loc, reductionOp.getKind(),
+                                           reductionOp.getVector(), size,
+                                           shuffle);
+    result = rewriter.create<vector::ExtractOp>(loc, result, 0);
+    if (Value acc = reductionOp.getAcc()) {
+      result =
+          makeArithReduction(rewriter, loc, reductionOp.getKind(), result, acc);
+    }
+    rewriter.replaceOp(reductionOp, result);
+    return success();
+  }
+};
+
+} // namespace
+
 void mlir::vector_ext::populatePropagateVectorDistributionPatterns(
-    RewritePatternSet &pattern) {
+    RewritePatternSet &pattern, WarpShuffleFn shuffleFn) {
   pattern.add<WarpOpElementwise, WarpOpTransferRead, WarpOpDeadResult,
-              WarpOpReduction, WarpOpBroadcast, WarpOpForwardOperand,
+              WarpOpBroadcast, WarpOpContract, WarpOpForwardOperand,
               WarpOpScfForOp>(pattern.getContext());
+  pattern.add<WarpOpReduction, WarpOpMultiReduction>(pattern.getContext(),
+                                                     shuffleFn);
   // TODO: This constant should not be hard-coded here.
   static const int64_t kWarpSize = 32;
   vector::populateVectorUnrollPatterns(
@@ -696,6 +983,11 @@ void mlir::vector_ext::populatePropagateVectorDistributionPatterns(
                    }));
 }
 
+void mlir::vector_ext::populateVectorReductionToButterflyShufflePatterns(
+    RewritePatternSet &patterns) {
+  patterns.add<VectorReductionToButterflyShuffle>(patterns.getContext());
+}
+
 void mlir::vector_ext::populateDistributeTransferWriteOpPatterns(
     RewritePatternSet &patterns, DistributionMapFn distributionMapFn) {
   patterns.add<WarpOpTransferWrite>(patterns.getContext(), distributionMapFn);
@@ -830,6 +1122,268 @@ void mlir::vector_ext::populateWarpExecuteOnLane0OpToScfForPattern(
   patterns.add<WarpOpToScfForPattern>(patterns.getContext(), allocationFn);
 }
 
+/// Creates a loop over the lanes iterated by `laneLoop` with the body built by
+/// `bodyBuilder`. The loop is an scf.parallel if `parallel` is set.
+static void createLaneLoop(OpBuilder &b, scf::ForOp laneLoop, bool parallel,
+                           function_ref<void(OpBuilder &, Location, Value)>
+                               bodyBuilder) {
+  Location loc = laneLoop.getLoc();
+  if (parallel) {
+    b.create<scf::ParallelOp>(
+        loc, laneLoop.getLowerBound(), laneLoop.getUpperBound(),
+        laneLoop.getStep(),
+        [&](OpBuilder &nested, Location nestedLoc, ValueRange ivs) {
+          bodyBuilder(nested, nestedLoc, ivs.front());
+        });
+    return;
+  }
+  b.create<scf::ForOp>(
+      loc, laneLoop.getLowerBound(), laneLoop.getUpperBound(),
+      laneLoop.getStep(), llvm::None,
+      [&](OpBuilder &nested, Location nestedLoc, Value iv, ValueRange) {
+        bodyBuilder(nested, nestedLoc, iv);
+        nested.create<scf::YieldOp>(nestedLoc);
+      });
+}
+
+namespace {
+
+/// Lower a WarpExecuteOnLane0Op nested in a loop over the lanes of the warp for
+/// execution on CPU. The lanes are the iterations of the loop and do not run in
+/// lock-step, the loop is thus split around the warp op: a first loop executes
+/// the ops preceding the warp op and stores the arguments of every lane into
+/// a buffer. The region of the warp op then executes once on the full vectors.
+/// The original loop finally loads the results of every lane from a buffer and
+/// executes the ops following the warp op. Example:
+/// ```
+/// scf.for %laneid = %c0 to %c32 step %c1 {
+///   %v = "some_def"(%laneid) : (index) -> (vector<4xf32>)
+///   %r = vector_ext.warp_execute_on_lane_0(%laneid)[32]
+///       args(%v : vector<4xf32>) -> (vector<1xf32>) {
+///   ^bb0(%arg: vector<128xf32>):
+///     ...
+///     vector_ext.yield %0 : vector<32xf32>
+///   }
+///   "some_use"(%r) : (vector<1xf32>) -> ()
+/// }
+/// ```
+/// To:
+/// ```
+/// scf.for %laneid = %c0 to %c32 step %c1 {
+///   %v = "some_def"(%laneid) : (index) -> (vector<4xf32>)
+///   %o = arith.muli %laneid, %c4 : index
+///   vector.store %v, %arg_buffer[%o] : memref<128xf32>, vector<4xf32>
+/// }
+/// %arg = vector.load %arg_buffer[%c0] : memref<128xf32>, vector<128xf32>
+/// ...
+/// vector.store %0, %result_buffer[%c0] : memref<32xf32>, vector<32xf32>
+/// scf.for %laneid = %c0 to %c32 step %c1 {
+///   %r = vector.load %result_buffer[%laneid] : memref<32xf32>, vector<1xf32>
+///   "some_use"(%r) : (vector<1xf32>) -> ()
+/// }
+/// ```
+/// The ops preceding the warp op that are used after it are recomputed in the
+/// second loop and must thus be free of side effects. The warp region may not
+/// use values defined in the lane loop other than through its arguments.
+/// If `parallelLanes` is set, the loops without warp ops left are rewritten to
+/// scf.parallel ops to execute the lanes on worker threads. The buffers are
+/// then shared by the threads.
+struct WarpOpLaneLoopToCpuPattern
+    : public OpRewritePattern<WarpExecuteOnLane0Op> {
+  WarpOpLaneLoopToCpuPattern(MLIRContext *context,
+                             WarpAllocationFn allocationFn, bool parallelLanes,
+                             PatternBenefit benefit = 1)
+      : OpRewritePattern<WarpExecuteOnLane0Op>(context, benefit),
+        allocationFn(allocationFn), parallelLanes(parallelLanes) {}
+
+  LogicalResult matchAndRewrite(WarpExecuteOnLane0Op warpOp,
+                                PatternRewriter &rewriter) const override {
+    auto laneLoop = dyn_cast<scf::ForOp>(warpOp->getParentOp());
+    if (!laneLoop || laneLoop.getInductionVar() != warpOp.laneid() ||
+        laneLoop.getNumResults() != 0 ||
+        !isConstantIntValue(laneLoop.getLowerBound(), 0) ||
+        !isConstantIntValue(laneLoop.getStep(), 1) ||
+        !isConstantIntValue(laneLoop.getUpperBound(),
+                            static_cast<int64_t>(warpOp.warp_size())))
+      return rewriter.notifyMatchFailure(warpOp, "expected a lane loop");
+
+    // Only 1-D vectors can be exchanged through the buffers.
+    Block *warpOpBody = warpOp.getBody();
+    auto yield = cast<vector_ext::YieldOp>(warpOpBody->getTerminator());
+    auto isVector1D = [](Type type) {
+      auto vectorType = type.dyn_cast<VectorType>();
+      return vectorType && vectorType.getRank() == 1;
+    };
+    if (!llvm::all_of(warpOp.args().getTypes(), isVector1D))
+      return rewriter.notifyMatchFailure(warpOp, "expected 1-D vector args");
+    for (auto it :
+         llvm::zip(warpOp.getResultTypes(), yield->getOperandTypes())) {
+      if (std::get<0>(it) != std::get<1>(it) && !isVector1D(std::get<0>(it)))
+        return rewriter.notifyMatchFailure(warpOp, "expected 1-D vectors");
+    }
+
+    // The warp region executes once for all the lanes.
+    Region &laneRegion = laneLoop.getLoopBody();
+    WalkResult usesLaneValues = warpOp.getBodyRegion().walk([&](Operation *op) {
+      for (Value operand : op->getOperands()) {
+        Region *region = operand.getParentRegion();
+        if (laneRegion.isAncestor(region) &&
+            !warpOp.getBodyRegion().isAncestor(region))
+          return WalkResult::interrupt();
+      }
+      return WalkResult::advance();
+    });
+    if (usesLaneValues.wasInterrupted())
+      return rewriter.notifyMatchFailure(warpOp, "uses values of the lanes");
+
+    // Only the first warp op of the loop is lowered, the ops preceding it are
+    // moved to the first loop.
+    SmallVector<Operation *> preOps;
+    for (Operation &op : laneLoop.getBody()->without_terminator()) {
+      if (&op == warpOp.getOperation())
+        break;
+      preOps.push_back(&op);
+    }
+    llvm::SmallPtrSet<Operation *, 8> preOpSet(preOps.begin(), preOps.end());
+    for (Operation *op : preOps) {
+      if (op->walk([](WarpExecuteOnLane0Op) { return WalkResult::interrupt(); })
+              .wasInterrupted())
+        return rewriter.notifyMatchFailure(warpOp, "expected first warp op");
+    }
+
+    // Collect the preceding ops to recompute in the second loop.
+    llvm::SetVector<Operation *> recomputedOps;
+    auto recompute = [&](Value value) {
+      Operation *def = value.getDefiningOp();
+      if (def && preOpSet.contains(def))
+        recomputedOps.insert(def);
+    };
+    for (Operation *op = warpOp->getNextNode(); op; op = op->getNextNode()) {
+      op->walk([&](Operation *nested) {
+        llvm::for_each(nested->getOperands(), recompute);
+      });
+    }
+    for (unsigned i = 0; i < recomputedOps.size(); ++i)
+      llvm::for_each(recomputedOps[i]->getOperands(), recompute);
+    if (llvm::any_of(recomputedOps, [](Operation *op) {
+          return hasSideEffect(*op) || op->getNumRegions() != 0;
+        }))
+      return rewriter.notifyMatchFailure(warpOp, "cannot recompute lane ops");
+
+    // Passed all checks. Start rewriting.
+    Location loc = warpOp.getLoc();
+    OpBuilder::InsertionGuard g(rewriter);
+    rewriter.setInsertionPoint(laneLoop);
+    SmallVector<Value> argBuffers, resultBuffers;
+    for (BlockArgument bbArg : warpOpBody->getArguments()) {
+      argBuffers.push_back(
+          allocationFn(loc, rewriter, warpOp, bbArg.getType()));
+    }
+    SmallVector<Type> yieldedTypes = llvm::to_vector(yield->getOperandTypes());
+    for (Type type : yieldedTypes)
+      resultBuffers.push_back(allocationFn(loc, rewriter, warpOp, type));
+    rewriter.setInsertionPoint(laneLoop);
+    Value c0 = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+
+    // Execute the preceding ops and store the arguments of every lane.
+    if (!preOps.empty() || !argBuffers.empty()) {
+      auto storeArgs = [&](OpBuilder &b, Location nestedLoc, Value laneId) {
+        BlockAndValueMapping mapping;
+        mapping.map(laneLoop.getInductionVar(), laneId);
+        for (Operation *op : preOps)
+          b.clone(*op, mapping);
+        for (auto it : llvm::zip(warpOp.args(), argBuffers)) {
+          Value val = mapping.lookupOrDefault(std::get<0>(it));
+          int64_t storeSize = val.getType().cast<VectorType>().getShape()[0];
+          Value storeOffset = b.create<arith::MulIOp>(
+              nestedLoc, laneId,
+              b.create<arith::ConstantIndexOp>(nestedLoc, storeSize));
+          b.create<vector::StoreOp>(nestedLoc, val, std::get<1>(it),
+                                    storeOffset);
+        }
+      };
+      createLaneLoop(rewriter, laneLoop, parallelLanes, storeArgs);
+    }
+
+    // Execute the warp region once on the full vectors.
+    SmallVector<Value> bbArgReplacements;
+    for (auto it : llvm::zip(warpOpBody->getArgumentTypes(), argBuffers)) {
+      bbArgReplacements.push_back(rewriter.create<vector::LoadOp>(
+          loc, std::get<0>(it).cast<VectorType>(), std::get<1>(it), c0));
+    }
+    rewriter.mergeBlockBefore(warpOpBody, laneLoop, bbArgReplacements);
+    rewriter.setInsertionPoint(yield);
+    for (auto it : llvm::zip(yield.operands(), resultBuffers)) {
+      Value val = std::get<0>(it);
+      if (val.getType().isa<VectorType>())
+        rewriter.create<vector::StoreOp>(loc, val, std::get<1>(it), c0);
+      else
+        rewriter.create<memref::StoreOp>(loc, val, std::get<1>(it), c0);
+    }
+    rewriter.eraseOp(yield);
+
+    // Load the results of every lane, a result of the yielded type is
+    // broadcasted to all lanes.
+    rewriter.setInsertionPoint(warpOp);
+    SmallVector<Value> replacements;
+    for (auto it :
+         llvm::zip(warpOp.getResults(), yieldedTypes, resultBuffers)) {
+      Type resultType = std::get<0>(it).getType();
+      Value buffer = std::get<2>(it);
+      if (resultType == std::get<1>(it) && !resultType.isa<VectorType>()) {
+        replacements.push_back(
+            rewriter.create<memref::LoadOp>(loc, buffer, c0));
+        continue;
+      }
+      Value loadOffset = c0;
+      if (resultType != std::get<1>(it)) {
+        int64_t loadSize = resultType.cast<VectorType>().getShape()[0];
+        loadOffset = rewriter.create<arith::MulIOp>(
+            loc, warpOp.laneid(),
+            rewriter.create<arith::ConstantIndexOp>(loc, loadSize));
+      }
+      replacements.push_back(rewriter.create<vector::LoadOp>(
+          loc, resultType.cast<VectorType>(), buffer, loadOffset));
+    }
+    rewriter.replaceOp(warpOp, replacements);
+    for (Operation *op : llvm::reverse(preOps)) {
+      if (!recomputedOps.contains(op))
+        rewriter.eraseOp(op);
+    }
+
+    // Execute the lanes in parallel once the loop has no warp op left.
+    if (!parallelLanes ||
+        laneLoop->walk([](WarpExecuteOnLane0Op) {
+                  return WalkResult::interrupt();
+                }).wasInterrupted())
+      return success();
+    rewriter.setInsertionPoint(laneLoop);
+    auto parallelOp = rewriter.create<scf::ParallelOp>(
+        laneLoop.getLoc(), laneLoop.getLowerBound(), laneLoop.getUpperBound(),
+        laneLoop.getStep());
+    Block *laneLoopBody = laneLoop.getBody();
+    rewriter.eraseOp(laneLoopBody->getTerminator());
+    rewriter.mergeBlockBefore(laneLoopBody,
+                              parallelOp.getBody()->getTerminator(),
+                              parallelOp.getInductionVars());
+    rewriter.eraseOp(laneLoop);
+    return success();
+  }
+
+private:
+  WarpAllocationFn allocationFn;
+  bool parallelLanes;
+};
+
+} // namespace
+
+void mlir::vector_ext::populateWarpLaneLoopToCpuPatterns(
+    RewritePatternSet &patterns, WarpAllocationFn allocationFn,
+    bool parallelLanes) {
+  patterns.add<WarpOpLaneLoopToCpuPattern>(patterns.getContext(), allocationFn,
+                                           parallelLanes);
+}
+
 /// Helper to know if an op can be hoisted out of the region.
 static bool canBeHoisted(Operation *op,
                          function_ref<bool(Value)> definedOutside) {
@@ -18,20 +18,43 @@
 //===----------------------------------------------------------------------===//
 
 #include "mlir/ExecutionEngine/AsyncRuntime.h"
+#include "ExecutionEngine/AsyncRuntimeExtensions.h"
 
 #ifdef MLIR_ASYNCRUNTIME_DEFINE_FUNCTIONS
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <condition_variable>
-#include <functional>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
 #include <vector>
 
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 
 using namespace mlir::runtime;
 
@@ -46,26 +69,932 @@ namespace {
 // Forward declare class defined below.
 class RefCounted;
 
+// -------------------------------------------------------------------------- //
+// Tracing of the async runtime events, enabled by setting SANDBOX_ASYNC_TRACE
+// to the path of a trace file. Every thread records its events in a ring
+// buffer that keeps its most recent events only. The buffers are written in
+// the Chrome trace event format (chrome://tracing or Perfetto) when the runtime
+// is destroyed, i.e. at `__mlir_runner_destroy` or at exit. When tracing is
+// disabled, recording an event costs a relaxed load and a branch.
+// -------------------------------------------------------------------------- //
+
+class Tracer {
+public:
+  enum class EventKind : uint8_t {
+    kSpawn,
+    kTaskBegin,
+    kTaskEnd,
+    kAwaitBegin,
+    kAwaitEnd,
+  };
+
+  static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+  static void enable() {
+    getState().start = std::chrono::steady_clock::now();
+    enabled.store(true, std::memory_order_release);
+  }
+
+  // Records an event on the current thread. `id` identifies the task or the
+  // awaited value.
+  static void record(EventKind kind, const void *id) {
+    ThreadBuffer *buffer = getThreadBuffer();
+    int64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - getState().start)
+                            .count();
+    buffer->events[buffer->numEvents & kBufferMask] =
+        Event{timestamp, kind, id};
+    ++buffer->numEvents;
+  }
+
+  // Names the current thread in the trace. Must be called before the first
+  // event of the thread is recorded.
+  static void setThreadName(std::string name) {
+    threadName = std::move(name);
+  }
+
+  // Disables tracing and writes the recorded events to `path`. The threads
+  // must not record events concurrently.
+  static void dump(const std::string &path) {
+    enabled.store(false, std::memory_order_release);
+    State &state = getState();
+    std::lock_guard<std::mutex> lock(state.mu);
+    std::ofstream file(path);
+    if (!file) {
+      std::cerr << "Failed to open the async runtime trace file: " << path
+                << std::endl;
+      return;
+    }
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    auto separator = [&]() -> const char * {
+      const char *result = first ? "\n" : ",\n";
+      first = false;
+      return result;
+    };
+    for (size_t tid = 0; tid < state.buffers.size(); ++tid) {
+      ThreadBuffer &buffer = *state.buffers[tid];
+      file << separator()
+           << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":"
+           << tid << ",\"args\":{\"name\":\"" << buffer.name << "\"}}";
+      uint64_t begin = buffer.numEvents > kBufferSize
+                           ? buffer.numEvents - kBufferSize
+                           : 0;
+      for (uint64_t i = begin; i < buffer.numEvents; ++i) {
+        const Event &event = buffer.events[i & kBufferMask];
+        file << separator() << "{\"name\":\"" << getName(event.kind)
+             << "\",\"ph\":\"" << getPhase(event.kind)
+             << "\",\"pid\":0,\"tid\":" << tid << ",\"ts\":"
+             << event.timestamp / 1000 << "." << std::setfill('0')
+             << std::setw(3) << event.timestamp % 1000 << std::setfill(' ')
+             << ",\"args\":{\"id\":\"" << event.id << "\"}}";
+      }
+      buffer.numEvents = 0;
+    }
+    file << "\n]}\n";
+  }
+
+private:
+  // Number of events kept per thread.
+  static constexpr uint64_t kBufferSize = 1 << 16;
+  static constexpr uint64_t kBufferMask = kBufferSize - 1;
+
+  struct Event {
+    // Nanoseconds since tracing was enabled.
+    int64_t timestamp;
+    EventKind kind;
+    const void *id;
+  };
+
+  struct ThreadBuffer {
+    explicit ThreadBuffer(std::string name)
+        : name(std::move(name)), numEvents(0), events(new Event[kBufferSize]) {}
+
+    std::string name;
+    // Total number of events recorded, only the last kBufferSize are kept.
+    uint64_t numEvents;
+    std::unique_ptr<Event[]> events;
+  };
+
+  // The buffers are owned by the global state rather than by the threads, such
+  // that the events of the exited threads are dumped. The state is never
+  // destroyed, the trace may be dumped during the static destructions.
+  struct State {
+    std::mutex mu;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  static State &getState() {
+    static State *state = new State();
+    return *state;
+  }
+
+  static ThreadBuffer *getThreadBuffer() {
+    if (LLVM_LIKELY(threadBuffer != nullptr))
+      return threadBuffer;
+    State &state = getState();
+    std::lock_guard<std::mutex> lock(state.mu);
+    std::string name = threadName;
+    if (name.empty())
+      name = "thread " + std::to_string(state.buffers.size());
+    state.buffers.push_back(std::make_unique<ThreadBuffer>(std::move(name)));
+    threadBuffer = state.buffers.back().get();
+    return threadBuffer;
+  }
+
+  static const char *getName(EventKind kind) {
+    switch (kind) {
+    case EventKind::kSpawn:
+      return "spawn";
+    case EventKind::kTaskBegin:
+    case EventKind::kTaskEnd:
+      return "task";
+    case EventKind::kAwaitBegin:
+    case EventKind::kAwaitEnd:
+      return "await";
+    }
+    llvm_unreachable("unknown event kind");
+  }
+
+  static const char *getPhase(EventKind kind) {
+    switch (kind) {
+    case EventKind::kSpawn:
+      return "i";
+    case EventKind::kTaskBegin:
+    case EventKind::kAwaitBegin:
+      return "B";
+    case EventKind::kTaskEnd:
+    case EventKind::kAwaitEnd:
+      return "E";
+    }
+    llvm_unreachable("unknown event kind");
+  }
+
+  static std::atomic<bool> enabled;
+  static thread_local ThreadBuffer *threadBuffer;
+  static thread_local std::string threadName;
+};
+
+std::atomic<bool> Tracer::enabled(false);
+thread_local Tracer::ThreadBuffer *Tracer::threadBuffer = nullptr;
+thread_local std::string Tracer::threadName;
+
+// -------------------------------------------------------------------------- //
+// A task resumes a suspended coroutine. Tasks are trivially copyable so that
+// the executors can store them without any heap allocation.
+// -------------------------------------------------------------------------- //
+
+struct Task {
+  CoroHandle handle;
+  CoroResume resume;
+
+  void operator()() const {
+    if (LLVM_LIKELY(!Tracer::isEnabled()))
+      return (*resume)(handle);
+    Tracer::record(Tracer::EventKind::kTaskBegin, handle);
+    (*resume)(handle);
+    Tracer::record(Tracer::EventKind::kTaskEnd, handle);
+  }
+};
+
+// -------------------------------------------------------------------------- //
+// Chase-Lev work-stealing deque of tasks, with the memory orderings of "Correct
+// and Efficient Work-Stealing for Weak Memory Models" (Le et al., PPoPP 2013).
+// The owner thread pushes and pops tasks at the bottom (LIFO, to keep the data
+// of the last spawned task hot in its caches) while the other threads steal
+// tasks from the top (FIFO, to steal the oldest and usually largest tasks).
+// -------------------------------------------------------------------------- //
+
+class WorkStealingDeque {
+public:
+  explicit WorkStealingDeque(int64_t logCapacity = 8)
+      : top(0), bottom(0), buffer(new Buffer(logCapacity)) {}
+
+  ~WorkStealingDeque() {
+    delete buffer.load(std::memory_order_relaxed);
+    for (Buffer *retired : retiredBuffers)
+      delete retired;
+  }
+
+  WorkStealingDeque(const WorkStealingDeque &) = delete;
+  WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+  // Pushes a task at the bottom of the deque. Must only be called by the owner.
+  void push(Task task) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    Buffer *buf = buffer.load(std::memory_order_relaxed);
+    if (b - t > buf->mask)
+      buf = grow(buf, t, b);
+    buf->store(b, task);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  // Pops a task from the bottom of the deque. Must only be called by the owner.
+  bool pop(Task &task) {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    Buffer *buf = buffer.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+    if (t > b) {
+      // The deque is empty.
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    task = buf->load(b);
+    if (t < b)
+      return true;
+    // This is the last task, race against the thieves for it.
+    bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                           std::memory_order_relaxed);
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return won;
+  }
+
+  // Steals a task from the top of the deque. May be called by any thread.
+  bool steal(Task &task) {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b)
+      return false;
+    Buffer *buf = buffer.load(std::memory_order_acquire);
+    task = buf->load(t);
+    return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed);
+  }
+
+  // Returns true if the deque looks empty. Sequentially consistent so that a
+  // worker going to sleep can not miss a concurrent push.
+  bool empty() const {
+    int64_t b = bottom.load(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_seq_cst);
+    return b <= t;
+  }
+
+private:
+  // Circular array of tasks. Every slot is made of relaxed atomics: a thief may
+  // read a slot that the owner concurrently overwrites, in which case its CAS
+  // on `top` fails and the torn task is discarded.
+  struct Buffer {
+    explicit Buffer(int64_t logCapacity)
+        : logCapacity(logCapacity), mask((int64_t(1) << logCapacity) - 1),
+          slots(new Slot[mask + 1]) {}
+
+    void store(int64_t index, Task task) {
+      Slot &slot = slots[index & mask];
+      slot.handle.store(task.handle, std::memory_order_relaxed);
+      slot.resume.store(task.resume, std::memory_order_relaxed);
+    }
+
+    Task load(int64_t index) const {
+      const Slot &slot = slots[index & mask];
+      return Task{slot.handle.load(std::memory_order_relaxed),
+                  slot.resume.load(std::memory_order_relaxed)};
+    }
+
+    struct Slot {
+      std::atomic<CoroHandle> handle;
+      std::atomic<CoroResume> resume;
+    };
+
+    int64_t logCapacity;
+    int64_t mask;
+    std::unique_ptr<Slot[]> slots;
+  };
+
+  // Doubles the capacity of the deque. The previous buffer may still be read
+  // by thieves, it is retired and only released with the deque.
+  Buffer *grow(Buffer *buf, int64_t t, int64_t b) {
+    Buffer *grown = new Buffer(buf->logCapacity + 1);
+    for (int64_t i = t; i < b; ++i)
+      grown->store(i, buf->load(i));
+    retiredBuffers.push_back(buf);
+    buffer.store(grown, std::memory_order_release);
+    return grown;
+  }
+
+  alignas(64) std::atomic<int64_t> top;
+  alignas(64) std::atomic<int64_t> bottom;
+  std::atomic<Buffer *> buffer;
+  std::vector<Buffer *> retiredBuffers;
+};
+
+// -------------------------------------------------------------------------- //
+// Placement of the worker threads on the CPUs.
+// -------------------------------------------------------------------------- //
+
+enum class ThreadPinning {
+  // Workers may run on any CPU.
+  kNone,
+  // Every worker is pinned to a single CPU.
+  kCpu,
+  // Every worker is pinned to the CPUs of a single NUMA node.
+  kNumaNode,
+};
+
+#if defined(__linux__)
+// Parses a Linux CPU list such as `0-17,36-39`.
+static std::vector<unsigned> parseCpuList(const std::string &list) {
+  std::vector<unsigned> cpus;
+  size_t pos = 0;
+  while (pos < list.size()) {
+    size_t end = list.find(',', pos);
+    if (end == std::string::npos)
+      end = list.size();
+    std::string range = list.substr(pos, end - pos);
+    size_t dash = range.find('-');
+    unsigned first = std::stoul(range.substr(0, dash));
+    unsigned last =
+        dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+    for (unsigned cpu = first; cpu <= last; ++cpu)
+      cpus.push_back(cpu);
+    pos = end + 1;
+  }
+  return cpus;
+}
+#endif
+
+// Returns the CPUs the process is allowed to run on, grouped by NUMA node. All
+// the CPUs are in a single group if the NUMA topology is unknown.
+static std::vector<std::vector<unsigned>> getCpusPerNumaNode() {
+  std::vector<std::vector<unsigned>> nodes;
+#if defined(__linux__)
+  cpu_set_t allowed;
+  if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0)
+    return nodes;
+  std::vector<unsigned> unassigned;
+  for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &allowed))
+      unassigned.push_back(cpu);
+  }
+  for (unsigned node = 0;; ++node) {
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) +
+                       "/cpulist");
+    std::string list;
+    if (!file || !std::getline(file, list))
+      break;
+    std::vector<unsigned> cpus;
+    for (unsigned cpu : parseCpuList(list)) {
+      auto it = llvm::find(unassigned, cpu);
+      if (it == unassigned.end())
+        continue;
+      cpus.push_back(cpu);
+      unassigned.erase(it);
+    }
+    if (!cpus.empty())
+      nodes.push_back(std::move(cpus));
+  }
+  if (!unassigned.empty())
+    nodes.push_back(std::move(unassigned));
+#endif
+  return nodes;
+}
+
+// Pins `thread` to the given CPUs.
+static void pinThread(std::thread &thread, llvm::ArrayRef<unsigned> cpus) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (unsigned cpu : cpus)
+    CPU_SET(cpu, &set);
+  pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &set);
+#endif
+}
+
+// -------------------------------------------------------------------------- //
+// Work-stealing executor: every worker thread owns a WorkStealingDeque in which
+// it pushes the tasks it spawns. Idle workers pop tasks from their own deque
+// first, then from the shared injection queue that receives the tasks spawned
+// by non-worker threads, and finally steal from randomly chosen victims. Task
+// submission from a worker thus never takes a lock. Workers spin for a short
+// while before going to sleep when they run out of tasks.
+//
+// Tasks may also be bound to a worker, they are then pushed to its mailbox and
+// never stolen: binding the tasks that process the same data to the same
+// worker, across kernel invocations, keeps that data in the caches and in the
+// NUMA node of this worker.
+//
+// Threads blocked on async values keep running tasks and sleep like idle
+// workers when there are none, such that they are woken up by new tasks, in
+// particular by the tasks bound to them. A thread blocked in too many nested
+// awaits stops running tasks, which live on its stack, and a spare thread runs
+// them in its place until it is unblocked.
+// -------------------------------------------------------------------------- //
+
+class WorkStealingExecutor {
+public:
+  WorkStealingExecutor(unsigned numThreads, ThreadPinning pinning)
+      : numSleeping(0), numPendingTasks(0), injectionSize(0),
+        numSparesNeeded(0), stop(false) {
+    numThreads = std::max(numThreads, 1u);
+    workers.reserve(numThreads);
+    for (unsigned i = 0; i < numThreads; ++i)
+      workers.push_back(std::make_unique<Worker>(i));
+    // Start the threads once all the deques exist, they may steal right away.
+    for (unsigned i = 0; i < numThreads; ++i)
+      workers[i]->thread = std::thread([this, i]() { run(i); });
+    if (pinning != ThreadPinning::kNone)
+      pinThreads(pinning);
+  }
+
+  ~WorkStealingExecutor() {
+    wait();
+    {
+      std::lock_guard<std::mutex> lock(sleepMu);
+      stop.store(true);
+    }
+    sleepCv.notify_all();
+    parkedCv.notify_all();
+    for (auto &worker : workers)
+      worker->thread.join();
+    for (std::thread &spare : spares)
+      spare.join();
+  }
+
+  // Schedules `task` for execution on one of the workers.
+  void execute(Task task) {
+    numPendingTasks.fetch_add(1, std::memory_order_relaxed);
+    if (currentExecutor == this) {
+      workers[currentWorkerIndex]->deque.push(task);
+    } else {
+      std::lock_guard<std::mutex> lock(injectionMu);
+      injectionQueue.push_back(task);
+      injectionSize.fetch_add(1, std::memory_order_seq_cst);
+    }
+    notifySleeping();
+  }
+
+  // Schedules `task` for execution on the worker `index` modulo the number of
+  // workers.
+  void executeOnWorker(int64_t index, Task task) {
+    numPendingTasks.fetch_add(1, std::memory_order_relaxed);
+    Worker &worker = *workers[index % workers.size()];
+    {
+      std::lock_guard<std::mutex> lock(worker.mailboxMu);
+      worker.mailbox.push_back(task);
+      worker.mailboxSize.fetch_add(1, std::memory_order_seq_cst);
+    }
+    // Only the target worker can run the task, wake up all the workers.
+    notifySleeping(/*all=*/true);
+  }
+
+  unsigned getNumWorkers() const { return workers.size(); }
+
+  // Returns the index of the worker running on the current thread, or -1 if
+  // the current thread is not a worker of this executor.
+  int64_t getCurrentWorkerIndex() const {
+    return currentExecutor == this ? int64_t(currentWorkerIndex) : -1;
+  }
+
+  // Blocks the current thread until `isDone` returns true. The thread runs the
+  // tasks it finds meanwhile, and otherwise sleeps until new tasks are
+  // submitted or `notifyBlocked` is called. The tasks run by a blocked thread
+  // live on its stack: past kMaxBlockedDepth nested calls, it only runs the
+  // tasks bound to it, which no other thread can run, and a spare thread runs
+  // the other ones in its place until it is unblocked.
+  void blockUntil(llvm::function_ref<bool()> isDone) {
+    Worker *worker =
+        currentExecutor == this ? workers[currentWorkerIndex].get() : nullptr;
+    uint64_t &rngState = worker ? worker->rngState : externalRngState;
+    bool runsAnyTask = blockedDepth < kMaxBlockedDepth;
+    // One spare thread per thread blocked past the limit.
+    bool needsSpare = blockedDepth == kMaxBlockedDepth;
+    if (needsSpare)
+      updateNumSparesNeeded(1);
+    ++blockedDepth;
+    Task task;
+    while (!isDone()) {
+      bool found = false;
+      for (int round = 0; round < kNumSpinRounds && !found; ++round) {
+        if (isDone())
+          break;
+        if (runsAnyTask)
+          found = findTask(worker, rngState, task);
+        else
+          found = worker && popMailbox(*worker, task);
+        if (!found)
+          std::this_thread::yield();
+      }
+      if (found) {
+        task();
+        numPendingTasks.fetch_sub(1, std::memory_order_release);
+        continue;
+      }
+
+      // Same protocol as the idle workers in `run`. The threads that do not
+      // run any task sleep apart, such that they do not absorb the
+      // notifications of new tasks.
+      std::unique_lock<std::mutex> lock(sleepMu);
+      numSleeping.fetch_add(1, std::memory_order_seq_cst);
+      if (runsAnyTask) {
+        while (!isDone() && !hasVisibleTasks(worker))
+          sleepCv.wait(lock);
+      } else {
+        while (!isDone() && !(worker && worker->mailboxSize.load(
+                                            std::memory_order_seq_cst) != 0))
+          parkedCv.wait(lock);
+      }
+      numSleeping.fetch_sub(1, std::memory_order_relaxed);
+    }
+    --blockedDepth;
+    if (needsSpare)
+      updateNumSparesNeeded(-1);
+  }
+
+  // Wakes up the threads sleeping in `blockUntil` to check their condition.
+  void notifyBlocked() { notifySleeping(/*all=*/true); }
+
+  // Waits for the completion of all the scheduled tasks.
+  void wait() {
+    while (numPendingTasks.load(std::memory_order_acquire) != 0)
+      std::this_thread::yield();
+  }
+
+private:
+  // Number of rounds a worker looks for tasks before going to sleep.
+  static constexpr int kNumSpinRounds = 64;
+  // Maximal number of tasks a worker moves from the injection queue to its own
+  // deque, where they can be stolen, to amortize the injection queue lock.
+  static constexpr size_t kMaxInjectedBatch = 32;
+  // Maximal nesting of the `blockUntil` calls running tasks on a thread.
+  static constexpr int kMaxBlockedDepth = 16;
+
+  struct Worker {
+    explicit Worker(unsigned index)
+        : rngState(0x9E3779B97F4A7C15ull * (index + 1)), mailboxSize(0) {}
+
+    WorkStealingDeque deque;
+    std::thread thread;
+    // State of the generator picking the steal victims.
+    uint64_t rngState;
+
+    // Tasks bound to this worker.
+    std::mutex mailboxMu;
+    std::deque<Task> mailbox;
+    std::atomic<int64_t> mailboxSize;
+  };
+
+  // Xorshift pseudo-random generator used to pick the steal victims.
+  static uint64_t nextRandom(uint64_t &state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+
+  // Distributes the workers over the NUMA nodes in contiguous ranges, such
+  // that workers with close indices share a node, and pins them to a CPU or to
+  // all the CPUs of their node.
+  void pinThreads(ThreadPinning pinning) {
+    std::vector<std::vector<unsigned>> nodes = getCpusPerNumaNode();
+    if (nodes.empty())
+      return;
+    size_t numWorkers = workers.size();
+    for (size_t i = 0; i < numWorkers; ++i) {
+      size_t node = i * nodes.size() / numWorkers;
+      llvm::ArrayRef<unsigned> cpus = nodes[node];
+      if (pinning == ThreadPinning::kCpu) {
+        size_t firstWorker = (node * numWorkers + nodes.size() - 1) /
+                             nodes.size();
+        cpus = cpus.slice((i - firstWorker) % cpus.size(), 1);
+      }
+      pinThread(workers[i]->thread, cpus);
+    }
+  }
+
+  void run(unsigned index) {
+    currentExecutor = this;
+    currentWorkerIndex = index;
+    Tracer::setThreadName("worker " + std::to_string(index));
+    Task task;
+    while (true) {
+      bool found = false;
+      for (int round = 0; round < kNumSpinRounds && !found; ++round) {
+        found = findTask(workers[index].get(), workers[index]->rngState, task);
+        if (!found)
+          std::this_thread::yield();
+      }
+      if (found) {
+        task();
+        numPendingTasks.fetch_sub(1, std::memory_order_release);
+        continue;
+      }
+
+      // Go to sleep until new tasks are submitted. `numSleeping` is
+      // incremented before checking for work with sequentially consistent
+      // operations, and submitters check it after publishing their tasks: one
+      // of the two is guaranteed to see the other.
+      std::unique_lock<std::mutex> lock(sleepMu);
+      numSleeping.fetch_add(1, std::memory_order_seq_cst);
+      while (!stop.load() && !hasVisibleTasks(workers[index].get()))
+        sleepCv.wait(lock);
+      numSleeping.fetch_sub(1, std::memory_order_relaxed);
+      if (stop.load() && !hasVisibleTasks(workers[index].get()))
+        return;
+    }
+  }
+
+  // Adds `delta` to the number of spare threads running tasks in place of the
+  // blocked threads, and starts a new spare thread if there are not enough.
+  // The spare threads sleep on the condition variable matching their state:
+  // it is updated under the sleep lock, with all of them woken up.
+  void updateNumSparesNeeded(int delta) {
+    {
+      std::lock_guard<std::mutex> lock(sleepMu);
+      numSparesNeeded += delta;
+      if (spares.size() < numSparesNeeded) {
+        unsigned index = spares.size();
+        spares.emplace_back([this, index]() { runSpare(index); });
+      }
+    }
+    sleepCv.notify_all();
+    parkedCv.notify_all();
+  }
+
+  // Runs the tasks like a worker without deque nor mailbox while it is one of
+  // the `numSparesNeeded` first spare threads, and sleeps otherwise.
+  void runSpare(unsigned index) {
+    Tracer::setThreadName("spare " + std::to_string(index));
+    Task task;
+    while (true) {
+      bool found = false;
+      for (int round = 0; round < kNumSpinRounds && !found; ++round) {
+        if (index >= numSparesNeeded.load(std::memory_order_relaxed))
+          break;
+        found = findTask(nullptr, externalRngState, task);
+        if (!found)
+          std::this_thread::yield();
+      }
+      if (found) {
+        task();
+        numPendingTasks.fetch_sub(1, std::memory_order_release);
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(sleepMu);
+      numSleeping.fetch_add(1, std::memory_order_seq_cst);
+      while (!stop.load()) {
+        if (index >= numSparesNeeded.load(std::memory_order_relaxed))
+          parkedCv.wait(lock);
+        else if (!hasVisibleTasks(nullptr))
+          sleepCv.wait(lock);
+        else
+          break;
+      }
+      numSleeping.fetch_sub(1, std::memory_order_relaxed);
+      if (stop.load())
+        return;
+    }
+  }
+
+  // Looks for a task in the deque of `worker`, then in the injection queue and
+  // finally in the deques of the other workers. `worker` is null when called
+  // from a thread that is not a worker.
+  bool findTask(Worker *worker, uint64_t &rngState, Task &task) {
+    if (worker && worker->deque.pop(task))
+      return true;
+    if (worker && popMailbox(*worker, task))
+      return true;
+    if (popInjected(worker, task))
+      return true;
+    unsigned numWorkers = workers.size();
+    for (unsigned attempt = 0; attempt < 2 * numWorkers; ++attempt) {
+      Worker *victim = workers[nextRandom(rngState) % numWorkers].get();
+      if (victim != worker && victim->deque.steal(task))
+        return true;
+    }
+    return false;
+  }
+
+  bool popMailbox(Worker &worker, Task &task) {
+    if (worker.mailboxSize.load(std::memory_order_relaxed) == 0)
+      return false;
+    std::lock_guard<std::mutex> lock(worker.mailboxMu);
+    if (worker.mailbox.empty())
+      return false;
+    task = worker.mailbox.front();
+    worker.mailbox.pop_front();
+    worker.mailboxSize.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Pops a task from the injection queue and moves a share of the remaining
+  // ones to the deque of `worker`, if any.
+  bool popInjected(Worker *worker, Task &task) {
+    if (injectionSize.load(std::memory_order_relaxed) == 0)
+      return false;
+    size_t share;
+    {
+      std::lock_guard<std::mutex> lock(injectionMu);
+      if (injectionQueue.empty())
+        return false;
+      task = injectionQueue.front();
+      injectionQueue.pop_front();
+      share = worker ? std::min(injectionQueue.size() / workers.size(),
+                                kMaxInjectedBatch)
+                     : 0;
+      for (size_t i = 0; i < share; ++i) {
+        worker->deque.push(injectionQueue.front());
+        injectionQueue.pop_front();
+      }
+      injectionSize.fetch_sub(1 + share, std::memory_order_relaxed);
+    }
+    if (share > 0)
+      notifySleeping();
+    return true;
+  }
+
+  // Returns true if there are tasks `worker` could run. `worker` is null for
+  // the threads that are not workers.
+  bool hasVisibleTasks(const Worker *worker) const {
+    if (injectionSize.load(std::memory_order_seq_cst) != 0 ||
+        (worker && worker->mailboxSize.load(std::memory_order_seq_cst) != 0))
+      return true;
+    return llvm::any_of(workers, [](const std::unique_ptr<Worker> &worker) {
+      return !worker->deque.empty();
+    });
+  }
+
+  void notifySleeping(bool all = false) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (numSleeping.load(std::memory_order_relaxed) == 0)
+      return;
+    std::lock_guard<std::mutex> lock(sleepMu);
+    if (all) {
+      sleepCv.notify_all();
+      parkedCv.notify_all();
+    } else {
+      sleepCv.notify_one();
+    }
+  }
+
+  std::vector<std::unique_ptr<Worker>> workers;
+
+  std::mutex sleepMu;
+  std::condition_variable sleepCv;
+  // Condition variable of the sleeping threads that do not run any task, the
+  // parked spare threads and the threads blocked past kMaxBlockedDepth.
+  std::condition_variable parkedCv;
+  std::atomic<int> numSleeping;
+  std::atomic<int64_t> numPendingTasks;
+
+  std::mutex injectionMu;
+  std::deque<Task> injectionQueue;
+  std::atomic<int64_t> injectionSize;
+
+  // Spare threads, only started and counted under the sleep lock.
+  std::vector<std::thread> spares;
+  std::atomic<unsigned> numSparesNeeded;
+
+  std::atomic<bool> stop;
+
+  // The executor and the index of the worker running on the current thread.
+  static thread_local WorkStealingExecutor *currentExecutor;
+  static thread_local unsigned currentWorkerIndex;
+  // Number of nested `blockUntil` calls on the current thread.
+  static thread_local int blockedDepth;
+  // State of the generator picking the steal victims on the other threads.
+  static thread_local uint64_t externalRngState;
+};
+
+thread_local WorkStealingExecutor *WorkStealingExecutor::currentExecutor =
+    nullptr;
+thread_local unsigned WorkStealingExecutor::currentWorkerIndex = 0;
+thread_local int WorkStealingExecutor::blockedDepth = 0;
+thread_local uint64_t WorkStealingExecutor::externalRngState =
+    0x2545F4914F6CDD1Dull;
+
+// Returns the value of the environment variable `name` parsed as a positive
+// integer, or `defaultValue` if it is not set or not a positive integer.
+static unsigned getEnvPositiveInteger(const char *name, unsigned defaultValue) {
+  const char *value = std::getenv(name);
+  if (!value)
+    return defaultValue;
+  char *end;
+  unsigned long parsed = std::strtoul(value, &end, 10);
+  if (end == value || *end != '\0' || parsed == 0)
+    return defaultValue;
+  return parsed;
+}
+
+// Returns the thread pinning policy named by the environment variable `name`.
+static ThreadPinning getEnvThreadPinning(const char *name) {
+  const char *value = std::getenv(name);
+  if (!value)
+    return ThreadPinning::kNone;
+  if (std::strcmp(value, "1") == 0 || std::strcmp(value, "cpu") == 0)
+    return ThreadPinning::kCpu;
+  if (std::strcmp(value, "numa") == 0)
+    return ThreadPinning::kNumaNode;
+  return ThreadPinning::kNone;
+}
+
 // -------------------------------------------------------------------------- //
 // AsyncRuntime orchestrates all async operations and Async runtime API is built
 // on top of the default runtime instance.
+//
+// The executor running the tasks is configured with environment variables read
+// when the runtime is created:
+//   SANDBOX_ASYNC_EXECUTOR:    `work_stealing` (default) or `thread_pool`, the
+//                              single queue llvm::ThreadPool of the upstream
+//                              runtime.
+//   SANDBOX_ASYNC_NUM_THREADS: number of worker threads, defaults to the
+//                              number of hardware threads.
+//   SANDBOX_ASYNC_TRACE:       path of the file the trace of the runtime events
+//                              is written to when the runtime is destroyed.
+//   SANDBOX_ASYNC_PIN_THREADS: `cpu` (or 1) pins every worker of the
+//                              work-stealing executor to a CPU, `numa` to the
+//                              CPUs of a NUMA node. Workers are distributed
+//                              over the NUMA nodes in contiguous ranges.
 // -------------------------------------------------------------------------- //
 
 class AsyncRuntime {
 public:
-  AsyncRuntime() : numRefCountedObjects(0) {}
+  AsyncRuntime() : numRefCountedObjects(0) {
+    if (const char *path = std::getenv("SANDBOX_ASYNC_TRACE")) {
+      tracePath = path;
+      Tracer::enable();
+    }
+    unsigned numThreads = getEnvPositiveInteger(
+        "SANDBOX_ASYNC_NUM_THREADS",
+        llvm::hardware_concurrency().compute_thread_count());
+    const char *executor = std::getenv("SANDBOX_ASYNC_EXECUTOR");
+    if (executor && std::strcmp(executor, "thread_pool") == 0) {
+      threadPool = std::make_unique<llvm::ThreadPool>(
+          llvm::hardware_concurrency(numThreads));
+    } else {
+      workStealingExecutor = std::make_unique<WorkStealingExecutor>(
+          numThreads, getEnvThreadPinning("SANDBOX_ASYNC_PIN_THREADS"));
+    }
+  }
 
   ~AsyncRuntime() {
-    threadPool.wait(); // wait for the completion of all async tasks
+    // Wait for the completion of all async tasks.
+    if (threadPool)
+      threadPool->wait();
+    else
+      workStealingExecutor->wait();
     assert(getNumRefCountedObjects() == 0 &&
            "all ref counted objects must be destroyed");
+    // Join the worker threads before dumping the events they recorded.
+    if (!tracePath.empty()) {
+      threadPool.reset();
+      workStealingExecutor.reset();
+      Tracer::dump(tracePath);
+    }
   }
 
   int64_t getNumRefCountedObjects() {
     return numRefCountedObjects.load(std::memory_order_relaxed);
   }
 
-  llvm::ThreadPool &getThreadPool() { return threadPool; }
+  void execute(Task task) {
+    if (threadPool)
+      threadPool->async([task]() { task(); });
+    else
+      workStealingExecutor->execute(task);
+  }
+
+  // Schedules `task` on the worker `index` modulo the number of workers. The
+  // llvm::ThreadPool can not bind tasks to its threads, they are scheduled on
+  // any thread.
+  void executeOnWorker(int64_t index, Task task) {
+    if (threadPool)
+      execute(task);
+    else
+      workStealingExecutor->executeOnWorker(index, task);
+  }
+
+  unsigned getNumWorkers() const {
+    return threadPool ? threadPool->getThreadCount()
+                      : workStealingExecutor->getNumWorkers();
+  }
+
+  // Returns true if the tasks scheduled with `executeOnWorker` run on the
+  // worker they are bound to.
+  bool bindsTasksToWorkers() const { return workStealingExecutor != nullptr; }
+
+  // Returns the index of the worker running on the current thread, or -1.
+  int64_t getCurrentWorkerIndex() const {
+    return workStealingExecutor ? workStealingExecutor->getCurrentWorkerIndex()
+                                : -1;
+  }
+
+  // Returns true if the blocked threads run the scheduled tasks. The
+  // llvm::ThreadPool does not expose its queue, its tasks never run inline.
+  bool runsTasksInline() const { return workStealingExecutor != nullptr; }
+
+  // Blocks the current thread until `isDone` returns true, see
+  // WorkStealingExecutor::blockUntil. Only valid if `runsTasksInline`.
+  void blockUntil(llvm::function_ref<bool()> isDone) {
+    workStealingExecutor->blockUntil(isDone);
+  }
+
+  void notifyBlocked() { workStealingExecutor->notifyBlocked(); }
 
 private:
   friend class RefCounted;
@@ -80,7 +1009,11 @@ private:
   }
 
   std::atomic<int64_t> numRefCountedObjects;
-  llvm::ThreadPool threadPool;
+  // Exactly one of the two executors is set.
+  std::unique_ptr<llvm::ThreadPool> threadPool;
+  std::unique_ptr<WorkStealingExecutor> workStealingExecutor;
+  // Path of the trace file, empty if tracing is disabled.
+  std::string tracePath;
 };
 
 // -------------------------------------------------------------------------- //
@@ -123,11 +1056,420 @@ private:
   StateEnum state;
 };
 
+// -------------------------------------------------------------------------- //
+// Pooled allocation of the async runtime objects. Blocks of a few size classes
+// are recycled through per-thread free lists such that, in steady state, the
+// parallel kernels do not call the system allocator. Objects are often
+// released by another thread than the one that allocated them (e.g. a token
+// created by the caller and dropped by the task emplacing it): thread caches
+// exchange batches of free blocks with a global depot to rebalance them.
+// -------------------------------------------------------------------------- //
+
+class BlockPool {
+public:
+  // Allocates a block of at least `size` bytes.
+  static void *allocate(size_t size) {
+    size_t sizeClass = getSizeClass(size);
+    ThreadCache *cache = getThreadCache();
+    if (sizeClass == kNumSizeClasses || !cache)
+      return allocateFromHeap(getBlockSize(sizeClass, size));
+    FreeBlock *block = cache->pop(sizeClass);
+    if (!block)
+      return allocateFromHeap(getBlockSize(sizeClass, size));
+    cache->numPooledAllocations.store(
+        cache->numPooledAllocations.load(std::memory_order_relaxed) + 1,
+        std::memory_order_relaxed);
+    return block;
+  }
+
+  // Releases a block previously allocated with the same `size`.
+  static void deallocate(void *ptr, size_t size) {
+    size_t sizeClass = getSizeClass(size);
+    ThreadCache *cache = getThreadCache();
+    if (sizeClass == kNumSizeClasses || !cache)
+      return deallocateToHeap(ptr);
+    cache->push(sizeClass, static_cast<FreeBlock *>(ptr));
+  }
+
+  static AsyncRuntimeAllocationCounters getCounters() {
+    Depot &depot = getDepot();
+    AsyncRuntimeAllocationCounters counters;
+    {
+      std::lock_guard<std::mutex> lock(depot.mu);
+      counters.numPooledAllocations = depot.numRetiredPooledAllocations;
+      for (ThreadCache *cache : depot.caches)
+        counters.numPooledAllocations +=
+            cache->numPooledAllocations.load(std::memory_order_relaxed);
+    }
+    counters.numHeapAllocations =
+        depot.numHeapAllocations.load(std::memory_order_relaxed);
+    counters.numHeapDeallocations =
+        depot.numHeapDeallocations.load(std::memory_order_relaxed);
+    return counters;
+  }
+
+private:
+  // Block sizes are 32, 64, 128 and 256 bytes, larger blocks are not pooled.
+  static constexpr size_t kNumSizeClasses = 4;
+  static constexpr size_t kMinBlockSize = 32;
+  // Number of free blocks moved at once between a thread cache and the depot.
+  static constexpr size_t kBatchSize = 64;
+
+  // A free block, the first block of a batch also links the batches together.
+  struct FreeBlock {
+    FreeBlock *next;
+    FreeBlock *nextBatch;
+    size_t batchSize;
+  };
+  static_assert(sizeof(FreeBlock) <= kMinBlockSize, "blocks are too small");
+
+  struct ThreadCache;
+
+  // Global depot of free blocks, it is never destroyed such that threads can
+  // return their free blocks during the static destructions.
+  struct Depot {
+    Depot() : numRetiredPooledAllocations(0) {
+      std::fill(std::begin(batches), std::end(batches), nullptr);
+    }
+
+    std::mutex mu;
+    FreeBlock *batches[kNumSizeClasses];
+    std::vector<ThreadCache *> caches;
+    int64_t numRetiredPooledAllocations;
+
+    std::atomic<int64_t> numHeapAllocations{0};
+    std::atomic<int64_t> numHeapDeallocations{0};
+  };
+
+  struct ThreadCache {
+    ThreadCache() : numPooledAllocations(0) {
+      std::fill(std::begin(heads), std::end(heads), nullptr);
+      std::fill(std::begin(sizes), std::end(sizes), 0);
+      Depot &depot = getDepot();
+      std::lock_guard<std::mutex> lock(depot.mu);
+      depot.caches.push_back(this);
+    }
+
+    ~ThreadCache() {
+      Depot &depot = getDepot();
+      std::lock_guard<std::mutex> lock(depot.mu);
+      for (size_t sizeClass = 0; sizeClass < kNumSizeClasses; ++sizeClass) {
+        if (heads[sizeClass])
+          pushBatch(depot, sizeClass, heads[sizeClass], sizes[sizeClass]);
+      }
+      depot.numRetiredPooledAllocations +=
+          numPooledAllocations.load(std::memory_order_relaxed);
+      depot.caches.erase(llvm::find(depot.caches, this));
+      isThreadCacheDestroyed = true;
+    }
+
+    FreeBlock *pop(size_t sizeClass) {
+      if (!heads[sizeClass] && !refill(sizeClass))
+        return nullptr;
+      FreeBlock *block = heads[sizeClass];
+      heads[sizeClass] = block->next;
+      --sizes[sizeClass];
+      return block;
+    }
+
+    void push(size_t sizeClass, FreeBlock *block) {
+      block->next = heads[sizeClass];
+      heads[sizeClass] = block;
+      if (++sizes[sizeClass] < 2 * kBatchSize)
+        return;
+      // Return the most recently freed blocks, the others are less likely to
+      // be in the caches of this thread.
+      FreeBlock *batch = heads[sizeClass];
+      FreeBlock *last = batch;
+      for (size_t i = 1; i < kBatchSize; ++i)
+        last = last->next;
+      heads[sizeClass] = last->next;
+      last->next = nullptr;
+      sizes[sizeClass] -= kBatchSize;
+      Depot &depot = getDepot();
+      std::lock_guard<std::mutex> lock(depot.mu);
+      pushBatch(depot, sizeClass, batch, kBatchSize);
+    }
+
+    // Takes a batch of free blocks from the depot.
+    bool refill(size_t sizeClass) {
+      Depot &depot = getDepot();
+      std::lock_guard<std::mutex> lock(depot.mu);
+      FreeBlock *batch = depot.batches[sizeClass];
+      if (!batch)
+        return false;
+      depot.batches[sizeClass] = batch->nextBatch;
+      heads[sizeClass] = batch;
+      sizes[sizeClass] = batch->batchSize;
+      return true;
+    }
+
+    static void pushBatch(Depot &depot, size_t sizeClass, FreeBlock *batch,
+                          size_t size) {
+      batch->batchSize = size;
+      batch->nextBatch = depot.batches[sizeClass];
+      depot.batches[sizeClass] = batch;
+    }
+
+    FreeBlock *heads[kNumSizeClasses];
+    size_t sizes[kNumSizeClasses];
+    // Only written by the owner thread, read when collecting the counters.
+    std::atomic<int64_t> numPooledAllocations;
+  };
+
+  static Depot &getDepot() {
+    static Depot *depot = new Depot();
+    return *depot;
+  }
+
+  // Returns the cache of the current thread, or nullptr if the thread is
+  // exiting and its cache was already destroyed.
+  static ThreadCache *getThreadCache() {
+    if (isThreadCacheDestroyed)
+      return nullptr;
+    static thread_local ThreadCache cache;
+    return &cache;
+  }
+
+  static size_t getSizeClass(size_t size) {
+    size_t sizeClass = 0;
+    size_t blockSize = kMinBlockSize;
+    while (sizeClass < kNumSizeClasses && blockSize < size) {
+      ++sizeClass;
+      blockSize *= 2;
+    }
+    return sizeClass;
+  }
+
+  static size_t getBlockSize(size_t sizeClass, size_t size) {
+    return sizeClass == kNumSizeClasses ? size : kMinBlockSize << sizeClass;
+  }
+
+  static void *allocateFromHeap(size_t size) {
+    getDepot().numHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size);
+  }
+
+  static void deallocateToHeap(void *ptr) {
+    getDepot().numHeapDeallocations.fetch_add(1, std::memory_order_relaxed);
+    ::operator delete(ptr);
+  }
+
+  static thread_local bool isThreadCacheDestroyed;
+};
+
+thread_local bool BlockPool::isThreadCacheDestroyed = false;
+
+// Base class of the objects allocated from the block pool.
+struct Pooled {
+  static void *operator new(size_t size) { return BlockPool::allocate(size); }
+  static void operator delete(void *ptr, size_t size) {
+    BlockPool::deallocate(ptr, size);
+  }
+};
+
+// -------------------------------------------------------------------------- //
+// Awaiters of the async runtime values (tokens, values or groups). An awaiter
+// is a node of an intrusive lock-free list, it is run once when the awaited
+// value becomes available. Awaiters are allocated by the awaiting side: on the
+// heap for the coroutines resumed asynchronously, and on the stack for the
+// threads blocked until the value becomes available.
+// -------------------------------------------------------------------------- //
+
+struct Awaiter : public Pooled {
+  explicit Awaiter(void (*run)(Awaiter *)) : next(nullptr), run(run) {}
+
+  Awaiter *next;
+  // Runs the awaiter. The awaiter may be destroyed once `run` returns.
+  void (*run)(Awaiter *);
+};
+
+// Treiber stack of the awaiters of an async runtime value. The list is closed
+// when the value becomes available: all the awaiters pushed so far are run and
+// the following pushes fail, the caller must then proceed without waiting.
+class AwaiterList {
+public:
+  AwaiterList() : head(nullptr) {}
+
+  // Adds `awaiter` to the list. Returns false if the list is already closed.
+  bool push(Awaiter *awaiter) {
+    Awaiter *current = head.load(std::memory_order_acquire);
+    do {
+      if (current == closed())
+        return false;
+      awaiter->next = current;
+    } while (!head.compare_exchange_weak(current, awaiter,
+                                         std::memory_order_release,
+                                         std::memory_order_acquire));
+    return true;
+  }
+
+  bool isClosed() const {
+    return head.load(std::memory_order_acquire) == closed();
+  }
+
+  // Closes the list and runs its awaiters in the order they were pushed.
+  void closeAndRun() {
+    Awaiter *awaiter = head.exchange(closed(), std::memory_order_acq_rel);
+    assert(awaiter != closed() && "awaiter list must not be closed twice");
+    Awaiter *reversed = nullptr;
+    while (awaiter) {
+      Awaiter *next = awaiter->next;
+      awaiter->next = reversed;
+      reversed = awaiter;
+      awaiter = next;
+    }
+    while (reversed) {
+      Awaiter *next = reversed->next;
+      reversed->run(reversed);
+      reversed = next;
+    }
+  }
+
+private:
+  static Awaiter *closed() { return reinterpret_cast<Awaiter *>(uintptr_t(1)); }
+
+  std::atomic<Awaiter *> head;
+};
+
+// Awaiter resuming a coroutine once the awaited value becomes available.
+struct ResumeAwaiter : public Awaiter {
+  explicit ResumeAwaiter(Task task)
+      : Awaiter(&ResumeAwaiter::resume), task(task) {}
+
+  static void resume(Awaiter *awaiter) {
+    auto *self = static_cast<ResumeAwaiter *>(awaiter);
+    Task task = self->task;
+    delete self;
+    task();
+  }
+
+  Task task;
+};
+
+// Awaiter of a thread blocked until the awaited value becomes available. It
+// lives on the stack of the blocked thread, which sleeps on a futex on Linux
+// and on a condition variable otherwise.
+class BlockingAwaiter : public Awaiter {
+public:
+  BlockingAwaiter() : Awaiter(&BlockingAwaiter::wake), ready(0) {}
+
+  void wait() {
+#if defined(__linux__)
+    while (ready.load(std::memory_order_acquire) == 0)
+      syscall(SYS_futex, &ready, FUTEX_WAIT_PRIVATE, 0, nullptr, nullptr, 0);
+#else
+    std::unique_lock<std::mutex> lock(mu);
+    cv.wait(lock, [this] { return ready.load(std::memory_order_acquire); });
+#endif
+  }
+
+private:
+  static void wake(Awaiter *awaiter) {
+    auto *self = static_cast<BlockingAwaiter *>(awaiter);
+#if defined(__linux__)
+    // The awaiter may be destroyed as soon as `ready` is set, in which case the
+    // futex wakes nobody up.
+    self->ready.store(1, std::memory_order_release);
+    syscall(SYS_futex, &self->ready, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr,
+            0);
+#else
+    std::lock_guard<std::mutex> lock(self->mu);
+    self->ready.store(1, std::memory_order_release);
+    self->cv.notify_one();
+#endif
+  }
+
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                "futex word must be a 32-bit integer");
+  std::atomic<uint32_t> ready;
+#if !defined(__linux__)
+  std::mutex mu;
+  std::condition_variable cv;
+#endif
+};
+
+// Awaiter of a thread blocked until the awaited value becomes available, which
+// runs the tasks of the work-stealing executor meanwhile. The thread sleeps
+// with the idle workers, such that it is also woken up by new tasks, e.g. the
+// tasks bound to it that the awaited value depends on.
+class HelpingAwaiter : public Awaiter {
+public:
+  explicit HelpingAwaiter(AsyncRuntime *runtime)
+      : Awaiter(&HelpingAwaiter::wake), runtime(runtime), ready(false) {}
+
+  void wait() {
+    runtime->blockUntil(
+        [this] { return ready.load(std::memory_order_seq_cst); });
+  }
+
+private:
+  static void wake(Awaiter *awaiter) {
+    auto *self = static_cast<HelpingAwaiter *>(awaiter);
+    // The awaiter may be destroyed as soon as `ready` is set.
+    AsyncRuntime *runtime = self->runtime;
+    self->ready.store(true, std::memory_order_release);
+    runtime->notifyBlocked();
+  }
+
+  AsyncRuntime *runtime;
+  std::atomic<bool> ready;
+};
+
+// Blocks the current thread until the `awaiters` list is closed. With the
+// work-stealing executor, the thread executes the pending tasks, and then
+// spins for a short while before going to sleep: short parallel regions
+// complete without paying for a wake up, and the waiting thread contributes to
+// the work it waits for.
+static void blockUntilClosedImpl(AsyncRuntime *runtime,
+                                 AwaiterList &awaiters) {
+  if (runtime->runsTasksInline()) {
+    HelpingAwaiter awaiter(runtime);
+    if (awaiters.push(&awaiter))
+      awaiter.wait();
+    return;
+  }
+
+  // Number of rounds spent checking for the list closure before going to
+  // sleep.
+  constexpr int kNumSpinRounds = 128;
+  for (int round = 0; round < kNumSpinRounds; ++round) {
+    if (awaiters.isClosed())
+      return;
+    std::this_thread::yield();
+  }
+
+  BlockingAwaiter awaiter;
+  if (awaiters.push(&awaiter))
+    awaiter.wait();
+}
+
+static void blockUntilClosed(AsyncRuntime *runtime, AwaiterList &awaiters) {
+  if (LLVM_LIKELY(!Tracer::isEnabled()))
+    return blockUntilClosedImpl(runtime, awaiters);
+  if (awaiters.isClosed())
+    return;
+  Tracer::record(Tracer::EventKind::kAwaitBegin, &awaiters);
+  blockUntilClosedImpl(runtime, awaiters);
+  Tracer::record(Tracer::EventKind::kAwaitEnd, &awaiters);
+}
+
+// Resumes the coroutine once the `awaiters` list is closed.
+static void executeWhenClosed(AwaiterList &awaiters, CoroHandle handle,
+                              CoroResume resume) {
+  Task task{handle, resume};
+  if (awaiters.isClosed())
+    return task();
+  auto *awaiter = new ResumeAwaiter(task);
+  if (!awaiters.push(awaiter))
+    ResumeAwaiter::resume(awaiter);
+}
+
 // -------------------------------------------------------------------------- //
 // A base class for all reference counted objects created by the async runtime.
 // -------------------------------------------------------------------------- //
 
-class RefCounted {
+class RefCounted : public Pooled {
 public:
   RefCounted(AsyncRuntime *runtime, int64_t refCount = 1)
       : runtime(runtime), refCount(refCount) {
@@ -187,10 +1529,8 @@ struct AsyncToken : public RefCounted {
 
   std::atomic<State::StateEnum> state;
 
-  // Pending awaiters are guarded by a mutex.
-  std::mutex mu;
-  std::condition_variable cv;
-  std::vector<std::function<void()>> awaiters;
+  // Lock-free list of pending awaiters.
+  AwaiterList awaiters;
 };
 
 // Async value provides a mechanism to access the result of asynchronous
@@ -200,17 +1540,25 @@ struct AsyncValue : public RefCounted {
   // AsyncValue similar to an AsyncToken created with a reference count of 2.
   AsyncValue(AsyncRuntime *runtime, int64_t size)
       : RefCounted(runtime, /*refCount=*/2), state(State::kUnavailable),
-        storage(size) {}
+        size(size), storage(size <= kInlineStorageSize
+                                ? inlineStorage
+                                : BlockPool::allocate(size)) {}
+
+  ~AsyncValue() override {
+    if (storage != inlineStorage)
+      BlockPool::deallocate(storage, size);
+  }
 
   std::atomic<State::StateEnum> state;
 
-  // Use vector of bytes to store async value payload.
-  std::vector<int8_t> storage;
+  // Small payloads are stored inline, larger ones in a separate block.
+  static constexpr int64_t kInlineStorageSize = 64;
+  int64_t size;
+  void *storage;
+  alignas(16) int8_t inlineStorage[kInlineStorageSize];
 
-  // Pending awaiters are guarded by a mutex.
-  std::mutex mu;
-  std::condition_variable cv;
-  std::vector<std::function<void()>> awaiters;
+  // Lock-free list of pending awaiters.
+  AwaiterList awaiters;
 };
 
 // Async group provides a mechanism to group together multiple async tokens or
@@ -224,10 +1572,8 @@ struct AsyncGroup : public RefCounted {
   std::atomic<int> numErrors;
   std::atomic<int> rank;
 
-  // Pending awaiters are guarded by a mutex.
-  std::mutex mu;
-  std::condition_variable cv;
-  std::vector<std::function<void()>> awaiters;
+  // Lock-free list of pending awaiters.
+  AwaiterList awaiters;
 };
 
 // Adds references to reference counted runtime object.
@@ -260,51 +1606,58 @@ extern "C" AsyncGroup *mlirAsyncRuntimeCreateGroup(int64_t size) {
   return group;
 }
 
-extern "C" int64_t mlirAsyncRuntimeAddTokenToGroup(AsyncToken *token,
-                                                   AsyncGroup *group) {
-  std::unique_lock<std::mutex> lockToken(token->mu);
-  std::unique_lock<std::mutex> lockGroup(group->mu);
+// Updates the group once `token` is available or in error state.
+static void onTokenReady(AsyncToken *token, AsyncGroup *group) {
+  // Increment the number of errors in the group.
+  if (State(token->state).isError())
+    group->numErrors.fetch_add(1);
 
-  // Get the rank of the token inside the group before we drop the reference.
-  int rank = group->rank.fetch_add(1);
+  // If pending tokens go below zero it means that more tokens than the group
+  // size were added to this group.
+  assert(group->pendingTokens > 0 && "wrong group size");
 
-  auto onTokenReady = [group, token]() {
-    // Increment the number of errors in the group.
-    if (State(token->state).isError())
-      group->numErrors.fetch_add(1);
+  // Run all group awaiters if it was the last token in the group.
+  if (group->pendingTokens.fetch_sub(1) == 1)
+    group->awaiters.closeAndRun();
+}
 
-    // If pending tokens go below zero it means that more tokens than the group
-    // size were added to this group.
-    assert(group->pendingTokens > 0 && "wrong group size");
+// Awaiter updating a group once the token added to it becomes available.
+struct GroupAwaiter : public Awaiter {
+  GroupAwaiter(AsyncToken *token, AsyncGroup *group)
+      : Awaiter(&GroupAwaiter::update), token(token), group(group) {}
+
+  static void update(Awaiter *awaiter) {
+    auto *self = static_cast<GroupAwaiter *>(awaiter);
+    AsyncToken *token = self->token;
+    AsyncGroup *group = self->group;
+    delete self;
+    onTokenReady(token, group);
+    group->dropRef();
+  }
 
-    // Run all group awaiters if it was the last token in the group.
-    if (group->pendingTokens.fetch_sub(1) == 1) {
-      group->cv.notify_all();
-      for (auto &awaiter : group->awaiters)
-        awaiter();
-    }
-  };
+  AsyncToken *token;
+  AsyncGroup *group;
+};
 
-  if (State(token->state).isAvailableOrError()) {
+extern "C" int64_t mlirAsyncRuntimeAddTokenToGroup(AsyncToken *token,
+                                                   AsyncGroup *group) {
+  // Get the rank of the token inside the group before we drop the reference.
+  int rank = group->rank.fetch_add(1);
+
+  if (token->awaiters.isClosed()) {
     // Update group pending tokens immediately and maybe run awaiters.
-    onTokenReady();
-
-  } else {
-    // Update group pending tokens when token will become ready. Because this
-    // will happen asynchronously we must ensure that `group` is alive until
-    // then, and re-ackquire the lock.
-    group->addRef();
-
-    token->awaiters.emplace_back([group, onTokenReady]() {
-      // Make sure that `dropRef` does not destroy the mutex owned by the lock.
-      {
-        std::unique_lock<std::mutex> lockGroup(group->mu);
-        onTokenReady();
-      }
-      group->dropRef();
-    });
+    onTokenReady(token, group);
+    return rank;
   }
 
+  // Update group pending tokens when token will become ready. Because this
+  // will happen asynchronously we must ensure that `group` is alive until
+  // then. If the token became ready in the meantime, update the group now.
+  group->addRef();
+  auto *awaiter = new GroupAwaiter(token, group);
+  if (!token->awaiters.push(awaiter))
+    GroupAwaiter::update(awaiter);
+
   return rank;
 }
 
@@ -314,14 +1667,8 @@ static void setTokenState(AsyncToken *token, State state) {
   assert(state.isAvailableOrError() && "must be terminal state");
   assert(State(token->state).isUnavailable() && "token must be unavailable");
 
-  // Make sure that `dropRef` does not destroy the mutex owned by the lock.
-  {
-    std::unique_lock<std::mutex> lock(token->mu);
-    token->state = state;
-    token->cv.notify_all();
-    for (auto &awaiter : token->awaiters)
-      awaiter();
-  }
+  token->state = state;
+  token->awaiters.closeAndRun();
 
   // Async tokens created with a ref count `2` to keep token alive until the
   // async task completes. Drop this reference explicitly when token emplaced.
@@ -332,14 +1679,8 @@ static void setValueState(AsyncValue *value, State state) {
   assert(state.isAvailableOrError() && "must be terminal state");
   assert(State(value->state).isUnavailable() && "value must be unavailable");
 
-  // Make sure that `dropRef` does not destroy the mutex owned by the lock.
-  {
-    std::unique_lock<std::mutex> lock(value->mu);
-    value->state = state;
-    value->cv.notify_all();
-    for (auto &awaiter : value->awaiters)
-      awaiter();
-  }
+  value->state = state;
+  value->awaiters.closeAndRun();
 
   // Async values created with a ref count `2` to keep value alive until the
   // async task completes. Drop this reference explicitly when value emplaced.
@@ -375,73 +1716,208 @@ extern "C" bool mlirAsyncRuntimeIsGroupError(AsyncGroup *group) {
 }
 
 extern "C" void mlirAsyncRuntimeAwaitToken(AsyncToken *token) {
-  std::unique_lock<std::mutex> lock(token->mu);
-  if (!State(token->state).isAvailableOrError())
-    token->cv.wait(
-        lock, [token] { return State(token->state).isAvailableOrError(); });
+  blockUntilClosed(getDefaultAsyncRuntime(), token->awaiters);
 }
 
 extern "C" void mlirAsyncRuntimeAwaitValue(AsyncValue *value) {
-  std::unique_lock<std::mutex> lock(value->mu);
-  if (!State(value->state).isAvailableOrError())
-    value->cv.wait(
-        lock, [value] { return State(value->state).isAvailableOrError(); });
+  blockUntilClosed(getDefaultAsyncRuntime(), value->awaiters);
 }
 
 extern "C" void mlirAsyncRuntimeAwaitAllInGroup(AsyncGroup *group) {
-  std::unique_lock<std::mutex> lock(group->mu);
+  // The awaiters of an empty group are never run.
   if (group->pendingTokens != 0)
-    group->cv.wait(lock, [group] { return group->pendingTokens == 0; });
+    blockUntilClosed(getDefaultAsyncRuntime(), group->awaiters);
 }
 
 // Returns a pointer to the storage owned by the async value.
 extern "C" ValueStorage mlirAsyncRuntimeGetValueStorage(AsyncValue *value) {
   assert(!State(value->state).isError() && "unexpected error state");
-  return value->storage.data();
+  return value->storage;
 }
 
 extern "C" void mlirAsyncRuntimeExecute(CoroHandle handle, CoroResume resume) {
   auto *runtime = getDefaultAsyncRuntime();
-  runtime->getThreadPool().async([handle, resume]() { (*resume)(handle); });
+  if (LLVM_UNLIKELY(Tracer::isEnabled()))
+    Tracer::record(Tracer::EventKind::kSpawn, handle);
+  runtime->execute(Task{handle, resume});
+}
+
+extern "C" void mlirAsyncRuntimeExecuteOnWorker(int64_t workerIndex,
+                                                CoroHandle handle,
+                                                CoroResume resume) {
+  auto *runtime = getDefaultAsyncRuntime();
+  if (LLVM_UNLIKELY(Tracer::isEnabled()))
+    Tracer::record(Tracer::EventKind::kSpawn, handle);
+  runtime->executeOnWorker(workerIndex, Task{handle, resume});
+}
+
+extern "C" int64_t mlirAsyncRuntimeGetNumWorkerThreads() {
+  return getDefaultAsyncRuntime()->getNumWorkers();
+}
+
+namespace {
+// A chunk of the buffer zeroed by `mlirAsyncRuntimeFirstTouch`.
+struct FirstTouchChunk {
+  int8_t *begin;
+  int8_t *end;
+  std::atomic<int64_t> *numPendingChunks;
+  AwaiterList *done;
+};
+} // namespace
+
+static void firstTouchChunk(void *handle) {
+  auto *chunk = static_cast<FirstTouchChunk *>(handle);
+  std::memset(chunk->begin, 0, chunk->end - chunk->begin);
+  if (chunk->numPendingChunks->fetch_sub(1, std::memory_order_acq_rel) == 1)
+    chunk->done->closeAndRun();
+}
+
+extern "C" void mlirAsyncRuntimeFirstTouch(void *data, int64_t sizeInBytes) {
+  AsyncRuntime *runtime = getDefaultAsyncRuntime();
+  int64_t numWorkers = runtime->getNumWorkers();
+#if defined(__linux__)
+  uint64_t pageSize = sysconf(_SC_PAGESIZE);
+#else
+  uint64_t pageSize = 4096;
+#endif
+
+  // Split the buffer in one chunk per worker, with page aligned boundaries.
+  auto begin = reinterpret_cast<uintptr_t>(data);
+  uint64_t chunkSize = llvm::divideCeil(sizeInBytes, numWorkers);
+  auto getBoundary = [&](int64_t index) {
+    if (index == 0)
+      return begin;
+    return std::min<uintptr_t>(llvm::alignTo(begin + index * chunkSize,
+                                             pageSize),
+                               begin + sizeInBytes);
+  };
+
+  std::vector<FirstTouchChunk> chunks(numWorkers);
+  std::atomic<int64_t> numPendingChunks(numWorkers);
+  AwaiterList done;
+  for (int64_t i = 0; i < numWorkers; ++i) {
+    chunks[i] = FirstTouchChunk{reinterpret_cast<int8_t *>(getBoundary(i)),
+                                reinterpret_cast<int8_t *>(getBoundary(i + 1)),
+                                &numPendingChunks, &done};
+    runtime->executeOnWorker(i, Task{&chunks[i], firstTouchChunk});
+  }
+  blockUntilClosed(runtime, done);
+}
+
+namespace {
+// State of a `mlirAsyncRuntimeParallelFor` call shared by its parts.
+struct ParallelFor : public Pooled {
+  ParallelForBody body;
+  void *ctx;
+  int64_t begin;
+  int64_t end;
+  int64_t grain;
+  int64_t numChunks;
+  int64_t numParts;
+  // Parts are run by the worker of the same index if the runtime binds tasks
+  // to workers. Otherwise the tasks and the caller claim the parts, such that
+  // the caller makes progress even if the tasks are queued behind blocked
+  // threads, and the tasks may run after the call returned: the state is
+  // reference counted.
+  bool bound;
+  std::atomic<int64_t> nextPart;
+  std::atomic<int64_t> numPendingParts;
+  std::atomic<int64_t> refCount;
+  AwaiterList done;
+};
+} // namespace
+
+static void dropRef(ParallelFor *state) {
+  if (state->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    delete state;
+}
+
+static void runParallelForPart(ParallelFor *state, int64_t part) {
+  assert(part >= 0 && part < state->numParts && "unexpected part index");
+  // The part `p` runs the chunks [p * numChunks / numParts,
+  // (p + 1) * numChunks / numParts), this balances the parts to within one
+  // chunk.
+  int64_t firstChunk = part * state->numChunks / state->numParts;
+  int64_t lastChunk = (part + 1) * state->numChunks / state->numParts;
+  int64_t begin = state->begin + firstChunk * state->grain;
+  int64_t end = std::min(state->begin + lastChunk * state->grain, state->end);
+  state->body(begin, end, state->ctx);
+  if (state->numPendingParts.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    state->done.closeAndRun();
+}
+
+// Runs the parts that are not claimed yet.
+static void runUnclaimedParallelForParts(ParallelFor *state) {
+  while (true) {
+    int64_t part = state->nextPart.fetch_add(1, std::memory_order_relaxed);
+    if (part >= state->numParts)
+      return;
+    runParallelForPart(state, part);
+  }
+}
+
+static void runParallelForTask(void *handle) {
+  auto *state = static_cast<ParallelFor *>(handle);
+  if (state->bound)
+    runParallelForPart(state,
+                       getDefaultAsyncRuntime()->getCurrentWorkerIndex());
+  else
+    runUnclaimedParallelForParts(state);
+  dropRef(state);
+}
+
+extern "C" void mlirAsyncRuntimeParallelFor(int64_t begin, int64_t end,
+                                            int64_t grain, ParallelForBody body,
+                                            void *ctx) {
+  if (begin >= end)
+    return;
+  AsyncRuntime *runtime = getDefaultAsyncRuntime();
+  grain = std::max<int64_t>(grain, 1);
+  int64_t numChunks = llvm::divideCeil(end - begin, grain);
+  int64_t numParts = std::min<int64_t>(numChunks, runtime->getNumWorkers());
+  if (numParts <= 1)
+    return body(begin, end, ctx);
+
+  auto *state = new ParallelFor();
+  state->body = body;
+  state->ctx = ctx;
+  state->begin = begin;
+  state->end = end;
+  state->grain = grain;
+  state->numChunks = numChunks;
+  state->numParts = numParts;
+  state->bound = runtime->bindsTasksToWorkers();
+  state->nextPart = 0;
+  state->numPendingParts = numParts;
+  // Without binding, the caller runs parts too and one less task is needed.
+  int64_t numTasks = state->bound ? numParts : numParts - 1;
+  state->refCount = numTasks + 1;
+  for (int64_t task = 0; task < numTasks; ++task)
+    runtime->executeOnWorker(task, Task{state, runParallelForTask});
+  if (!state->bound)
+    runUnclaimedParallelForParts(state);
+  blockUntilClosed(runtime, state->done);
+  dropRef(state);
 }
 
 extern "C" void mlirAsyncRuntimeAwaitTokenAndExecute(AsyncToken *token,
                                                      CoroHandle handle,
                                                      CoroResume resume) {
-  auto execute = [handle, resume]() { (*resume)(handle); };
-  std::unique_lock<std::mutex> lock(token->mu);
-  if (State(token->state).isAvailableOrError()) {
-    lock.unlock();
-    execute();
-  } else {
-    token->awaiters.emplace_back([execute]() { execute(); });
-  }
+  executeWhenClosed(token->awaiters, handle, resume);
 }
 
 extern "C" void mlirAsyncRuntimeAwaitValueAndExecute(AsyncValue *value,
                                                      CoroHandle handle,
                                                      CoroResume resume) {
-  auto execute = [handle, resume]() { (*resume)(handle); };
-  std::unique_lock<std::mutex> lock(value->mu);
-  if (State(value->state).isAvailableOrError()) {
-    lock.unlock();
-    execute();
-  } else {
-    value->awaiters.emplace_back([execute]() { execute(); });
-  }
+  executeWhenClosed(value->awaiters, handle, resume);
 }
 
 extern "C" void mlirAsyncRuntimeAwaitAllInGroupAndExecute(AsyncGroup *group,
                                                           CoroHandle handle,
                                                           CoroResume resume) {
-  auto execute = [handle, resume]() { (*resume)(handle); };
-  std::unique_lock<std::mutex> lock(group->mu);
-  if (group->pendingTokens == 0) {
-    lock.unlock();
-    execute();
-  } else {
-    group->awaiters.emplace_back([execute]() { execute(); });
-  }
+  if (group->pendingTokens == 0)
+    return (*resume)(handle);
+  executeWhenClosed(group->awaiters, handle, resume);
 }
 
 //===----------------------------------------------------------------------===//
@@ -453,6 +1929,19 @@ extern "C" void mlirAsyncRuntimePrintCurrentThreadId() {
   std::cout << "Current thread id: " << thisId << std::endl;
 }
 
+extern "C" AsyncRuntimeAllocationCounters
+mlirAsyncRuntimeGetAllocationCounters() {
+  return BlockPool::getCounters();
+}
+
+extern "C" void mlirAsyncRuntimePrintAllocationCounters() {
+  AsyncRuntimeAllocationCounters counters = BlockPool::getCounters();
+  std::cout << "Pooled allocations: " << counters.numPooledAllocations
+            << ", heap allocations: " << counters.numHeapAllocations
+            << ", heap deallocations: " << counters.numHeapDeallocations
+            << std::endl;
+}
+
 //===----------------------------------------------------------------------===//
 // MLIR Runner (JitRunner) dynamic library integration.
 //===----------------------------------------------------------------------===//
@@ -485,6 +1974,14 @@ void __mlir_runner_init(llvm::StringMap<void *> &exportSymbols) {
                &mlir::runtime::mlirAsyncRuntimeDropRef);
   exportSymbol("mlirAsyncRuntimeExecute",
                &mlir::runtime::mlirAsyncRuntimeExecute);
+  exportSymbol("mlirAsyncRuntimeExecuteOnWorker",
+               &mlir::runtime::mlirAsyncRuntimeExecuteOnWorker);
+  exportSymbol("mlirAsyncRuntimeGetNumWorkerThreads",
+               &mlir::runtime::mlirAsyncRuntimeGetNumWorkerThreads);
+  exportSymbol("mlirAsyncRuntimeFirstTouch",
+               &mlir::runtime::mlirAsyncRuntimeFirstTouch);
+  exportSymbol("mlirAsyncRuntimeParallelFor",
+               &mlir::runtime::mlirAsyncRuntimeParallelFor);
   exportSymbol("mlirAsyncRuntimeGetValueStorage",
                &mlir::runtime::mlirAsyncRuntimeGetValueStorage);
   exportSymbol("mlirAsyncRuntimeCreateToken",
@@ -523,6 +2020,8 @@ void __mlir_runner_init(llvm::StringMap<void *> &exportSymbols) {
                &mlir::runtime::mlirAsyncRuntimeAwaitAllInGroupAndExecute);
   exportSymbol("mlirAsyncRuntimePrintCurrentThreadId",
                &mlir::runtime::mlirAsyncRuntimePrintCurrentThreadId);
+  exportSymbol("mlirAsyncRuntimePrintAllocationCounters",
+               &mlir::runtime::mlirAsyncRuntimePrintAllocationCounters);
 }
 
 // NOLINTNEXTLINE(*-identifier-naming): externally called.
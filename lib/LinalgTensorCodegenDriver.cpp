@@ -86,6 +86,13 @@ struct LinalgFuseOutputIntoReductionPass
   void runOnOperation() override;
 };
 
+struct LinalgSplitReductionPass
+    : public LinalgSplitReductionBase<LinalgSplitReductionPass> {
+  LinalgSplitReductionPass() = default;
+  LinalgSplitReductionPass(const LinalgSplitReductionPass &pass) {}
+  void runOnOperation() override;
+};
+
 struct LinalgSingleTilingExpertPass
     : public LinalgSingleTilingExpertBase<LinalgSingleTilingExpertPass> {
   LinalgSingleTilingExpertPass() = default;
@@ -261,6 +268,20 @@ void LinalgFuseOutputIntoReductionPass::runOnOperation() {
   (void)mlir::applyPatternsAndFoldGreedily(funcOp, std::move(patterns));
 }
 
+void LinalgSplitReductionPass::runOnOperation() {
+  FuncOp funcOp = getOperation();
+  if (funcOp.getName() != anchorFuncOpName || splitRatio <= 1)
+    return;
+
+  SmallVector<GenericOp> genericOps;
+  funcOp.walk([&](GenericOp op) { genericOps.push_back(op); });
+  IRRewriter rewriter(funcOp.getContext());
+  for (GenericOp op : genericOps) {
+    rewriter.setInsertionPoint(op);
+    (void)splitReduction(rewriter, op, splitRatio, innerParallel);
+  }
+}
+
 void LinalgSingleTilingExpertPass::runOnOperation() {
   FuncOp funcOp = getOperation();
 
@@ -306,18 +327,44 @@ void LinalgSingleTilingExpertPass::runOnOperation() {
       SmallVector<int64_t>{hoistPaddings.begin(), hoistPaddings.end()});
   paddingOptions.setTransposePaddings(transposePaddingVectors);
 
+  // Vectorizing with masking pads the tiles of the anchor op with zeros to
+  // their static bounding box, without packing nor hoisting. The padding then
+  // folds into out-of-bounds transfers masked by the remaining iteration count.
+  bool padToMask = false;
+  if (vectorize && vectorizeWithMasking) {
+    LinalgOp anchorOp;
+    funcOp.walk([&](LinalgOp op) {
+      if (op->getName().getStringRef() != anchorOpName)
+        return WalkResult::advance();
+      anchorOp = op;
+      return WalkResult::interrupt();
+    });
+    SmallVector<Attribute> zeros;
+    if (anchorOp) {
+      OpBuilder b(&getContext());
+      for (Type type : anchorOp->getOperandTypes())
+        zeros.push_back(b.getZeroAttr(getElementTypeOrSelf(type)));
+    }
+    if (!zeros.empty() && llvm::all_of(zeros, [](Attribute a) { return a; })) {
+      padToMask = true;
+      paddingOptions = LinalgPaddingOptions()
+                           .setPaddingValues(zeros)
+                           .setPaddingDimensions(getZeroPaddableDims(anchorOp));
+    }
+  }
+
   auto vectorizeFilter = [&](mlir::Operation *op) {
     return success(!vectorizeOnlyTiled || op->getParentOfType<scf::ForOp>());
   };
   CodegenStrategy strategy;
   StringRef genericOpName = GenericOp::getOperationName();
   strategy.tileIf(doTiling, anchorOpName, tilingOptions)
-      .padIf(pad, anchorOpName, paddingOptions)
+      .padIf(pad || padToMask, anchorOpName, paddingOptions)
       .decomposeIf(decomposeToLowerDimOp)
       .generalizeIf(generalize, anchorOpName)
       .interchangeIf(!iteratorInterchange.empty(), iteratorInterchange)
       .vectorizeIf(vectorize, generalize ? genericOpName : anchorOpName,
-                   vectorizeFilter, vectorizePadding);
+                   vectorizeFilter, vectorizePadding || padToMask);
 
   // Created a nested OpPassManager and run.
   OpPassManager dynamicPM(FuncOp::getOperationName());
@@ -587,6 +634,11 @@ mlir::createLinalgFuseOutputIntoReductionPass() {
   return std::make_unique<LinalgFuseOutputIntoReductionPass>();
 }
 
+std::unique_ptr<OperationPass<FuncOp>>
+mlir::createLinalgSplitReductionPass() {
+  return std::make_unique<LinalgSplitReductionPass>();
+}
+
 std::unique_ptr<OperationPass<FuncOp>>
 mlir::createLinalgSingleTilingExpertPass() {
   return std::make_unique<LinalgSingleTilingExpertPass>();
@@ -14,41 +14,82 @@
 #include "mlir/Dialect/SCF/SCF.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/Dominance.h"
 
 namespace mlir {
 namespace linalg {
+
+mlir::FailureOr<Operation *> DetectCombiner(LinalgOp linalg_op) {
+  mlir::SmallVector<Operation *, 4> combiners;
+  if (!matchReduction(linalg_op.getRegionOutputArgs(), 0, combiners) ||
+      combiners.size() != 1)
+    return mlir::failure();
+  return combiners.front();
+}
+
 namespace {
 
 using llvm::makeArrayRef;
 using mlir::tensor::ExtractSliceOp;
 using mlir::tensor::InsertSliceOp;
 
-SmallVector<OpFoldResult> GetParallelDimStep(scf::LoopNest nest,
-                                             GenericOp tiled_op) {
-  assert(nest.loops.size() == 2 && "Expected a 2D loop");
-  assert(tiled_op.getNumLoops() && "Expected a 2D tiled op");
-  SmallVector<unsigned> parallelDims;
-  tiled_op.getParallelDims(parallelDims);
-  assert(parallelDims.size() == 1 && "Should be only 1 parallel loop");
-  Value step = parallelDims.front() == 1 ? nest.loops.back().getStep()
-                                         : nest.loops.front().getStep();
-  if (auto constant = step.getDefiningOp<mlir::arith::ConstantOp>()) {
-    return {constant.getValue()};
+// Returns the perfect nest of `scf.for` loops around `op`, from the outermost
+// loop, whose init argument is produced by a `linalg.fill`, to the immediate
+// parent of `op`. Every loop must carry exactly one iter argument and every
+// loop but the innermost must only contain the next loop.
+mlir::FailureOr<scf::LoopNest> GetTiledReductionLoopNest(Operation *op) {
+  scf::LoopNest nest;
+  auto loop = dyn_cast<scf::ForOp>(op->getParentOp());
+  while (loop) {
+    if (loop.getNumIterOperands() != 1)
+      return mlir::failure();
+    if (!nest.loops.empty() &&
+        !llvm::hasSingleElement(loop.getBody()->without_terminator()))
+      return mlir::failure();
+    nest.loops.insert(nest.loops.begin(), loop);
+    if (loop.getIterOperands().front().getDefiningOp<FillOp>())
+      return nest;
+    loop = dyn_cast<scf::ForOp>(loop->getParentOp());
   }
-  return {step};
+  return mlir::failure();
 }
 
-mlir::FailureOr<Operation *> DetectCombiner(LinalgOp linalg_op) {
-  mlir::SmallVector<Operation *, 4> combiners;
-  if (!matchReduction(linalg_op.getRegionOutputArgs(), 0, combiners) ||
-      combiners.size() != 1)
-    return mlir::failure();
-  return combiners.front();
+// Returns the sizes of the accumulator of the partial results, i.e. an upper
+// bound of the sizes of the output tile that is defined above the loop nest.
+// The size of a dimension is either static, defined above the nest or the step
+// of the loop whose induction variable is the offset of the output tile.
+mlir::FailureOr<SmallVector<OpFoldResult>>
+GetOutputTileUpperBounds(scf::LoopNest nest, ExtractSliceOp extract_slice) {
+  Region &nest_region = nest.loops.front().getLoopBody();
+  SmallVector<OpFoldResult> bounds;
+  for (auto it : llvm::zip(extract_slice.getMixedOffsets(),
+                           extract_slice.getMixedSizes())) {
+    OpFoldResult size = std::get<1>(it);
+    auto size_value = size.dyn_cast<Value>();
+    if (!size_value || !nest_region.isAncestor(size_value.getParentRegion())) {
+      bounds.push_back(size);
+      continue;
+    }
+    auto offset_value = std::get<0>(it).dyn_cast<Value>();
+    auto loop = llvm::find_if(nest.loops, [&](scf::ForOp loop) {
+      return loop.getInductionVar() == offset_value;
+    });
+    if (!offset_value || loop == nest.loops.end())
+      return mlir::failure();
+    Value step = loop->getStep();
+    if (auto constant = step.getDefiningOp<mlir::arith::ConstantOp>())
+      bounds.push_back(constant.getValue());
+    else
+      bounds.push_back(step);
+  }
+  return bounds;
 }
 
-// Fuses `linalg.fill` into a loop with a tiled reduction.
-// Currently, only 2D case is supported. Fusion into a tiled 1D reduction is
-// also possible.
+// Fuses `linalg.fill` into a loop nest with a tiled reduction of any rank: the
+// reduced tiles are accumulated in a tile-sized tensor initialized by the fill
+// instead of the output tensor, and then combined with the output tile. The
+// output is either a slice of the loop iter argument, or the iter argument
+// itself, e.g. the 0-D result of a 1-D reduction.
 struct FuseFillIntoTiledReductionPattern : public OpRewritePattern<GenericOp> {
   explicit FuseFillIntoTiledReductionPattern(MLIRContext *context,
                                              mlir::PatternBenefit benefit = 1)
@@ -58,26 +99,20 @@ struct FuseFillIntoTiledReductionPattern : public OpRewritePattern<GenericOp> {
                                 PatternRewriter &rewriter) const override {
     if (linalg_op.getNumOutputs() != 1)
       return failure();
-    if (linalg_op.getNumLoops() != 2)
+    if (linalg_op.getNumReductionLoops() == 0)
       return failure();
 
-    // Get immediate parent.
-    auto inner_loop =
-        dyn_cast<scf::ForOp>(linalg_op->getParentRegion()->getParentOp());
-    if (!inner_loop)
-      return failure();
-    auto outer_loop =
-        dyn_cast<scf::ForOp>(inner_loop->getParentRegion()->getParentOp());
-    if (!outer_loop)
+    auto nest_or = GetTiledReductionLoopNest(linalg_op);
+    if (failed(nest_or))
       return failure();
-    scf::LoopNest nest{{outer_loop, inner_loop}};
 
-    return RewriteTiledReduction(rewriter, nest, linalg_op);
+    return RewriteTiledReduction(rewriter, *nest_or, linalg_op);
   }
 
 private:
   // Add a new output argument to the `scf.for` nest. It will be produced by
-  // `init_tensor` op with the same shape of the tiled output argument.
+  // `init_tensor` op with the shape of the tiled output argument, or an upper
+  // bound of it.
   //
   // Rewrite
   //
@@ -91,31 +126,27 @@ private:
   //** %init_tile = linalg.init_tensor [%stride]
   //   %fill = linalg.fill(%cst, %init)
   //** scf.for iter_args(%fill, %init_tile)
-  BlockArgument CloneAndAppendInitTensorToTiledLoop(PatternRewriter &rewriter,
-                                                    FillOp fill,
-                                                    scf::LoopNest nest,
-                                                    GenericOp tiled_op) const {
+  BlockArgument CloneAndAppendInitTensorToTiledLoop(
+      PatternRewriter &rewriter, FillOp fill, scf::LoopNest nest,
+      ArrayRef<OpFoldResult> tile_sizes) const {
     OpBuilder::InsertionGuard guard(rewriter);
     rewriter.setInsertionPoint(fill);
 
     auto fillType = fill.output().getType();
 
     auto loc = fill.getLoc();
-    auto inner = nest.loops.back();
-    auto outer = nest.loops.front();
     Value init_clone = rewriter.create<InitTensorOp>(
-        fill.getLoc(), GetParallelDimStep(nest, tiled_op),
+        fill.getLoc(), tile_sizes,
         fillType.cast<mlir::RankedTensorType>().getElementType());
-    rewriter.updateRootInPlace(outer, [&]() {
-      outer.getInitArgsMutable().append(init_clone);
-      outer.getBody()->addArgument(init_clone.getType(), loc);
-    });
-    rewriter.updateRootInPlace(outer, [&]() {
-      auto bbArg = outer.getBody()->getArguments().back();
-      inner.getInitArgsMutable().append(bbArg);
-      inner.getBody()->addArgument(bbArg.getType(), loc);
-    });
-    return inner.getBody()->getArguments().back();
+    Value iter_arg = init_clone;
+    for (scf::ForOp loop : nest.loops) {
+      rewriter.updateRootInPlace(loop, [&]() {
+        loop.getInitArgsMutable().append(iter_arg);
+        loop.getBody()->addArgument(iter_arg.getType(), loc);
+      });
+      iter_arg = loop.getBody()->getArguments().back();
+    }
+    return nest.loops.back().getBody()->getArguments().back();
   }
 
   // Fuse `fill` operation into the `scf.for`, rewire the `linalg.generic` to
@@ -150,20 +181,28 @@ private:
   //   %insert_output_slice = tensor.insert_slice %reduce into %fill
   //   linalg.yield %insert_output_slice, %update_output_tile
   // }
+  //
+  // Without `extract_output_slice`, the whole `%init_tile` is filled and
+  // yielded.
   void FuseFill(PatternRewriter &rewriter, LinalgOp tiled_op, FillOp fill,
-                BlockArgument loop_output_bb_arg,
                 BlockArgument output_tile_bb_arg,
-                ExtractSliceOp extract_output_slice,
-                InsertSliceOp insert_output_slice) const {
+                ExtractSliceOp extract_output_slice) const {
     Location loc = tiled_op.getLoc();
 
     OpBuilder::InsertionGuard g(rewriter);
     rewriter.setInsertionPoint(tiled_op);
 
-    SmallVector<OpFoldResult> offset{rewriter.getIndexAttr(0)};
-    Value slice_of_output_tile = rewriter.create<ExtractSliceOp>(
-        loc, output_tile_bb_arg, offset, extract_output_slice.getMixedSizes(),
-        extract_output_slice.getMixedStrides());
+    SmallVector<OpFoldResult> offset(output_tile_bb_arg.getType()
+                                         .cast<mlir::RankedTensorType>()
+                                         .getRank(),
+                                     rewriter.getIndexAttr(0));
+    Value slice_of_output_tile = output_tile_bb_arg;
+    if (extract_output_slice) {
+      slice_of_output_tile = rewriter.create<ExtractSliceOp>(
+          loc, output_tile_bb_arg, offset,
+          extract_output_slice.getMixedSizes(),
+          extract_output_slice.getMixedStrides());
+    }
 
     auto fused_fill = rewriter.create<FillOp>(loc, ValueRange{fill.value()},
                                               ValueRange{slice_of_output_tile});
@@ -172,10 +211,13 @@ private:
     });
 
     rewriter.setInsertionPointAfter(tiled_op);
-    Value cloned_insert = rewriter.create<mlir::tensor::InsertSliceOp>(
-        loc, fused_fill.getResult(0), output_tile_bb_arg, offset,
-        extract_output_slice.getMixedSizes(),
-        extract_output_slice.getMixedStrides());
+    Value cloned_insert = fused_fill.getResult(0);
+    if (extract_output_slice) {
+      cloned_insert = rewriter.create<mlir::tensor::InsertSliceOp>(
+          loc, fused_fill.getResult(0), output_tile_bb_arg, offset,
+          extract_output_slice.getMixedSizes(),
+          extract_output_slice.getMixedStrides());
+    }
 
     auto yield = tiled_op.getOperation()->getBlock()->getTerminator();
     rewriter.updateRootInPlace(
@@ -219,26 +261,23 @@ private:
   //
   //   linalg.yield %insert_output_slice, %update_output_tile
   // }
-  LogicalResult
-  CombineReducedTileWithOutput(PatternRewriter &rewriter, GenericOp tiled_op,
-                               Value partial_result,
-                               ExtractSliceOp extract_output_slice,
-                               InsertSliceOp insert_output_slice) const {
+  //
+  // Without the slices, `%combine` combines `%reduce` with the loop iter
+  // argument and is yielded directly.
+  void CombineReducedTileWithOutput(PatternRewriter &rewriter,
+                                    GenericOp tiled_op, Operation *combiner,
+                                    Value partial_result, Value output_tile,
+                                    OpOperand &output_update) const {
     rewriter.setInsertionPointAfter(tiled_op);
-    auto num_parallel_loops = tiled_op.getNumParallelLoops();
+    auto rank =
+        partial_result.getType().cast<mlir::RankedTensorType>().getRank();
     SmallVector<mlir::StringRef, 3> parallel_iter_types(
-        num_parallel_loops, mlir::getParallelIteratorTypeName());
-    auto id_map = rewriter.getMultiDimIdentityMap(num_parallel_loops);
-
-    auto combiner_or = DetectCombiner(tiled_op);
-    if (failed(combiner_or))
-      return failure();
-    Operation *combiner = combiner_or.getValue();
+        rank, mlir::getParallelIteratorTypeName());
+    auto id_map = rewriter.getMultiDimIdentityMap(rank);
 
     auto accumulator = rewriter.create<GenericOp>(
         tiled_op.getLoc(), partial_result.getType(),
-        makeArrayRef(partial_result),
-        makeArrayRef(extract_output_slice.result()),
+        makeArrayRef(partial_result), makeArrayRef(output_tile),
         makeArrayRef({id_map, id_map}), parallel_iter_types,
         [&](OpBuilder &b, Location nested_loc, ValueRange args) {
           BlockAndValueMapping bvm;
@@ -247,10 +286,9 @@ private:
           b.create<YieldOp>(nested_loc, result_val);
         });
 
-    rewriter.updateRootInPlace(insert_output_slice, [&]() {
-      insert_output_slice.sourceMutable().assign(accumulator.getResult(0));
+    rewriter.updateRootInPlace(output_update.getOwner(), [&]() {
+      output_update.set(accumulator.getResult(0));
     });
-    return success();
   }
 
   // Unfortunaly, there is no way to modify the results of the loop inplace. So
@@ -261,9 +299,12 @@ private:
     scf::ForOp outer = nest.loops.front();
     auto loc = outer.getLoc();
     rewriter.setInsertionPoint(outer);
-    SmallVector<Value, 2> lbs{outer.getLowerBound(), inner.getLowerBound()};
-    SmallVector<Value, 2> ubs{outer.getUpperBound(), inner.getUpperBound()};
-    SmallVector<Value, 2> steps{outer.getStep(), inner.getStep()};
+    SmallVector<Value, 4> lbs, ubs, steps;
+    for (scf::ForOp loop : nest.loops) {
+      lbs.push_back(loop.getLowerBound());
+      ubs.push_back(loop.getUpperBound());
+      steps.push_back(loop.getStep());
+    }
     SmallVector<Value, 2> iters{outer.getInitArgs().front(),
                                 outer.getInitArgs().back()};
     auto new_nest = scf::buildLoopNest(
@@ -271,8 +312,8 @@ private:
         [&](mlir::OpBuilder &b, mlir::Location location, ValueRange ivs,
             ValueRange iter_args) -> scf::ValueVector {
           BlockAndValueMapping bvm;
-          bvm.map(outer.getInductionVar(), ivs[0]);
-          bvm.map(inner.getInductionVar(), ivs[1]);
+          for (auto it : llvm::zip(nest.loops, ivs))
+            bvm.map(std::get<0>(it).getInductionVar(), std::get<1>(it));
           bvm.map(inner.getRegionIterArgs(), iter_args);
           for (auto &op : inner.getBody()->without_terminator())
             b.clone(op, bvm);
@@ -297,7 +338,7 @@ private:
     // Find scf.for output operand and the corresponding block argument.
     mlir::OpOperand &loop_output_operand =
         nest.loops.front().getIterOpOperands().front();
-    BlockArgument &loop_output_bb_arg =
+    BlockArgument loop_output_bb_arg =
         nest.loops.back().getRegionIterArgs().back();
 
     // Find `linalg.fill` producer of the output.
@@ -305,29 +346,68 @@ private:
     if (!fill)
       return failure();
 
-    // Find extract_slice/insert_slice pair used to RMW output.
-    auto extract_output_slice =
-        tiled_op.getOutputOperand(0)->get().getDefiningOp<ExtractSliceOp>();
-    if (!extract_output_slice)
+    // The output of the tiled op must not be transposed or broadcast.
+    if (!tiled_op.getTiedIndexingMap(tiled_op.getOutputOperand(0))
+             .isProjectedPermutation())
+      return failure();
+    auto combiner_or = DetectCombiner(tiled_op);
+    if (failed(combiner_or))
       return failure();
 
+    // Find extract_slice/insert_slice pair used to RMW output, or use the
+    // loop iter argument directly, e.g. for a 1-D reduction.
     Value tiled_op_result = tiled_op->getResult(0);
-    auto insert_output_slice =
-        dyn_cast<InsertSliceOp>(*tiled_op_result.getUsers().begin());
-    if (!insert_output_slice)
+    if (!tiled_op_result.hasOneUse())
+      return failure();
+    OpOperand &output_update = *tiled_op_result.getUses().begin();
+    Operation *yield = nest.loops.back().getBody()->getTerminator();
+    Value output = tiled_op.getOutputOperand(0)->get();
+    auto extract_output_slice = output.getDefiningOp<ExtractSliceOp>();
+    SmallVector<OpFoldResult> tile_sizes;
+    if (extract_output_slice) {
+      auto insert_output_slice =
+          dyn_cast<InsertSliceOp>(output_update.getOwner());
+      if (!insert_output_slice ||
+          extract_output_slice.getSourceType().getRank() !=
+              extract_output_slice.getType().getRank() ||
+          extract_output_slice.source() != loop_output_bb_arg ||
+          insert_output_slice.dest() != loop_output_bb_arg ||
+          !insert_output_slice.result().hasOneUse() ||
+          *insert_output_slice.result().getUsers().begin() != yield)
+        return failure();
+      auto tile_sizes_or =
+          GetOutputTileUpperBounds(nest, extract_output_slice);
+      if (failed(tile_sizes_or))
+        return failure();
+      tile_sizes = *tile_sizes_or;
+    } else {
+      auto output_type = output.getType().cast<mlir::RankedTensorType>();
+      if (output != loop_output_bb_arg || output_update.getOwner() != yield ||
+          !output_type.hasStaticShape())
+        return failure();
+      for (int64_t size : output_type.getShape())
+        tile_sizes.push_back(rewriter.getIndexAttr(size));
+    }
+    // The dynamic tile sizes must be available at the fill.
+    DominanceInfo dominance_info(fill->getParentOp());
+    if (llvm::any_of(tile_sizes, [&](OpFoldResult size) {
+          auto value = size.dyn_cast<Value>();
+          return value && !dominance_info.properlyDominates(value, fill);
+        }))
       return failure();
 
     // Fuse the output.
     BlockArgument output_tile_bb_arg =
-        CloneAndAppendInitTensorToTiledLoop(rewriter, fill, nest, tiled_op);
-    FuseFill(rewriter, tiled_op, fill, loop_output_bb_arg, output_tile_bb_arg,
-             extract_output_slice, insert_output_slice);
+        CloneAndAppendInitTensorToTiledLoop(rewriter, fill, nest, tile_sizes);
+    FuseFill(rewriter, tiled_op, fill, output_tile_bb_arg,
+             extract_output_slice);
     // We have already modified the loop above, so we need to update the
     // results.
-    if (failed(CombineReducedTileWithOutput(rewriter, tiled_op, tiled_op_result,
-                                            extract_output_slice,
-                                            insert_output_slice)))
-      return failure();
+    Value output_tile = extract_output_slice
+                            ? extract_output_slice.result()
+                            : Value(loop_output_bb_arg);
+    CombineReducedTileWithOutput(rewriter, tiled_op, *combiner_or,
+                                 tiled_op_result, output_tile, output_update);
     CreateLoopWithUpdatedResults(rewriter, nest);
     return success();
   }
@@ -0,0 +1,84 @@
+//===- PartialTiles.cpp ---------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "Passes/Transforms.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/IR/BuiltinTypes.h"
+
+namespace mlir {
+namespace linalg {
+namespace {
+
+// The costs are relative to the cost of computing one element of a full tile.
+
+// Cost of copying one element into a padded tile. Every tile is padded, not
+// only the partial one, unless the padding is hoisted out of the loop.
+constexpr double kPadCopyCost = 0.125;
+
+// Cost of computing one element of a peeled partial tile. The peeled tile has
+// static but arbitrary sizes that vectorize into partial vectors.
+constexpr double kPeelElementCost = 2.0;
+
+// Fixed cost of peeling, accounting for the duplicated loop body.
+constexpr double kPeelFixedCost = 8.0;
+
+// Cost of masking one element of a tile. The masked transfers do not copy, but
+// the masks are computed and applied to every tile since the tile sizes are
+// not static.
+constexpr double kMaskElementCost = 0.03125;
+
+} // namespace
+
+PartialTileStrategy choosePartialTileStrategy(int64_t size, int64_t tileSize,
+                                              bool canPad, bool canMask) {
+  if (tileSize <= 0)
+    return PartialTileStrategy::None;
+  // Masking pads with zeros as well.
+  canMask &= canPad;
+
+  // Peeling a dynamic dimension leaves a dynamically-sized partial tile that
+  // does not vectorize, padding and masking keep all the vectors static.
+  if (ShapedType::isDynamic(size)) {
+    if (canMask)
+      return PartialTileStrategy::Mask;
+    return canPad ? PartialTileStrategy::Pad : PartialTileStrategy::Peel;
+  }
+
+  // A loop with a single iteration or without partial tile is left as is.
+  int64_t remainder = size % tileSize;
+  if (size <= tileSize || remainder == 0)
+    return PartialTileStrategy::None;
+  if (!canPad)
+    return PartialTileStrategy::Peel;
+
+  int64_t num_tiles = size / tileSize + 1;
+  double pad_cost =
+      (tileSize - remainder) + kPadCopyCost * num_tiles * tileSize;
+  double peel_cost = kPeelFixedCost + (kPeelElementCost - 1.0) * remainder;
+  if (canMask) {
+    double mask_cost =
+        (tileSize - remainder) + kMaskElementCost * num_tiles * tileSize;
+    if (mask_cost < pad_cost && mask_cost < peel_cost)
+      return PartialTileStrategy::Mask;
+  }
+  return pad_cost < peel_cost ? PartialTileStrategy::Pad
+                              : PartialTileStrategy::Peel;
+}
+
+SmallVector<int64_t> getZeroPaddableDims(LinalgOp linalgOp) {
+  bool is_contraction = isaContractionOpInterface(linalgOp);
+  SmallVector<int64_t> dims;
+  for (auto it : llvm::enumerate(linalgOp.iterator_types())) {
+    if (is_contraction || isParallelIterator(it.value()))
+      dims.push_back(it.index());
+  }
+  return dims;
+}
+
+} // namespace linalg
+} // namespace mlir
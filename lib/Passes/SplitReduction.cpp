@@ -0,0 +1,224 @@
+//===- SplitReduction.cpp -------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "Passes/Transforms.h"
+#include "mlir/Dialect/Arithmetic/IR/Arithmetic.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/AffineMap.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/PatternMatch.h"
+
+namespace mlir {
+namespace linalg {
+namespace {
+
+// Returns the neutral element of `combiner`, i.e. the value the partial
+// results are initialized with, or a null attribute if it is unknown.
+Attribute GetNeutralElement(Builder &b, Operation *combiner) {
+  Type type = combiner->getResult(0).getType();
+  if (auto float_type = type.dyn_cast<FloatType>()) {
+    const llvm::fltSemantics &semantics = float_type.getFloatSemantics();
+    if (isa<arith::AddFOp>(combiner))
+      return b.getFloatAttr(type, llvm::APFloat::getZero(semantics));
+    if (isa<arith::MulFOp>(combiner))
+      return b.getFloatAttr(type, llvm::APFloat(semantics, 1));
+    if (isa<arith::MaxFOp>(combiner))
+      return b.getFloatAttr(
+          type, llvm::APFloat::getInf(semantics, /*Negative=*/true));
+    if (isa<arith::MinFOp>(combiner))
+      return b.getFloatAttr(
+          type, llvm::APFloat::getInf(semantics, /*Negative=*/false));
+    return {};
+  }
+  auto int_type = type.dyn_cast<IntegerType>();
+  if (!int_type)
+    return {};
+  unsigned width = int_type.getWidth();
+  if (isa<arith::AddIOp, arith::OrIOp, arith::XOrIOp, arith::MaxUIOp>(
+          combiner))
+    return b.getIntegerAttr(type, llvm::APInt::getZero(width));
+  if (isa<arith::MulIOp>(combiner))
+    return b.getIntegerAttr(type, llvm::APInt(width, 1));
+  if (isa<arith::AndIOp, arith::MinUIOp>(combiner))
+    return b.getIntegerAttr(type, llvm::APInt::getAllOnes(width));
+  if (isa<arith::MaxSIOp>(combiner))
+    return b.getIntegerAttr(type, llvm::APInt::getSignedMinValue(width));
+  if (isa<arith::MinSIOp>(combiner))
+    return b.getIntegerAttr(type, llvm::APInt::getSignedMaxValue(width));
+  return {};
+}
+
+} // namespace
+
+FailureOr<GenericOp> splitReduction(RewriterBase &rewriter, GenericOp op,
+                                    int64_t ratio, bool innerParallel) {
+  if (!op.hasTensorSemantics() || op.getNumOutputs() != 1)
+    return rewriter.notifyMatchFailure(op, "expected a single tensor output");
+  if (op.getNumReductionLoops() != 1)
+    return rewriter.notifyMatchFailure(op, "expected one reduction dimension");
+  if (op.hasIndexSemantics())
+    return rewriter.notifyMatchFailure(op, "expected no linalg.index ops");
+
+  SmallVector<unsigned> reduction_dims;
+  op.getReductionDims(reduction_dims);
+  unsigned split_dim = reduction_dims.front();
+  int64_t size = op.getStaticLoopRanges()[split_dim];
+  if (ShapedType::isDynamic(size) || ratio <= 1 || ratio >= size ||
+      size % ratio != 0) {
+    return rewriter.notifyMatchFailure(
+        op, "expected a static reduction size that is a multiple of the ratio");
+  }
+
+  auto combiner_or = DetectCombiner(op);
+  if (failed(combiner_or))
+    return rewriter.notifyMatchFailure(op, "expected a single combiner");
+  Operation *combiner = *combiner_or;
+  BlockArgument output_arg = op.getRegionOutputArgs().front();
+  if (combiner->getNumOperands() != 2 ||
+      llvm::count(combiner->getOperands(), output_arg) != 1)
+    return rewriter.notifyMatchFailure(op, "expected a binary combiner");
+  Attribute neutral = GetNeutralElement(rewriter, combiner);
+  if (!neutral)
+    return rewriter.notifyMatchFailure(op, "unknown neutral element");
+
+  // The split dimension is replaced by two consecutive loops: the loop
+  // `split_dim` iterates over the outer part of the index, the loop
+  // `split_dim + 1` over its inner part. One of them is the new parallel loop.
+  MLIRContext *ctx = op.getContext();
+  unsigned num_loops = op.getNumLoops() + 1;
+  unsigned parallel_dim = innerParallel ? split_dim + 1 : split_dim;
+  int64_t outer_size = innerParallel ? size / ratio : ratio;
+  int64_t inner_size = innerParallel ? ratio : size / ratio;
+  auto remap_dim = [&](unsigned dim) {
+    return getAffineDimExpr(dim <= split_dim ? dim : dim + 1, ctx);
+  };
+
+  // Compute the indexing maps of the split op and the types and reassociations
+  // of the expanded inputs before modifying the IR.
+  SmallVector<AffineMap> indexing_maps;
+  SmallVector<Type> expanded_types;
+  SmallVector<SmallVector<ReassociationIndices>> reassociations;
+  for (OpOperand *input : op.getInputOperands()) {
+    AffineMap map = op.getTiedIndexingMap(input);
+    if (!map.isProjectedPermutation())
+      return rewriter.notifyMatchFailure(op, "expected projected permutations");
+    ArrayRef<int64_t> shape = op.getShape(input);
+    SmallVector<AffineExpr> exprs;
+    SmallVector<int64_t> expanded_shape;
+    SmallVector<ReassociationIndices> reassociation;
+    bool expand = false;
+    for (auto it : llvm::enumerate(map.getResults())) {
+      unsigned dim = it.value().cast<AffineDimExpr>().getPosition();
+      int64_t pos = exprs.size();
+      if (dim != split_dim) {
+        exprs.push_back(remap_dim(dim));
+        expanded_shape.push_back(shape[it.index()]);
+        reassociation.push_back({pos});
+        continue;
+      }
+      if (shape[it.index()] != size) {
+        return rewriter.notifyMatchFailure(
+            op, "expected static input sizes along the reduction dimension");
+      }
+      exprs.push_back(getAffineDimExpr(split_dim, ctx));
+      exprs.push_back(getAffineDimExpr(split_dim + 1, ctx));
+      expanded_shape.push_back(outer_size);
+      expanded_shape.push_back(inner_size);
+      reassociation.push_back({pos, pos + 1});
+      expand = true;
+    }
+    indexing_maps.push_back(AffineMap::get(num_loops, 0, exprs, ctx));
+    expanded_types.push_back(
+        expand ? RankedTensorType::get(expanded_shape,
+                                       getElementTypeOrSelf(input->get()))
+               : Type());
+    reassociations.push_back(reassociation);
+  }
+
+  // The partial results have the parallel dimension leading if it is the
+  // outer one and trailing if it is the inner one.
+  OpOperand *output = op.getOutputOperand(0);
+  AffineMap output_map = op.getTiedIndexingMap(output);
+  if (!output_map.isProjectedPermutation())
+    return rewriter.notifyMatchFailure(op, "expected projected permutations");
+  SmallVector<AffineExpr> output_exprs;
+  for (AffineExpr expr : output_map.getResults())
+    output_exprs.push_back(remap_dim(expr.cast<AffineDimExpr>().getPosition()));
+  int64_t partial_pos = innerParallel ? output_exprs.size() : 0;
+  output_exprs.insert(output_exprs.begin() + partial_pos,
+                      getAffineDimExpr(parallel_dim, ctx));
+  indexing_maps.push_back(AffineMap::get(num_loops, 0, output_exprs, ctx));
+
+  SmallVector<StringRef> iterator_types =
+      llvm::to_vector(op.iterator_types().getAsValueRange<StringAttr>());
+  iterator_types.insert(iterator_types.begin() + parallel_dim,
+                        getParallelIteratorTypeName());
+
+  // Expand the inputs along the split dimension.
+  Location loc = op.getLoc();
+  SmallVector<Value> inputs;
+  for (auto it : llvm::enumerate(op.getInputOperands())) {
+    Value input = it.value()->get();
+    if (Type expanded_type = expanded_types[it.index()]) {
+      input = rewriter.create<tensor::ExpandShapeOp>(
+          loc, expanded_type, input, reassociations[it.index()]);
+    }
+    inputs.push_back(input);
+  }
+
+  // Initialize the partial results with the neutral element.
+  auto output_type = output->get().getType().cast<RankedTensorType>();
+  SmallVector<OpFoldResult> partial_sizes;
+  for (int64_t dim = 0; dim < output_type.getRank(); ++dim) {
+    if (output_type.isDynamicDim(dim)) {
+      partial_sizes.push_back(
+          rewriter.create<tensor::DimOp>(loc, output->get(), dim).getResult());
+    } else {
+      partial_sizes.push_back(
+          rewriter.getIndexAttr(output_type.getDimSize(dim)));
+    }
+  }
+  partial_sizes.insert(partial_sizes.begin() + partial_pos,
+                       rewriter.getIndexAttr(ratio));
+  Value init = rewriter.create<InitTensorOp>(loc, partial_sizes,
+                                             output_type.getElementType());
+  Value neutral_value = rewriter.create<arith::ConstantOp>(loc, neutral);
+  Value partial_init =
+      rewriter.create<FillOp>(loc, ValueRange{neutral_value}, ValueRange{init})
+          .getResult(0);
+
+  // Compute the partial results with the body of the original op.
+  auto split_op = rewriter.create<GenericOp>(
+      loc, TypeRange{partial_init.getType()}, inputs, ValueRange{partial_init},
+      indexing_maps, iterator_types);
+  rewriter.cloneRegionBefore(op.region(), split_op.region(),
+                             split_op.region().begin());
+
+  // Reduce the partial results into the original output with the combiner.
+  int64_t partial_rank = output_type.getRank() + 1;
+  AffineMap partial_map = rewriter.getMultiDimIdentityMap(partial_rank);
+  SmallVector<StringRef> combine_iterator_types(partial_rank,
+                                                getParallelIteratorTypeName());
+  combine_iterator_types[partial_pos] = getReductionIteratorTypeName();
+  auto combine_op = rewriter.create<GenericOp>(
+      loc, op->getResultTypes(), split_op->getResults(), output->get(),
+      ArrayRef<AffineMap>{partial_map, partial_map.dropResult(partial_pos)},
+      combine_iterator_types, [&](OpBuilder &b, Location loc, ValueRange args) {
+        BlockAndValueMapping bvm;
+        for (Value operand : combiner->getOperands())
+          bvm.map(operand, operand == output_arg ? args[1] : args[0]);
+        Operation *combined = b.clone(*combiner, bvm);
+        b.create<YieldOp>(loc, combined->getResults());
+      });
+  rewriter.replaceOp(op, combine_op->getResults());
+  return split_op;
+}
+
+} // namespace linalg
+} // namespace mlir
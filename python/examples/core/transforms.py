@@ -91,14 +91,22 @@ class Tile(Transform):
   * `tile_sizes`: Tile sizes used for tiling.
   * `tile_interchange`: Interchange used for tiling.
   * `peel`: Peel the specified loops generated by the tiling pattern.
+  * `partial_tiles`: Handling of the partial last tiles, `none` or `auto` to
+    peel or pad every loop with a partial tile depending on a cost model.
+    `auto_mask` also considers masking, which requires a subsequent
+    `Vectorize` with `vectorize_with_masking`.
   * `scalarize_dyn_dims`: Scalarize all dimensions of the main tiled op that
     have statically unknown size.
   """
 
+  class PartialTilesChoice(ChoiceVariableBase):
+    options = ("none", "auto", "auto_mask")
+
   variables = {
       'tile_sizes': (TilingSizesVariable, []),
       'tile_interchange': (InterchangeVariable, []),
       'peel': (PeelingVariable, []),
+      'partial_tiles': (PartialTilesChoice, 'none'),
       'scalarize_dyn_dims': (BoolVariable, False),
   }
 
@@ -112,7 +120,8 @@ class Tile(Transform):
                                                     self.op_name))
     tiled = tx.TileOp(target,
                       sizes=self.tile_sizes,
-                      interchange=self.tile_interchange)
+                      interchange=self.tile_interchange,
+                      partial_tiles=self.partial_tiles)
     for loop_index in self.peel:
       tx.PeelLoopOp(tiled.results[1 + loop_index])
     if self.scalarize_dyn_dims:
@@ -167,11 +176,14 @@ class Vectorize(Transform):
   This transform can be configured as follows:
   * `vectorize_paddings`: Vectorize pad tensor operations.
   * `vectorize_only_tiled`: Vectorize only tiled operations.
+  * `vectorize_with_masking`: Vectorize dynamically-sized tiles with transfers
+    masked by the remaining iteration count. Requires an `op_name`.
   """
 
   variables = {
       'vectorize_paddings': (BoolVariable, True),
       'vectorize_only_tiled': (BoolVariable, False),
+      'vectorize_with_masking': (BoolVariable, False),
   }
 
   def __init__(self, fun_name: str, op_name: str, **kwargs):
@@ -187,7 +199,9 @@ class Vectorize(Transform):
 
     target = tx.MatchOp(emit_pattern_if_not_present(self.fun_name,
                                                     self.op_name))
-    tx.VectorizeOp(target, vectorize_padding=self.vectorize_paddings)
+    tx.VectorizeOp(target,
+                   vectorize_padding=self.vectorize_paddings,
+                   vectorize_with_masking=self.vectorize_with_masking)
 
 
 class Generalize(Transform):
@@ -235,6 +249,35 @@ class Interchange(Transform):
     tx.InterchangeOp(target, iterator_interchange=self.iterator_interchange)
 
 
+class SplitReduction(Transform):
+  """Split the reduction dimension of a generic operation into a parallel
+  dimension computing partial results and a reduction dimension, followed by
+  a generic operation combining the partial results.
+
+  This transform can be configured as follows:
+  * `split_factor`: The number of partial results.
+  * `inner_parallel`: Interleave the elements reduced into the partial results
+     instead of reducing contiguous chunks, e.g. to map them to vector lanes.
+
+  Note: The operation must be in its generic form, see `Generalize`.
+  """
+
+  variables = {
+      'split_factor': (IntVariable, 8),
+      'inner_parallel': (BoolVariable, False),
+  }
+
+  def __init__(self, fun_name: str, **kwargs):
+    self._parse_variables_in_kwargs(kwargs)
+    self.fun_name = fun_name
+
+  def build_transform_ir(self):
+    target = tx.MatchOp(emit_pattern_if_not_present(self.fun_name, 'generic'))
+    tx.SplitReductionOp(target,
+                        split_factor=self.split_factor,
+                        inner_parallel=self.inner_parallel)
+
+
 class DecomposeToLowerDimensionalNamedOp(Transform):
   """Rewrite all known named ops to a lower-dimensional form suitable for
   vectorization.
@@ -436,6 +479,31 @@ class LinalgExtTile(Transform):
     tx.TileToLinalgExtTileOp(target, sizes=self.tile_sizes)
 
 
+class LinalgExtFuseConsumer(Transform):
+  """Fuse an elementwise linalg op into the iree_linalg_ext.tile or
+  iree_linalg_ext.in_parallel op producing one of its inputs, e.g. to apply
+  the epilogue of a tiled matmul to each tile while it is hot in cache.
+
+  This transform can be configured as follows:
+  * `operand_to_fuse`: The input of the consumer produced by the loop.
+  """
+
+  variables = {
+      'operand_to_fuse': (IntVariable, 0),
+  }
+
+  def __init__(self, fun_name: str, op_name: str, **kwargs):
+    self._parse_variables_in_kwargs(kwargs)
+    self.fun_name = fun_name
+    self.op_name = op_name
+
+  def build_transform_ir(self):
+    target = tx.MatchOp(emit_pattern_if_not_present(self.fun_name,
+                                                    self.op_name))
+    tx.FuseConsumerIntoLinalgExtLoopOp(target,
+                                       operand_to_fuse=self.operand_to_fuse)
+
+
 class LinalgExtTileToScfFor(Transform):
   """Rewrite iree_linalg_ext.tile op to scf.for.
   """
@@ -453,17 +521,32 @@ class LinalgExtTileToScfFor(Transform):
 
 class LinalgExtTileToInParallel(Transform):
   """Rewrite iree_linalg_ext.tile op to iree_linalg_ext.in_parallel.
+
+  This transform can be configured as follows:
+  * `schedule`: Distribution of the tiles to the threads, one of `static`,
+     `dynamic` or `guided`.
+  * `chunk_size`: Number of consecutive tiles claimed at once by the `dynamic`
+     schedule, or minimum number of tiles claimed by the `guided` schedule.
   """
 
-  variables = {}
+  class ScheduleChoice(ChoiceVariableBase):
+    options = ("static", "dynamic", "guided")
+
+  variables = {
+      'schedule': (ScheduleChoice, 'static'),
+      'chunk_size': (IntVariable, 1),
+  }
 
   def __init__(self, fun_name: str, **kwargs):
+    self._parse_variables_in_kwargs(kwargs)
     self.fun_name = fun_name
 
   def build_transform_ir(self):
     target = tx.MatchOp(
         emit_pattern_if_not_present(self.fun_name, 'iree_linalg_ext.tile'))
-    tx.RewriteLinalgExtTileToInParallelOp(target)
+    tx.RewriteLinalgExtTileToInParallelOp(target,
+                                          schedule=self.schedule,
+                                          chunk_size=self.chunk_size)
 
 
 class LinalgExtInParallelToScfFor(Transform):
@@ -484,18 +567,121 @@ class LinalgExtInParallelToScfFor(Transform):
 
 class LinalgExtInParallelToAsync(Transform):
   """Rewrite iree_linalg_ext.in_parallel op to async.
+
+  This transform can be configured as follows:
+  * `block_size`: Number of consecutive iterations executed by every async
+     task.
   """
 
-  variables = {}
+  variables = {
+      'block_size': (IntVariable, 1),
+  }
 
   def __init__(self, fun_name: str, **kwargs):
+    self._parse_variables_in_kwargs(kwargs)
     self.fun_name = fun_name
 
   def build_transform_ir(self):
     target = tx.MatchOp(
         emit_pattern_if_not_present(self.fun_name,
                                     'iree_linalg_ext.in_parallel'))
-    tx.RewriteLinalgExtInParallelToAsyncOp(target)
+    tx.RewriteLinalgExtInParallelToAsyncOp(target, block_size=self.block_size)
+
+
+class LinalgExtSoftmaxToLinalg(Transform):
+  """Rewrite iree_linalg_ext.softmax op to linalg.generic ops.
+  """
+
+  variables = {}
+
+  def __init__(self, fun_name: str, **kwargs):
+    self.fun_name = fun_name
+
+  def build_transform_ir(self):
+    target = tx.MatchOp(
+        emit_pattern_if_not_present(self.fun_name, 'iree_linalg_ext.softmax'))
+    tx.RewriteLinalgExtSoftmaxToLinalgOp(target)
+
+
+class LinalgExtPackToLinalg(Transform):
+  """Rewrite iree_linalg_ext.pack ops to linalg.generic transpositions of the
+  padded and expanded inputs.
+  """
+
+  variables = {}
+
+  def __init__(self, fun_name: str, **kwargs):
+    self.fun_name = fun_name
+
+  def build_transform_ir(self):
+    target = tx.MatchOp(
+        emit_pattern_if_not_present(self.fun_name, 'iree_linalg_ext.pack'))
+    tx.RewriteLinalgExtPackToLinalgOp(target)
+
+
+class LinalgExtUnPackToLinalg(Transform):
+  """Rewrite iree_linalg_ext.unpack ops to linalg.generic transpositions
+  followed by the extraction of the unpadded outputs.
+  """
+
+  variables = {}
+
+  def __init__(self, fun_name: str, **kwargs):
+    self.fun_name = fun_name
+
+  def build_transform_ir(self):
+    target = tx.MatchOp(
+        emit_pattern_if_not_present(self.fun_name, 'iree_linalg_ext.unpack'))
+    tx.RewriteLinalgExtUnPackToLinalgOp(target)
+
+
+class LinalgExtSortToParallelMergeSort(Transform):
+  """Rewrite 1-D iree_linalg_ext.sort ops into a parallel merge sort: the
+  chunks of the operands are sorted in an iree_linalg_ext.in_parallel op and
+  merged pairwise by iree_linalg_ext.in_parallel ops partitioned along the
+  merge path.
+
+  This transform can be configured as follows:
+  * `num_threads`: The number of chunks sorted and merged in parallel.
+  """
+
+  variables = {
+      'num_threads': (IntVariable, 8),
+  }
+
+  def __init__(self, fun_name: str, **kwargs):
+    self._parse_variables_in_kwargs(kwargs)
+    self.fun_name = fun_name
+
+  def build_transform_ir(self):
+    target = tx.MatchOp(
+        emit_pattern_if_not_present(self.fun_name, 'iree_linalg_ext.sort'))
+    tx.RewriteLinalgExtSortToParallelMergeSortOp(target,
+                                                 num_threads=self.num_threads)
+
+
+class ConvToWinograd(Transform):
+  """Rewrite a 3x3 stride-1 linalg.conv_2d_nhwc_hwcf op into the Winograd
+  transform ops of F(m x m, 3 x 3) around a linalg.batch_matmul.
+
+  This transform can be configured as follows:
+  * `output_tile_size`: The size m of the output tiles, either 2 or 4.
+  """
+
+  variables = {
+      'output_tile_size': (IntVariable, 4),
+  }
+
+  def __init__(self, fun_name: str, op_name: str, **kwargs):
+    self._parse_variables_in_kwargs(kwargs)
+    self.fun_name = fun_name
+    self.op_name = op_name
+
+  def build_transform_ir(self):
+    target = tx.MatchOp(emit_pattern_if_not_present(self.fun_name,
+                                                    self.op_name))
+    tx.RewriteConv2DToWinogradOp(target,
+                                 output_tile_size=self.output_tile_size)
 
 
 ###############################################################################
@@ -23,6 +23,9 @@ all_names = [                    \
   "SingleTiling3DPad",           \
   "SingleTiling3DPeelTranspose", \
   "DoubleTile2DPadAndHoist",     \
+  "SingleTiling3DAuto",          \
+  "SingleTiling3DMask",          \
+  "SingleTiling3DAutoMask",      \
 ]
 
 
@@ -87,6 +90,32 @@ def all_experts(fun_name):
           .then(LoweringOnlyExpert(fun_name,
                                    op_name,
                                    transpose_lowering='eltwise')),
+        Tile(fun_name,
+             op_name,
+             tile_sizes=[12, 32, 16],
+             tile_interchange=[0, 1, 2],
+             partial_tiles='auto')
+          .then(Vectorize(fun_name, ''))
+          .then(LoweringOnlyExpert(fun_name, op_name)),
+        Tile(fun_name,
+             op_name,
+             tile_sizes=[12, 32, 16],
+             tile_interchange=[0, 1, 2])
+          .then(Vectorize(fun_name, op_name, vectorize_with_masking=True))
+          .then(Vectorize(fun_name, ''))
+          .then(LoweringOnlyExpert(fun_name,
+                                   op_name,
+                                   split_transfers='none')),
+        Tile(fun_name,
+             op_name,
+             tile_sizes=[12, 32, 16],
+             tile_interchange=[0, 1, 2],
+             partial_tiles='auto_mask')
+          .then(Vectorize(fun_name, op_name, vectorize_with_masking=True))
+          .then(Vectorize(fun_name, ''))
+          .then(LoweringOnlyExpert(fun_name,
+                                   op_name,
+                                   split_transfers='none')),
     ]
   ]
 
@@ -0,0 +1,176 @@
+import os
+import numpy as np
+
+from typing import Any, Callable, List, Mapping, Sequence
+
+from mlir.ir import *
+from mlir.dialects import arith, func, linalg, math
+import mlir.dialects.iree_linalg_ext as linalg_ext
+
+from ..core.compilation import attach_inplaceable_attributes, attach_passthrough
+from ..core.problem_definition import *
+from ..core.utils import *
+
+# TODO: Orthogonal configuration object.
+avx512 = True
+
+
+def _emit_generic(inputs: Sequence[Value], outputs: Sequence[Value],
+                  indexing_maps: Sequence[AffineMap],
+                  iterator_types: Sequence[str],
+                  body_builder: Callable) -> Sequence[Value]:
+  """Emits a linalg.generic whose body yields the values returned by
+  `body_builder` called on the block arguments."""
+  generic = linalg.GenericOp(
+      [o.type for o in outputs], inputs, outputs,
+      ArrayAttr.get([AffineMapAttr.get(m) for m in indexing_maps]),
+      ArrayAttr.get([StringAttr.get(t) for t in iterator_types]))
+  block = generic.regions[0].blocks.append(
+      *[RankedTensorType(v.type).element_type for v in [*inputs, *outputs]])
+  with InsertionPoint(block):
+    linalg.YieldOp(body_builder(*block.arguments))
+  return generic.results
+
+
+################################################################################
+### Softmax
+################################################################################
+#   Op def: (     m,     n )
+#    Iters: ({Par(), Red()})
+#               I       O
+#   Layout: {{m, n}, {m, n}}
+class SoftmaxProblem(ProblemDefinition):
+  """Problem definition for a 2-D softmax along the innermost dimension.
+
+  If `online` is set, the softmax is expressed as an iree_linalg_ext.softmax op
+  that lowers to the online normalization and streams the input twice.
+  Otherwise, it is expressed as the max-reduction, exp, sum-reduction and
+  division sequence of linalg.generic ops that streams the input or the
+  exponentials four times.
+  """
+
+  def __init__(self, online: bool):
+    self.online = online
+
+  @property
+  def keys(self) -> List[str]:
+    """Returns the list of parameter keys for the current problem definition."""
+    return ['m', 'n']
+
+  def shapes_builder(self, sizes: Mapping[str, Any]) -> List[List[int]]:
+    """Constructs the tensor shapes given problem parameters."""
+    M, N = sizes['m'], sizes['n']
+    return [[M, N], [M, N]]
+
+  def gflop_count_builder(self, sizes: Mapping[str, Any]) -> float:
+    """Returns the GFLOp count given problem parameters.
+
+    Counts the max, subtraction, exponential, sum and division of the
+    reference implementation for every element.
+    """
+    M, N = sizes['m'], sizes['n']
+    return float(5.0 * M * N) / float(1e9)
+
+  def gbyte_count_builder(self, sizes: Mapping[str, Any],
+                          types: Sequence[np.dtype]) -> float:
+    """Return the GByte count given problem parameters.
+
+    Only counts the compulsory traffic: reading the input and writing the
+    output once. The bandwidth reported for implementations that stream the
+    rows more than once is thus proportionally lower.
+    """
+    M, N = sizes['m'], sizes['n']
+    input_np_type, output_np_type = types
+    return float(M * N * np.dtype(input_np_type).itemsize +
+                 M * N * np.dtype(output_np_type).itemsize) / float(1e9)
+
+  def tensors_np_builder(self, sizes: Mapping[str, Any],
+                         types: Sequence[np.dtype]) -> List[np.dtype]:
+    """Returns random NumPy suitable for calling the kernel."""
+    shapes = self.shapes_builder(sizes)
+    tensors = [
+        realign(np.random.rand(*s).astype(t), byte_alignment=64)
+        for s, t in zip(shapes, types)
+    ]
+    # A row that starts with -inf, e.g. a masked attention score, must not
+    # produce NaNs in the online normalization.
+    tensors[0][0, 0] = -np.inf
+    tensors[-1].fill(0.)
+    return tensors
+
+  def check_np(self, I: np.dtype, O: np.dtype) -> None:
+    """Checks whether the computation results match the reference impl."""
+    E = np.exp(I - np.amax(I, axis=1, keepdims=True))
+    expected = E / np.sum(E, axis=1, keepdims=True)
+    if not np.allclose(O, expected):
+      delta = O - expected
+      max_abs_delta = max(delta.max(), delta.min(), key=abs)
+      raise ValueError(f'max_abs_delta: {max_abs_delta} -> FAILURE ')
+
+  def types_mlir_builder(self, sizes: Mapping[str, Any],
+                         types: Sequence[Type]) -> List[Type]:
+    """Returns the list of MLIR types for arguments of this computation."""
+    shapes = self.shapes_builder(sizes)
+    return [RankedTensorType.get(s, t) for s, t in zip(shapes, types)]
+
+  def build_problem_under_context_manager(self,
+                                          name: str,
+                                          types: Sequence[Type],
+                                          zero_at_each_iteration: bool = False):
+    """Constructs MLIR that implements the softmax.
+
+    Expects to operate under MLIR's context manager. The baseline creates
+    static temporaries and thus only supports static sizes.
+
+    Arguments:
+    name: name of the MLIR function to generate (must be unique in its parent
+      module).
+    mlir_types: types of arguments of this computation.
+    """
+    global avx512
+
+    bench = func.FuncOp(name, (types, [types[-1]]))
+    # TODO: need something much more flexible to add function argument attributes.
+    attach_inplaceable_attributes(bench, inplaceable=[False, True])
+    attach_passthrough(
+        bench, [StringAttr.get(os.getenv('SANDBOX_INLINING', 'noinline'))],
+        avx512=avx512)
+
+    input_type = RankedTensorType(types[0])
+    element_type = input_type.element_type
+    with InsertionPoint(bench.add_entry_block()):
+      input_tensor, output_tensor = bench.arguments
+      if self.online:
+        i64 = IntegerType.get_signless(64)
+        softmax = linalg_ext.SoftmaxOp([types[-1]], [input_tensor],
+                                       [output_tensor],
+                                       IntegerAttr.get(i64, 1))
+        func.ReturnOp(softmax.results)
+        return bench
+
+      M, N = input_type.shape
+      identity_map = AffineMap.get_identity(2)
+      row_map = AffineMap.get(2, 0, [AffineDimExpr.get(0)])
+      row_init = linalg.InitTensorOp([M], element_type)
+      neg_inf = arith.ConstantOp(element_type, float('-inf'))
+      zero = arith.ConstantOp(element_type, 0.0)
+
+      row_max = _emit_generic(
+          [input_tensor], [linalg.fill(neg_inf, outs=[row_init])],
+          [identity_map, row_map], ['parallel', 'reduction'],
+          lambda x, acc: [arith.MaxFOp(acc, x)])[0]
+      exp = _emit_generic(
+          [input_tensor, row_max], [linalg.InitTensorOp([M, N], element_type)],
+          [identity_map, row_map, identity_map], ['parallel', 'parallel'],
+          lambda x, m, _: [math.ExpOp(arith.SubFOp(x, m))])[0]
+      row_sum = _emit_generic([exp], [linalg.fill(zero, outs=[row_init])],
+                              [identity_map, row_map],
+                              ['parallel', 'reduction'],
+                              lambda e, acc: [arith.AddFOp(acc, e)])[0]
+      softmax = _emit_generic([exp, row_sum], [output_tensor],
+                              [identity_map, row_map, identity_map],
+                              ['parallel', 'parallel'],
+                              lambda e, s, _: [arith.DivFOp(e, s)])
+      func.ReturnOp(softmax)
+
+    return bench
@@ -0,0 +1,104 @@
+# RUN: %PYTHON %s 2>&1 | FileCheck %s
+
+# This file contains small benchmarks with reasonably-sized problem/tiling sizes
+# and codegen options.
+#
+# It compares the online softmax (iree_linalg_ext.softmax), that streams every
+# row twice, to the max-reduction, exp, sum-reduction and division sequence of
+# linalg ops, that streams every row four times and materializes the
+# exponentials.
+
+from ..core.experts import *
+from ..core.harness import *
+from ..core.transforms import *
+
+from .definitions import *
+
+fun_name = 'softmax_2d'
+op_name = 'linalg.generic'
+
+################################################################################
+### Compilation strategies.
+################################################################################
+
+# Note: `\` char at the end of next line prevents formatter reflows, keep it.
+all_names = [ \
+  "Tile4", \
+  "Tile8", \
+  "Tile16", \
+  ]
+
+
+def all_experts(online: bool):
+  tile_sizes = [4, 8, 16]
+  res = []
+  for ts in tile_sizes:
+    # Only tile the parallel dimension, the rows are reduced as a whole.
+    expert = Tile(fun_name=fun_name, op_name=op_name, tile_sizes=[ts])
+    if online:
+      expert = LinalgExtSoftmaxToLinalg(fun_name).then(expert)
+    res.append(
+      # Note: `\` char at the end of next line prevents formatter reflows, keep it. \
+      expert
+        .then(Vectorize(fun_name, ''))
+        .then(LoweringOnlyExpert(fun_name,
+                                 op_name,
+                                 multi_reduction_lowering='innerreduction')),
+    )
+  return [e.print_ir(after_all=False, at_begin=False, llvm=False) for e in res]
+
+
+################################################################################
+### Problem instantiations.
+################################################################################
+
+keys = ['m', 'n']
+
+
+# CHECK-NOT: FAILURE
+def main():
+  # Specify default configuration and parse command line.
+  # Note: `\` char at the end of next line prevents formatter reflows, keep it.
+  args = test_argparser(  \
+    "softmax 2d benchmark",
+    default_n_iters=100,
+    default_problem_sizes_list=[
+      [128, 256],
+      [256, 1024],
+      [1000, 1024],
+      [8000, 6144],
+    ],
+    default_expert_list=all_names,
+    # The linalg baseline allocates static temporaries.
+    default_dynamic_at_compile_time_list=[[]],
+    default_spec_list=[])
+
+  def numpy_kernel(args, sizes, types):
+    I, O = args
+    E = np.exp(I - np.amax(I, axis=1, keepdims=True))
+    np.divide(E, np.sum(E, axis=1, keepdims=True), out=O)
+
+  def pytorch_kernel(args, sizes, types):
+    I, O = args
+    O.copy_(torch.softmax(I, dim=1))
+
+  for online in [False, True]:
+    print(f'Online softmax: {online}')
+    for dynamic_at_compile_time in args.dynamic_at_compile_time_list:
+      for problem_sizes in args.problem_sizes_list:
+        test_harness(lambda s, t: SoftmaxProblem(online),
+                     [[np.float32] * 2],
+                     test_sizes(keys, [problem_sizes]),
+                     test_experts(all_experts(online), all_names,
+                                  args.expert_list),
+                     n_iters=args.n_iters,
+                     dynamic_at_compile_time_sizes=set(
+                         dynamic_at_compile_time).intersection(keys),
+                     function_name=fun_name,
+                     dump_ir_to_file='/tmp/abcd.mlir',
+                     dump_obj_to_file='/tmp/abcd.o',
+                     dump_data_to_file=args.dump_data)
+
+
+if __name__ == '__main__':
+  main()
@@ -170,10 +170,12 @@ class TileOp:
                *,
                sizes: IntListArg = None,
                interchange: IntListArg = None,
+               partial_tiles: StringArg = None,
                loc=None,
                ip=None):
     sizes = _ensure_int_array_attr(sizes, [])
     interchange = _ensure_int_array_attr(interchange, [])
+    partial_tiles = _ensure_string_attr(partial_tiles, "none")
     operation_type = pdl.OperationType.get()
     tile_size_zero = _ensure_int_attr(0)
     num_loops = _count_expected_loops(sizes)
@@ -181,6 +183,7 @@ class TileOp:
                      target,
                      sizes,
                      interchange,
+                     partial_tiles,
                      loc=loc,
                      ip=ip)
 class ScalarizeOp:
@@ -269,6 +272,28 @@ class InterchangeOp:
                      ip=ip)
 
 
+class SplitReductionOp:
+  """Specialization for the SplitReductionOp class."""
+
+  def __init__(self,
+               target: Union[ir.Value, ir.Operation, ir.OpView],
+               *,
+               split_factor: IntArg = None,
+               inner_parallel: BoolArg = None,
+               loc=None,
+               ip=None):
+    split_factor = _ensure_int_attr(split_factor, 2)
+    inner_parallel = _ensure_bool_attr(inner_parallel, False)
+    operation_type = pdl.OperationType.get()
+
+    super().__init__(operation_type,
+                     target,
+                     split_factor,
+                     inner_parallel,
+                     loc=loc,
+                     ip=ip)
+
+
 class VectorizeOp:
 
   def __init__(self,
@@ -276,6 +301,7 @@ class VectorizeOp:
                                       ir.OpView]] = None,
                *,
                vectorize_padding: BoolArg = None,
+               vectorize_with_masking: BoolArg = None,
                loc=None,
                ip=None):
     operation_type = pdl.OperationType.get()
@@ -283,6 +309,7 @@ class VectorizeOp:
     super().__init__(operation_type if target is not None else None,
                      target,
                      _ensure_bool_attr(vectorize_padding, False),
+                     _ensure_bool_attr(vectorize_with_masking, False),
                      loc=loc,
                      ip=ip)
 
@@ -403,10 +430,19 @@ class RewriteLinalgExtTileToInParallelOp:
   def __init__(self,
                target: Union[ir.Value, ir.Operation, ir.OpView],
                *,
+               schedule: StringArg = None,
+               chunk_size: IntArg = None,
                loc=None,
                ip=None):
     operation_type = pdl.OperationType.get()
-    super().__init__(operation_type, target, loc=loc, ip=ip)
+    schedule = _ensure_string_attr(schedule, "static")
+    chunk_size = _ensure_int_attr(chunk_size, 1)
+    super().__init__(operation_type,
+                     target,
+                     schedule,
+                     chunk_size,
+                     loc=loc,
+                     ip=ip)
 
 
 class RewriteLinalgExtInParallelToScfForOp:
@@ -424,6 +460,20 @@ class RewriteLinalgExtInParallelToScfForOp:
 class RewriteLinalgExtInParallelToAsyncOp:
   """Specialization for the RewriteLinalgExtInParallelToAsyncOp class."""
 
+  def __init__(self,
+               target: Union[ir.Value, ir.Operation, ir.OpView],
+               *,
+               block_size: IntArg = None,
+               loc=None,
+               ip=None):
+    operation_type = pdl.OperationType.get()
+    block_size = _ensure_int_attr(block_size, 1)
+    super().__init__(operation_type, target, block_size, loc=loc, ip=ip)
+
+
+class RewriteLinalgExtSoftmaxToLinalgOp:
+  """Specialization for the RewriteLinalgExtSoftmaxToLinalgOp class."""
+
   def __init__(self,
                target: Union[ir.Value, ir.Operation, ir.OpView],
                *,
@@ -431,3 +481,122 @@ class RewriteLinalgExtInParallelToAsyncOp:
                ip=None):
     operation_type = pdl.OperationType.get()
     super().__init__(operation_type, target, loc=loc, ip=ip)
+
+
+class RewriteLinalgExtPackToLinalgOp:
+  """Specialization for the RewriteLinalgExtPackToLinalgOp class."""
+
+  def __init__(self,
+               target: Union[ir.Value, ir.Operation, ir.OpView],
+               *,
+               loc=None,
+               ip=None):
+    operation_type = pdl.OperationType.get()
+    super().__init__(operation_type, target, loc=loc, ip=ip)
+
+
+class RewriteLinalgExtUnPackToLinalgOp:
+  """Specialization for the RewriteLinalgExtUnPackToLinalgOp class."""
+
+  def __init__(self,
+               target: Union[ir.Value, ir.Operation, ir.OpView],
+               *,
+               loc=None,
+               ip=None):
+    operation_type = pdl.OperationType.get()
+    super().__init__(operation_type, target, loc=loc, ip=ip)
+
+
+class RewriteLinalgExtSortToParallelMergeSortOp:
+  """Specialization for the RewriteLinalgExtSortToParallelMergeSortOp class."""
+
+  def __init__(self,
+               target: Union[ir.Value, ir.Operation, ir.OpView],
+               *,
+               num_threads: Union[int, ir.IntegerAttr],
+               loc=None,
+               ip=None):
+    operation_type = pdl.OperationType.get()
+    # The number of threads must not be None, do not provide the default value
+    # here.
+    num_threads = _ensure_int_attr(num_threads)
+    super().__init__(operation_type, target, num_threads, loc=loc, ip=ip)
+
+
+class FuseConsumerIntoLinalgExtLoopOp:
+  """Specialization for the FuseConsumerIntoLinalgExtLoopOp class."""
+
+  def __init__(self,
+               target: Union[ir.Value, ir.Operation, ir.OpView],
+               *,
+               operand_to_fuse: IntArg = None,
+               loc=None,
+               ip=None):
+    operation_type = pdl.OperationType.get()
+    operand_to_fuse = _ensure_int_attr(operand_to_fuse, 0)
+    super().__init__(operation_type,
+                     target,
+                     operand_to_fuse,
+                     loc=loc,
+                     ip=ip)
+
+
+class RewriteConv2DToWinogradOp:
+  """Specialization for the RewriteConv2DToWinogradOp class."""
+
+  def __init__(self,
+               target: Union[ir.Value, ir.Operation, ir.OpView],
+               *,
+               output_tile_size: IntArg = None,
+               loc=None,
+               ip=None):
+    operation_type = pdl.OperationType.get()
+    output_tile_size = _ensure_int_attr(output_tile_size, 4)
+    super().__init__(operation_type,
+                     target,
+                     output_tile_size,
+                     loc=loc,
+                     ip=ip)
+
+
+class PadContractionToBlockSizeOp:
+  """Specialization for the PadContractionToBlockSizeOp class."""
+
+  def __init__(self,
+               target: Union[ir.Value, ir.Operation, ir.OpView],
+               *,
+               row_alignment: IntArg = None,
+               column_alignment: IntArg = None,
+               vector_bit_width: IntArg = None,
+               loc=None,
+               ip=None):
+    operation_type = pdl.OperationType.get()
+    row_alignment = _ensure_int_attr(row_alignment, 16)
+    column_alignment = _ensure_int_attr(column_alignment, 16)
+    vector_bit_width = _ensure_int_attr(vector_bit_width, 0)
+    super().__init__(operation_type,
+                     target,
+                     row_alignment,
+                     column_alignment,
+                     vector_bit_width,
+                     loc=loc,
+                     ip=ip)
+
+
+class RewriteLinalgExtTopkSplitReductionOp:
+  """Specialization for the RewriteLinalgExtTopkSplitReductionOp class."""
+
+  def __init__(self,
+               target: Union[ir.Value, ir.Operation, ir.OpView],
+               *,
+               split_ratio: IntArg = None,
+               loc=None,
+               ip=None):
+    operation_type = pdl.OperationType.get()
+    split_ratio = _ensure_int_attr(split_ratio, 4)
+    super().__init__(operation_type,
+                     operation_type,
+                     target,
+                     split_ratio,
+                     loc=loc,
+                     ip=ip)
@@ -0,0 +1,60 @@
+// RUN: mlir-proto-opt %s -linalg-interp-transforms | FileCheck %s
+
+module {
+
+// CHECK-LABEL: func @pack_inplace(
+//  CHECK-SAME:     %[[IN:.*]]: memref<13x15xf32, #{{.*}}>,
+//  CHECK-SAME:     %[[PAD:.*]]: f32,
+//  CHECK-SAME:     %[[OUT:.*]]: memref<4x2x8x4xf32, #{{.*}}>
+func @pack_inplace(
+    %in: tensor<13x15xf32> {linalg.inplaceable=false},
+    %pad: f32,
+    %out: tensor<4x2x8x4xf32> {linalg.inplaceable=true}) -> tensor<4x2x8x4xf32>
+{
+  // The output is overwritten without being read: no copy is needed.
+  //  CHECK-NOT: memref.alloc
+  //  CHECK-NOT: memref.copy
+  //      CHECK: iree_linalg_ext.pack outer_dims_perm = [1, 0]
+  // CHECK-SAME:   ins(%[[IN]], %[[PAD]] : memref<13x15xf32, #{{.*}}>, f32)
+  // CHECK-SAME:   outs(%[[OUT]] : memref<4x2x8x4xf32, #{{.*}}>)
+  //  CHECK-NOT: ->
+  %0 = iree_linalg_ext.pack outer_dims_perm = [1, 0]
+        inner_dims_pos = [0, 1] inner_tiles = [8, 4]
+        ins(%in, %pad : tensor<13x15xf32>, f32)
+        outs(%out : tensor<4x2x8x4xf32>) -> tensor<4x2x8x4xf32>
+  // CHECK: return
+  return %0 : tensor<4x2x8x4xf32>
+}
+
+// CHECK-LABEL: func @unpack_inplace(
+//  CHECK-SAME:     %[[IN:.*]]: memref<4x2x8x4xf32, #{{.*}}>,
+//  CHECK-SAME:     %[[OUT:.*]]: memref<13x15xf32, #{{.*}}>
+func @unpack_inplace(
+    %in: tensor<4x2x8x4xf32> {linalg.inplaceable=false},
+    %out: tensor<13x15xf32> {linalg.inplaceable=true}) -> tensor<13x15xf32>
+{
+  //  CHECK-NOT: memref.alloc
+  //  CHECK-NOT: memref.copy
+  //      CHECK: iree_linalg_ext.unpack outer_dims_perm = [1, 0]
+  // CHECK-SAME:   ins(%[[IN]] : memref<4x2x8x4xf32, #{{.*}}>)
+  // CHECK-SAME:   outs(%[[OUT]] : memref<13x15xf32, #{{.*}}>)
+  //  CHECK-NOT: ->
+  %0 = iree_linalg_ext.unpack outer_dims_perm = [1, 0]
+        inner_dims_pos = [0, 1] inner_tiles = [8, 4]
+        ins(%in : tensor<4x2x8x4xf32>)
+        outs(%out : tensor<13x15xf32>) -> tensor<13x15xf32>
+  // CHECK: return
+  return %0 : tensor<13x15xf32>
+}
+
+pdl.pattern @pdl_target : benefit(1) {
+  %0 = operation "func"
+  // TODO: we don't want this, but it is the required terminator for pdl.pattern
+  rewrite %0 with "iree_linalg_transform.apply"
+}
+
+iree_linalg_transform.sequence {
+  bufferize
+}
+
+}
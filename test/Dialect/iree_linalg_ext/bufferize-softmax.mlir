@@ -0,0 +1,37 @@
+// RUN: mlir-proto-opt %s -linalg-interp-transforms | FileCheck %s
+
+module {
+
+// CHECK-LABEL: func @softmax_inplace(
+//  CHECK-SAME:     %[[IN:.*]]: memref<16x128xf32, #{{.*}}>,
+//  CHECK-SAME:     %[[OUT:.*]]: memref<16x128xf32, #{{.*}}>
+func @softmax_inplace(
+    %in: tensor<16x128xf32> {linalg.inplaceable=false},
+    %out: tensor<16x128xf32> {linalg.inplaceable=true}) -> tensor<16x128xf32>
+{
+  // The output is overwritten without being read: no copy is needed.
+  //  CHECK-NOT: memref.alloc
+  //  CHECK-NOT: memref.copy
+  //      CHECK: iree_linalg_ext.softmax dimension(1)
+  // CHECK-SAME:   ins(%[[IN]] : memref<16x128xf32, #{{.*}}>)
+  // CHECK-SAME:   outs(%[[OUT]] : memref<16x128xf32, #{{.*}}>)
+  //  CHECK-NOT: ->
+  %0 = iree_linalg_ext.softmax
+        dimension(1)
+        ins(%in : tensor<16x128xf32>)
+        outs(%out : tensor<16x128xf32>) -> tensor<16x128xf32>
+  // CHECK: return
+  return %0 : tensor<16x128xf32>
+}
+
+pdl.pattern @pdl_target : benefit(1) {
+  %0 = operation "func"
+  // TODO: we don't want this, but it is the required terminator for pdl.pattern
+  rewrite %0 with "iree_linalg_transform.apply"
+}
+
+iree_linalg_transform.sequence {
+  bufferize
+}
+
+}
@@ -0,0 +1,82 @@
+// RUN: mlir-proto-opt %s -linalg-interp-transforms --split-input-file | FileCheck %s
+
+module {
+  // CHECK-LABEL: func @conv_2d_winograd_4x4
+  //  CHECK-SAME:   %[[IN:[0-9a-z]+]]: tensor<1x10x10x8xf32>
+  //  CHECK-SAME:   %[[FILTER:[0-9a-z]+]]: tensor<3x3x8x16xf32>
+  //  CHECK-SAME:   %[[OUT:[0-9a-z]+]]: tensor<1x8x8x16xf32>
+  func @conv_2d_winograd_4x4(%in: tensor<1x10x10x8xf32>, %filter: tensor<3x3x8x16xf32>, %out: tensor<1x8x8x16xf32>) -> tensor<1x8x8x16xf32> {
+    // CHECK-DAG: %[[ZERO:.*]] = arith.constant 0.000000e+00 : f32
+    // CHECK-DAG: %[[FILTER_INIT:.*]] = linalg.init_tensor [6, 6, 8, 16] : tensor<6x6x8x16xf32>
+    // CHECK: %[[U:.*]] = iree_linalg_ext.winograd.filter_transform
+    // CHECK-SAME: output_tile_size(4)
+    // CHECK-SAME: ins(%[[FILTER]] : tensor<3x3x8x16xf32>) outs(%[[FILTER_INIT]] : tensor<6x6x8x16xf32>)
+    // CHECK: %[[INPUT_INIT:.*]] = linalg.init_tensor [6, 6, 1, 2, 2, 8] : tensor<6x6x1x2x2x8xf32>
+    // CHECK: %[[V:.*]] = iree_linalg_ext.winograd.input_transform
+    // CHECK-SAME: output_tile_size(4)
+    // CHECK-SAME: ins(%[[IN]] : tensor<1x10x10x8xf32>) outs(%[[INPUT_INIT]] : tensor<6x6x1x2x2x8xf32>)
+    // CHECK: %[[LHS:.*]] = tensor.collapse_shape %[[V]] {{\[}}[0, 1], [2, 3, 4], [5]] : tensor<6x6x1x2x2x8xf32> into tensor<36x4x8xf32>
+    // CHECK: %[[RHS:.*]] = tensor.collapse_shape %[[U]] {{\[}}[0, 1], [2], [3]] : tensor<6x6x8x16xf32> into tensor<36x8x16xf32>
+    // CHECK: %[[MATMUL_INIT:.*]] = linalg.init_tensor [36, 4, 16] : tensor<36x4x16xf32>
+    // CHECK: %[[FILL:.*]] = linalg.fill ins(%[[ZERO]] : f32) outs(%[[MATMUL_INIT]] : tensor<36x4x16xf32>)
+    // CHECK: %[[MATMUL:.*]] = linalg.batch_matmul ins(%[[LHS]], %[[RHS]] : tensor<36x4x8xf32>, tensor<36x8x16xf32>) outs(%[[FILL]] : tensor<36x4x16xf32>)
+    // CHECK: %[[PRODUCT:.*]] = tensor.expand_shape %[[MATMUL]] {{\[}}[0, 1], [2, 3, 4], [5]] : tensor<36x4x16xf32> into tensor<6x6x1x2x2x16xf32>
+    // CHECK: %[[RES:.*]] = iree_linalg_ext.winograd.output_transform
+    // CHECK-SAME: output_tile_size(4)
+    // CHECK-SAME: ins(%[[PRODUCT]] : tensor<6x6x1x2x2x16xf32>) outs(%[[OUT]] : tensor<1x8x8x16xf32>)
+    // CHECK-NOT: linalg.conv_2d_nhwc_hwcf
+    // CHECK: return %[[RES]]
+    %0 = linalg.conv_2d_nhwc_hwcf
+           {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+           ins(%in, %filter : tensor<1x10x10x8xf32>, tensor<3x3x8x16xf32>)
+           outs(%out : tensor<1x8x8x16xf32>) -> tensor<1x8x8x16xf32>
+    return %0 : tensor<1x8x8x16xf32>
+  }
+
+  pdl.pattern @match_conv : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "linalg.conv_2d_nhwc_hwcf"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_conv
+    %1 = rewrite_conv2d_to_winograd %0
+  }
+}
+
+// -----
+
+module {
+  // The last tiles along H and W are partial: 7 = 3 * 2 + 1.
+  // CHECK-LABEL: func @conv_2d_winograd_2x2
+  func @conv_2d_winograd_2x2(%in: tensor<2x9x9x8xf32>, %filter: tensor<3x3x8x16xf32>, %out: tensor<2x7x7x16xf32>) -> tensor<2x7x7x16xf32> {
+    // CHECK: linalg.init_tensor [4, 4, 8, 16] : tensor<4x4x8x16xf32>
+    // CHECK: iree_linalg_ext.winograd.filter_transform
+    // CHECK-SAME: output_tile_size(2)
+    // CHECK: linalg.init_tensor [4, 4, 2, 4, 4, 8] : tensor<4x4x2x4x4x8xf32>
+    // CHECK: iree_linalg_ext.winograd.input_transform
+    // CHECK-SAME: output_tile_size(2)
+    // CHECK: linalg.batch_matmul
+    // CHECK-SAME: ins(%{{.*}}, %{{.*}} : tensor<16x32x8xf32>, tensor<16x8x16xf32>) outs(%{{.*}} : tensor<16x32x16xf32>)
+    // CHECK: iree_linalg_ext.winograd.output_transform
+    // CHECK-SAME: output_tile_size(2)
+    // CHECK-SAME: ins(%{{.*}} : tensor<4x4x2x4x4x16xf32>) outs(%{{.*}} : tensor<2x7x7x16xf32>)
+    %0 = linalg.conv_2d_nhwc_hwcf
+           {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+           ins(%in, %filter : tensor<2x9x9x8xf32>, tensor<3x3x8x16xf32>)
+           outs(%out : tensor<2x7x7x16xf32>) -> tensor<2x7x7x16xf32>
+    return %0 : tensor<2x7x7x16xf32>
+  }
+
+  pdl.pattern @match_conv : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "linalg.conv_2d_nhwc_hwcf"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_conv
+    %1 = rewrite_conv2d_to_winograd %0 {output_tile_size = 2 : i64}
+  }
+}
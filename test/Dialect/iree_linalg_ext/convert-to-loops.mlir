@@ -0,0 +1,168 @@
+// RUN: mlir-proto-opt %s -linalg-interp-transforms --split-input-file | FileCheck %s
+
+module {
+  func @topk_memref(%input_values: memref<?x?xf32>, %out_values: memref<?x?xf32>, %out_indices: memref<?x?xi32>) {
+    iree_linalg_ext.topk
+          dimension(1)
+          ins(%input_values : memref<?x?xf32>)
+          outs(%out_values, %out_indices : memref<?x?xf32>, memref<?x?xi32>) {
+          ^bb0(%arg0: f32, %arg1: f32):  // no predecessors
+            %0 = arith.cmpf ogt, %arg0, %arg1 : f32
+            iree_linalg_ext.yield %0 : i1
+          }
+    return
+  }
+  // CHECK-LABEL: func @topk_memref
+  //  CHECK-SAME:   %[[INPUT_VALUES:[a-zA-Z0-9_]+]]: memref<?x?xf32>
+  //  CHECK-SAME:   %[[OUT_VALUES:[a-zA-Z0-9_]+]]: memref<?x?xf32>
+  //  CHECK-SAME:   %[[OUT_INDICES:[a-zA-Z0-9_]+]]: memref<?x?xi32>
+  //   CHECK-DAG:   %[[C0:.+]] = arith.constant 0 : index
+  //   CHECK-DAG:   %[[C1:.+]] = arith.constant 1 : index
+  //   CHECK-DAG:   %[[D0:.+]] = memref.dim %[[INPUT_VALUES]], %[[C0]]
+  //   CHECK-DAG:   %[[D1:.+]] = memref.dim %[[INPUT_VALUES]], %[[C1]]
+  //   CHECK-DAG:   %[[K:.+]] = memref.dim %[[OUT_VALUES]], %[[C1]]
+  //       CHECK:   scf.for %[[I:.+]] = %[[C0]] to %[[D0]] step %[[C1]]
+  //       CHECK:     scf.for %[[J:.+]] = %[[C0]] to %[[D1]] step %[[C1]]
+  //       CHECK:       %[[VALUE:.+]] = memref.load %[[INPUT_VALUES]][%[[I]], %[[J]]]
+  //       CHECK:       %[[INDEX:.+]] = arith.index_cast %[[J]] : index to i32
+  //       CHECK:       scf.for %[[L:.+]] = %[[C0]] to %[[K]] step %[[C1]]
+  //  CHECK-SAME:           iter_args(%[[CUR_VALUE:.+]] = %[[VALUE]], %[[CUR_INDEX:.+]] = %[[INDEX]])
+  //       CHECK:         %[[BEST_VALUE:.+]] = memref.load %[[OUT_VALUES]][%[[I]], %[[L]]]
+  //       CHECK:         %[[BEST_INDEX:.+]] = memref.load %[[OUT_INDICES]][%[[I]], %[[L]]]
+  //       CHECK:         %[[BETTER:.+]] = arith.cmpf ogt, %[[CUR_VALUE]], %[[BEST_VALUE]]
+  //       CHECK:         %[[WORSE:.+]] = arith.cmpf ogt, %[[BEST_VALUE]], %[[CUR_VALUE]]
+  //       CHECK:         %[[EQUAL:.+]] = arith.cmpi eq, %[[BETTER]], %[[WORSE]]
+  //       CHECK:         %[[FIRST:.+]] = arith.cmpi slt, %[[CUR_INDEX]], %[[BEST_INDEX]]
+  //       CHECK:         %[[TIE:.+]] = arith.andi %[[EQUAL]], %[[FIRST]]
+  //       CHECK:         %[[PRECEDES:.+]] = arith.ori %[[BETTER]], %[[TIE]]
+  //       CHECK:         %[[NEW_VALUE:.+]] = arith.select %[[PRECEDES]], %[[CUR_VALUE]], %[[BEST_VALUE]]
+  //       CHECK:         memref.store %[[NEW_VALUE]], %[[OUT_VALUES]][%[[I]], %[[L]]]
+  //       CHECK:         %[[NEW_INDEX:.+]] = arith.select %[[PRECEDES]], %[[CUR_INDEX]], %[[BEST_INDEX]]
+  //       CHECK:         memref.store %[[NEW_INDEX]], %[[OUT_INDICES]][%[[I]], %[[L]]]
+  //       CHECK:         %[[NEXT_VALUE:.+]] = arith.select %[[PRECEDES]], %[[BEST_VALUE]], %[[CUR_VALUE]]
+  //       CHECK:         %[[NEXT_INDEX:.+]] = arith.select %[[PRECEDES]], %[[BEST_INDEX]], %[[CUR_INDEX]]
+  //       CHECK:         scf.yield %[[NEXT_VALUE]], %[[NEXT_INDEX]]
+
+  pdl.pattern @match_iree_linalg_ext_topk : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.topk"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_topk
+    rewrite_iree_linalg_ext_to_loops %0
+  }
+}
+
+// -----
+
+module {
+  func @topk_memref_small_k(%input_values: memref<4x10xf32>, %input_indices: memref<4x10xi32>, %out_values: memref<4x3xf32>, %out_indices: memref<4x3xi32>) {
+    iree_linalg_ext.topk
+          dimension(1)
+          ins(%input_values, %input_indices : memref<4x10xf32>, memref<4x10xi32>)
+          outs(%out_values, %out_indices : memref<4x3xf32>, memref<4x3xi32>) {
+          ^bb0(%arg0: f32, %arg1: f32):  // no predecessors
+            %0 = arith.cmpf ogt, %arg0, %arg1 : f32
+            iree_linalg_ext.yield %0 : i1
+          }
+    return
+  }
+  // CHECK-LABEL: func @topk_memref_small_k
+  //  CHECK-SAME:   %[[INPUT_VALUES:[a-zA-Z0-9_]+]]: memref<4x10xf32>
+  //  CHECK-SAME:   %[[INPUT_INDICES:[a-zA-Z0-9_]+]]: memref<4x10xi32>
+  //  CHECK-SAME:   %[[OUT_VALUES:[a-zA-Z0-9_]+]]: memref<4x3xf32>
+  //  CHECK-SAME:   %[[OUT_INDICES:[a-zA-Z0-9_]+]]: memref<4x3xi32>
+  //   CHECK-DAG:   %[[C0:.+]] = arith.constant 0 : index
+  // The interpreter hoists the accesses to the outputs out of the inner loop.
+  //       CHECK:   scf.for %[[I:.+]] =
+  //       CHECK:     %[[INIT_VALUES:.+]] = vector.transfer_read %[[OUT_VALUES]][%[[I]], %[[C0]]]
+  //  CHECK-SAME:         memref<4x3xf32>, vector<3xf32>
+  //       CHECK:     %[[INIT_INDICES:.+]] = vector.transfer_read %[[OUT_INDICES]][%[[I]], %[[C0]]]
+  //  CHECK-SAME:         memref<4x3xi32>, vector<3xi32>
+  //       CHECK:     %[[BEST:.+]]:2 = scf.for %[[J:[a-zA-Z0-9_]+]] =
+  //  CHECK-SAME:         iter_args(%[[BEST_VALUES:[a-zA-Z0-9_]+]] = %[[INIT_VALUES]], %[[BEST_INDICES:[a-zA-Z0-9_]+]] = %[[INIT_INDICES]])
+  //       CHECK:       %[[VALUE:.+]] = memref.load %[[INPUT_VALUES]][%[[I]], %[[J]]]
+  //       CHECK:       %[[INDEX:.+]] = memref.load %[[INPUT_INDICES]][%[[I]], %[[J]]]
+  //       CHECK:       %[[VALUE_SPLAT:.+]] = vector.broadcast %[[VALUE]] : f32 to vector<3xf32>
+  //       CHECK:       %[[INDEX_SPLAT:.+]] = vector.broadcast %[[INDEX]] : i32 to vector<3xi32>
+  //       CHECK:       %[[BETTER:.+]] = arith.cmpf ogt, %[[VALUE_SPLAT]], %[[BEST_VALUES]] : vector<3xf32>
+  //       CHECK:       %[[PRECEDES:.+]] = arith.ori %[[BETTER]], %{{.+}} : vector<3xi1>
+  //       CHECK:       %[[SHIFTED_PRECEDES:.+]] = vector.shuffle %{{.+}}, %[[PRECEDES]] [0, 3, 4] : vector<3xi1>, vector<3xi1>
+  //       CHECK:       %[[SHIFTED_VALUES:.+]] = vector.shuffle %[[VALUE_SPLAT]], %[[BEST_VALUES]] [0, 3, 4]
+  //       CHECK:       %[[INSERTED_VALUES:.+]] = arith.select %[[SHIFTED_PRECEDES]], %[[SHIFTED_VALUES]], %[[VALUE_SPLAT]]
+  //       CHECK:       %[[NEW_VALUES:.+]] = arith.select %[[PRECEDES]], %[[INSERTED_VALUES]], %[[BEST_VALUES]]
+  //       CHECK:       %[[SHIFTED_INDICES:.+]] = vector.shuffle %[[INDEX_SPLAT]], %[[BEST_INDICES]] [0, 3, 4]
+  //       CHECK:       %[[INSERTED_INDICES:.+]] = arith.select %[[SHIFTED_PRECEDES]], %[[SHIFTED_INDICES]], %[[INDEX_SPLAT]]
+  //       CHECK:       %[[NEW_INDICES:.+]] = arith.select %[[PRECEDES]], %[[INSERTED_INDICES]], %[[BEST_INDICES]]
+  //       CHECK:       scf.yield %[[NEW_VALUES]], %[[NEW_INDICES]]
+  //   CHECK-DAG:     vector.transfer_write %[[BEST]]#0, %[[OUT_VALUES]][%[[I]], %[[C0]]]
+  //   CHECK-DAG:     vector.transfer_write %[[BEST]]#1, %[[OUT_INDICES]][%[[I]], %[[C0]]]
+
+  pdl.pattern @match_iree_linalg_ext_topk : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.topk"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_topk
+    rewrite_iree_linalg_ext_to_loops %0
+  }
+}
+
+// -----
+
+module {
+  func @softmax_memref(%input: memref<?x?xf32>, %output: memref<?x?xf32>) {
+    iree_linalg_ext.softmax
+          dimension(1)
+          ins(%input : memref<?x?xf32>)
+          outs(%output : memref<?x?xf32>)
+    return
+  }
+  // CHECK-LABEL: func @softmax_memref
+  //  CHECK-SAME:   %[[INPUT:[a-zA-Z0-9_]+]]: memref<?x?xf32>
+  //  CHECK-SAME:   %[[OUTPUT:[a-zA-Z0-9_]+]]: memref<?x?xf32>
+  //   CHECK-DAG:   %[[C0:.+]] = arith.constant 0 : index
+  //   CHECK-DAG:   %[[C1:.+]] = arith.constant 1 : index
+  //   CHECK-DAG:   %[[D0:.+]] = memref.dim %[[INPUT]], %[[C0]]
+  //   CHECK-DAG:   %[[D1:.+]] = memref.dim %[[INPUT]], %[[C1]]
+  //   CHECK-DAG:   %[[NEG_INF:.+]] = arith.constant 0xFF800000 : f32
+  //   CHECK-DAG:   %[[ZERO:.+]] = arith.constant 0.000000e+00 : f32
+  // The softmax dimension is only iterated by the two passes over each row.
+  //       CHECK:   scf.for %[[I:.+]] = %[[C0]] to %[[D0]] step %[[C1]]
+  //   CHECK-NOT:     scf.for %{{[a-zA-Z0-9_]+}} = %[[C0]] to %[[D1]] step %[[C1]] {
+  //   CHECK-NOT:     scf.if
+  //       CHECK:     %[[STATS:.+]]:2 = scf.for %[[K:.+]] = %[[C0]] to %[[D1]] step %[[C1]]
+  //  CHECK-SAME:         iter_args(%[[MAX:.+]] = %[[NEG_INF]], %[[SUM:.+]] = %[[ZERO]])
+  //       CHECK:       %[[X:.+]] = memref.load %[[INPUT]][%[[I]], %[[K]]]
+  //       CHECK:       %[[NEW_MAX:.+]] = arith.maxf %[[MAX]], %[[X]]
+  //       CHECK:       %[[DELTA:.+]] = arith.subf %[[MAX]], %[[NEW_MAX]]
+  //       CHECK:       %[[RESCALE:.+]] = math.exp %[[DELTA]]
+  //       CHECK:       %[[SHIFTED:.+]] = arith.subf %[[X]], %[[NEW_MAX]]
+  //       CHECK:       %[[TERM:.+]] = math.exp %[[SHIFTED]]
+  //       CHECK:       %[[SCALED:.+]] = arith.mulf %[[SUM]], %[[RESCALE]]
+  //       CHECK:       %[[UPDATED_SUM:.+]] = arith.addf %[[SCALED]], %[[TERM]]
+  //       CHECK:       %[[ALL_NEG_INF:.+]] = arith.cmpf oeq, %[[NEW_MAX]], %[[NEG_INF]]
+  //       CHECK:       %[[NEW_SUM:.+]] = arith.select %[[ALL_NEG_INF]], %[[ZERO]], %[[UPDATED_SUM]]
+  //       CHECK:       scf.yield %[[NEW_MAX]], %[[NEW_SUM]]
+  //       CHECK:     scf.for %[[L:.+]] = %[[C0]] to %[[D1]] step %[[C1]]
+  //       CHECK:       %[[Y:.+]] = memref.load %[[INPUT]][%[[I]], %[[L]]]
+  //       CHECK:       %[[Y_SHIFTED:.+]] = arith.subf %[[Y]], %[[STATS]]#0
+  //       CHECK:       %[[EXP:.+]] = math.exp %[[Y_SHIFTED]]
+  //       CHECK:       %[[NORMALIZED:.+]] = arith.divf %[[EXP]], %[[STATS]]#1
+  //       CHECK:       memref.store %[[NORMALIZED]], %[[OUTPUT]][%[[I]], %[[L]]]
+
+  pdl.pattern @match_iree_linalg_ext_softmax : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.softmax"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_softmax
+    rewrite_iree_linalg_ext_to_loops %0
+  }
+}
@@ -0,0 +1,108 @@
+// RUN: mlir-proto-opt %s  -linalg-interp-transforms -split-input-file | FileCheck %s
+
+#map0 = affine_map<()[s0] -> (64 ceildiv s0)>
+#map1 = affine_map<(d0)[s0] -> (d0 * s0)>
+#map2 = affine_map<(d0)[s0] -> (-(d0 * s0) + 64, s0)>
+#map3 = affine_map<(d0) -> (d0)>
+
+module {
+  // CHECK-LABEL: func @fuse_into_in_parallel
+  //  CHECK-SAME:   %[[CHUNK_SIZE:[0-9a-z]+]]: index
+  //  CHECK-SAME:   %[[IN:[0-9a-z]+]]: tensor<64xf32>
+  //  CHECK-SAME:   %[[OUT:[0-9a-z]+]]: tensor<64xf32>
+  //  CHECK-SAME:   %[[BIAS:[0-9a-z]+]]: tensor<64xf32>
+  //  CHECK-SAME:   %[[INIT:[0-9a-z]+]]: tensor<64xf32>
+  func @fuse_into_in_parallel(%arg0: index, %in: tensor<64xf32>, %out: tensor<64xf32>,
+                              %bias: tensor<64xf32>, %init: tensor<64xf32>) -> tensor<64xf32> {
+    %0 = affine.apply #map0()[%arg0]
+    // CHECK: %[[RES:.*]] = iree_linalg_ext.in_parallel %{{.*}} -> (tensor<64xf32>) {
+    %1 = iree_linalg_ext.in_parallel %0  -> (tensor<64xf32>) {
+    ^bb0(%arg1: index):
+      // CHECK:    %[[OFFSET:.*]] = affine.apply
+      // CHECK:    %[[SIZE:.*]] = affine.min
+      // CHECK:    %[[T:.*]] = linalg.elemwise_unary
+      %2 = affine.apply #map1(%arg1)[%arg0]
+      %3 = affine.min #map2(%arg1)[%arg0]
+      %4 = tensor.extract_slice %in[%2] [%3] [1] : tensor<64xf32> to tensor<?xf32>
+      %5 = tensor.extract_slice %out[%2] [%3] [1] : tensor<64xf32> to tensor<?xf32>
+      %6 = linalg.elemwise_unary ins(%4 : tensor<?xf32>) outs(%5 : tensor<?xf32>) -> tensor<?xf32>
+
+      // CHECK:    %[[INIT_SLICE:.*]] = tensor.extract_slice %[[INIT]][%[[OFFSET]]] [%[[SIZE]]] [{{.*}}]
+      // CHECK:    %[[BIAS_SLICE:.*]] = tensor.extract_slice %[[BIAS]][%[[OFFSET]]] [%[[SIZE]]] [{{.*}}]
+      // CHECK:    %[[R:.*]] = linalg.generic
+      // CHECK-SAME:   ins(%[[T]], %[[BIAS_SLICE]] : tensor<?xf32>, tensor<?xf32>) outs(%[[INIT_SLICE]] : tensor<?xf32>)
+      // CHECK:    iree_linalg_ext.perform_concurrently {
+      // CHECK-NEXT: iree_linalg_ext.parallel_insert_slice %[[R]] into %[[INIT]][%[[OFFSET]]] [%[[SIZE]]] [{{.*}}]
+      // CHECK-NEXT: }
+      iree_linalg_ext.perform_concurrently {
+        iree_linalg_ext.parallel_insert_slice %6 into %out[%2] [%3] [1] : tensor<?xf32> into tensor<64xf32>
+      }
+    }
+    %7 = linalg.generic {
+      indexing_maps = [#map3, #map3, #map3],
+      iterator_types = ["parallel"]
+    } ins(%1, %bias : tensor<64xf32>, tensor<64xf32>) outs(%init : tensor<64xf32>) {
+    ^bb0(%arg2: f32, %arg3: f32, %arg4: f32):
+      %8 = arith.addf %arg2, %arg3 : f32
+      linalg.yield %8 : f32
+    } -> tensor<64xf32>
+    // CHECK: return %[[RES]]
+    return %7 : tensor<64xf32>
+  }
+
+  pdl.pattern @match_generic : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "linalg.generic"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_generic
+    %1 = fuse_consumer_into_iree_linalg_ext_loop %0
+  }
+}
+
+// -----
+
+module {
+  // CHECK-LABEL: func @fuse_into_tile
+  //  CHECK-SAME:   %[[CHUNK_SIZE:[0-9a-z]+]]: index
+  //  CHECK-SAME:   %[[IN:[0-9a-z]+]]: tensor<?xf32>
+  //  CHECK-SAME:   %[[OUT:[0-9a-z]+]]: tensor<?xf32>
+  //  CHECK-SAME:   %[[INIT:[0-9a-z]+]]: tensor<?xf32>
+  func @fuse_into_tile(%chunk_size: index, %in: tensor<?xf32>, %out: tensor<?xf32>,
+                       %init: tensor<?xf32>) -> (tensor<?xf32>, tensor<?xf32>) {
+    // CHECK: %[[RES:.*]]:2 = iree_linalg_ext.tile %[[CHUNK_SIZE]] outs(%[[OUT]]: tensor<?xf32>, %[[INIT]]: tensor<?xf32>) -> (tensor<?xf32>, tensor<?xf32>) {
+    // CHECK: ^bb0(%[[OFFSET:.*]]: index, %[[SIZE:.*]]: index, %[[O:.*]]: tensor<?xf32>, %[[I:.*]]: tensor<?xf32>):
+    %0 = iree_linalg_ext.tile %chunk_size outs(%out: tensor<?xf32>) -> (tensor<?xf32>) {
+    ^bb0(%offset: index, %size: index, %st1: tensor<?xf32>):
+      // CHECK:   %[[T:.*]] = linalg.elemwise_unary {{.*}}outs(%[[O]] : tensor<?xf32>)
+      // CHECK:   %[[R:.*]] = linalg.generic {{.*}}ins(%[[T]] : tensor<?xf32>) outs(%[[I]] : tensor<?xf32>)
+      // CHECK:   iree_linalg_ext.tile_yield %[[T]], %[[R]] : tensor<?xf32>, tensor<?xf32>
+      %1 = tensor.extract_slice %in[%offset][%size][1] : tensor<?xf32> to tensor<?xf32>
+      %2 = linalg.elemwise_unary ins(%1 : tensor<?xf32>) outs(%st1 : tensor<?xf32>) -> tensor<?xf32>
+      iree_linalg_ext.tile_yield %2: tensor<?xf32>
+    }
+    %3 = linalg.generic {
+      indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>],
+      iterator_types = ["parallel"]
+    } ins(%0 : tensor<?xf32>) outs(%init : tensor<?xf32>) {
+    ^bb0(%arg0: f32, %arg1: f32):
+      %4 = arith.negf %arg0 : f32
+      linalg.yield %4 : f32
+    } -> tensor<?xf32>
+    // CHECK: return %[[RES]]#0, %[[RES]]#1
+    return %0, %3 : tensor<?xf32>, tensor<?xf32>
+  }
+
+  pdl.pattern @match_generic : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "linalg.generic"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_generic
+    %1 = fuse_consumer_into_iree_linalg_ext_loop %0
+  }
+}
@@ -22,15 +22,27 @@ module {
     %1 = affine.apply #map0(%0)[%arg0]
 
     // CHECK: %[[M:.*]] = memref.dim %{{.*}}, %{{.*}} : memref<?xf32>
-    // CHECK: %[[group:.*]] = async.create_group {{.*}}: !async.group 
-    // CHECK: scf.for %[[IV:.*]] = {{.*}} 
-    // CHECK:   %[[token:.*]] = async.execute {
-    // CHECK:     subview
-    // CHECK:     subview
-    // CHECK:     linalg.generic
+    // CHECK: math.sqrt
+    // CHECK: math.ceil
+    // CHECK: %[[FAN_OUT:.*]] = arith.maxsi
+    // CHECK: %[[NUM_SPAWNERS:.*]] = affine.apply {{.*}}%[[FAN_OUT]]
+    // CHECK: %[[group:.*]] = async.create_group {{.*}}: !async.group
+    // CHECK: scf.for %{{.*}} = %{{.*}} to %[[NUM_SPAWNERS]]
+    // CHECK:   %[[spawner_token:.*]] = async.execute {
+    // CHECK:     scf.for %{{.*}} = %{{.*}} to %{{.*}}
+    // CHECK:       %[[token:.*]] = async.execute {
+    // CHECK:         scf.for %[[IV:.*]] = %{{.*}} to %{{.*}}
+    // CHECK:           subview
+    // CHECK:           subview
+    // CHECK:           linalg.generic
+    // CHECK:         }
+    // CHECK:         async.yield
+    // CHECK:       }
+    // CHECK:       async.add_to_group %[[token]], %[[group]] : !async.token
+    // CHECK:     }
     // CHECK:     async.yield
     // CHECK:   }
-    // CHECK:   async.add_to_group %[[token]], %[[group]] : !async.token
+    // CHECK:   async.add_to_group %[[spawner_token]], %[[group]] : !async.token
     // CHECK: }
     // CHECK: async.await_all %[[group]]
     iree_linalg_ext.in_parallel %1 -> () {
@@ -66,3 +78,240 @@ module {
     %1 = rewrite_iree_linalg_ext_in_parallel_to_async %0
   }
 }
+
+// -----
+
+#map0 = affine_map<(d0)[s0] -> (d0 * s0)>
+#map1 = affine_map<(d0) -> (d0)>
+
+module {
+  // CHECK-LABEL: func @blocked
+  //  CHECK-SAME:   %[[NUM_THREADS:[0-9a-z]+]]: index
+  func @blocked(%num_threads: index, %arg0: memref<?xf32>) {
+    %cst = arith.constant 4.200000e+01 : f32
+    // CHECK: affine.apply {{.*}}%[[NUM_THREADS]]
+    // CHECK: async.create_group
+    // CHECK: scf.for
+    // CHECK:   async.execute {
+    // CHECK:     scf.for %[[BLOCK:.*]] =
+    // CHECK:       async.execute {
+    // CHECK:         %[[BEGIN:.*]] = affine.apply {{.*}}(%[[BLOCK]])
+    // CHECK:         %[[END:.*]] = affine.min {{.*}}%[[NUM_THREADS]]
+    // CHECK:         scf.for %[[IV:.*]] = %[[BEGIN]] to %[[END]]
+    // CHECK:           memref.store %{{.*}}, %{{.*}}[%[[IV]]]
+    // CHECK: async.await_all
+    iree_linalg_ext.in_parallel %num_threads -> () {
+      ^bb0(%arg1: index):  // no predecessors
+        memref.store %cst, %arg0[%arg1] : memref<?xf32>
+        iree_linalg_ext.perform_concurrently {
+        }
+    }
+    return
+  }
+
+  pdl.pattern @match_iree_linalg_ext_in_parallel : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.in_parallel"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_in_parallel
+    %1 = rewrite_iree_linalg_ext_in_parallel_to_async %0 {block_size = 16}
+  }
+}
+
+// -----
+
+module {
+  // CHECK-LABEL: func @nested
+  //  CHECK-SAME:   %[[M:[0-9a-z]+]]: index
+  //  CHECK-SAME:   %[[N:[0-9a-z]+]]: index
+  //  CHECK-SAME:   %[[ARG:[0-9a-z]+]]: memref<?x?xf32>
+  func @nested(%m: index, %n: index, %arg0: memref<?x?xf32>) {
+    %cst = arith.constant 4.200000e+01 : f32
+    // CHECK: %[[NUM_THREADS:.*]] = arith.muli %[[M]], %[[N]] : index
+    // CHECK: async.create_group
+    // CHECK: scf.for
+    // CHECK:   async.execute {
+    // CHECK:     scf.for
+    // CHECK:       async.execute {
+    // CHECK:         scf.for %[[IV:.*]] = %{{.*}} to %{{.*}}
+    // CHECK:           %[[I:.*]] = arith.divui %[[IV]], %[[N]] : index
+    // CHECK:           %[[J:.*]] = arith.remui %[[IV]], %[[N]] : index
+    // CHECK:           memref.store %{{.*}}, %[[ARG]][%[[I]], %[[J]]]
+    // CHECK-NOT: iree_linalg_ext.in_parallel
+    // CHECK: async.await_all
+    iree_linalg_ext.in_parallel %m -> () {
+      ^bb0(%arg1: index):  // no predecessors
+        iree_linalg_ext.in_parallel %n -> () {
+          ^bb0(%arg2: index):  // no predecessors
+            memref.store %cst, %arg0[%arg1, %arg2] : memref<?x?xf32>
+            iree_linalg_ext.perform_concurrently {
+            }
+        }
+        iree_linalg_ext.perform_concurrently {
+        }
+    }
+    return
+  }
+
+  pdl.pattern @match_iree_linalg_ext_in_parallel : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.in_parallel"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_in_parallel
+    %1 = rewrite_iree_linalg_ext_in_parallel_to_async %0
+  }
+}
+
+// -----
+
+module {
+  // A nested InParallelOp with a dynamic schedule is not flattened, it is
+  // rewritten on its own within the tasks of its parent.
+  // CHECK-LABEL: func @nested_dynamic
+  //  CHECK-SAME:   %[[M:[0-9a-z]+]]: index
+  //  CHECK-SAME:   %[[N:[0-9a-z]+]]: index
+  //  CHECK-SAME:   %[[ARG:[0-9a-z]+]]: memref<?x?xf32>
+  func @nested_dynamic(%m: index, %n: index, %arg0: memref<?x?xf32>) {
+    %cst = arith.constant 4.200000e+01 : f32
+    // CHECK-NOT: arith.muli %[[M]], %[[N]]
+    // CHECK: async.create_group
+    // CHECK: scf.for
+    // CHECK:   async.execute {
+    // CHECK:     scf.for
+    // CHECK:       async.execute {
+    // CHECK:         scf.for %[[I:.*]] = %{{.*}} to %{{.*}}
+    // CHECK:           %[[COUNTER:.*]] = memref.alloc() : memref<i64>
+    // CHECK:           async.create_group
+    // CHECK:           scf.while
+    // CHECK:             memref.atomic_rmw addi %{{.*}}, %[[COUNTER]][]
+    // CHECK:             scf.for %[[J:.*]] = %{{.*}} to %{{.*}}
+    // CHECK:               memref.store %{{.*}}, %[[ARG]][%[[I]], %[[J]]]
+    // CHECK:           async.await_all
+    // CHECK:           memref.dealloc %[[COUNTER]] : memref<i64>
+    // CHECK-NOT: iree_linalg_ext.in_parallel
+    // CHECK: async.await_all
+    iree_linalg_ext.in_parallel %m -> () {
+      ^bb0(%arg1: index):  // no predecessors
+        iree_linalg_ext.in_parallel %n -> () {
+          ^bb0(%arg2: index):  // no predecessors
+            memref.store %cst, %arg0[%arg1, %arg2] : memref<?x?xf32>
+            iree_linalg_ext.perform_concurrently {
+            }
+        } {chunk_size = 4, schedule = "dynamic"}
+        iree_linalg_ext.perform_concurrently {
+        }
+    }
+    return
+  }
+
+  pdl.pattern @match_iree_linalg_ext_in_parallel : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.in_parallel"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_in_parallel
+    %1 = rewrite_iree_linalg_ext_in_parallel_to_async %0
+  }
+}
+
+// -----
+
+module {
+  // CHECK-LABEL: func @dynamic
+  //  CHECK-SAME:   %[[NUM_THREADS:[0-9a-z]+]]: index
+  func @dynamic(%num_threads: index, %arg0: memref<?xf32>) {
+    %cst = arith.constant 4.200000e+01 : f32
+    // CHECK: %[[COUNTER:.*]] = memref.alloc() : memref<i64>
+    // CHECK: memref.store %{{.*}}, %[[COUNTER]][] : memref<i64>
+    // CHECK: async.create_group
+    // CHECK: scf.for
+    // CHECK:   async.execute {
+    // CHECK:     scf.for
+    // CHECK:       async.execute {
+    // CHECK:         scf.while
+    // CHECK:           %[[BEGIN:.*]] = memref.atomic_rmw addi %{{.*}}, %[[COUNTER]][] : (i64, memref<i64>) -> i64
+    // CHECK:           %[[CLAIMED:.*]] = arith.cmpi slt, %[[BEGIN]]
+    // CHECK:           scf.condition(%[[CLAIMED]]) %[[BEGIN]]
+    // CHECK:         } do {
+    // CHECK:         ^bb0(%[[B:.*]]: i64, %[[E:.*]]: i64):
+    // CHECK:           %[[LB:.*]] = arith.index_cast %[[B]] : i64 to index
+    // CHECK:           %[[UB:.*]] = arith.index_cast %[[E]] : i64 to index
+    // CHECK:           scf.for %[[IV:.*]] = %[[LB]] to %[[UB]]
+    // CHECK:             memref.store %{{.*}}, %{{.*}}[%[[IV]]]
+    // CHECK: async.await_all
+    // CHECK: memref.dealloc %[[COUNTER]] : memref<i64>
+    iree_linalg_ext.in_parallel %num_threads -> () {
+      ^bb0(%arg1: index):  // no predecessors
+        memref.store %cst, %arg0[%arg1] : memref<?xf32>
+        iree_linalg_ext.perform_concurrently {
+        }
+    } {chunk_size = 4, schedule = "dynamic"}
+    return
+  }
+
+  pdl.pattern @match_iree_linalg_ext_in_parallel : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.in_parallel"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_in_parallel
+    %1 = rewrite_iree_linalg_ext_in_parallel_to_async %0 {block_size = 16}
+  }
+}
+
+// -----
+
+module {
+  // CHECK-LABEL: func @guided
+  func @guided(%num_threads: index, %arg0: memref<?xf32>) {
+    %cst = arith.constant 4.200000e+01 : f32
+    // CHECK: %[[COUNTER:.*]] = memref.alloc() : memref<i64>
+    // CHECK: async.execute {
+    // CHECK:   async.execute {
+    // CHECK:     scf.while
+    // CHECK:       %[[BEGIN:.*]] = memref.generic_atomic_rmw %[[COUNTER]][] : memref<i64> {
+    // CHECK:       ^bb0(%[[CURRENT:.*]]: i64):
+    // CHECK:         %[[REMAINING:.*]] = arith.subi %{{.*}}, %[[CURRENT]] : i64
+    // CHECK:         %[[SHARE:.*]] = arith.ceildivsi %[[REMAINING]], %{{.*}} : i64
+    // CHECK:         %[[SIZE:.*]] = arith.maxsi %[[SHARE]], %{{.*}} : i64
+    // CHECK:         %[[NEXT:.*]] = arith.addi %[[CURRENT]], %[[SIZE]] : i64
+    // CHECK:         %[[END:.*]] = arith.minsi %[[NEXT]], %{{.*}} : i64
+    // CHECK:         memref.atomic_yield %[[END]] : i64
+    // CHECK:       }
+    // CHECK:       arith.cmpi slt, %[[BEGIN]]
+    // CHECK:       scf.condition
+    // CHECK:     } do {
+    // CHECK:       scf.for
+    // CHECK:         memref.store
+    // CHECK: async.await_all
+    // CHECK: memref.dealloc %[[COUNTER]] : memref<i64>
+    iree_linalg_ext.in_parallel %num_threads -> () {
+      ^bb0(%arg1: index):  // no predecessors
+        memref.store %cst, %arg0[%arg1] : memref<?xf32>
+        iree_linalg_ext.perform_concurrently {
+        }
+    } {schedule = "guided"}
+    return
+  }
+
+  pdl.pattern @match_iree_linalg_ext_in_parallel : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.in_parallel"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_in_parallel
+    %1 = rewrite_iree_linalg_ext_in_parallel_to_async %0 {block_size = 16}
+  }
+}
@@ -406,6 +406,176 @@ func @reverse_dup_dims(%arg0: tensor<3x5xi32>) -> tensor<3x5xi32> {
 
 // -----
 
+func @topk_invalid_dimension(%input_values: tensor<2x10xf32>, %out_values: tensor<2x3xf32>, %out_indices: tensor<2x3xi32>) -> (tensor<2x3xf32>, tensor<2x3xi32>) {
+  // expected-error@+1 {{dimension must be within [0, 2)}}
+  %0:2 = iree_linalg_ext.topk
+        dimension(2)
+        ins(%input_values : tensor<2x10xf32>)
+        outs(%out_values, %out_indices : tensor<2x3xf32>, tensor<2x3xi32>) {
+        ^bb0(%arg0: f32, %arg1: f32):  // no predecessors
+          %0 = arith.cmpf ogt, %arg0, %arg1 : f32
+          iree_linalg_ext.yield %0 : i1
+        } -> tensor<2x3xf32>, tensor<2x3xi32>
+  return %0#0, %0#1 : tensor<2x3xf32>, tensor<2x3xi32>
+}
+
+// -----
+
+func @topk_invalid_indices_type(%input_values: tensor<2x10xf32>, %out_values: tensor<2x3xf32>, %out_indices: tensor<2x3xi64>) -> (tensor<2x3xf32>, tensor<2x3xi64>) {
+  // expected-error@+1 {{expected output indices to be of type i32}}
+  %0:2 = iree_linalg_ext.topk
+        dimension(1)
+        ins(%input_values : tensor<2x10xf32>)
+        outs(%out_values, %out_indices : tensor<2x3xf32>, tensor<2x3xi64>) {
+        ^bb0(%arg0: f32, %arg1: f32):  // no predecessors
+          %0 = arith.cmpf ogt, %arg0, %arg1 : f32
+          iree_linalg_ext.yield %0 : i1
+        } -> tensor<2x3xf32>, tensor<2x3xi64>
+  return %0#0, %0#1 : tensor<2x3xf32>, tensor<2x3xi64>
+}
+
+// -----
+
+func @topk_mismatch_batch(%input_values: tensor<2x10xf32>, %out_values: tensor<3x3xf32>, %out_indices: tensor<3x3xi32>) -> (tensor<3x3xf32>, tensor<3x3xi32>) {
+  // expected-error@+1 {{incompatible input/output shapes}}
+  %0:2 = iree_linalg_ext.topk
+        dimension(1)
+        ins(%input_values : tensor<2x10xf32>)
+        outs(%out_values, %out_indices : tensor<3x3xf32>, tensor<3x3xi32>) {
+        ^bb0(%arg0: f32, %arg1: f32):  // no predecessors
+          %0 = arith.cmpf ogt, %arg0, %arg1 : f32
+          iree_linalg_ext.yield %0 : i1
+        } -> tensor<3x3xf32>, tensor<3x3xi32>
+  return %0#0, %0#1 : tensor<3x3xf32>, tensor<3x3xi32>
+}
+
+// -----
+
+func @topk_invalid_region(%input_values: tensor<2x10xf32>, %out_values: tensor<2x3xf32>, %out_indices: tensor<2x3xi32>) -> (tensor<2x3xf32>, tensor<2x3xi32>) {
+  // expected-error@+1 {{region block argument #1 should be of type 'f32' but got 'i32'}}
+  %0:2 = iree_linalg_ext.topk
+        dimension(1)
+        ins(%input_values : tensor<2x10xf32>)
+        outs(%out_values, %out_indices : tensor<2x3xf32>, tensor<2x3xi32>) {
+        ^bb0(%arg0: f32, %arg1: i32):  // no predecessors
+          %0 = arith.constant true
+          iree_linalg_ext.yield %0 : i1
+        } -> tensor<2x3xf32>, tensor<2x3xi32>
+  return %0#0, %0#1 : tensor<2x3xf32>, tensor<2x3xi32>
+}
+
+// -----
+
+func @softmax_invalid_dimension(%input: tensor<2x10xf32>, %output: tensor<2x10xf32>) -> tensor<2x10xf32> {
+  // expected-error@+1 {{dimension must be within [0, 2)}}
+  %0 = iree_linalg_ext.softmax
+        dimension(2)
+        ins(%input : tensor<2x10xf32>)
+        outs(%output : tensor<2x10xf32>) -> tensor<2x10xf32>
+  return %0 : tensor<2x10xf32>
+}
+
+// -----
+
+func @softmax_invalid_element_type(%input: tensor<2x10xi32>, %output: tensor<2x10xi32>) -> tensor<2x10xi32> {
+  // expected-error@+1 {{expected input element type to be a float type}}
+  %0 = iree_linalg_ext.softmax
+        dimension(1)
+        ins(%input : tensor<2x10xi32>)
+        outs(%output : tensor<2x10xi32>) -> tensor<2x10xi32>
+  return %0 : tensor<2x10xi32>
+}
+
+// -----
+
+func @softmax_incompatible_shapes(%input: tensor<2x10xf32>, %output: tensor<2x9xf32>) -> tensor<2x9xf32> {
+  // expected-error@+1 {{incompatible input/output shapes}}
+  %0 = iree_linalg_ext.softmax
+        dimension(1)
+        ins(%input : tensor<2x10xf32>)
+        outs(%output : tensor<2x9xf32>) -> tensor<2x9xf32>
+  return %0 : tensor<2x9xf32>
+}
+
+// -----
+
+func @winograd_invalid_output_tile_size(%input: tensor<1x10x10x8xf32>, %output: tensor<5x5x1x3x3x8xf32>) -> tensor<5x5x1x3x3x8xf32> {
+  // expected-error@+1 {{expected output_tile_size to be 2 or 4}}
+  %0 = iree_linalg_ext.winograd.input_transform
+        output_tile_size(3)
+        ins(%input : tensor<1x10x10x8xf32>)
+        outs(%output : tensor<5x5x1x3x3x8xf32>) -> tensor<5x5x1x3x3x8xf32>
+  return %0 : tensor<5x5x1x3x3x8xf32>
+}
+
+// -----
+
+func @winograd_invalid_input_tiles(%input: tensor<1x10x10x8xf32>, %output: tensor<6x6x1x3x3x8xf32>) -> tensor<6x6x1x3x3x8xf32> {
+  // expected-error@+1 {{incompatible input/output shapes}}
+  %0 = iree_linalg_ext.winograd.input_transform
+        output_tile_size(4)
+        ins(%input : tensor<1x10x10x8xf32>)
+        outs(%output : tensor<6x6x1x3x3x8xf32>) -> tensor<6x6x1x3x3x8xf32>
+  return %0 : tensor<6x6x1x3x3x8xf32>
+}
+
+// -----
+
+func @winograd_invalid_kernel(%filter: tensor<5x5x8x16xf32>, %output: tensor<6x6x8x16xf32>) -> tensor<6x6x8x16xf32> {
+  // expected-error@+1 {{expected a static 3x3 kernel}}
+  %0 = iree_linalg_ext.winograd.filter_transform
+        output_tile_size(4)
+        ins(%filter : tensor<5x5x8x16xf32>)
+        outs(%output : tensor<6x6x8x16xf32>) -> tensor<6x6x8x16xf32>
+  return %0 : tensor<6x6x8x16xf32>
+}
+
+// -----
+
+func @winograd_invalid_leading_dims(%input: tensor<4x4x1x2x2x16xf32>, %output: tensor<1x8x8x16xf32>) -> tensor<1x8x8x16xf32> {
+  // expected-error@+1 {{expected the two leading input dimensions to be 6}}
+  %0 = iree_linalg_ext.winograd.output_transform
+        output_tile_size(4)
+        ins(%input : tensor<4x4x1x2x2x16xf32>)
+        outs(%output : tensor<1x8x8x16xf32>) -> tensor<1x8x8x16xf32>
+  return %0 : tensor<1x8x8x16xf32>
+}
+
+// -----
+
+func @pack_missing_padding(%input: tensor<13x16xf32>, %output: tensor<2x16x8xf32>) -> tensor<2x16x8xf32> {
+  // expected-error@+1 {{expected a padding value when the inner tiles do not divide the input}}
+  %0 = iree_linalg_ext.pack
+        inner_dims_pos = [0] inner_tiles = [8]
+        ins(%input : tensor<13x16xf32>)
+        outs(%output : tensor<2x16x8xf32>) -> tensor<2x16x8xf32>
+  return %0 : tensor<2x16x8xf32>
+}
+
+// -----
+
+func @pack_invalid_perm(%input: tensor<16x16xf32>, %output: tensor<2x16x8xf32>) -> tensor<2x16x8xf32> {
+  // expected-error@+1 {{expected outer_dims_perm to be a permutation of the unpacked dimensions}}
+  %0 = iree_linalg_ext.pack outer_dims_perm = [0, 0]
+        inner_dims_pos = [0] inner_tiles = [8]
+        ins(%input : tensor<16x16xf32>)
+        outs(%output : tensor<2x16x8xf32>) -> tensor<2x16x8xf32>
+  return %0 : tensor<2x16x8xf32>
+}
+
+// -----
+
+func @unpack_incompatible_shapes(%input: tensor<2x16x4xf32>, %output: tensor<16x16xf32>) -> tensor<16x16xf32> {
+  // expected-error@+1 {{incompatible packed/unpacked shapes}}
+  %0 = iree_linalg_ext.unpack
+        inner_dims_pos = [0] inner_tiles = [8]
+        ins(%input : tensor<2x16x4xf32>)
+        outs(%output : tensor<16x16xf32>) -> tensor<16x16xf32>
+  return %0 : tensor<16x16xf32>
+}
+
+// -----
+
 func @not_enough_results() -> () {
   %num_threads = arith.constant 100 : index
   // expected-error@+1 {{'iree_linalg_ext.in_parallel' op produces 1 results, but its terminator yields 0 values}}
@@ -446,3 +616,25 @@ func @type_mismatch(%1 : tensor<1xf32>, %out : tensor<200xf32>) -> () {
       }
   }
 }
+
+// -----
+
+func @unknown_schedule(%num_threads: index) -> () {
+  // expected-error@+1 {{'iree_linalg_ext.in_parallel' op expected schedule to be one of 'static', 'dynamic' or 'guided', got 'affinity'}}
+  iree_linalg_ext.in_parallel %num_threads -> () {
+    ^bb0(%thread_idx : index):
+      iree_linalg_ext.perform_concurrently {}
+  } {schedule = "affinity"}
+  return
+}
+
+// -----
+
+func @static_schedule_chunk_size(%num_threads: index) -> () {
+  // expected-error@+1 {{'iree_linalg_ext.in_parallel' op expected chunk_size to only be specified with the 'dynamic' or 'guided' schedules}}
+  iree_linalg_ext.in_parallel %num_threads -> () {
+    ^bb0(%thread_idx : index):
+      iree_linalg_ext.perform_concurrently {}
+  } {chunk_size = 4}
+  return
+}
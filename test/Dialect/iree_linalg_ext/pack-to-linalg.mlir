@@ -0,0 +1,110 @@
+// RUN: mlir-proto-opt %s -linalg-interp-transforms --split-input-file | FileCheck %s
+
+// CHECK-DAG: #[[$ID_MAP:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+// CHECK-DAG: #[[$PACK_MAP:.*]] = affine_map<(d0, d1, d2, d3) -> (d1, d2, d0, d3)>
+module {
+  // CHECK-LABEL: func @pack
+  //  CHECK-SAME:   %[[IN:[0-9a-z]+]]: tensor<13x15xf32>
+  //  CHECK-SAME:   %[[PAD:[0-9a-z]+]]: f32
+  //  CHECK-SAME:   %[[OUT:[0-9a-z]+]]: tensor<4x2x8x4xf32>
+  func @pack(%in: tensor<13x15xf32>, %pad: f32, %out: tensor<4x2x8x4xf32>) -> tensor<4x2x8x4xf32> {
+    // CHECK: %[[PADDED:.*]] = tensor.pad %[[IN]] low[0, 0] high[3, 1]
+    // CHECK:   tensor.yield %[[PAD]] : f32
+    // CHECK: tensor<13x15xf32> to tensor<16x16xf32>
+    // CHECK: %[[EXPANDED:.*]] = tensor.expand_shape %[[PADDED]] {{\[}}[0, 1], [2, 3]] : tensor<16x16xf32> into tensor<2x8x4x4xf32>
+    // CHECK: %[[RES:.*]] = linalg.generic
+    // CHECK-SAME: indexing_maps = [#[[$PACK_MAP]], #[[$ID_MAP]]]
+    // CHECK-SAME: iterator_types = ["parallel", "parallel", "parallel", "parallel"]
+    // CHECK-SAME: ins(%[[EXPANDED]] : tensor<2x8x4x4xf32>) outs(%[[OUT]] : tensor<4x2x8x4xf32>)
+    // CHECK: ^bb0(%[[X:.*]]: f32, %{{.*}}: f32):
+    // CHECK:   linalg.yield %[[X]] : f32
+    // CHECK-NOT: iree_linalg_ext.pack
+    // CHECK: return %[[RES]]
+    %0 = iree_linalg_ext.pack outer_dims_perm = [1, 0]
+          inner_dims_pos = [0, 1] inner_tiles = [8, 4]
+          ins(%in, %pad : tensor<13x15xf32>, f32)
+          outs(%out : tensor<4x2x8x4xf32>) -> tensor<4x2x8x4xf32>
+    return %0 : tensor<4x2x8x4xf32>
+  }
+
+  pdl.pattern @match_iree_linalg_ext_pack : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.pack"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_pack
+    %1 = rewrite_iree_linalg_ext_pack_to_linalg %0
+  }
+}
+
+// -----
+
+// CHECK-DAG: #[[$ID_MAP:.*]] = affine_map<(d0, d1, d2) -> (d0, d1, d2)>
+// CHECK-DAG: #[[$UNPACK_MAP:.*]] = affine_map<(d0, d1, d2) -> (d0, d2, d1)>
+module {
+  // The inner tiles divide the output: the transposition writes into it.
+  // CHECK-LABEL: func @unpack_divisible
+  //  CHECK-SAME:   %[[IN:[0-9a-z]+]]: tensor<4x32x16xf32>
+  //  CHECK-SAME:   %[[OUT:[0-9a-z]+]]: tensor<64x32xf32>
+  func @unpack_divisible(%in: tensor<4x32x16xf32>, %out: tensor<64x32xf32>) -> tensor<64x32xf32> {
+    // CHECK: %[[INIT:.*]] = tensor.expand_shape %[[OUT]] {{\[}}[0, 1], [2]] : tensor<64x32xf32> into tensor<4x16x32xf32>
+    // CHECK: %[[T:.*]] = linalg.generic
+    // CHECK-SAME: indexing_maps = [#[[$ID_MAP]], #[[$UNPACK_MAP]]]
+    // CHECK-SAME: ins(%[[IN]] : tensor<4x32x16xf32>) outs(%[[INIT]] : tensor<4x16x32xf32>)
+    // CHECK: %[[RES:.*]] = tensor.collapse_shape %[[T]] {{\[}}[0, 1], [2]] : tensor<4x16x32xf32> into tensor<64x32xf32>
+    // CHECK-NOT: iree_linalg_ext.unpack
+    // CHECK: return %[[RES]]
+    %0 = iree_linalg_ext.unpack
+          inner_dims_pos = [0] inner_tiles = [16]
+          ins(%in : tensor<4x32x16xf32>)
+          outs(%out : tensor<64x32xf32>) -> tensor<64x32xf32>
+    return %0 : tensor<64x32xf32>
+  }
+
+  pdl.pattern @match_iree_linalg_ext_unpack : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.unpack"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_unpack
+    %1 = rewrite_iree_linalg_ext_unpack_to_linalg %0
+  }
+}
+
+// -----
+
+// CHECK-DAG: #[[$ID_MAP:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+// CHECK-DAG: #[[$UNPACK_MAP:.*]] = affine_map<(d0, d1, d2, d3) -> (d1, d2, d0, d3)>
+module {
+  // CHECK-LABEL: func @unpack_padded
+  //  CHECK-SAME:   %[[IN:[0-9a-z]+]]: tensor<4x2x8x4xf32>
+  func @unpack_padded(%in: tensor<4x2x8x4xf32>, %out: tensor<13x15xf32>) -> tensor<13x15xf32> {
+    // CHECK: %[[INIT:.*]] = linalg.init_tensor [2, 8, 4, 4] : tensor<2x8x4x4xf32>
+    // CHECK: %[[T:.*]] = linalg.generic
+    // CHECK-SAME: indexing_maps = [#[[$ID_MAP]], #[[$UNPACK_MAP]]]
+    // CHECK-SAME: ins(%[[IN]] : tensor<4x2x8x4xf32>) outs(%[[INIT]] : tensor<2x8x4x4xf32>)
+    // CHECK: %[[COLLAPSED:.*]] = tensor.collapse_shape %[[T]] {{\[}}[0, 1], [2, 3]] : tensor<2x8x4x4xf32> into tensor<16x16xf32>
+    // CHECK: %[[RES:.*]] = tensor.extract_slice %[[COLLAPSED]][0, 0] [13, 15] [1, 1] : tensor<16x16xf32> to tensor<13x15xf32>
+    // CHECK: return %[[RES]]
+    %0 = iree_linalg_ext.unpack outer_dims_perm = [1, 0]
+          inner_dims_pos = [0, 1] inner_tiles = [8, 4]
+          ins(%in : tensor<4x2x8x4xf32>)
+          outs(%out : tensor<13x15xf32>) -> tensor<13x15xf32>
+    return %0 : tensor<13x15xf32>
+  }
+
+  pdl.pattern @match_iree_linalg_ext_unpack : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.unpack"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_unpack
+    %1 = rewrite_iree_linalg_ext_unpack_to_linalg %0
+  }
+}
@@ -0,0 +1,122 @@
+// RUN: mlir-proto-opt %s -linalg-interp-transforms --split-input-file | FileCheck %s
+
+module {
+  // CHECK-LABEL: func @static_matmul
+  //  CHECK-SAME:   %[[LHS:[a-zA-Z0-9]+]]: tensor<13x17xf32>
+  //  CHECK-SAME:   %[[RHS:[a-zA-Z0-9]+]]: tensor<17x7xf32>
+  //  CHECK-SAME:   %[[OUT:[a-zA-Z0-9]+]]: tensor<13x7xf32>
+  func @static_matmul(%lhs: tensor<13x17xf32>, %rhs: tensor<17x7xf32>,
+                      %out: tensor<13x7xf32>) -> tensor<13x7xf32> {
+    //  CHECK-NOT: scf.if
+    //      CHECK: %[[PLHS:.+]] = tensor.pad %[[LHS]] low[0, 0] high[3, 15]
+    //      CHECK:   : tensor<13x17xf32> to tensor<16x32xf32>
+    //      CHECK: %[[PRHS:.+]] = tensor.pad %[[RHS]] low[0, 0] high[15, 9]
+    //      CHECK:   : tensor<17x7xf32> to tensor<32x16xf32>
+    //      CHECK: %[[POUT:.+]] = tensor.pad %[[OUT]] low[0, 0] high[3, 9]
+    //      CHECK:   : tensor<13x7xf32> to tensor<16x16xf32>
+    //      CHECK: %[[MATMUL:.+]] = linalg.matmul
+    // CHECK-SAME:   ins(%[[PLHS]], %[[PRHS]] : tensor<16x32xf32>, tensor<32x16xf32>)
+    // CHECK-SAME:   outs(%[[POUT]] : tensor<16x16xf32>)
+    //      CHECK: %[[RES:.+]] = tensor.extract_slice %[[MATMUL]][0, 0] [13, 7] [1, 1]
+    //      CHECK: return %[[RES]]
+    %0 = linalg.matmul ins(%lhs, %rhs : tensor<13x17xf32>, tensor<17x7xf32>)
+                       outs(%out : tensor<13x7xf32>) -> tensor<13x7xf32>
+    return %0 : tensor<13x7xf32>
+  }
+
+  pdl.pattern @match_linalg_matmul : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "linalg.matmul"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_linalg_matmul
+    %1 = pad_contraction_to_block_size %0
+  }
+}
+
+// -----
+
+module {
+  // CHECK-LABEL: func @dynamic_matmul
+  //  CHECK-SAME:   %[[LHS:[a-zA-Z0-9]+]]: tensor<?x?xf32>
+  //  CHECK-SAME:   %[[RHS:[a-zA-Z0-9]+]]: tensor<?x?xf32>
+  //  CHECK-SAME:   %[[OUT:[a-zA-Z0-9]+]]: tensor<?x?xf32>
+  func @dynamic_matmul(%lhs: tensor<?x?xf32>, %rhs: tensor<?x?xf32>,
+                       %out: tensor<?x?xf32>) -> tensor<?x?xf32> {
+    //  CHECK-DAG: %[[ZERO:.+]] = arith.constant 0 : index
+    //  CHECK-DAG: %[[MASK:.+]] = arith.constant 15 : index
+    //      CHECK: %[[D0:.+]] = tensor.dim %[[LHS]], %[[ZERO]] : tensor<?x?xf32>
+    //      CHECK: %[[REM:.+]] = arith.andi %[[D0]], %[[MASK]] : index
+    //      CHECK: arith.cmpi eq, %[[REM]], %[[ZERO]] : index
+    //      CHECK: %[[ALIGNED:.+]] = arith.andi %{{.+}}, %{{.+}} : i1
+    //      CHECK: %[[RES:.+]] = scf.if %[[ALIGNED]] -> (tensor<?x?xf32>) {
+    //  CHECK-NOT:   tensor.pad
+    //      CHECK:   %[[FAST:.+]] = linalg.matmul
+    // CHECK-SAME:     ins(%[[LHS]], %[[RHS]] : tensor<?x?xf32>, tensor<?x?xf32>)
+    // CHECK-SAME:     outs(%[[OUT]] : tensor<?x?xf32>)
+    //      CHECK:   scf.yield %[[FAST]] : tensor<?x?xf32>
+    //      CHECK: } else {
+    //      CHECK:   %[[PLHS:.+]] = tensor.pad %[[LHS]]
+    //      CHECK:   %[[PRHS:.+]] = tensor.pad %[[RHS]]
+    //      CHECK:   %[[POUT:.+]] = tensor.pad %[[OUT]]
+    //      CHECK:   %[[SLOW:.+]] = linalg.matmul
+    // CHECK-SAME:     ins(%[[PLHS]], %[[PRHS]] : tensor<?x?xf32>, tensor<?x?xf32>)
+    // CHECK-SAME:     outs(%[[POUT]] : tensor<?x?xf32>)
+    //      CHECK:   %[[SLICE:.+]] = tensor.extract_slice %[[SLOW]][0, 0]
+    //      CHECK:   scf.yield %[[SLICE]] : tensor<?x?xf32>
+    //      CHECK: return %[[RES]]
+    %0 = linalg.matmul ins(%lhs, %rhs : tensor<?x?xf32>, tensor<?x?xf32>)
+                       outs(%out : tensor<?x?xf32>) -> tensor<?x?xf32>
+    return %0 : tensor<?x?xf32>
+  }
+
+  pdl.pattern @match_linalg_matmul : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "linalg.matmul"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_linalg_matmul
+    %1 = pad_contraction_to_block_size %0
+  }
+}
+
+// -----
+
+module {
+  // The K dimension is contiguous in the lhs and is aligned to 8 f32 lanes.
+
+  // CHECK-LABEL: func @vector_aligned_matmul
+  //  CHECK-SAME:   %[[LHS:[a-zA-Z0-9]+]]: tensor<8x12xf32>
+  //  CHECK-SAME:   %[[RHS:[a-zA-Z0-9]+]]: tensor<12x16xf32>
+  //  CHECK-SAME:   %[[OUT:[a-zA-Z0-9]+]]: tensor<8x16xf32>
+  func @vector_aligned_matmul(%lhs: tensor<8x12xf32>, %rhs: tensor<12x16xf32>,
+                              %out: tensor<8x16xf32>) -> tensor<8x16xf32> {
+    //      CHECK: %[[PLHS:.+]] = tensor.pad %[[LHS]] low[0, 0] high[0, 4]
+    //      CHECK:   : tensor<8x12xf32> to tensor<8x16xf32>
+    //      CHECK: %[[PRHS:.+]] = tensor.pad %[[RHS]] low[0, 0] high[4, 0]
+    //      CHECK:   : tensor<12x16xf32> to tensor<16x16xf32>
+    //  CHECK-NOT: tensor.pad
+    //      CHECK: %[[MATMUL:.+]] = linalg.matmul
+    // CHECK-SAME:   ins(%[[PLHS]], %[[PRHS]] : tensor<8x16xf32>, tensor<16x16xf32>)
+    // CHECK-SAME:   outs(%[[OUT]] : tensor<8x16xf32>)
+    //      CHECK: return %[[MATMUL]]
+    %0 = linalg.matmul ins(%lhs, %rhs : tensor<8x12xf32>, tensor<12x16xf32>)
+                       outs(%out : tensor<8x16xf32>) -> tensor<8x16xf32>
+    return %0 : tensor<8x16xf32>
+  }
+
+  pdl.pattern @match_linalg_matmul : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "linalg.matmul"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_linalg_matmul
+    %1 = pad_contraction_to_block_size %0 {row_alignment = 4, column_alignment = 4, vector_bit_width = 256}
+  }
+}
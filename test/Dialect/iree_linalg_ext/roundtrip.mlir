@@ -542,6 +542,209 @@ func @reverse_multi_dims(%arg0: tensor<3x5xi32>) -> tensor<3x5xi32> {
 
 // -----
 
+func @topk_tensor(%input_values: tensor<20x10xf32>, %input_indices: tensor<20x10xi32>) -> (tensor<20x3xf32>, tensor<20x3xi32>) {
+  %out_values = linalg.init_tensor [20, 3] : tensor<20x3xf32>
+  %out_indices = linalg.init_tensor [20, 3] : tensor<20x3xi32>
+  %0:2 = iree_linalg_ext.topk
+        dimension(1)
+        ins(%input_values, %input_indices : tensor<20x10xf32> , tensor<20x10xi32>)
+        outs(%out_values, %out_indices : tensor<20x3xf32>, tensor<20x3xi32>) {
+        ^bb0(%arg0: f32, %arg1: f32):  // no predecessors
+          %0 = arith.cmpf ogt, %arg0, %arg1 : f32
+          iree_linalg_ext.yield %0 : i1
+        } -> tensor<20x3xf32>, tensor<20x3xi32>
+  return %0#0, %0#1 : tensor<20x3xf32>, tensor<20x3xi32>
+}
+// CHECK-LABEL: func @topk_tensor
+//  CHECK-SAME:   %[[ARG0:[a-zA-Z0-9_]+]]: tensor<20x10xf32>
+//  CHECK-SAME:   %[[ARG1:[a-zA-Z0-9_]+]]: tensor<20x10xi32>
+//       CHECK:   %[[OUT_VALUES:.+]] = linalg.init_tensor [20, 3]
+//       CHECK:   %[[OUT_INDICES:.+]] = linalg.init_tensor [20, 3]
+//       CHECK:   %[[RESULT:.+]]:2 = iree_linalg_ext.topk
+//  CHECK-SAME:      dimension(1)
+//  CHECK-SAME:      ins(%[[ARG0]], %[[ARG1]]
+//  CHECK-SAME:      outs(%[[OUT_VALUES]], %[[OUT_INDICES]]
+//       CHECK:      iree_linalg_ext.yield
+//       CHECK:   return %[[RESULT]]#0, %[[RESULT]]#1
+
+// -----
+
+func @topk_memref(%input_values: memref<4x10xf32>, %out_values: memref<4x3xf32>, %out_indices: memref<4x3xi32>) {
+  iree_linalg_ext.topk
+        dimension(1)
+        ins(%input_values : memref<4x10xf32>)
+        outs(%out_values, %out_indices : memref<4x3xf32>, memref<4x3xi32>) {
+        ^bb0(%arg0: f32, %arg1: f32):  // no predecessors
+          %0 = arith.cmpf ogt, %arg0, %arg1 : f32
+          iree_linalg_ext.yield %0 : i1
+        }
+  return
+}
+// CHECK-LABEL: func @topk_memref
+//  CHECK-SAME:   %[[ARG0:[a-zA-Z0-9_]+]]: memref<4x10xf32>
+//  CHECK-SAME:   %[[ARG1:[a-zA-Z0-9_]+]]: memref<4x3xf32>
+//  CHECK-SAME:   %[[ARG2:[a-zA-Z0-9_]+]]: memref<4x3xi32>
+//       CHECK:   iree_linalg_ext.topk
+//  CHECK-SAME:      dimension(1)
+//  CHECK-SAME:      ins(%[[ARG0]]
+//  CHECK-SAME:      outs(%[[ARG1]], %[[ARG2]]
+//       CHECK:      iree_linalg_ext.yield
+
+// -----
+
+func @topk_dynamic_tensor(%input_values: tensor<?x?xf32>, %out_values: tensor<?x?xf32>, %out_indices: tensor<?x?xi32>) -> (tensor<?x?xf32>, tensor<?x?xi32>) {
+  %0:2 = iree_linalg_ext.topk
+        dimension(0)
+        ins(%input_values : tensor<?x?xf32>)
+        outs(%out_values, %out_indices : tensor<?x?xf32>, tensor<?x?xi32>) {
+        ^bb0(%arg0: f32, %arg1: f32):  // no predecessors
+          %0 = arith.cmpf olt, %arg0, %arg1 : f32
+          iree_linalg_ext.yield %0 : i1
+        } -> tensor<?x?xf32>, tensor<?x?xi32>
+  return %0#0, %0#1 : tensor<?x?xf32>, tensor<?x?xi32>
+}
+// CHECK-LABEL: func @topk_dynamic_tensor
+//  CHECK-SAME:   %[[ARG0:[a-zA-Z0-9_]+]]: tensor<?x?xf32>
+//  CHECK-SAME:   %[[ARG1:[a-zA-Z0-9_]+]]: tensor<?x?xf32>
+//  CHECK-SAME:   %[[ARG2:[a-zA-Z0-9_]+]]: tensor<?x?xi32>
+//       CHECK:   %[[RESULT:.+]]:2 = iree_linalg_ext.topk
+//  CHECK-SAME:      dimension(0)
+//  CHECK-SAME:      ins(%[[ARG0]]
+//  CHECK-SAME:      outs(%[[ARG1]], %[[ARG2]]
+//       CHECK:      iree_linalg_ext.yield
+//       CHECK:   return %[[RESULT]]#0, %[[RESULT]]#1
+
+// -----
+
+func @softmax_tensor(%input: tensor<16x128xf32>) -> tensor<16x128xf32> {
+  %init = linalg.init_tensor [16, 128] : tensor<16x128xf32>
+  %0 = iree_linalg_ext.softmax
+        dimension(1)
+        ins(%input : tensor<16x128xf32>)
+        outs(%init : tensor<16x128xf32>) -> tensor<16x128xf32>
+  return %0 : tensor<16x128xf32>
+}
+// CHECK-LABEL: func @softmax_tensor
+//  CHECK-SAME:   %[[ARG0:[a-zA-Z0-9_]+]]: tensor<16x128xf32>
+//       CHECK:   %[[INIT:.+]] = linalg.init_tensor [16, 128]
+//       CHECK:   %[[RESULT:.+]] = iree_linalg_ext.softmax
+//  CHECK-SAME:      dimension(1)
+//  CHECK-SAME:      ins(%[[ARG0]]
+//  CHECK-SAME:      outs(%[[INIT]]
+//       CHECK:   return %[[RESULT]]
+
+// -----
+
+func @softmax_memref(%input: memref<?x?xf32>, %output: memref<?x?xf32>) {
+  iree_linalg_ext.softmax
+        dimension(0)
+        ins(%input : memref<?x?xf32>)
+        outs(%output : memref<?x?xf32>)
+  return
+}
+// CHECK-LABEL: func @softmax_memref
+//  CHECK-SAME:   %[[ARG0:[a-zA-Z0-9_]+]]: memref<?x?xf32>
+//  CHECK-SAME:   %[[ARG1:[a-zA-Z0-9_]+]]: memref<?x?xf32>
+//       CHECK:   iree_linalg_ext.softmax
+//  CHECK-SAME:      dimension(0)
+//  CHECK-SAME:      ins(%[[ARG0]]
+//  CHECK-SAME:      outs(%[[ARG1]]
+
+// -----
+
+func @winograd_input_transform(%input: tensor<1x10x10x8xf32>) -> tensor<6x6x1x2x2x8xf32> {
+  %init = linalg.init_tensor [6, 6, 1, 2, 2, 8] : tensor<6x6x1x2x2x8xf32>
+  %0 = iree_linalg_ext.winograd.input_transform
+        output_tile_size(4)
+        ins(%input : tensor<1x10x10x8xf32>)
+        outs(%init : tensor<6x6x1x2x2x8xf32>) -> tensor<6x6x1x2x2x8xf32>
+  return %0 : tensor<6x6x1x2x2x8xf32>
+}
+// CHECK-LABEL: func @winograd_input_transform
+//  CHECK-SAME:   %[[ARG0:[a-zA-Z0-9_]+]]: tensor<1x10x10x8xf32>
+//       CHECK:   %[[INIT:.+]] = linalg.init_tensor [6, 6, 1, 2, 2, 8]
+//       CHECK:   %[[RESULT:.+]] = iree_linalg_ext.winograd.input_transform
+//  CHECK-SAME:      output_tile_size(4)
+//  CHECK-SAME:      ins(%[[ARG0]]
+//  CHECK-SAME:      outs(%[[INIT]]
+//       CHECK:   return %[[RESULT]]
+
+// -----
+
+func @winograd_filter_transform(%filter: memref<3x3x8x16xf32>, %output: memref<4x4x8x16xf32>) {
+  iree_linalg_ext.winograd.filter_transform
+        output_tile_size(2)
+        ins(%filter : memref<3x3x8x16xf32>)
+        outs(%output : memref<4x4x8x16xf32>)
+  return
+}
+// CHECK-LABEL: func @winograd_filter_transform
+//  CHECK-SAME:   %[[ARG0:[a-zA-Z0-9_]+]]: memref<3x3x8x16xf32>
+//  CHECK-SAME:   %[[ARG1:[a-zA-Z0-9_]+]]: memref<4x4x8x16xf32>
+//       CHECK:   iree_linalg_ext.winograd.filter_transform
+//  CHECK-SAME:      output_tile_size(2)
+//  CHECK-SAME:      ins(%[[ARG0]]
+//  CHECK-SAME:      outs(%[[ARG1]]
+
+// -----
+
+func @winograd_output_transform(%input: tensor<6x6x?x2x2x?xf32>, %output: tensor<?x8x8x?xf32>) -> tensor<?x8x8x?xf32> {
+  %0 = iree_linalg_ext.winograd.output_transform
+        output_tile_size(4)
+        ins(%input : tensor<6x6x?x2x2x?xf32>)
+        outs(%output : tensor<?x8x8x?xf32>) -> tensor<?x8x8x?xf32>
+  return %0 : tensor<?x8x8x?xf32>
+}
+// CHECK-LABEL: func @winograd_output_transform
+//  CHECK-SAME:   %[[ARG0:[a-zA-Z0-9_]+]]: tensor<6x6x?x2x2x?xf32>
+//  CHECK-SAME:   %[[ARG1:[a-zA-Z0-9_]+]]: tensor<?x8x8x?xf32>
+//       CHECK:   %[[RESULT:.+]] = iree_linalg_ext.winograd.output_transform
+//  CHECK-SAME:      output_tile_size(4)
+//  CHECK-SAME:      ins(%[[ARG0]]
+//  CHECK-SAME:      outs(%[[ARG1]]
+//       CHECK:   return %[[RESULT]]
+
+// -----
+
+func @pack_tensor(%input: tensor<13x15xf32>, %pad: f32) -> tensor<4x2x8x4xf32> {
+  %init = linalg.init_tensor [4, 2, 8, 4] : tensor<4x2x8x4xf32>
+  %0 = iree_linalg_ext.pack outer_dims_perm = [1, 0]
+        inner_dims_pos = [0, 1] inner_tiles = [8, 4]
+        ins(%input, %pad : tensor<13x15xf32>, f32)
+        outs(%init : tensor<4x2x8x4xf32>) -> tensor<4x2x8x4xf32>
+  return %0 : tensor<4x2x8x4xf32>
+}
+// CHECK-LABEL: func @pack_tensor
+//  CHECK-SAME:   %[[ARG0:[a-zA-Z0-9_]+]]: tensor<13x15xf32>
+//  CHECK-SAME:   %[[ARG1:[a-zA-Z0-9_]+]]: f32
+//       CHECK:   %[[INIT:.+]] = linalg.init_tensor [4, 2, 8, 4]
+//       CHECK:   %[[RESULT:.+]] = iree_linalg_ext.pack
+//  CHECK-SAME:      outer_dims_perm = [1, 0]
+//  CHECK-SAME:      inner_dims_pos = [0, 1] inner_tiles = [8, 4]
+//  CHECK-SAME:      ins(%[[ARG0]], %[[ARG1]]
+//  CHECK-SAME:      outs(%[[INIT]]
+//       CHECK:   return %[[RESULT]]
+
+// -----
+
+func @unpack_memref(%input: memref<?x?x32x8xf32>, %output: memref<?x?xf32>) {
+  iree_linalg_ext.unpack
+        inner_dims_pos = [0, 1] inner_tiles = [32, 8]
+        ins(%input : memref<?x?x32x8xf32>)
+        outs(%output : memref<?x?xf32>)
+  return
+}
+// CHECK-LABEL: func @unpack_memref
+//  CHECK-SAME:   %[[ARG0:[a-zA-Z0-9_]+]]: memref<?x?x32x8xf32>
+//  CHECK-SAME:   %[[ARG1:[a-zA-Z0-9_]+]]: memref<?x?xf32>
+//       CHECK:   iree_linalg_ext.unpack
+//   CHECK-NOT:      outer_dims_perm
+//  CHECK-SAME:      inner_dims_pos = [0, 1] inner_tiles = [32, 8]
+//  CHECK-SAME:      ins(%[[ARG0]]
+//  CHECK-SAME:      outs(%[[ARG1]]
+
+// -----
+
 // CHECK-LABEL: func @static_tile
 func @static_tile(%chunk_size: index, %in: tensor<?xf32>, %out: tensor<?xf32>, %out2: tensor<?xf32>) -> (tensor<?xf32>) {
   %c0 = arith.constant 0: index
@@ -594,3 +797,16 @@ func @no_terminator() -> () {
   }
   return
 }
+
+// -----
+
+// CHECK-LABEL: func @dynamic_schedule
+func @dynamic_schedule(%num_threads: index) -> () {
+  // CHECK: iree_linalg_ext.in_parallel
+  // CHECK: } {chunk_size = 4 : i64, schedule = "dynamic"}
+  iree_linalg_ext.in_parallel %num_threads -> () {
+    ^bb0(%thread_idx : index):
+      iree_linalg_ext.perform_concurrently {}
+  } {chunk_size = 4, schedule = "dynamic"}
+  return
+}
@@ -0,0 +1,94 @@
+// RUN: mlir-proto-opt %s -linalg-interp-transforms --split-input-file | FileCheck %s
+
+// CHECK-DAG: #[[$ID_MAP:.*]] = affine_map<(d0, d1) -> (d0, d1)>
+// CHECK-DAG: #[[$ROW_MAP:.*]] = affine_map<(d0, d1) -> (d0)>
+module {
+  // CHECK-LABEL: func @softmax
+  //  CHECK-SAME:   %[[IN:[0-9a-z]+]]: tensor<16x128xf32>
+  //  CHECK-SAME:   %[[OUT:[0-9a-z]+]]: tensor<16x128xf32>
+  func @softmax(%in: tensor<16x128xf32>, %out: tensor<16x128xf32>) -> tensor<16x128xf32> {
+    // CHECK-DAG: %[[NEG_INF:.*]] = arith.constant 0xFF800000 : f32
+    // CHECK-DAG: %[[ZERO:.*]] = arith.constant 0.000000e+00 : f32
+    // CHECK-DAG: %[[INIT:.*]] = linalg.init_tensor [16] : tensor<16xf32>
+    // CHECK: %[[MAX_INIT:.*]] = linalg.fill ins(%[[NEG_INF]] : f32) outs(%[[INIT]] : tensor<16xf32>)
+    // CHECK: %[[SUM_INIT:.*]] = linalg.fill ins(%[[ZERO]] : f32) outs(%[[INIT]] : tensor<16xf32>)
+    // CHECK: %[[STATS:.*]]:2 = linalg.generic
+    // CHECK-SAME: indexing_maps = [#[[$ID_MAP]], #[[$ROW_MAP]], #[[$ROW_MAP]]]
+    // CHECK-SAME: iterator_types = ["parallel", "reduction"]
+    // CHECK-SAME: ins(%[[IN]] : tensor<16x128xf32>) outs(%[[MAX_INIT]], %[[SUM_INIT]] : tensor<16xf32>, tensor<16xf32>)
+    // CHECK: ^bb0(%[[X:.*]]: f32, %[[MAX:.*]]: f32, %[[SUM:.*]]: f32):
+    // CHECK:   %[[NEW_MAX:.*]] = arith.maxf %[[MAX]], %[[X]] : f32
+    // CHECK:   %[[DELTA:.*]] = arith.subf %[[MAX]], %[[NEW_MAX]] : f32
+    // CHECK:   %[[RESCALE:.*]] = math.exp %[[DELTA]] : f32
+    // CHECK:   %[[SHIFTED:.*]] = arith.subf %[[X]], %[[NEW_MAX]] : f32
+    // CHECK:   %[[TERM:.*]] = math.exp %[[SHIFTED]] : f32
+    // CHECK:   %[[SCALED:.*]] = arith.mulf %[[SUM]], %[[RESCALE]] : f32
+    // CHECK:   %[[UPDATED_SUM:.*]] = arith.addf %[[SCALED]], %[[TERM]] : f32
+    // CHECK:   %[[ALL_NEG_INF:.*]] = arith.cmpf oeq, %[[NEW_MAX]], %[[NEG_INF]] : f32
+    // CHECK:   %[[NEW_SUM:.*]] = arith.select %[[ALL_NEG_INF]], %[[ZERO]], %[[UPDATED_SUM]] : f32
+    // CHECK:   linalg.yield %[[NEW_MAX]], %[[NEW_SUM]] : f32, f32
+    // CHECK: %[[RES:.*]] = linalg.generic
+    // CHECK-SAME: indexing_maps = [#[[$ID_MAP]], #[[$ROW_MAP]], #[[$ROW_MAP]], #[[$ID_MAP]]]
+    // CHECK-SAME: iterator_types = ["parallel", "parallel"]
+    // CHECK-SAME: ins(%[[IN]], %[[STATS]]#0, %[[STATS]]#1 : tensor<16x128xf32>, tensor<16xf32>, tensor<16xf32>) outs(%[[OUT]] : tensor<16x128xf32>)
+    // CHECK: ^bb0(%[[Y:.*]]: f32, %[[ROW_MAX:.*]]: f32, %[[ROW_SUM:.*]]: f32, %{{.*}}: f32):
+    // CHECK:   %[[Y_SHIFTED:.*]] = arith.subf %[[Y]], %[[ROW_MAX]] : f32
+    // CHECK:   %[[EXP:.*]] = math.exp %[[Y_SHIFTED]] : f32
+    // CHECK:   %[[NORMALIZED:.*]] = arith.divf %[[EXP]], %[[ROW_SUM]] : f32
+    // CHECK:   linalg.yield %[[NORMALIZED]] : f32
+    // CHECK-NOT: iree_linalg_ext.softmax
+    // CHECK: return %[[RES]]
+    %0 = iree_linalg_ext.softmax
+          dimension(1)
+          ins(%in : tensor<16x128xf32>)
+          outs(%out : tensor<16x128xf32>) -> tensor<16x128xf32>
+    return %0 : tensor<16x128xf32>
+  }
+
+  pdl.pattern @match_iree_linalg_ext_softmax : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.softmax"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_softmax
+    %1 = rewrite_iree_linalg_ext_softmax_to_linalg %0
+  }
+}
+
+// -----
+
+// CHECK-DAG: #[[$ID_MAP:.*]] = affine_map<(d0, d1) -> (d0, d1)>
+// CHECK-DAG: #[[$COL_MAP:.*]] = affine_map<(d0, d1) -> (d1)>
+module {
+  // CHECK-LABEL: func @softmax_dynamic_outer_dim
+  //  CHECK-SAME:   %[[IN:[0-9a-z]+]]: tensor<?x?xf32>
+  func @softmax_dynamic_outer_dim(%in: tensor<?x?xf32>, %out: tensor<?x?xf32>) -> tensor<?x?xf32> {
+    // CHECK: %[[C1:.*]] = arith.constant 1 : index
+    // CHECK: %[[D1:.*]] = tensor.dim %[[IN]], %[[C1]] : tensor<?x?xf32>
+    // CHECK: %[[INIT:.*]] = linalg.init_tensor [%[[D1]]] : tensor<?xf32>
+    // CHECK: linalg.generic
+    // CHECK-SAME: indexing_maps = [#[[$ID_MAP]], #[[$COL_MAP]], #[[$COL_MAP]]]
+    // CHECK-SAME: iterator_types = ["reduction", "parallel"]
+    // CHECK: linalg.generic
+    // CHECK-SAME: indexing_maps = [#[[$ID_MAP]], #[[$COL_MAP]], #[[$COL_MAP]], #[[$ID_MAP]]]
+    // CHECK-SAME: iterator_types = ["parallel", "parallel"]
+    %0 = iree_linalg_ext.softmax
+          dimension(0)
+          ins(%in : tensor<?x?xf32>)
+          outs(%out : tensor<?x?xf32>) -> tensor<?x?xf32>
+    return %0 : tensor<?x?xf32>
+  }
+
+  pdl.pattern @match_iree_linalg_ext_softmax : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.softmax"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_softmax
+    %1 = rewrite_iree_linalg_ext_softmax_to_linalg %0
+  }
+}
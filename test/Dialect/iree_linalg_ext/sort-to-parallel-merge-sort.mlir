@@ -0,0 +1,113 @@
+// RUN: mlir-proto-opt %s -linalg-interp-transforms --split-input-file | FileCheck %s
+
+module {
+  // CHECK-LABEL: func @sort_1d
+  //  CHECK-SAME:   %[[ARG:[0-9a-z]+]]: tensor<1024xi32>
+  func @sort_1d(%arg0: tensor<1024xi32>) -> tensor<1024xi32> {
+    // Sort the 4 chunks independently.
+    // CHECK: %[[SORTED:.*]] = iree_linalg_ext.in_parallel %{{.*}} -> (tensor<1024xi32>) {
+    // CHECK:   %[[CHUNK:.*]] = tensor.extract_slice %[[ARG]]
+    // CHECK:   %[[SORTED_CHUNK:.*]] = iree_linalg_ext.sort dimension(0) outs(%[[CHUNK]] : tensor<?xi32>)
+    // CHECK:     arith.cmpi sgt
+    // CHECK:   iree_linalg_ext.perform_concurrently {
+    // CHECK:     iree_linalg_ext.parallel_insert_slice %[[SORTED_CHUNK]] into %[[ARG]]
+    // CHECK: %[[TMP:.*]] = linalg.init_tensor [1024] : tensor<1024xi32>
+
+    // Merge the pairs of chunks into the temporary buffer.
+    // CHECK: %[[MERGED:.*]] = iree_linalg_ext.in_parallel %{{.*}} -> (tensor<1024xi32>) {
+    // CHECK:   %[[OUT_CHUNK:.*]] = tensor.extract_slice %[[TMP]]
+    // CHECK:   %[[SPLIT:.*]]:2 = scf.while
+    // CHECK:     arith.cmpi slt
+    // CHECK:     scf.condition
+    // CHECK:   } do {
+    // CHECK:     tensor.extract %[[SORTED]]
+    // CHECK:     tensor.extract %[[SORTED]]
+    // CHECK:     arith.cmpi sgt
+    // CHECK:     scf.yield
+    // CHECK:   %[[MERGED_CHUNK:.*]]:3 = scf.for {{.*}} iter_args(%{{.*}} = %[[SPLIT]]#0, %{{.*}} = %{{.*}}, %{{.*}} = %[[OUT_CHUNK]])
+    // CHECK:     scf.if
+    // CHECK:     tensor.insert
+    // CHECK:   iree_linalg_ext.perform_concurrently {
+    // CHECK:     iree_linalg_ext.parallel_insert_slice %[[MERGED_CHUNK]]#2 into %[[TMP]]
+
+    // Merge the two halves back into the operand.
+    // CHECK: %[[RES:.*]] = iree_linalg_ext.in_parallel %{{.*}} -> (tensor<1024xi32>) {
+    // CHECK:   tensor.extract_slice %[[SORTED]]
+    // CHECK:   scf.while
+    // CHECK:     tensor.extract %[[MERGED]]
+    // CHECK:   scf.for
+    // CHECK:   iree_linalg_ext.perform_concurrently {
+    // CHECK:     iree_linalg_ext.parallel_insert_slice %{{.*}} into %[[SORTED]]
+    // CHECK-NOT: iree_linalg_ext.in_parallel
+    // CHECK-NOT: iree_linalg_ext.sort
+    // CHECK: return %[[RES]]
+    %0 = iree_linalg_ext.sort
+      dimension(0)
+      outs(%arg0 : tensor<1024xi32>) {
+    ^bb0(%arg1: i32, %arg2: i32):  // no predecessors
+      %1 = arith.cmpi sgt, %arg1, %arg2 : i32
+      iree_linalg_ext.yield %1 : i1
+    } -> tensor<1024xi32>
+    return %0 : tensor<1024xi32>
+  }
+
+  pdl.pattern @match_iree_linalg_ext_sort : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.sort"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_sort
+    %1 = rewrite_iree_linalg_ext_sort_to_parallel_merge_sort %0 {num_threads = 4}
+  }
+}
+
+// -----
+
+module {
+  // CHECK-LABEL: func @sort_1d_key_value
+  //  CHECK-SAME:   %[[KEYS:[0-9a-z]+]]: tensor<?xf32>
+  //  CHECK-SAME:   %[[VALUES:[0-9a-z]+]]: tensor<?xi32>
+  func @sort_1d_key_value(%keys: tensor<?xf32>, %values: tensor<?xi32>) -> (tensor<?xf32>, tensor<?xi32>) {
+    // CHECK: %[[SORTED:.*]]:2 = iree_linalg_ext.in_parallel %{{.*}} -> (tensor<?xf32>, tensor<?xi32>) {
+    // CHECK:   iree_linalg_ext.sort dimension(0) outs(%{{.*}}, %{{.*}} : tensor<?xf32>, tensor<?xi32>)
+    // CHECK: %[[D0:.*]] = tensor.dim %[[KEYS]]
+    // CHECK: %[[KEYS_TMP:.*]] = linalg.init_tensor [%[[D0]]] : tensor<?xf32>
+    // CHECK: %[[D1:.*]] = tensor.dim %[[VALUES]]
+    // CHECK: %[[VALUES_TMP:.*]] = linalg.init_tensor [%[[D1]]] : tensor<?xi32>
+    // CHECK: %[[RES:.*]]:2 = iree_linalg_ext.in_parallel %{{.*}} -> (tensor<?xf32>, tensor<?xi32>) {
+    // CHECK:   scf.while
+    // CHECK:     tensor.extract %[[SORTED]]#0
+    // CHECK:     tensor.extract %[[SORTED]]#1
+    // CHECK:     arith.cmpf olt
+    // CHECK:   scf.for
+    // CHECK:     %[[NEXT:.*]]:2 = scf.if %{{.*}} -> (f32, i32)
+    // CHECK:     tensor.insert %[[NEXT]]#0
+    // CHECK:     tensor.insert %[[NEXT]]#1
+    // CHECK:   iree_linalg_ext.perform_concurrently {
+    // CHECK:     iree_linalg_ext.parallel_insert_slice %{{.*}} into %[[KEYS_TMP]]
+    // CHECK:     iree_linalg_ext.parallel_insert_slice %{{.*}} into %[[VALUES_TMP]]
+    // CHECK-NOT: iree_linalg_ext.in_parallel
+    // CHECK: return %[[RES]]#0, %[[RES]]#1
+    %0:2 = iree_linalg_ext.sort
+      dimension(0)
+      outs(%keys, %values : tensor<?xf32>, tensor<?xi32>) {
+    ^bb0(%arg1: f32, %arg2: f32, %arg3: i32, %arg4: i32):  // no predecessors
+      %1 = arith.cmpf olt, %arg1, %arg2 : f32
+      iree_linalg_ext.yield %1 : i1
+    } -> tensor<?xf32>, tensor<?xi32>
+    return %0#0, %0#1 : tensor<?xf32>, tensor<?xi32>
+  }
+
+  pdl.pattern @match_iree_linalg_ext_sort : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.sort"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_sort
+    %1 = rewrite_iree_linalg_ext_sort_to_parallel_merge_sort %0 {num_threads = 2}
+  }
+}
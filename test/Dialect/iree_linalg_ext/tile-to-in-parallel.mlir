@@ -60,3 +60,29 @@ module {
     %1 = rewrite_iree_linalg_ext_tile_to_in_parallel %0
   }
 }
+
+// -----
+
+module {
+  // CHECK-LABEL: func @dynamic_schedule
+  func @dynamic_schedule(%chunk_size: index, %out: tensor<?xf32>) -> (tensor<?xf32>) {
+    // CHECK: iree_linalg_ext.in_parallel
+    // CHECK: } {chunk_size = 2 : i64, schedule = "dynamic"}
+    %0 = iree_linalg_ext.tile %chunk_size outs(%out: tensor<?xf32>) -> (tensor<?xf32>) {
+      ^bb0(%offset: index, %size: index, %st1: tensor<?xf32>):
+        iree_linalg_ext.tile_yield %st1: tensor<?xf32>
+    }
+    return %0: tensor<?xf32>
+  }
+
+  pdl.pattern @match_iree_linalg_ext_tile : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.tile"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_tile
+    %1 = rewrite_iree_linalg_ext_tile_to_in_parallel %0 {chunk_size = 2, schedule = "dynamic"}
+  }
+}
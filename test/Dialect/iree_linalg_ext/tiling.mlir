@@ -766,6 +766,171 @@ func @reverse_tensor_multi_dim(%arg0: tensor<?x?xi32>) -> tensor<?x?xi32> {
 
 // -----
 
+func @topk_tile_tensor(%input_values: tensor<?x?xf32>, %out_values: tensor<?x3xf32>, %out_indices: tensor<?x3xi32>) -> (tensor<?x3xf32>, tensor<?x3xi32>) {
+  %0:2 = iree_linalg_ext.topk
+        {__internal_linalg_transform__ = "inner_reduce_input"}
+        dimension(1)
+        ins(%input_values : tensor<?x?xf32>)
+        outs(%out_values, %out_indices : tensor<?x3xf32>, tensor<?x3xi32>) {
+        ^bb0(%arg0: f32, %arg1: f32):  // no predecessors
+          %0 = arith.cmpf ogt, %arg0, %arg1 : f32
+          iree_linalg_ext.yield %0 : i1
+        } -> tensor<?x3xf32>, tensor<?x3xi32>
+  return %0#0, %0#1 : tensor<?x3xf32>, tensor<?x3xi32>
+}
+//       CHECK: #[[MAP:.+]] = affine_map<(d0)[s0, s1] -> (10, -d0 + s1)>
+//       CHECK: func @topk_tile_tensor(
+//  CHECK-SAME:   %[[INPUT_VALUES:[a-zA-Z0-9_]+]]: tensor<?x?xf32>
+//  CHECK-SAME:   %[[OUT_VALUES:[a-zA-Z0-9_]+]]: tensor<?x3xf32>
+//  CHECK-SAME:   %[[OUT_INDICES:[a-zA-Z0-9_]+]]: tensor<?x3xi32>
+//   CHECK-DAG:   %[[TILESIZE:.+]] = arith.constant 10 : index
+//   CHECK-DAG:   %[[C0:.+]] = arith.constant 0 : index
+//   CHECK-DAG:   %[[C1:.+]] = arith.constant 1 : index
+//   CHECK-DAG:   %[[D0:.+]] = tensor.dim %[[INPUT_VALUES]], %[[C0]]
+//   CHECK-DAG:   %[[D1:.+]] = tensor.dim %[[INPUT_VALUES]], %[[C1]]
+//       CHECK:   %[[RESULT:.+]]:2 = scf.for %[[IV:.+]] = %[[C0]] to %[[D0]] step %[[TILESIZE]]
+//  CHECK-SAME:       iter_args(%[[INIT_VALUES:.+]] = %[[OUT_VALUES]], %[[INIT_INDICES:.+]] = %[[OUT_INDICES]])
+//   CHECK-DAG:     %[[USED_TILESIZE:.+]] = affine.min #[[MAP]](%[[IV]])[%[[TILESIZE]], %[[D0]]]
+//       CHECK:     %[[INPUT_SLICE:.+]] = tensor.extract_slice %[[INPUT_VALUES]][%[[IV]], 0]
+//  CHECK-SAME:         [%[[USED_TILESIZE]], %[[D1]]]
+//       CHECK:     %[[VALUES_SLICE:.+]] = tensor.extract_slice %[[INIT_VALUES]][%[[IV]], 0]
+//  CHECK-SAME:         [%[[USED_TILESIZE]], 3]
+//       CHECK:     %[[INDICES_SLICE:.+]] = tensor.extract_slice %[[INIT_INDICES]][%[[IV]], 0]
+//  CHECK-SAME:         [%[[USED_TILESIZE]], 3]
+//       CHECK:     %[[TOPK_TILE:.+]]:2 = iree_linalg_ext.topk
+//  CHECK-SAME:         __internal_linalg_transform__ = "inner_reduce_output"
+//  CHECK-SAME:         dimension(1)
+//  CHECK-SAME:         ins(%[[INPUT_SLICE]]
+//  CHECK-SAME:         outs(%[[VALUES_SLICE]], %[[INDICES_SLICE]]
+//       CHECK:     %[[YIELD_VALUES:.+]] = tensor.insert_slice %[[TOPK_TILE]]#0 into %[[INIT_VALUES]][%[[IV]], 0]
+//  CHECK-SAME:         [%[[USED_TILESIZE]], 3]
+//       CHECK:     %[[YIELD_INDICES:.+]] = tensor.insert_slice %[[TOPK_TILE]]#1 into %[[INIT_INDICES]][%[[IV]], 0]
+//  CHECK-SAME:         [%[[USED_TILESIZE]], 3]
+//       CHECK:     scf.yield %[[YIELD_VALUES]], %[[YIELD_INDICES]]
+//       CHECK:   return %[[RESULT]]#0, %[[RESULT]]#1
+
+// -----
+
+func @softmax_tile_tensor(%input: tensor<?x?xf32>, %output: tensor<?x?xf32>) -> tensor<?x?xf32> {
+  %0 = iree_linalg_ext.softmax
+        {__internal_linalg_transform__ = "inner_reduce_input"}
+        dimension(1)
+        ins(%input : tensor<?x?xf32>)
+        outs(%output : tensor<?x?xf32>) -> tensor<?x?xf32>
+  return %0 : tensor<?x?xf32>
+}
+//       CHECK: #[[MAP:.+]] = affine_map<(d0)[s0, s1] -> (10, -d0 + s1)>
+//       CHECK: func @softmax_tile_tensor(
+//  CHECK-SAME:   %[[INPUT:[a-zA-Z0-9_]+]]: tensor<?x?xf32>
+//  CHECK-SAME:   %[[OUTPUT:[a-zA-Z0-9_]+]]: tensor<?x?xf32>
+//   CHECK-DAG:   %[[TILESIZE:.+]] = arith.constant 10 : index
+//   CHECK-DAG:   %[[C0:.+]] = arith.constant 0 : index
+//   CHECK-DAG:   %[[C1:.+]] = arith.constant 1 : index
+//   CHECK-DAG:   %[[D0:.+]] = tensor.dim %[[INPUT]], %[[C0]]
+//   CHECK-DAG:   %[[D1:.+]] = tensor.dim %[[INPUT]], %[[C1]]
+//       CHECK:   %[[RESULT:.+]] = scf.for %[[IV:.+]] = %[[C0]] to %[[D0]] step %[[TILESIZE]]
+//  CHECK-SAME:       iter_args(%[[INIT:.+]] = %[[OUTPUT]])
+//   CHECK-DAG:     %[[USED_TILESIZE:.+]] = affine.min #[[MAP]](%[[IV]])[%[[TILESIZE]], %[[D0]]]
+//       CHECK:     %[[INPUT_SLICE:.+]] = tensor.extract_slice %[[INPUT]][%[[IV]], 0]
+//  CHECK-SAME:         [%[[USED_TILESIZE]], %[[D1]]]
+//       CHECK:     %[[OUTPUT_SLICE:.+]] = tensor.extract_slice %[[INIT]][%[[IV]], 0]
+//  CHECK-SAME:         [%[[USED_TILESIZE]], %[[D1]]]
+//       CHECK:     %[[SOFTMAX_TILE:.+]] = iree_linalg_ext.softmax
+//  CHECK-SAME:         __internal_linalg_transform__ = "inner_reduce_output"
+//  CHECK-SAME:         dimension(1)
+//  CHECK-SAME:         ins(%[[INPUT_SLICE]]
+//  CHECK-SAME:         outs(%[[OUTPUT_SLICE]]
+//       CHECK:     %[[YIELD:.+]] = tensor.insert_slice %[[SOFTMAX_TILE]] into %[[INIT]][%[[IV]], 0]
+//  CHECK-SAME:         [%[[USED_TILESIZE]], %[[D1]]]
+//       CHECK:     scf.yield %[[YIELD]]
+//       CHECK:   return %[[RESULT]]
+
+// -----
+
+func @winograd_filter_transform_tile_tensor(%filter: tensor<3x3x?x?xf32>, %output: tensor<6x6x?x?xf32>) -> tensor<6x6x?x?xf32> {
+  %0 = iree_linalg_ext.winograd.filter_transform
+        {__internal_linalg_transform__ = "tiling_input"}
+        output_tile_size(4)
+        ins(%filter : tensor<3x3x?x?xf32>)
+        outs(%output : tensor<6x6x?x?xf32>) -> tensor<6x6x?x?xf32>
+  return %0 : tensor<6x6x?x?xf32>
+}
+//  CHECK-DAG: #[[MAP0:.+]] = affine_map<(d0)[s0, s1] -> (10, -d0 + s1)>
+//  CHECK-DAG: #[[MAP1:.+]] = affine_map<(d0)[s0, s1] -> (20, -d0 + s1)>
+//      CHECK: func @winograd_filter_transform_tile_tensor(
+// CHECK-SAME:   %[[FILTER:[a-zA-Z0-9_]+]]: tensor<3x3x?x?xf32>
+// CHECK-SAME:   %[[OUTPUT:[a-zA-Z0-9_]+]]: tensor<6x6x?x?xf32>
+//  CHECK-DAG:   %[[C2:.+]] = arith.constant 2 : index
+//  CHECK-DAG:   %[[C3:.+]] = arith.constant 3 : index
+//  CHECK-DAG:   %[[D2:.+]] = tensor.dim %[[OUTPUT]], %[[C2]]
+//  CHECK-DAG:   %[[D3:.+]] = tensor.dim %[[OUTPUT]], %[[C3]]
+//      CHECK:   %[[RESULT:.+]] = scf.for %[[IV0:.+]] =
+// CHECK-SAME:       iter_args(%[[INIT0:.+]] = %[[OUTPUT]])
+//      CHECK:     %[[SZ0:.+]] = affine.min #[[MAP0]](%[[IV0]])
+//      CHECK:     %[[YIELD0:.+]] = scf.for %[[IV1:.+]] =
+// CHECK-SAME:         iter_args(%[[INIT1:.+]] = %[[INIT0]])
+//      CHECK:       %[[SZ1:.+]] = affine.min #[[MAP1]](%[[IV1]])
+//      CHECK:       %[[FILTER_SLICE:.+]] = tensor.extract_slice %[[FILTER]][0, 0, %[[IV0]], %[[IV1]]]
+// CHECK-SAME:           [3, 3, %[[SZ0]], %[[SZ1]]]
+//      CHECK:       %[[OUTPUT_SLICE:.+]] = tensor.extract_slice %[[INIT1]][0, 0, %[[IV0]], %[[IV1]]]
+// CHECK-SAME:           [6, 6, %[[SZ0]], %[[SZ1]]]
+//      CHECK:       %[[TILE:.+]] = iree_linalg_ext.winograd.filter_transform
+// CHECK-SAME:           __internal_linalg_transform__ = "tiling_output"
+// CHECK-SAME:           output_tile_size(4)
+// CHECK-SAME:           ins(%[[FILTER_SLICE]]
+// CHECK-SAME:           outs(%[[OUTPUT_SLICE]]
+//      CHECK:       %[[YIELD1:.+]] = tensor.insert_slice %[[TILE]] into %[[INIT1]][0, 0, %[[IV0]], %[[IV1]]]
+// CHECK-SAME:           [6, 6, %[[SZ0]], %[[SZ1]]]
+//      CHECK:       scf.yield %[[YIELD1]]
+//      CHECK:     scf.yield %[[YIELD0]]
+//      CHECK:   return %[[RESULT]]
+
+// -----
+
+func @pack_tile_tensor(%input: tensor<?x?xf32>, %pad: f32, %output: tensor<?x?x8x4xf32>) -> tensor<?x?x8x4xf32> {
+  %0 = iree_linalg_ext.pack
+        {__internal_linalg_transform__ = "tiling_input"}
+        inner_dims_pos = [0, 1] inner_tiles = [8, 4]
+        ins(%input, %pad : tensor<?x?xf32>, f32)
+        outs(%output : tensor<?x?x8x4xf32>) -> tensor<?x?x8x4xf32>
+  return %0 : tensor<?x?x8x4xf32>
+}
+//  CHECK-DAG: #[[MAP0:.+]] = affine_map<(d0)[s0, s1] -> (10, -d0 + s1)>
+//  CHECK-DAG: #[[MAP1:.+]] = affine_map<(d0)[s0, s1] -> (20, -d0 + s1)>
+//  CHECK-DAG: #[[MAP2:.+]] = affine_map<(d0) -> (d0 * 8)>
+//  CHECK-DAG: #[[MAP3:.+]] = affine_map<(d0, d1)[s0] -> (d0 * 8, -d1 * 8 + s0)>
+//  CHECK-DAG: #[[MAP4:.+]] = affine_map<(d0) -> (d0 * 4)>
+//  CHECK-DAG: #[[MAP5:.+]] = affine_map<(d0, d1)[s0] -> (d0 * 4, -d1 * 4 + s0)>
+//      CHECK: func @pack_tile_tensor(
+// CHECK-SAME:   %[[INPUT:[a-zA-Z0-9_]+]]: tensor<?x?xf32>
+// CHECK-SAME:   %[[PAD:[a-zA-Z0-9_]+]]: f32
+// CHECK-SAME:   %[[OUTPUT:[a-zA-Z0-9_]+]]: tensor<?x?x8x4xf32>
+//      CHECK:   %[[RESULT:.+]] = scf.for %[[IV0:.+]] =
+// CHECK-SAME:       iter_args(%[[INIT0:.+]] = %[[OUTPUT]])
+//      CHECK:     %[[SZ0:.+]] = affine.min #[[MAP0]](%[[IV0]])
+//      CHECK:     %[[YIELD0:.+]] = scf.for %[[IV1:.+]] =
+// CHECK-SAME:         iter_args(%[[INIT1:.+]] = %[[INIT0]])
+//      CHECK:       %[[SZ1:.+]] = affine.min #[[MAP1]](%[[IV1]])
+//  CHECK-DAG:       %[[IN_OFF0:.+]] = affine.apply #[[MAP2]](%[[IV0]])
+//  CHECK-DAG:       %[[IN_SZ0:.+]] = affine.min #[[MAP3]](%[[SZ0]], %[[IV0]])
+//  CHECK-DAG:       %[[IN_OFF1:.+]] = affine.apply #[[MAP4]](%[[IV1]])
+//  CHECK-DAG:       %[[IN_SZ1:.+]] = affine.min #[[MAP5]](%[[SZ1]], %[[IV1]])
+//      CHECK:       %[[INPUT_SLICE:.+]] = tensor.extract_slice %[[INPUT]][%[[IN_OFF0]], %[[IN_OFF1]]]
+// CHECK-SAME:           [%[[IN_SZ0]], %[[IN_SZ1]]]
+//      CHECK:       %[[OUTPUT_SLICE:.+]] = tensor.extract_slice %[[INIT1]][%[[IV0]], %[[IV1]], 0, 0]
+// CHECK-SAME:           [%[[SZ0]], %[[SZ1]], 8, 4]
+//      CHECK:       %[[TILE:.+]] = iree_linalg_ext.pack
+// CHECK-SAME:           __internal_linalg_transform__ = "tiling_output"
+// CHECK-SAME:           ins(%[[INPUT_SLICE]], %[[PAD]]
+// CHECK-SAME:           outs(%[[OUTPUT_SLICE]]
+//      CHECK:       %[[YIELD1:.+]] = tensor.insert_slice %[[TILE]] into %[[INIT1]][%[[IV0]], %[[IV1]], 0, 0]
+// CHECK-SAME:           [%[[SZ0]], %[[SZ1]], 8, 4]
+//      CHECK:       scf.yield %[[YIELD1]]
+//      CHECK:     scf.yield %[[YIELD0]]
+//      CHECK:   return %[[RESULT]]
+
+// -----
+
 func @dynamic_insert_slice(%arg0 : tensor<?xf32>, %arg1 : tensor<?x?xf32>,
     %arg2 : index, %arg3 : index) -> tensor<?x?xf32> {
   %c0 = arith.constant 0 : index
@@ -0,0 +1,105 @@
+// RUN: mlir-proto-opt %s -linalg-interp-transforms --split-input-file | FileCheck %s
+
+module {
+  func @topk_split_reduction(%input_values: tensor<2x16xf32>, %out_values: tensor<2x2xf32>, %out_indices: tensor<2x2xi32>) -> (tensor<2x2xf32>, tensor<2x2xi32>) {
+    %0:2 = iree_linalg_ext.topk
+          dimension(1)
+          ins(%input_values : tensor<2x16xf32>)
+          outs(%out_values, %out_indices : tensor<2x2xf32>, tensor<2x2xi32>) {
+          ^bb0(%arg0: f32, %arg1: f32):  // no predecessors
+            %0 = arith.cmpf ogt, %arg0, %arg1 : f32
+            iree_linalg_ext.yield %0 : i1
+          } -> tensor<2x2xf32>, tensor<2x2xi32>
+    return %0#0, %0#1 : tensor<2x2xf32>, tensor<2x2xi32>
+  }
+  // The outputs hold a running top-k, they are only merged by the final topk.
+  //       CHECK: func @topk_split_reduction(
+  //  CHECK-SAME:   %[[INPUT_VALUES:[a-zA-Z0-9_]+]]: tensor<2x16xf32>
+  //  CHECK-SAME:   %[[OUT_VALUES:[a-zA-Z0-9_]+]]: tensor<2x2xf32>
+  //  CHECK-SAME:   %[[OUT_INDICES:[a-zA-Z0-9_]+]]: tensor<2x2xi32>
+  //       CHECK:   %[[EXPANDED:.+]] = tensor.expand_shape %[[INPUT_VALUES]] {{\[}}[0], [1, 2]]
+  //  CHECK-SAME:       tensor<2x16xf32> into tensor<2x4x4xf32>
+  //   CHECK-NOT:   %[[OUT_VALUES]]
+  //   CHECK-NOT:   %[[OUT_INDICES]]
+  //   CHECK-DAG:   %[[NEG_INF:.+]] = arith.constant 0xFF800000 : f32
+  //   CHECK-DAG:   %[[MAX_INDEX:.+]] = arith.constant 2147483647 : i32
+  //       CHECK:   %[[INIT_VALUES:.+]] = linalg.init_tensor [2, 4, 2] : tensor<2x4x2xf32>
+  //       CHECK:   %[[CHUNK_OUT_VALUES:.+]] = linalg.fill ins(%[[NEG_INF]] : f32) outs(%[[INIT_VALUES]] : tensor<2x4x2xf32>)
+  //       CHECK:   %[[INIT_INDICES:.+]] = linalg.init_tensor [2, 4, 2] : tensor<2x4x2xi32>
+  //       CHECK:   %[[CHUNK_OUT_INDICES:.+]] = linalg.fill ins(%[[MAX_INDEX]] : i32) outs(%[[INIT_INDICES]] : tensor<2x4x2xi32>)
+  //   CHECK-NOT:   %[[OUT_VALUES]]
+  //   CHECK-NOT:   %[[OUT_INDICES]]
+  //       CHECK:   %[[CHUNK_TOPK:.+]]:2 = iree_linalg_ext.topk
+  //  CHECK-SAME:       dimension(2)
+  //  CHECK-SAME:       ins(%[[EXPANDED]] : tensor<2x4x4xf32>)
+  //  CHECK-SAME:       outs(%[[CHUNK_OUT_VALUES]], %[[CHUNK_OUT_INDICES]]
+  //       CHECK:   %[[CHUNK_INDICES:.+]] = linalg.generic
+  //  CHECK-SAME:       outs(%[[CHUNK_TOPK]]#1 : tensor<2x4x2xi32>)
+  //       CHECK:     %[[CHUNK:.+]] = linalg.index 1 : index
+  //       CHECK:     %[[OFFSET:.+]] = arith.muli %[[CHUNK]]
+  //       CHECK:     %[[OFFSET_I32:.+]] = arith.index_cast %[[OFFSET]] : index to i32
+  //       CHECK:     arith.addi %{{.+}}, %[[OFFSET_I32]] : i32
+  //   CHECK-NOT:   %[[OUT_VALUES]]
+  //   CHECK-NOT:   %[[OUT_INDICES]]
+  //       CHECK:   %[[CANDIDATE_VALUES:.+]] = tensor.collapse_shape %[[CHUNK_TOPK]]#0 {{\[}}[0], [1, 2]]
+  //  CHECK-SAME:       tensor<2x4x2xf32> into tensor<2x8xf32>
+  //       CHECK:   %[[CANDIDATE_INDICES:.+]] = tensor.collapse_shape %[[CHUNK_INDICES]] {{\[}}[0], [1, 2]]
+  //  CHECK-SAME:       tensor<2x4x2xi32> into tensor<2x8xi32>
+  //       CHECK:   %[[RESULT:.+]]:2 = iree_linalg_ext.topk
+  //  CHECK-SAME:       dimension(1)
+  //  CHECK-SAME:       ins(%[[CANDIDATE_VALUES]], %[[CANDIDATE_INDICES]]
+  //  CHECK-SAME:       outs(%[[OUT_VALUES]], %[[OUT_INDICES]]
+  //       CHECK:   return %[[RESULT]]#0, %[[RESULT]]#1
+
+  pdl.pattern @match_iree_linalg_ext_topk : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.topk"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_topk
+    %1, %2 = rewrite_iree_linalg_ext_topk_split_reduction %0 {split_ratio = 4}
+  }
+}
+
+// -----
+
+module {
+  func @topk_split_reduction_smallest(%input_values: tensor<32xi32>, %out_values: tensor<4xi32>, %out_indices: tensor<4xi32>) -> (tensor<4xi32>, tensor<4xi32>) {
+    %0:2 = iree_linalg_ext.topk
+          dimension(0)
+          ins(%input_values : tensor<32xi32>)
+          outs(%out_values, %out_indices : tensor<4xi32>, tensor<4xi32>) {
+          ^bb0(%arg0: i32, %arg1: i32):  // no predecessors
+            %0 = arith.cmpi sgt, %arg1, %arg0 : i32
+            iree_linalg_ext.yield %0 : i1
+          } -> tensor<4xi32>, tensor<4xi32>
+    return %0#0, %0#1 : tensor<4xi32>, tensor<4xi32>
+  }
+  // CHECK-LABEL: func @topk_split_reduction_smallest(
+  //  CHECK-SAME:   %{{[a-zA-Z0-9_]+}}: tensor<32xi32>
+  //  CHECK-SAME:   %[[OUT_VALUES:[a-zA-Z0-9_]+]]: tensor<4xi32>
+  //  CHECK-SAME:   %[[OUT_INDICES:[a-zA-Z0-9_]+]]: tensor<4xi32>
+  //       CHECK:   %[[MAX:.+]] = arith.constant 2147483647 : i32
+  //       CHECK:   %[[INIT_VALUES:.+]] = linalg.init_tensor [4, 4] : tensor<4x4xi32>
+  //       CHECK:   linalg.fill ins(%[[MAX]] : i32) outs(%[[INIT_VALUES]] : tensor<4x4xi32>)
+  //       CHECK:   %[[INIT_INDICES:.+]] = linalg.init_tensor [4, 4] : tensor<4x4xi32>
+  //       CHECK:   linalg.fill ins(%{{.+}} : i32) outs(%[[INIT_INDICES]] : tensor<4x4xi32>)
+  //       CHECK:   iree_linalg_ext.topk
+  //  CHECK-SAME:       dimension(1)
+  //       CHECK:   %[[RESULT:.+]]:2 = iree_linalg_ext.topk
+  //  CHECK-SAME:       dimension(0)
+  //  CHECK-SAME:       outs(%[[OUT_VALUES]], %[[OUT_INDICES]]
+
+  pdl.pattern @match_iree_linalg_ext_topk : benefit(1) {
+    %0 = operands
+    %1 = types
+    %2 = operation "iree_linalg_ext.topk"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+    rewrite %2 with "iree_linalg_transform.apply"
+  }
+  iree_linalg_transform.sequence {
+    %0 = match @match_iree_linalg_ext_topk
+    %1, %2 = rewrite_iree_linalg_ext_topk_split_reduction %0 {split_ratio = 4}
+  }
+}
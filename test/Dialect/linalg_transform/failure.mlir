@@ -177,3 +177,88 @@ iree_linalg_transform.sequence {
   tile %0 {sizes = [32, 32, 32]}
   tile %1 {sizes = [32, 32, 32]}
 }
+
+// -----
+
+// The input is larger than the output plus the kernel halo, the Winograd
+// transforms would ignore its last rows and columns.
+func public @winograd_mismatched_sizes(%in: tensor<1x12x12x8xf32>, %filter: tensor<3x3x8x16xf32>, %out: tensor<1x8x8x16xf32>) -> tensor<1x8x8x16xf32> {
+  %0 = linalg.conv_2d_nhwc_hwcf
+         {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+         ins(%in, %filter : tensor<1x12x12x8xf32>, tensor<3x3x8x16xf32>)
+         outs(%out : tensor<1x8x8x16xf32>) -> tensor<1x8x8x16xf32>
+  return %0 : tensor<1x8x8x16xf32>
+}
+
+pdl.pattern @target_pattern : benefit(1) {
+  %0 = operands
+  %1 = types
+  %2 = operation "linalg.conv_2d_nhwc_hwcf"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+  rewrite %2 with "iree_linalg_transform.apply"
+}
+
+iree_linalg_transform.sequence {
+  %0 = match @target_pattern
+  // expected-error@below {{failed to apply}}
+  %1 = rewrite_conv2d_to_winograd %0
+}
+
+// -----
+
+// The output is half of the reduced dimension, the chunks of 4 elements could
+// not produce 8 candidates each.
+func public @topk_split_reduction_too_small(%input_values: tensor<2x16xf32>, %out_values: tensor<2x8xf32>, %out_indices: tensor<2x8xi32>) -> (tensor<2x8xf32>, tensor<2x8xi32>) {
+  %0:2 = iree_linalg_ext.topk
+        dimension(1)
+        ins(%input_values : tensor<2x16xf32>)
+        outs(%out_values, %out_indices : tensor<2x8xf32>, tensor<2x8xi32>) {
+        ^bb0(%arg0: f32, %arg1: f32):  // no predecessors
+          %0 = arith.cmpf ogt, %arg0, %arg1 : f32
+          iree_linalg_ext.yield %0 : i1
+        } -> tensor<2x8xf32>, tensor<2x8xi32>
+  return %0#0, %0#1 : tensor<2x8xf32>, tensor<2x8xi32>
+}
+
+pdl.pattern @target_pattern : benefit(1) {
+  %0 = operands
+  %1 = types
+  %2 = operation "iree_linalg_ext.topk"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+  rewrite %2 with "iree_linalg_transform.apply"
+}
+
+iree_linalg_transform.sequence {
+  %0 = match @target_pattern
+  // expected-error@below {{failed to apply}}
+  %1, %2 = rewrite_iree_linalg_ext_topk_split_reduction %0 {split_ratio = 4}
+}
+
+// -----
+
+// The comparator is not a plain comparison of its arguments, no identity is
+// known to fill the chunk outputs with.
+func public @topk_split_reduction_unknown_identity(%input_values: tensor<2x16xf32>, %out_values: tensor<2x2xf32>, %out_indices: tensor<2x2xi32>) -> (tensor<2x2xf32>, tensor<2x2xi32>) {
+  %0:2 = iree_linalg_ext.topk
+        dimension(1)
+        ins(%input_values : tensor<2x16xf32>)
+        outs(%out_values, %out_indices : tensor<2x2xf32>, tensor<2x2xi32>) {
+        ^bb0(%arg0: f32, %arg1: f32):  // no predecessors
+          %neg0 = arith.negf %arg0 : f32
+          %neg1 = arith.negf %arg1 : f32
+          %0 = arith.cmpf ogt, %neg0, %neg1 : f32
+          iree_linalg_ext.yield %0 : i1
+        } -> tensor<2x2xf32>, tensor<2x2xi32>
+  return %0#0, %0#1 : tensor<2x2xf32>, tensor<2x2xi32>
+}
+
+pdl.pattern @target_pattern : benefit(1) {
+  %0 = operands
+  %1 = types
+  %2 = operation "iree_linalg_ext.topk"(%0 : !pdl.range<value>)  -> (%1 : !pdl.range<type>)
+  rewrite %2 with "iree_linalg_transform.apply"
+}
+
+iree_linalg_transform.sequence {
+  %0 = match @target_pattern
+  // expected-error@below {{failed to apply}}
+  %1, %2 = rewrite_iree_linalg_ext_topk_split_reduction %0 {split_ratio = 4}
+}
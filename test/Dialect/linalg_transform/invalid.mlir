@@ -65,3 +65,34 @@ iree_linalg_transform.sequence {
   // expected-error@below {{expects transpose_paddings to be a permutation, found [1, 1]}}
   pad %0 {transpose_paddings=[[1, 1]]}
 }
+
+// -----
+
+iree_linalg_transform.sequence {
+  %0 = match @match
+  // expected-error@below {{expects schedule to be one of 'static', 'dynamic' or 'guided', found 'affinity'}}
+  rewrite_iree_linalg_ext_tile_to_in_parallel %0 {schedule = "affinity"}
+}
+
+// -----
+
+iree_linalg_transform.sequence {
+  %0 = match @match
+  // expected-error@below {{'iree_linalg_transform.split_reduction' op attribute 'split_factor' failed to satisfy constraint: 64-bit signless integer attribute whose minimum value is 2}}
+  split_reduction %0 {split_factor = 1}
+}
+
+// -----
+
+iree_linalg_transform.sequence {
+  %0 = match @match
+  // expected-error@below {{expects partial_tiles to be one of 'none', 'auto' or 'auto_mask', found 'always'}}
+  tile %0 {sizes = [4], partial_tiles = "always"}
+}
+
+// -----
+
+iree_linalg_transform.sequence {
+  // expected-error@below {{expects a target when vectorizing with masking}}
+  vectorize {vectorize_with_masking = true}
+}
@@ -0,0 +1,115 @@
+// RUN: mlir-proto-opt -linalg-interp-transforms --split-input-file %s | FileCheck %s
+
+//   CHECK-DAG: #[[$IN:.*]] = affine_map<(d0, d1, d2) -> (d0, d1, d2)>
+//   CHECK-DAG: #[[$PARTIAL:.*]] = affine_map<(d0, d1, d2) -> (d1, d0)>
+//   CHECK-DAG: #[[$ID:.*]] = affine_map<(d0, d1) -> (d0, d1)>
+//   CHECK-DAG: #[[$OUT:.*]] = affine_map<(d0, d1) -> (d1)>
+
+// CHECK-LABEL: func @row_reduction
+//  CHECK-SAME:   %[[IN:[0-9a-z]+]]: tensor<8x32xf32>
+//  CHECK-SAME:   %[[OUT:[0-9a-z]+]]: tensor<8xf32>
+func @row_reduction(%in: tensor<8x32xf32>, %out: tensor<8xf32>) -> tensor<8xf32> {
+  //  CHECK-DAG: %[[ZERO:.*]] = arith.constant 0.000000e+00 : f32
+  //  CHECK-DAG: %[[EXPANDED:.*]] = tensor.expand_shape %[[IN]] {{\[}}[0], [1, 2]] : tensor<8x32xf32> into tensor<8x4x8xf32>
+  //  CHECK-DAG: %[[INIT:.*]] = linalg.init_tensor [4, 8] : tensor<4x8xf32>
+  //      CHECK: %[[FILL:.*]] = linalg.fill ins(%[[ZERO]] : f32) outs(%[[INIT]] : tensor<4x8xf32>)
+  //      CHECK: %[[PARTIAL:.*]] = linalg.generic
+  // CHECK-SAME:   indexing_maps = [#[[$IN]], #[[$PARTIAL]]]
+  // CHECK-SAME:   iterator_types = ["parallel", "parallel", "reduction"]
+  // CHECK-SAME:   ins(%[[EXPANDED]] : tensor<8x4x8xf32>) outs(%[[FILL]] : tensor<4x8xf32>)
+  //      CHECK:   arith.addf
+  //      CHECK: %[[RES:.*]] = linalg.generic
+  // CHECK-SAME:   indexing_maps = [#[[$ID]], #[[$OUT]]]
+  // CHECK-SAME:   iterator_types = ["reduction", "parallel"]
+  // CHECK-SAME:   ins(%[[PARTIAL]] : tensor<4x8xf32>) outs(%[[OUT]] : tensor<8xf32>)
+  //      CHECK: ^bb0(%[[A:.*]]: f32, %[[B:.*]]: f32):
+  //      CHECK:   %[[SUM:.*]] = arith.addf %[[A]], %[[B]] : f32
+  //      CHECK:   linalg.yield %[[SUM]] : f32
+  //      CHECK: return %[[RES]]
+  %0 = linalg.generic {
+    indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0)>],
+    iterator_types = ["parallel", "reduction"]
+  } ins(%in : tensor<8x32xf32>) outs(%out : tensor<8xf32>) {
+  ^bb0(%arg0: f32, %arg1: f32):
+    %1 = arith.addf %arg0, %arg1 : f32
+    linalg.yield %1 : f32
+  } -> tensor<8xf32>
+  return %0 : tensor<8xf32>
+}
+
+pdl.pattern @pdl_target : benefit(1) {
+  %args = operands
+  %results = types
+  %0 = pdl.operation "linalg.generic"(%args : !pdl.range<value>) -> (%results : !pdl.range<type>)
+  %1 = pdl.attribute @row_reduction
+  apply_native_constraint "nestedInFunc"(%0, %1 : !pdl.operation, !pdl.attribute)
+  // TODO: we don't want this, but it is the required terminator for pdl.pattern
+  rewrite %0 with "iree_linalg_transform.apply"
+}
+
+iree_linalg_transform.sequence {
+  %0 = match @pdl_target
+  %1 = split_reduction %0 {split_factor = 4}
+}
+
+// -----
+
+//   CHECK-DAG: #[[$A:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d2, d3)>
+//   CHECK-DAG: #[[$B:.*]] = affine_map<(d0, d1, d2, d3) -> (d2, d3, d1)>
+//   CHECK-DAG: #[[$C:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d3)>
+//   CHECK-DAG: #[[$ID:.*]] = affine_map<(d0, d1, d2) -> (d0, d1, d2)>
+//   CHECK-DAG: #[[$OUT:.*]] = affine_map<(d0, d1, d2) -> (d0, d1)>
+
+// CHECK-LABEL: func @matmul
+//  CHECK-SAME:   %[[A:[0-9a-z]+]]: tensor<16x64xf32>
+//  CHECK-SAME:   %[[B:[0-9a-z]+]]: tensor<64x?xf32>
+//  CHECK-SAME:   %[[C:[0-9a-z]+]]: tensor<16x?xf32>
+func @matmul(%a: tensor<16x64xf32>, %b: tensor<64x?xf32>, %c: tensor<16x?xf32>) -> tensor<16x?xf32> {
+  //  CHECK-DAG: %[[A_EXPANDED:.*]] = tensor.expand_shape %[[A]] {{\[}}[0], [1, 2]] : tensor<16x64xf32> into tensor<16x16x4xf32>
+  //  CHECK-DAG: %[[B_EXPANDED:.*]] = tensor.expand_shape %[[B]] {{\[}}[0, 1], [2]] : tensor<64x?xf32> into tensor<16x4x?xf32>
+  //  CHECK-DAG: %[[D1:.*]] = tensor.dim %[[C]], %{{.*}} : tensor<16x?xf32>
+  //      CHECK: %[[INIT:.*]] = linalg.init_tensor [16, %[[D1]], 4] : tensor<16x?x4xf32>
+  //      CHECK: %[[FILL:.*]] = linalg.fill ins(%{{.*}} : f32) outs(%[[INIT]] : tensor<16x?x4xf32>)
+  //      CHECK: %[[PARTIAL:.*]] = linalg.generic
+  // CHECK-SAME:   indexing_maps = [#[[$A]], #[[$B]], #[[$C]]]
+  // CHECK-SAME:   iterator_types = ["parallel", "parallel", "reduction", "parallel"]
+  // CHECK-SAME:   ins(%[[A_EXPANDED]], %[[B_EXPANDED]] : tensor<16x16x4xf32>, tensor<16x4x?xf32>)
+  // CHECK-SAME:   outs(%[[FILL]] : tensor<16x?x4xf32>)
+  //      CHECK:   arith.mulf
+  //      CHECK:   arith.addf
+  //      CHECK: %[[RES:.*]] = linalg.generic
+  // CHECK-SAME:   indexing_maps = [#[[$ID]], #[[$OUT]]]
+  // CHECK-SAME:   iterator_types = ["parallel", "parallel", "reduction"]
+  // CHECK-SAME:   ins(%[[PARTIAL]] : tensor<16x?x4xf32>) outs(%[[C]] : tensor<16x?xf32>)
+  //      CHECK: ^bb0(%[[IN:.*]]: f32, %[[OUT:.*]]: f32):
+  //      CHECK:   %[[SUM:.*]] = arith.addf %[[OUT]], %[[IN]] : f32
+  //      CHECK:   linalg.yield %[[SUM]] : f32
+  //      CHECK: return %[[RES]]
+  %0 = linalg.generic {
+    indexing_maps = [affine_map<(d0, d1, d2) -> (d0, d2)>,
+                     affine_map<(d0, d1, d2) -> (d2, d1)>,
+                     affine_map<(d0, d1, d2) -> (d0, d1)>],
+    iterator_types = ["parallel", "parallel", "reduction"]
+  } ins(%a, %b : tensor<16x64xf32>, tensor<64x?xf32>) outs(%c : tensor<16x?xf32>) {
+  ^bb0(%arg0: f32, %arg1: f32, %arg2: f32):
+    %1 = arith.mulf %arg0, %arg1 : f32
+    %2 = arith.addf %arg2, %1 : f32
+    linalg.yield %2 : f32
+  } -> tensor<16x?xf32>
+  return %0 : tensor<16x?xf32>
+}
+
+pdl.pattern @pdl_target : benefit(1) {
+  %args = operands
+  %results = types
+  %0 = pdl.operation "linalg.generic"(%args : !pdl.range<value>) -> (%results : !pdl.range<type>)
+  %1 = pdl.attribute @matmul
+  apply_native_constraint "nestedInFunc"(%0, %1 : !pdl.operation, !pdl.attribute)
+  // TODO: we don't want this, but it is the required terminator for pdl.pattern
+  rewrite %0 with "iree_linalg_transform.apply"
+}
+
+iree_linalg_transform.sequence {
+  %0 = match @pdl_target
+  %1 = split_reduction %0 {split_factor = 4, inner_parallel = true}
+}
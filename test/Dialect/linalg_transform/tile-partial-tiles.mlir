@@ -0,0 +1,132 @@
+// RUN: mlir-proto-opt -linalg-interp-transforms --split-input-file %s | FileCheck %s
+
+// With tile sizes [16, 32, 16], the cost model pads the M dimension (24 = 16 +
+// 8) and the K dimension (31 = 16 + 15) whose partial tiles are large, and
+// peels the N dimension (1021 = 31 * 32 + 29) that has many full tiles.
+
+// CHECK-LABEL: func @matmul
+func @matmul(%arg0: tensor<24x31xf32>, %arg1: tensor<31x1021xf32>,
+             %arg2: tensor<24x1021xf32>) -> tensor<24x1021xf32> {
+  //      CHECK: scf.for
+  //      CHECK:   scf.for %{{.*}} = %{{.*}} to %[[C992:.*]] step
+  //      CHECK:     scf.for
+  //      CHECK:       tensor.pad
+  //      CHECK:       tensor.pad
+  //      CHECK:       tensor.pad
+  //      CHECK:       linalg.matmul
+  // CHECK-SAME:         ins(%{{.*}}, %{{.*}} : tensor<16x16xf32>, tensor<16x32xf32>)
+  // CHECK-SAME:         outs(%{{.*}} : tensor<16x32xf32>)
+  //      CHECK:   scf.for %{{.*}} = %[[C992]] to
+  //      CHECK:     scf.for
+  //      CHECK:       tensor.pad
+  //      CHECK:       tensor.pad
+  //      CHECK:       tensor.pad
+  //      CHECK:       linalg.matmul
+  // CHECK-SAME:         ins(%{{.*}}, %{{.*}} : tensor<16x16xf32>, tensor<16x29xf32>)
+  // CHECK-SAME:         outs(%{{.*}} : tensor<16x29xf32>)
+  %0 = linalg.matmul ins(%arg0, %arg1: tensor<24x31xf32>, tensor<31x1021xf32>)
+                     outs(%arg2: tensor<24x1021xf32>) -> tensor<24x1021xf32>
+  return %0 : tensor<24x1021xf32>
+}
+
+pdl.pattern @pdl_target : benefit(1) {
+  %args = operands
+  %results = types
+  %0 = operation "linalg.matmul"(%args : !pdl.range<value>) -> (%results : !pdl.range<type>)
+  %1 = pdl.attribute @matmul
+  apply_native_constraint "nestedInFunc"(%0, %1 : !pdl.operation, !pdl.attribute)
+  // TODO: we don't want this, but it is the required terminator for pdl.pattern
+  rewrite %0 with "iree_linalg_transform.apply"
+}
+
+iree_linalg_transform.sequence {
+  %0 = match @pdl_target
+  %1, %loops:3 = tile %0 {sizes = [16, 32, 16], partial_tiles = "auto"}
+}
+
+// -----
+
+// With tile sizes [32, 32, 16], the cost model peels both the M and the N
+// dimensions (1021 = 31 * 32 + 29). The N loop is peeled in the main M loop
+// and in its peeled copy.
+
+// CHECK-LABEL: func @matmul_peel_nested
+func @matmul_peel_nested(%arg0: tensor<1021x32xf32>, %arg1: tensor<32x1021xf32>,
+                         %arg2: tensor<1021x1021xf32>) -> tensor<1021x1021xf32> {
+  //  CHECK-NOT: tensor.pad
+  //      CHECK: scf.for
+  //      CHECK:   scf.for
+  //      CHECK:     scf.for
+  //      CHECK:       linalg.matmul
+  // CHECK-SAME:         ins(%{{.*}}, %{{.*}} : tensor<32x16xf32>, tensor<16x32xf32>)
+  //      CHECK:   scf.for
+  //      CHECK:     scf.for
+  //      CHECK:       linalg.matmul
+  // CHECK-SAME:         ins(%{{.*}}, %{{.*}} : tensor<32x16xf32>, tensor<16x29xf32>)
+  //      CHECK: scf.for
+  //      CHECK:   scf.for
+  //      CHECK:     scf.for
+  //      CHECK:       linalg.matmul
+  // CHECK-SAME:         ins(%{{.*}}, %{{.*}} : tensor<29x16xf32>, tensor<16x32xf32>)
+  //      CHECK:   scf.for
+  //      CHECK:     scf.for
+  //      CHECK:       linalg.matmul
+  // CHECK-SAME:         ins(%{{.*}}, %{{.*}} : tensor<29x16xf32>, tensor<16x29xf32>)
+  //  CHECK-NOT: linalg.matmul
+  %0 = linalg.matmul ins(%arg0, %arg1: tensor<1021x32xf32>, tensor<32x1021xf32>)
+                     outs(%arg2: tensor<1021x1021xf32>) -> tensor<1021x1021xf32>
+  return %0 : tensor<1021x1021xf32>
+}
+
+pdl.pattern @pdl_target : benefit(1) {
+  %args = operands
+  %results = types
+  %0 = operation "linalg.matmul"(%args : !pdl.range<value>) -> (%results : !pdl.range<type>)
+  %1 = pdl.attribute @matmul_peel_nested
+  apply_native_constraint "nestedInFunc"(%0, %1 : !pdl.operation, !pdl.attribute)
+  // TODO: we don't want this, but it is the required terminator for pdl.pattern
+  rewrite %0 with "iree_linalg_transform.apply"
+}
+
+iree_linalg_transform.sequence {
+  %0 = match @pdl_target
+  %1, %loops:3 = tile %0 {sizes = [32, 32, 16], partial_tiles = "auto"}
+}
+
+// -----
+
+// With `auto_mask`, masking the partial tiles of the problem of @matmul is
+// cheaper than padding and peeling them. The partial tiles are left to the
+// masked vectorization.
+
+// CHECK-LABEL: func @matmul_mask
+func @matmul_mask(%arg0: tensor<24x31xf32>, %arg1: tensor<31x1021xf32>,
+                  %arg2: tensor<24x1021xf32>) -> tensor<24x1021xf32> {
+  //  CHECK-NOT: tensor.pad
+  //      CHECK: scf.for
+  //      CHECK:   scf.for
+  //      CHECK:     scf.for
+  //      CHECK:       linalg.matmul
+  // CHECK-SAME:         ins(%{{.*}}, %{{.*}} : tensor<?x?xf32>, tensor<?x?xf32>)
+  // CHECK-SAME:         outs(%{{.*}} : tensor<?x?xf32>)
+  //  CHECK-NOT: tensor.pad
+  //  CHECK-NOT: linalg.matmul
+  %0 = linalg.matmul ins(%arg0, %arg1: tensor<24x31xf32>, tensor<31x1021xf32>)
+                     outs(%arg2: tensor<24x1021xf32>) -> tensor<24x1021xf32>
+  return %0 : tensor<24x1021xf32>
+}
+
+pdl.pattern @pdl_target : benefit(1) {
+  %args = operands
+  %results = types
+  %0 = operation "linalg.matmul"(%args : !pdl.range<value>) -> (%results : !pdl.range<type>)
+  %1 = pdl.attribute @matmul_mask
+  apply_native_constraint "nestedInFunc"(%0, %1 : !pdl.operation, !pdl.attribute)
+  // TODO: we don't want this, but it is the required terminator for pdl.pattern
+  rewrite %0 with "iree_linalg_transform.apply"
+}
+
+iree_linalg_transform.sequence {
+  %0 = match @pdl_target
+  %1, %loops:3 = tile %0 {sizes = [16, 32, 16], partial_tiles = "auto_mask"}
+}
@@ -0,0 +1,46 @@
+// RUN: mlir-proto-opt -linalg-interp-transforms %s | FileCheck %s
+
+// The dynamically-sized tiles are vectorized to their static bounding box
+// without padding copies: the transfers are out-of-bounds and masked by the
+// remaining iteration count when lowered.
+
+// CHECK-LABEL: func @matmul
+//  CHECK-SAME:   %[[A:[0-9a-z]+]]: tensor<?x?xf32>
+//  CHECK-SAME:   %[[B:[0-9a-z]+]]: tensor<?x?xf32>
+//  CHECK-SAME:   %[[C:[0-9a-z]+]]: tensor<?x?xf32>
+func @matmul(%arg0: tensor<?x?xf32>, %arg1: tensor<?x?xf32>,
+             %arg2: tensor<?x?xf32>) -> tensor<?x?xf32> {
+  //  CHECK-NOT: tensor.pad
+  //      CHECK: scf.for
+  //      CHECK:   scf.for
+  //      CHECK:     scf.for
+  //  CHECK-DAG:       %[[SA:.*]] = tensor.extract_slice %[[A]]
+  //  CHECK-DAG:       %[[SB:.*]] = tensor.extract_slice %[[B]]
+  //  CHECK-DAG:       %[[SC:.*]] = tensor.extract_slice
+  //  CHECK-NOT:       tensor.pad
+  //  CHECK-DAG:       vector.transfer_read %[[SA]]{{[^{]*}}: tensor<?x?xf32>, vector<8x4xf32>
+  //  CHECK-DAG:       vector.transfer_read %[[SB]]{{[^{]*}}: tensor<?x?xf32>, vector<4x16xf32>
+  //  CHECK-DAG:       vector.transfer_read %[[SC]]{{[^{]*}}: tensor<?x?xf32>, vector<8x16xf32>
+  //      CHECK:       %[[RES:.*]] = vector.contract
+  //      CHECK:       %[[W:.*]] = vector.transfer_write %[[RES]], %[[SC]]{{[^{]*}}: vector<8x16xf32>, tensor<?x?xf32>
+  //      CHECK:       tensor.insert_slice %[[W]]
+  %0 = linalg.matmul ins(%arg0, %arg1: tensor<?x?xf32>, tensor<?x?xf32>)
+                     outs(%arg2: tensor<?x?xf32>) -> tensor<?x?xf32>
+  return %0 : tensor<?x?xf32>
+}
+
+pdl.pattern @pdl_target : benefit(1) {
+  %args = operands
+  %results = types
+  %0 = operation "linalg.matmul"(%args : !pdl.range<value>) -> (%results : !pdl.range<type>)
+  %1 = pdl.attribute @matmul
+  apply_native_constraint "nestedInFunc"(%0, %1 : !pdl.operation, !pdl.attribute)
+  // TODO: we don't want this, but it is the required terminator for pdl.pattern
+  rewrite %0 with "iree_linalg_transform.apply"
+}
+
+iree_linalg_transform.sequence {
+  %0 = match @pdl_target
+  %1, %loops:3 = tile %0 {sizes = [8, 16, 4]}
+  %2 = vectorize %1 {vectorize_with_masking = true}
+}
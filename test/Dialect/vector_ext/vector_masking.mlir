@@ -1,4 +1,5 @@
 // RUN: mlir-proto-opt %s -test-vector-masking-utils=masking -split-input-file | FileCheck %s
+// RUN: mlir-proto-opt %s -test-vector-masking-utils="masking mask-fmas" -split-input-file | FileCheck %s --check-prefix=FMA
 
 func @func_pred0(%arg0: memref<?xf32>, %arg1: memref<?xf32>, %pred_mask: vector<16xi1>,
                  %idx: index, %incoming_mask: vector<16xi1> ) {
@@ -27,3 +28,38 @@ func @func_pred0(%arg0: memref<?xf32>, %arg1: memref<?xf32>, %pred_mask: vector<
 // CHECK:           return
 // CHECK:         }
 
+
+// -----
+
+func @func_pred_fma(%arg0: memref<?xf32>, %arg1: memref<?xf32>, %pred_mask: vector<16xi1>,
+                    %idx: index, %incoming_mask: vector<16xi1> ) {
+  vector_ext.predicate(%pred_mask, [%idx], %incoming_mask): vector<16xi1> {
+  ^bb0(%true_mask: vector<16xi1>):
+    %c0 = arith.constant 0 : index
+    %cst = arith.constant 0.000000e+00 : f32
+    %0 = vector.transfer_read %arg0[%c0], %cst {in_bounds = [true]} : memref<?xf32>, vector<16xf32>
+    %1 = vector.transfer_read %arg1[%c0], %cst {in_bounds = [true]} : memref<?xf32>, vector<16xf32>
+    %2 = vector.fma %0, %0, %1 : vector<16xf32>
+    vector.transfer_write %2, %arg1[%c0] {in_bounds = [true]} : vector<16xf32>, memref<?xf32>
+  }
+  return
+}
+
+// The vector.fma is only masked with the "mask-fmas" option.
+
+// CHECK-LABEL:   func @func_pred_fma(
+// CHECK:           %[[FMA:.*]] = vector.fma
+// CHECK-NOT:       arith.select
+// CHECK:           vector.transfer_write %[[FMA]]
+
+// FMA-LABEL:   func @func_pred_fma(
+// FMA-SAME:                        %[[VAL_0:.*]]: memref<?xf32>, %[[VAL_1:.*]]: memref<?xf32>,
+// FMA-SAME:                        %[[VAL_2:.*]]: vector<16xi1>,
+// FMA-SAME:                        %[[VAL_3:.*]]: index,
+// FMA-SAME:                        %[[VAL_4:.*]]: vector<16xi1>) {
+// FMA:           %[[MASK:.*]] = arith.andi %[[VAL_4]], %[[VAL_2]] : vector<16xi1>
+// FMA:           %[[LHS:.*]] = vector.transfer_read %[[VAL_0]]{{.*}}, %[[MASK]] {in_bounds = [true]}
+// FMA:           %[[ACC:.*]] = vector.transfer_read %[[VAL_1]]{{.*}}, %[[MASK]] {in_bounds = [true]}
+// FMA:           %[[FMA:.*]] = vector.fma %[[LHS]], %[[LHS]], %[[ACC]] : vector<16xf32>
+// FMA:           %[[SEL:.*]] = arith.select %[[MASK]], %[[FMA]], %[[ACC]] : vector<16xi1>, vector<16xf32>
+// FMA:           vector.transfer_write %[[SEL]], %[[VAL_1]]{{.*}}, %[[MASK]] {in_bounds = [true]}
@@ -0,0 +1,25 @@
+// RUN: mlir-proto-opt %s -test-vector-masking-utils="masking mask-fmas" -convert-vector-to-llvm | FileCheck %s
+
+// The masked transfers lower to masked loads and stores and the masked FMA to
+// a select of the accumulator, which the X86 backend folds into a merge-masked
+// FMA on AVX-512.
+
+// CHECK-LABEL: func @masked_fma
+//       CHECK:   %[[LHS:.*]] = llvm.intr.masked.load
+//       CHECK:   %[[ACC:.*]] = llvm.intr.masked.load
+//       CHECK:   %[[FMA:.*]] = "llvm.intr.fmuladd"(%{{.*}}, %[[LHS]], %[[ACC]])
+//       CHECK:   %[[SEL:.*]] = llvm.select %{{.*}}, %[[FMA]], %[[ACC]] : vector<16xi1>, vector<16xf32>
+//       CHECK:   llvm.intr.masked.store %[[SEL]]
+func @masked_fma(%a: vector<16xf32>, %x: memref<?xf32>, %y: memref<?xf32>,
+                 %pred_mask: vector<16xi1>, %idx: index,
+                 %incoming_mask: vector<16xi1>) {
+  vector_ext.predicate(%pred_mask, [%idx], %incoming_mask): vector<16xi1> {
+  ^bb0(%true_mask: vector<16xi1>):
+    %f0 = arith.constant 0.0 : f32
+    %vx = vector.transfer_read %x[%idx], %f0 {in_bounds = [true]} : memref<?xf32>, vector<16xf32>
+    %vy = vector.transfer_read %y[%idx], %f0 {in_bounds = [true]} : memref<?xf32>, vector<16xf32>
+    %r = vector.fma %a, %vx, %vy : vector<16xf32>
+    vector.transfer_write %r, %y[%idx] {in_bounds = [true]} : vector<16xf32>, memref<?xf32>
+  }
+  return
+}
@@ -1,5 +1,6 @@
 // RUN: mlir-proto-opt %s -allow-unregistered-dialect -split-input-file -test-vector-warp-distribute=propagate-distribution -canonicalize | FileCheck %s
 // RUN: mlir-proto-opt %s -allow-unregistered-dialect -split-input-file -test-vector-warp-distribute=rewrite-warp-ops-to-scf-if -canonicalize | FileCheck %s --check-prefix=CHECK-SCF-IF
+// RUN: mlir-proto-opt %s -allow-unregistered-dialect -split-input-file -test-vector-warp-distribute=butterfly-reductions -canonicalize | FileCheck %s --check-prefix=CHECK-BFLY
 
 // CHECK-LABEL:   func @warp_dead_result(
 func @warp_dead_result(%laneid: index) -> (vector<1xf32>) {
@@ -200,7 +201,6 @@ func @rewrite_warp_op_to_scf_if(%laneid: index,
 
 // CHECK-LABEL: func @vector_reduction(
 //  CHECK-SAME:     %[[laneid:.*]]: index)
-//   CHECK-DAG:   %[[c0:.*]] = arith.constant 0 : i32
 //   CHECK-DAG:   %[[c1:.*]] = arith.constant 1 : i32
 //   CHECK-DAG:   %[[c2:.*]] = arith.constant 2 : i32
 //   CHECK-DAG:   %[[c4:.*]] = arith.constant 4 : i32
@@ -211,18 +211,18 @@ func @rewrite_warp_op_to_scf_if(%laneid: index,
 //       CHECK:     vector_ext.yield %{{.*}} : vector<32xf32>
 //       CHECK:   }
 //       CHECK:   %[[a:.*]] = vector.extract %[[warp_op]][0] : vector<1xf32>
-//       CHECK:   %[[r0:.*]], %{{.*}} = gpu.shuffle  down %[[a]], %[[c16]], %[[c32]]
+//       CHECK:   %[[r0:.*]], %{{.*}} = gpu.shuffle  xor %[[a]], %[[c16]], %[[c32]]
 //       CHECK:   %[[a0:.*]] = arith.addf %[[a]], %[[r0]]
-//       CHECK:   %[[r1:.*]], %{{.*}} = gpu.shuffle  down %[[a0]], %[[c8]], %[[c32]]
+//       CHECK:   %[[r1:.*]], %{{.*}} = gpu.shuffle  xor %[[a0]], %[[c8]], %[[c32]]
 //       CHECK:   %[[a1:.*]] = arith.addf %[[a0]], %[[r1]]
-//       CHECK:   %[[r2:.*]], %{{.*}} = gpu.shuffle  down %[[a1]], %[[c4]], %[[c32]]
+//       CHECK:   %[[r2:.*]], %{{.*}} = gpu.shuffle  xor %[[a1]], %[[c4]], %[[c32]]
 //       CHECK:   %[[a2:.*]] = arith.addf %[[a1]], %[[r2]]
-//       CHECK:   %[[r3:.*]], %{{.*}} = gpu.shuffle  down %[[a2]], %[[c2]], %[[c32]]
+//       CHECK:   %[[r3:.*]], %{{.*}} = gpu.shuffle  xor %[[a2]], %[[c2]], %[[c32]]
 //       CHECK:   %[[a3:.*]] = arith.addf %[[a2]], %[[r3]]
-//       CHECK:   %[[r4:.*]], %{{.*}} = gpu.shuffle  down %[[a3]], %[[c1]], %[[c32]]
+//       CHECK:   %[[r4:.*]], %{{.*}} = gpu.shuffle  xor %[[a3]], %[[c1]], %[[c32]]
 //       CHECK:   %[[a4:.*]] = arith.addf %[[a3]], %[[r4]]
-//       CHECK:   %[[broadcasted:.*]], %{{.*}} = gpu.shuffle  idx %[[a4]], %[[c0]], %[[c32]]
-//       CHECK:   vector.print %[[broadcasted]] : f32
+//   CHECK-NOT:   gpu.shuffle
+//       CHECK:   vector.print %[[a4]] : f32
 func @vector_reduction(%laneid: index) {
   %r = vector_ext.warp_execute_on_lane_0(%laneid)[32] -> (f32) {
     %0 = "some_def"() : () -> (vector<32xf32>)
@@ -418,28 +418,26 @@ func @warp_scf_for_multiple_yield(%arg0: index, %arg1: memref<?xf32>, %arg2: mem
 //       CHECK:     %[[slice2:.*]] = vector.extract_strided_slice %[[some_def]] {offsets = [32], sizes = [32]
 //       CHECK:     vector_ext.yield %[[slice1]], %[[slice2]]
 //       CHECK:   }
-//       CHECK:   gpu.shuffle  down
+//       CHECK:   gpu.shuffle  xor
 //  CHECK-NEXT:   arith.addf
-//  CHECK-NEXT:   gpu.shuffle  down
+//  CHECK-NEXT:   gpu.shuffle  xor
 //  CHECK-NEXT:   arith.addf
-//  CHECK-NEXT:   gpu.shuffle  down
+//  CHECK-NEXT:   gpu.shuffle  xor
 //  CHECK-NEXT:   arith.addf
-//  CHECK-NEXT:   gpu.shuffle  down
+//  CHECK-NEXT:   gpu.shuffle  xor
 //  CHECK-NEXT:   arith.addf
-//  CHECK-NEXT:   gpu.shuffle  down
+//  CHECK-NEXT:   gpu.shuffle  xor
+//  CHECK-NEXT:   %[[r0:.*]] = arith.addf
+//       CHECK:   gpu.shuffle  xor
 //  CHECK-NEXT:   arith.addf
-//  CHECK-NEXT:   %[[r0:.*]], %{{.*}} = gpu.shuffle  idx
-//       CHECK:   gpu.shuffle  down
+//  CHECK-NEXT:   gpu.shuffle  xor
 //  CHECK-NEXT:   arith.addf
-//  CHECK-NEXT:   gpu.shuffle  down
+//  CHECK-NEXT:   gpu.shuffle  xor
 //  CHECK-NEXT:   arith.addf
-//  CHECK-NEXT:   gpu.shuffle  down
+//  CHECK-NEXT:   gpu.shuffle  xor
 //  CHECK-NEXT:   arith.addf
-//  CHECK-NEXT:   gpu.shuffle  down
-//  CHECK-NEXT:   arith.addf
-//  CHECK-NEXT:   gpu.shuffle  down
-//  CHECK-NEXT:   arith.addf
-//  CHECK-NEXT:   %[[r1:.*]], %{{.*}} = gpu.shuffle  idx
+//  CHECK-NEXT:   gpu.shuffle  xor
+//  CHECK-NEXT:   %[[r1:.*]] = arith.addf
 //       CHECK:   %[[result:.*]] = arith.addf %[[r1]], %[[r0]] : f32
 //       CHECK:   vector.print %[[result]]
 func @large_vector_reduction(%laneid: index) {
@@ -451,3 +449,140 @@ func @large_vector_reduction(%laneid: index) {
   vector.print %r : f32
   return
 }
+
+// -----
+
+// CHECK-LABEL: func @vector_reduction_acc(
+//       CHECK:   %[[warp_op:.*]]:2 = vector_ext.warp_execute_on_lane_0(%{{.*}})[32] -> (vector<1xf32>, f32) {
+//       CHECK:     %[[def:.*]] = "some_def"() : () -> vector<32xf32>
+//       CHECK:     %[[acc:.*]] = "some_acc"() : () -> f32
+//       CHECK:     vector_ext.yield %[[def]], %[[acc]] : vector<32xf32>, f32
+//       CHECK:   }
+//       CHECK:   %[[a:.*]] = vector.extract %[[warp_op]]#0[0] : vector<1xf32>
+//       CHECK:   gpu.shuffle  xor
+//       CHECK:   gpu.shuffle  xor
+//       CHECK:   gpu.shuffle  xor
+//       CHECK:   gpu.shuffle  xor
+//       CHECK:   %[[r4:.*]], %{{.*}} = gpu.shuffle  xor
+//       CHECK:   %[[a4:.*]] = arith.addf %{{.*}}, %[[r4]] : f32
+//       CHECK:   %[[result:.*]] = arith.addf %[[a4]], %[[warp_op]]#1 : f32
+//       CHECK:   vector.print %[[result]] : f32
+func @vector_reduction_acc(%laneid: index) {
+  %r = vector_ext.warp_execute_on_lane_0(%laneid)[32] -> (f32) {
+    %0 = "some_def"() : () -> (vector<32xf32>)
+    %1 = "some_acc"() : () -> (f32)
+    %2 = vector.reduction <add>, %0, %1 : vector<32xf32> into f32
+    vector_ext.yield %2 : f32
+  }
+  vector.print %r : f32
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @vector_multi_reduction(
+//       CHECK:   %[[warp_op:.*]] = vector_ext.warp_execute_on_lane_0(%{{.*}})[32] -> (vector<2x2xf32>) {
+//       CHECK:     %[[def:.*]] = "some_def"() : () -> vector<2x64xf32>
+//       CHECK:     vector_ext.yield %[[def]] : vector<2x64xf32>
+//       CHECK:   }
+//       CHECK:   %[[a:.*]] = vector.multi_reduction <maxf>, %[[warp_op]] [1] : vector<2x2xf32> to vector<2xf32>
+//       CHECK:   %[[e0:.*]] = vector.extract %[[a]][0] : vector<2xf32>
+//       CHECK:   %[[s0:.*]], %{{.*}} = gpu.shuffle  xor %[[e0]]
+//       CHECK:   %[[e1:.*]] = vector.extract %[[a]][1] : vector<2xf32>
+//       CHECK:   %[[s1:.*]], %{{.*}} = gpu.shuffle  xor %[[e1]]
+//       CHECK:   arith.maxf %[[a]], %{{.*}} : vector<2xf32>
+// CHECK-COUNT-8:   gpu.shuffle  xor
+//       CHECK:   %[[result:.*]] = arith.maxf %{{.*}}, %{{.*}} : vector<2xf32>
+//       CHECK:   vector.print %[[result]] : vector<2xf32>
+func @vector_multi_reduction(%laneid: index) {
+  %r = vector_ext.warp_execute_on_lane_0(%laneid)[32] -> (vector<2xf32>) {
+    %0 = "some_def"() : () -> (vector<2x64xf32>)
+    %1 = vector.multi_reduction <maxf>, %0 [1] : vector<2x64xf32> to vector<2xf32>
+    vector_ext.yield %1 : vector<2xf32>
+  }
+  vector.print %r : vector<2xf32>
+  return
+}
+
+// -----
+
+// CHECK-BFLY-LABEL: func @butterfly_reduction(
+//  CHECK-BFLY-SAME:     %[[v:.*]]: vector<8xf32>, %[[acc:.*]]: f32)
+//       CHECK-BFLY:   %[[s0:.*]] = vector.shuffle %[[v]], %[[v]] [4, 5, 6, 7, 0, 1, 2, 3] : vector<8xf32>, vector<8xf32>
+//       CHECK-BFLY:   %[[a0:.*]] = arith.addf %[[v]], %[[s0]] : vector<8xf32>
+//       CHECK-BFLY:   %[[s1:.*]] = vector.shuffle %[[a0]], %[[a0]] [2, 3, 0, 1, 6, 7, 4, 5] : vector<8xf32>, vector<8xf32>
+//       CHECK-BFLY:   %[[a1:.*]] = arith.addf %[[a0]], %[[s1]] : vector<8xf32>
+//       CHECK-BFLY:   %[[s2:.*]] = vector.shuffle %[[a1]], %[[a1]] [1, 0, 3, 2, 5, 4, 7, 6] : vector<8xf32>, vector<8xf32>
+//       CHECK-BFLY:   %[[a2:.*]] = arith.addf %[[a1]], %[[s2]] : vector<8xf32>
+//       CHECK-BFLY:   %[[e:.*]] = vector.extract %[[a2]][0] : vector<8xf32>
+//       CHECK-BFLY:   %[[r:.*]] = arith.addf %[[e]], %[[acc]] : f32
+//       CHECK-BFLY:   return %[[r]] : f32
+func @butterfly_reduction(%v: vector<8xf32>, %acc: f32) -> f32 {
+  %0 = vector.reduction <add>, %v, %acc : vector<8xf32> into f32
+  return %0 : f32
+}
+
+// -----
+
+#map0 = affine_map<(d0, d1, d2) -> (d0, d2)>
+#map1 = affine_map<(d0, d1, d2) -> (d2, d1)>
+#map2 = affine_map<(d0, d1, d2) -> (d0, d1)>
+
+// CHECK-LABEL: func @vector_contract(
+//       CHECK:   %[[W:.*]]:3 = vector_ext.warp_execute_on_lane_0(%{{.*}})[32] -> (vector<16x8xf32>, vector<8x2xf32>, vector<16x2xf32>) {
+//       CHECK:     %[[A:.*]] = "some_def"() : () -> vector<16x8xf32>
+//       CHECK:     %[[B:.*]] = "some_def"() : () -> vector<8x64xf32>
+//       CHECK:     %[[C:.*]] = "some_def"() : () -> vector<16x64xf32>
+//       CHECK:     vector_ext.yield %[[A]], %[[B]], %[[C]] : vector<16x8xf32>, vector<8x64xf32>, vector<16x64xf32>
+//       CHECK:   }
+//       CHECK:   %[[R:.*]] = vector.contract {{.*}} %[[W]]#0, %[[W]]#1, %[[W]]#2 : vector<16x8xf32>, vector<8x2xf32> into vector<16x2xf32>
+//       CHECK:   return %[[R]] : vector<16x2xf32>
+func @vector_contract(%laneid: index) -> vector<16x2xf32> {
+  %r = vector_ext.warp_execute_on_lane_0(%laneid)[32] -> (vector<16x2xf32>) {
+    %a = "some_def"() : () -> (vector<16x8xf32>)
+    %b = "some_def"() : () -> (vector<8x64xf32>)
+    %c = "some_def"() : () -> (vector<16x64xf32>)
+    %d = vector.contract {indexing_maps = [#map0, #map1, #map2],
+                          iterator_types = ["parallel", "parallel", "reduction"],
+                          kind = #vector.kind<add>}
+      %a, %b, %c : vector<16x8xf32>, vector<8x64xf32> into vector<16x64xf32>
+    vector_ext.yield %d : vector<16x64xf32>
+  }
+  return %r : vector<16x2xf32>
+}
+
+// -----
+
+#map0 = affine_map<(d0, d1, d2) -> (d0, d2)>
+#map1 = affine_map<(d0, d1, d2) -> (d2, d1)>
+#map2 = affine_map<(d0, d1, d2) -> (d0, d1)>
+
+// The matmul is distributed along the rows of the lhs and the accumulator,
+// every lane reads the whole rhs.
+
+//   CHECK-DAG: #[[MAP:.*]] = affine_map<()[s0] -> (s0 * 2)>
+// CHECK-LABEL: func @warp_matmul(
+//  CHECK-SAME:     %[[laneid:.*]]: index, %[[A:.*]]: memref<64x8xf32>, %[[B:.*]]: memref<8x16xf32>, %[[C:.*]]: memref<64x16xf32>)
+//   CHECK-DAG:   %[[c0:.*]] = arith.constant 0 : index
+//   CHECK-DAG:   %[[ID:.*]] = affine.apply #[[MAP]]()[%[[laneid]]]
+//   CHECK-DAG:   %[[RA:.*]] = vector.transfer_read %[[A]][%[[ID]], %[[c0]]], %{{.*}} : memref<64x8xf32>, vector<2x8xf32>
+//   CHECK-DAG:   %[[RB:.*]] = vector.transfer_read %[[B]][%[[c0]], %[[c0]]], %{{.*}} : memref<8x16xf32>, vector<8x16xf32>
+//   CHECK-DAG:   %[[RC:.*]] = vector.transfer_read %[[C]][%[[ID]], %[[c0]]], %{{.*}} : memref<64x16xf32>, vector<2x16xf32>
+//       CHECK:   %[[R:.*]] = vector.contract {{.*}} %[[RA]], %[[RB]], %[[RC]] : vector<2x8xf32>, vector<8x16xf32> into vector<2x16xf32>
+//       CHECK:   return %[[R]] : vector<2x16xf32>
+func @warp_matmul(%laneid: index, %A: memref<64x8xf32>, %B: memref<8x16xf32>,
+                  %C: memref<64x16xf32>) -> vector<2x16xf32> {
+  %c0 = arith.constant 0 : index
+  %cst = arith.constant 0.000000e+00 : f32
+  %r = vector_ext.warp_execute_on_lane_0(%laneid)[32] -> (vector<2x16xf32>) {
+    %a = vector.transfer_read %A[%c0, %c0], %cst : memref<64x8xf32>, vector<64x8xf32>
+    %b = vector.transfer_read %B[%c0, %c0], %cst : memref<8x16xf32>, vector<8x16xf32>
+    %c = vector.transfer_read %C[%c0, %c0], %cst : memref<64x16xf32>, vector<64x16xf32>
+    %d = vector.contract {indexing_maps = [#map0, #map1, #map2],
+                          iterator_types = ["parallel", "parallel", "reduction"],
+                          kind = #vector.kind<add>}
+      %a, %b, %c : vector<64x8xf32>, vector<8x16xf32> into vector<64x16xf32>
+    vector_ext.yield %d : vector<64x16xf32>
+  }
+  return %r : vector<2x16xf32>
+}
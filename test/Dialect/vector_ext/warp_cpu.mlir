@@ -0,0 +1,114 @@
+// RUN: mlir-proto-opt %s -allow-unregistered-dialect -split-input-file -test-vector-warp-distribute=rewrite-warp-lane-loops-to-cpu -canonicalize | FileCheck %s
+// RUN: mlir-proto-opt %s -allow-unregistered-dialect -split-input-file -test-vector-warp-distribute="rewrite-warp-lane-loops-to-cpu parallel-lanes" -canonicalize | FileCheck %s --check-prefix=CHECK-PAR
+
+// CHECK-LABEL: func @warp_lane_loop(
+//  CHECK-SAME:   %[[A:[0-9a-z]+]]: memref<128xf32>
+//  CHECK-SAME:   %[[B:[0-9a-z]+]]: memref<64xf32>
+//   CHECK-DAG:   %[[ARG_BUF:.*]] = memref.alloca() : memref<128xf32>
+//   CHECK-DAG:   %[[RES_BUF:.*]] = memref.alloca() : memref<32xf32>
+//   CHECK-DAG:   %[[SCALAR_BUF:.*]] = memref.alloca() : memref<1xf32>
+//       CHECK:   scf.for %[[L0:.*]] = %{{.*}} to %{{.*}} step %{{.*}} {
+//       CHECK:     %[[V:.*]] = vector.transfer_read %[[A]]
+//       CHECK:     vector.store %[[V]], %[[ARG_BUF]][%{{.*}}] : memref<128xf32>, vector<4xf32>
+//       CHECK:   }
+//       CHECK:   %[[ARG:.*]] = vector.load %[[ARG_BUF]][%{{.*}}] : memref<128xf32>, vector<128xf32>
+//       CHECK:   %[[DEF:.*]] = "some_def"(%[[ARG]])
+//       CHECK:   %[[S:.*]] = "some_scalar_def"()
+//       CHECK:   vector.store %[[DEF]], %[[RES_BUF]][%{{.*}}] : memref<32xf32>, vector<32xf32>
+//       CHECK:   memref.store %[[S]], %[[SCALAR_BUF]][%{{.*}}] : memref<1xf32>
+//       CHECK:   scf.for %[[L1:.*]] = %{{.*}} to %{{.*}} step %{{.*}} {
+//   CHECK-NOT:     vector.transfer_read
+//   CHECK-DAG:     %[[IDX:.*]] = arith.addi %[[L1]], %{{.*}} : index
+//   CHECK-DAG:     %[[R:.*]] = vector.load %[[RES_BUF]][%[[L1]]] : memref<32xf32>, vector<1xf32>
+//   CHECK-DAG:     %[[SR:.*]] = memref.load %[[SCALAR_BUF]][%{{.*}}] : memref<1xf32>
+//       CHECK:     %[[SV:.*]] = vector.broadcast %[[SR]] : f32 to vector<1xf32>
+//       CHECK:     %[[M:.*]] = arith.mulf %[[R]], %[[SV]] : vector<1xf32>
+//       CHECK:     vector.transfer_write %[[M]], %[[B]][%[[IDX]]]
+//   CHECK-NOT:   vector_ext.warp_execute_on_lane_0
+
+// CHECK-PAR-LABEL: func @warp_lane_loop(
+//   CHECK-PAR-NOT:   scf.for
+//       CHECK-PAR:   scf.parallel
+//       CHECK-PAR:     vector.store
+//       CHECK-PAR:   "some_def"
+//       CHECK-PAR:   scf.parallel
+//       CHECK-PAR:     vector.load
+//   CHECK-PAR-NOT:   scf.for
+func @warp_lane_loop(%a: memref<128xf32>, %b: memref<64xf32>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c4 = arith.constant 4 : index
+  %c32 = arith.constant 32 : index
+  %cst = arith.constant 0.000000e+00 : f32
+  scf.for %laneid = %c0 to %c32 step %c1 {
+    %offset = arith.muli %laneid, %c4 : index
+    %idx = arith.addi %laneid, %c32 : index
+    %v = vector.transfer_read %a[%offset], %cst {in_bounds = [true]} : memref<128xf32>, vector<4xf32>
+    %r:2 = vector_ext.warp_execute_on_lane_0(%laneid)[32]
+        args(%v : vector<4xf32>) -> (vector<1xf32>, f32) {
+    ^bb0(%arg: vector<128xf32>):
+      %0 = "some_def"(%arg) : (vector<128xf32>) -> (vector<32xf32>)
+      %1 = "some_scalar_def"() : () -> (f32)
+      vector_ext.yield %0, %1 : vector<32xf32>, f32
+    }
+    %s = vector.broadcast %r#1 : f32 to vector<1xf32>
+    %m = arith.mulf %r#0, %s : vector<1xf32>
+    vector.transfer_write %m, %b[%idx] {in_bounds = [true]} : vector<1xf32>, memref<64xf32>
+  }
+  return
+}
+
+// -----
+
+// Every warp op splits the lane loop.
+
+// CHECK-LABEL: func @warp_lane_loop_two_warp_ops(
+//       CHECK:   "some_def"
+//       CHECK:   scf.for
+//       CHECK:     "some_use"
+//       CHECK:   }
+//       CHECK:   "some_other_def"
+//       CHECK:   scf.for
+//       CHECK:     "some_other_use"
+//       CHECK:   }
+//   CHECK-NOT:   vector_ext.warp_execute_on_lane_0
+func @warp_lane_loop_two_warp_ops() {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c32 = arith.constant 32 : index
+  scf.for %laneid = %c0 to %c32 step %c1 {
+    %r0 = vector_ext.warp_execute_on_lane_0(%laneid)[32] -> (vector<2xf32>) {
+      %0 = "some_def"() : () -> (vector<64xf32>)
+      vector_ext.yield %0 : vector<64xf32>
+    }
+    "some_use"(%r0) : (vector<2xf32>) -> ()
+    %r1 = vector_ext.warp_execute_on_lane_0(%laneid)[32] -> (vector<2xf32>) {
+      %1 = "some_other_def"() : () -> (vector<64xf32>)
+      vector_ext.yield %1 : vector<64xf32>
+    }
+    "some_other_use"(%r1) : (vector<2xf32>) -> ()
+  }
+  return
+}
+
+// -----
+
+// The warp region executes once for all the lanes and cannot use values of a
+// single lane.
+
+// CHECK-LABEL: func @warp_lane_loop_uses_lane_value(
+//       CHECK:   scf.for
+//       CHECK:     vector_ext.warp_execute_on_lane_0
+func @warp_lane_loop_uses_lane_value() {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c32 = arith.constant 32 : index
+  scf.for %laneid = %c0 to %c32 step %c1 {
+    %r = vector_ext.warp_execute_on_lane_0(%laneid)[32] -> (vector<1xf32>) {
+      %0 = "some_def"(%laneid) : (index) -> (vector<32xf32>)
+      vector_ext.yield %0 : vector<32xf32>
+    }
+    "some_use"(%r) : (vector<1xf32>) -> ()
+  }
+  return
+}
@@ -0,0 +1,53 @@
+// RUN: mlir-proto-opt %s -async-to-async-runtime -async-runtime-ref-counting \
+// RUN:   -async-runtime-ref-counting-opt -arith-expand -convert-async-to-llvm \
+// RUN:   -convert-scf-to-cf -convert-vector-to-llvm -convert-arith-to-llvm -convert-memref-to-llvm \
+// RUN:   -convert-func-to-llvm -reconcile-unrealized-casts > %t
+
+// RUN: env SANDBOX_ASYNC_NUM_THREADS=1 mlir-cpu-runner %t -e main -entry-point-result=void \
+// RUN:   -shared-libs=%mlir_runner_utils_dir/libmlir_c_runner_utils%shlibext \
+// RUN:   -shared-libs=%mlir_runner_utils_dir/libmlir_async_runtime_copy%shlibext | \
+// RUN: FileCheck %s
+
+// RUN: env SANDBOX_ASYNC_NUM_THREADS=2 mlir-cpu-runner %t -e main -entry-point-result=void \
+// RUN:   -shared-libs=%mlir_runner_utils_dir/libmlir_c_runner_utils%shlibext \
+// RUN:   -shared-libs=%mlir_runner_utils_dir/libmlir_async_runtime_copy%shlibext | \
+// RUN: FileCheck %s
+
+// RUN: env SANDBOX_ASYNC_NUM_THREADS=4 mlir-cpu-runner %t -e main -entry-point-result=void \
+// RUN:   -shared-libs=%mlir_runner_utils_dir/libmlir_c_runner_utils%shlibext \
+// RUN:   -shared-libs=%mlir_runner_utils_dir/libmlir_async_runtime_copy%shlibext | \
+// RUN: FileCheck %s
+
+// Every link of the chain spawns the next one in an async task and blocks on
+// its token, the blocked threads are soon nested too deep to run the next
+// links inline: the runtime must still run them.
+func @link(%i: index, %n: index, %count: memref<index>) {
+  %c1 = arith.constant 1 : index
+  %continue = arith.cmpi ult, %i, %n : index
+  scf.if %continue {
+    %next = arith.addi %i, %c1 : index
+    %token = async.execute {
+      call @link(%next, %n, %count) : (index, index, memref<index>) -> ()
+      async.yield
+    }
+    async.await %token : !async.token
+  }
+  %0 = memref.load %count[] : memref<index>
+  %1 = arith.addi %0, %c1 : index
+  memref.store %1, %count[] : memref<index>
+  return
+}
+
+func @main() {
+  %c0 = arith.constant 0 : index
+  %c1000 = arith.constant 1000 : index
+  %count = memref.alloc() : memref<index>
+  memref.store %c0, %count[] : memref<index>
+  call @link(%c0, %c1000, %count) : (index, index, memref<index>) -> ()
+  %0 = memref.load %count[] : memref<index>
+  %1 = arith.index_cast %0 : index to i64
+  // CHECK: 1001
+  vector.print %1 : i64
+  memref.dealloc %count : memref<index>
+  return
+}
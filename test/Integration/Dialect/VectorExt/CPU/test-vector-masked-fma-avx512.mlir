@@ -0,0 +1,75 @@
+// REQUIRES: avx512f
+// RUN: mlir-proto-opt %s -test-vector-masking-utils="masking mask-fmas" \
+// RUN:   -convert-scf-to-cf -convert-vector-to-llvm -convert-arith-to-llvm -convert-memref-to-llvm \
+// RUN:   -convert-func-to-llvm -reconcile-unrealized-casts | \
+// RUN: mlir-cpu-runner -e entry -entry-point-result=void -mattr=+avx512f \
+// RUN:   -shared-libs=%mlir_runner_utils_dir/libmlir_c_runner_utils%shlibext | \
+// RUN: FileCheck %s
+
+// Computes y = a * x + y by vectors of 16 elements. The last partial vector is
+// predicated by the mask of the remaining elements, instead of being peeled.
+// After masking, the loads, stores and FMAs of all the iterations lower to
+// AVX-512 operations masked by a k register.
+func @saxpy(%a: f32, %x: memref<?xf32>, %y: memref<?xf32>) {
+  %c0 = arith.constant 0 : index
+  %c16 = arith.constant 16 : index
+  %f0 = arith.constant 0.0 : f32
+  %all = arith.constant dense<true> : vector<16xi1>
+  %n = memref.dim %x, %c0 : memref<?xf32>
+  %va = vector.broadcast %a : f32 to vector<16xf32>
+  scf.for %i = %c0 to %n step %c16 {
+    %rem = arith.subi %n, %i : index
+    %mask = vector.create_mask %rem : vector<16xi1>
+    vector_ext.predicate(%mask, [%i], %all) : vector<16xi1> {
+    ^bb0(%true_mask: vector<16xi1>):
+      %vx = vector.transfer_read %x[%i], %f0 {in_bounds = [true]} : memref<?xf32>, vector<16xf32>
+      %vy = vector.transfer_read %y[%i], %f0 {in_bounds = [true]} : memref<?xf32>, vector<16xf32>
+      %r = vector.fma %va, %vx, %vy : vector<16xf32>
+      vector.transfer_write %r, %y[%i] {in_bounds = [true]} : vector<16xf32>, memref<?xf32>
+    }
+  }
+  return
+}
+
+func @entry() {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c16 = arith.constant 16 : index
+  %c32 = arith.constant 32 : index
+  %c37 = arith.constant 37 : index
+  %c48 = arith.constant 48 : index
+  %f0 = arith.constant 0.0 : f32
+  %f1 = arith.constant 1.0 : f32
+  %f2 = arith.constant 2.0 : f32
+
+  // x has 37 elements x[i] = i, y has 48 elements y[i] = 1 of which only the
+  // first 37 are updated.
+  %x = memref.alloc(%c37) : memref<?xf32>
+  %y = memref.alloc(%c48) : memref<?xf32>
+  scf.for %i = %c0 to %c48 step %c1 {
+    %i_i32 = arith.index_cast %i : index to i32
+    %i_f32 = arith.sitofp %i_i32 : i32 to f32
+    %in_x = arith.cmpi ult, %i, %c37 : index
+    scf.if %in_x {
+      memref.store %i_f32, %x[%i] : memref<?xf32>
+    }
+    memref.store %f1, %y[%i] : memref<?xf32>
+  }
+
+  call @saxpy(%f2, %x, %y) : (f32, memref<?xf32>, memref<?xf32>) -> ()
+
+  %r0 = vector.transfer_read %y[%c0], %f0 {in_bounds = [true]} : memref<?xf32>, vector<16xf32>
+  %r1 = vector.transfer_read %y[%c16], %f0 {in_bounds = [true]} : memref<?xf32>, vector<16xf32>
+  %r2 = vector.transfer_read %y[%c32], %f0 {in_bounds = [true]} : memref<?xf32>, vector<16xf32>
+  vector.print %r0 : vector<16xf32>
+  vector.print %r1 : vector<16xf32>
+  vector.print %r2 : vector<16xf32>
+
+  memref.dealloc %x : memref<?xf32>
+  memref.dealloc %y : memref<?xf32>
+  return
+}
+
+// CHECK: ( 1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31 )
+// CHECK: ( 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63 )
+// CHECK: ( 65, 67, 69, 71, 73, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 )
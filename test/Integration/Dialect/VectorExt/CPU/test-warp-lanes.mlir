@@ -0,0 +1,60 @@
+// RUN: mlir-proto-opt %s -test-vector-warp-distribute=rewrite-warp-lane-loops-to-cpu -canonicalize \
+// RUN:   -convert-scf-to-cf -convert-vector-to-llvm -convert-arith-to-llvm -convert-memref-to-llvm \
+// RUN:   -convert-func-to-llvm -reconcile-unrealized-casts | \
+// RUN: mlir-cpu-runner -e main -entry-point-result=void \
+// RUN:   -shared-libs=%mlir_runner_utils_dir/libmlir_c_runner_utils%shlibext | \
+// RUN: FileCheck %s
+
+// RUN: mlir-proto-opt %s -test-vector-warp-distribute="rewrite-warp-lane-loops-to-cpu parallel-lanes" -canonicalize \
+// RUN:   -async-parallel-for -async-to-async-runtime -async-runtime-ref-counting \
+// RUN:   -async-runtime-ref-counting-opt -arith-expand -convert-async-to-llvm \
+// RUN:   -convert-scf-to-cf -convert-vector-to-llvm -convert-arith-to-llvm -convert-memref-to-llvm \
+// RUN:   -convert-func-to-llvm -reconcile-unrealized-casts | \
+// RUN: mlir-cpu-runner -e main -entry-point-result=void \
+// RUN:   -shared-libs=%mlir_runner_utils_dir/libmlir_c_runner_utils%shlibext \
+// RUN:   -shared-libs=%mlir_runner_utils_dir/libmlir_runner_utils%shlibext \
+// RUN:   -shared-libs=%mlir_runner_utils_dir/libmlir_async_runtime%shlibext | \
+// RUN: FileCheck %s
+
+// The lanes of the warp are the iterations of the loop, the warp region adds
+// the full vectors once and every lane squares its element of the sum.
+func @lanes(%arg0: memref<32xf32>, %arg1: memref<32xf32>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c32 = arith.constant 32 : index
+  %cst = arith.constant 0.000000e+00 : f32
+  scf.for %laneid = %c0 to %c32 step %c1 {
+    %r = vector_ext.warp_execute_on_lane_0(%laneid)[32] -> (vector<1xf32>) {
+      %0 = vector.transfer_read %arg0[%c0], %cst {in_bounds = [true]} : memref<32xf32>, vector<32xf32>
+      %1 = vector.transfer_read %arg1[%c0], %cst {in_bounds = [true]} : memref<32xf32>, vector<32xf32>
+      %2 = arith.addf %0, %1 : vector<32xf32>
+      vector_ext.yield %2 : vector<32xf32>
+    }
+    %3 = arith.mulf %r, %r : vector<1xf32>
+    vector.transfer_write %3, %arg0[%laneid] {in_bounds = [true]} : vector<1xf32>, memref<32xf32>
+  }
+  return
+}
+
+func @main() {
+  %cst = arith.constant 0.000000e+00 : f32
+  %c0 = arith.constant 0 : index
+  %0 = memref.alloc() : memref<32xf32>
+  %1 = memref.alloc() : memref<32xf32>
+  %cst_1 = arith.constant dense<[
+    0.0,  1.0,  2.0,  3.0,  4.0,  5.0,  6.0,  7.0,
+    8.0,  9.0,  10.0, 11.0, 12.0, 13.0, 14.0, 15.0,
+    16.0, 17.0, 18.0, 19.0, 20.0, 21.0, 22.0, 23.0,
+    24.0, 25.0, 26.0, 27.0, 28.0, 29.0, 30.0, 31.0]> : vector<32xf32>
+  %cst_2 = arith.constant dense<2.000000e+00> : vector<32xf32>
+  vector.transfer_write %cst_1, %0[%c0] {in_bounds = [true]} : vector<32xf32>, memref<32xf32>
+  vector.transfer_write %cst_2, %1[%c0] {in_bounds = [true]} : vector<32xf32>, memref<32xf32>
+  call @lanes(%0, %1) : (memref<32xf32>, memref<32xf32>) -> ()
+  %2 = vector.transfer_read %0[%c0], %cst : memref<32xf32>, vector<32xf32>
+  vector.print %2 : vector<32xf32>
+  memref.dealloc %0 : memref<32xf32>
+  memref.dealloc %1 : memref<32xf32>
+  return
+}
+
+// CHECK: ( 4, 9, 16, 25, 36, 49, 64, 81, 100, 121, 144, 169, 196, 225, 256, 289, 324, 361, 400, 441, 484, 529, 576, 625, 676, 729, 784, 841, 900, 961, 1024, 1089 )
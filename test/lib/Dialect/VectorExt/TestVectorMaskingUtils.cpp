@@ -48,6 +48,10 @@ struct TestVectorMaskingUtils
                               llvm::cl::desc("Test vector masking"),
                               llvm::cl::init(false)};
 
+  Option<bool> maskFMAs{*this, "mask-fmas",
+                        llvm::cl::desc("Also mask vector.fma ops"),
+                        llvm::cl::init(false)};
+
   void testPredication() {
     // Try different testing approaches until one triggers the predication
     // transformation for that particular function.
@@ -91,8 +95,9 @@ struct TestVectorMaskingUtils
   void testMasking() {
     FuncOp funcOp = getOperation();
     OpBuilder builder(funcOp);
-    if (failed(maskVectorPredicateOps(builder, funcOp,
-                                      maskGenericOpWithSideEffects)))
+    auto maskGenericOp = maskFMAs ? maskGenericOpWithSideEffectsAndFMAs
+                                  : maskGenericOpWithSideEffects;
+    if (failed(maskVectorPredicateOps(builder, funcOp, maskGenericOp)))
       funcOp.emitError("Masking of function failed");
   }
 
@@ -10,6 +10,7 @@
 #include "Dialect/VectorExt/VectorExtWarpUtils.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/SCF.h"
 #include "mlir/Dialect/Vector/IR/VectorOps.h"
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/Visitors.h"
@@ -67,6 +68,24 @@ static Value allocateGlobalSharedMemory(Location loc, OpBuilder &builder,
   return builder.create<memref::GetGlobalOp>(loc, memrefType, symbolName);
 }
 
+/// Allocate a buffer shared by all the lanes on the stack of the function to
+/// test the CPU lowering of WarpExecuteOnLane0Op.
+static Value allocateStackMemory(Location loc, OpBuilder &builder,
+                                 WarpExecuteOnLane0Op warpOp, Type type) {
+  MemRefType memrefType;
+  if (auto vectorType = type.dyn_cast<VectorType>()) {
+    memrefType =
+        MemRefType::get(vectorType.getShape(), vectorType.getElementType());
+  } else {
+    memrefType = MemRefType::get({1}, type);
+  }
+
+  OpBuilder::InsertionGuard g(builder);
+  FuncOp funcOp = warpOp->getParentOfType<FuncOp>();
+  builder.setInsertionPointToStart(&funcOp.getBody().front());
+  return builder.create<memref::AllocaOp>(loc, memrefType);
+}
+
 namespace {
 
 struct TestVectorWarp
@@ -81,7 +100,8 @@ struct TestVectorWarp
     return "Test vector warp transformations";
   }
   void getDependentDialects(DialectRegistry &registry) const override {
-    registry.insert<VectorDialect, VectorExtDialect>();
+    registry.insert<memref::MemRefDialect, scf::SCFDialect, VectorDialect,
+                    VectorExtDialect>();
   }
 
   Option<bool> distributeTransferWriteOps{
@@ -101,6 +121,23 @@ struct TestVectorWarp
       *this, "rewrite-warp-ops-to-scf-if",
       llvm::cl::desc("Test rewriting of warp_execute_on_lane_0 to scf.if")};
 
+  Option<bool> rewriteWarpLaneLoopsToCpu{
+      *this, "rewrite-warp-lane-loops-to-cpu",
+      llvm::cl::desc("Test rewriting of warp_execute_on_lane_0 nested in lane "
+                     "loops for CPU execution"),
+      llvm::cl::init(false)};
+
+  Option<bool> parallelLanes{
+      *this, "parallel-lanes",
+      llvm::cl::desc("Execute the lanes of the lane loops in parallel"),
+      llvm::cl::init(false)};
+
+  Option<bool> butterflyReductions{
+      *this, "butterfly-reductions",
+      llvm::cl::desc("Test rewriting of vector.reduction to butterflies of "
+                     "vector.shuffle"),
+      llvm::cl::init(false)};
+
   void runOnOperation() override {
     FuncOp funcOp = getOperation();
     funcOp.walk([&](Operation *op) {
@@ -138,6 +175,17 @@ struct TestVectorWarp
           patterns, allocateGlobalSharedMemory);
       (void)applyPatternsAndFoldGreedily(funcOp, std::move(patterns));
     }
+    if (rewriteWarpLaneLoopsToCpu) {
+      RewritePatternSet patterns(ctx);
+      vector_ext::populateWarpLaneLoopToCpuPatterns(
+          patterns, allocateStackMemory, parallelLanes);
+      (void)applyPatternsAndFoldGreedily(funcOp, std::move(patterns));
+    }
+    if (butterflyReductions) {
+      RewritePatternSet patterns(ctx);
+      vector_ext::populateVectorReductionToButterflyShufflePatterns(patterns);
+      (void)applyPatternsAndFoldGreedily(funcOp, std::move(patterns));
+    }
   }
 };
 
@@ -52,3 +52,10 @@ sys.path.append(os.path.join(build_dir, "bin"))
 config.environment["PYTHONPATH"] = ":".join(sys.path)
 config.environment["PATH"] = ":".join(sys.path)
 project_root = os.path.dirname(os.path.dirname(__file__))
+
+# Enable the integration tests that execute AVX-512 code on hosts that support
+# it.
+if os.path.exists("/proc/cpuinfo"):
+  with open("/proc/cpuinfo") as cpuinfo:
+    if "avx512f" in cpuinfo.read().split():
+      config.available_features.add("avx512f")
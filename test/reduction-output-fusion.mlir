@@ -96,3 +96,133 @@ func @reduce(%in: tensor<8x16xf32>) -> tensor<8xf32> {
 // CHECK:   scf.yield %[[INNER]]#0, %[[INNER]]#1 : tensor<8xf32>, tensor<4xf32>
 // CHECK: }
 // CHECK: return %[[OUTER]]#0 : tensor<8xf32>
+
+// -----
+
+#map0 = affine_map<(d0) -> (d0)>
+#map1 = affine_map<(d0) -> ()>
+
+func @reduce(%in: tensor<16xf32>) -> tensor<f32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %c0 = arith.constant 0 : index
+  %c4 = arith.constant 4 : index
+  %c16 = arith.constant 16 : index
+  %0 = linalg.init_tensor [] : tensor<f32>
+  %fill = linalg.fill ins(%cst : f32) outs(%0 : tensor<f32>) -> tensor<f32>
+  %1 = scf.for %i = %c0 to %c16 step %c4
+      iter_args (%fill_ = %fill) -> (tensor<f32>) {
+    %2 = tensor.extract_slice %in[%i] [4] [1]
+      : tensor<16xf32> to tensor<4xf32>
+    %3 = linalg.generic {
+           indexing_maps = [#map0, #map1],
+           iterator_types = ["reduction"]}
+           ins(%2 : tensor<4xf32>)
+           outs(%fill_ : tensor<f32>) {
+    ^bb0(%arg0: f32, %arg1: f32):
+      %4 = arith.addf %arg0, %arg1 : f32
+      linalg.yield %4 : f32
+    } -> tensor<f32>
+    scf.yield %3 : tensor<f32>
+  }
+  return %1 : tensor<f32>
+}
+
+// CHECK-LABEL: func @reduce(
+// CHECK-SAME:    %[[INPUT:.*]]: tensor<16xf32>) -> tensor<f32> {
+
+// CHECK: %[[INIT:.*]] = linalg.init_tensor [] : tensor<f32>
+// CHECK: %[[FILL:.*]] = linalg.fill ins(%[[ZERO:.*]] : f32) outs(%[[INIT]] : tensor<f32>) -> tensor<f32>
+
+// CHECK: %[[LOOP:.*]]:2 = scf.for %[[I:.*]] = %{{.*}} to %{{.*}} step %{{.*}}
+// CHECK-SAME: iter_args(%[[FILL_:.*]] = %[[FILL]],
+// CHECK-SAME: %[[INIT_:.*]] = %[[INIT]]) -> (tensor<f32>, tensor<f32>) {
+
+// CHECK:   %[[IN_SUB:.*]] = tensor.extract_slice %[[INPUT]][%[[I]]] [4] [1] : tensor<16xf32> to tensor<4xf32>
+// CHECK:   %[[FILL_TILE:.*]] = linalg.fill ins(%[[ZERO]] : f32) outs(%[[INIT_]] : tensor<f32>) -> tensor<f32>
+
+// CHECK:   %[[REDUCE_TILE:.*]] = linalg.generic {
+// CHECK-SAME:  iterator_types = ["reduction"]}
+// CHECK-SAME:  ins(%[[IN_SUB]] : tensor<4xf32>)
+// CHECK-SAME:  outs(%[[FILL_TILE]] : tensor<f32>) {
+
+// CHECK:   %[[COMBINE:.*]] = linalg.generic {
+// CHECK-SAME:  iterator_types = []}
+// CHECK-SAME:  ins(%[[REDUCE_TILE]] : tensor<f32>)
+// CHECK-SAME:  outs(%[[FILL_]] : tensor<f32>) {
+// CHECK:       arith.addf
+// CHECK:   scf.yield %[[COMBINE]], %[[FILL_TILE]] : tensor<f32>, tensor<f32>
+// CHECK: }
+// CHECK: return %[[LOOP]]#0 : tensor<f32>
+
+// -----
+
+#map0 = affine_map<(d0, d1, d2) -> (d0, d1, d2)>
+#map1 = affine_map<(d0, d1, d2) -> (d0, d1)>
+
+func @reduce(%in: tensor<4x8x16xf32>) -> tensor<4x8xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %c0 = arith.constant 0 : index
+  %c2 = arith.constant 2 : index
+  %c4 = arith.constant 4 : index
+  %c8 = arith.constant 8 : index
+  %c16 = arith.constant 16 : index
+  %0 = linalg.init_tensor [4, 8] : tensor<4x8xf32>
+  %fill = linalg.fill ins(%cst : f32) outs(%0 : tensor<4x8xf32>)
+    -> tensor<4x8xf32>
+  %1 = scf.for %i = %c0 to %c4 step %c2
+      iter_args (%fill0_ = %fill) -> (tensor<4x8xf32>) {
+    %2 = scf.for %j = %c0 to %c8 step %c4
+        iter_args (%fill1_ = %fill0_) -> (tensor<4x8xf32>) {
+      %3 = scf.for %k = %c0 to %c16 step %c8
+          iter_args (%fill2_ = %fill1_) -> (tensor<4x8xf32>) {
+        %4 = tensor.extract_slice %in[%i, %j, %k] [2, 4, 8] [1, 1, 1]
+          : tensor<4x8x16xf32> to tensor<2x4x8xf32>
+        %5 = tensor.extract_slice %fill2_[%i, %j] [2, 4] [1, 1]
+          : tensor<4x8xf32> to tensor<2x4xf32>
+        %6 = linalg.generic {
+               indexing_maps = [#map0, #map1],
+               iterator_types = ["parallel", "parallel", "reduction"]}
+               ins(%4 : tensor<2x4x8xf32>)
+               outs(%5 : tensor<2x4xf32>) {
+        ^bb0(%arg0: f32, %arg1: f32):
+          %7 = arith.maxf %arg0, %arg1 : f32
+          linalg.yield %7 : f32
+        } -> tensor<2x4xf32>
+        %8 = tensor.insert_slice %6 into %fill2_[%i, %j] [2, 4] [1, 1]
+          : tensor<2x4xf32> into tensor<4x8xf32>
+        scf.yield %8 : tensor<4x8xf32>
+      }
+      scf.yield %3 : tensor<4x8xf32>
+    }
+    scf.yield %2 : tensor<4x8xf32>
+  }
+  return %1 : tensor<4x8xf32>
+}
+
+// CHECK-LABEL: func @reduce(
+// CHECK-SAME:    %[[INPUT:.*]]: tensor<4x8x16xf32>) -> tensor<4x8xf32> {
+
+// CHECK: %[[INIT:.*]] = linalg.init_tensor [4, 8] : tensor<4x8xf32>
+// CHECK: %[[INIT_TILE:.*]] = linalg.init_tensor [2, 4] : tensor<2x4xf32>
+// CHECK: %[[FILL:.*]] = linalg.fill ins(%[[ZERO:.*]] : f32) outs(%[[INIT]] : tensor<4x8xf32>) -> tensor<4x8xf32>
+
+// CHECK: %[[LOOP_I:.*]]:2 = scf.for %[[I:.*]] = {{.*}} iter_args(%{{.*}} = %[[FILL]], %{{.*}} = %[[INIT_TILE]]) -> (tensor<4x8xf32>, tensor<2x4xf32>) {
+// CHECK:   %[[LOOP_J:.*]]:2 = scf.for %[[J:.*]] = {{.*}} -> (tensor<4x8xf32>, tensor<2x4xf32>) {
+// CHECK:     %[[LOOP_K:.*]]:2 = scf.for %[[K:.*]] = {{.*}} iter_args(%[[FILL_:.*]] = %{{.*}}, %[[INIT_TILE_:.*]] = %{{.*}}) -> (tensor<4x8xf32>, tensor<2x4xf32>) {
+// CHECK:       %[[IN_SUB:.*]] = tensor.extract_slice %[[INPUT]][%[[I]], %[[J]], %[[K]]] [2, 4, 8] [1, 1, 1]
+// CHECK:       %[[OUT_SUB:.*]] = tensor.extract_slice %[[FILL_]][%[[I]], %[[J]]] [2, 4] [1, 1]
+// CHECK:       %[[FILL_TILE:.*]] = linalg.fill ins(%[[ZERO]] : f32) outs(%[[INIT_TILE_]] : tensor<2x4xf32>) -> tensor<2x4xf32>
+// CHECK:       %[[REDUCE_TILE:.*]] = linalg.generic {
+// CHECK-SAME:    iterator_types = ["parallel", "parallel", "reduction"]}
+// CHECK-SAME:    ins(%[[IN_SUB]] : tensor<2x4x8xf32>)
+// CHECK-SAME:    outs(%[[FILL_TILE]] : tensor<2x4xf32>) {
+// CHECK:       %[[COMBINE:.*]] = linalg.generic {
+// CHECK-SAME:    iterator_types = ["parallel", "parallel"]}
+// CHECK-SAME:    ins(%[[REDUCE_TILE]] : tensor<2x4xf32>)
+// CHECK-SAME:    outs(%[[OUT_SUB]] : tensor<2x4xf32>) {
+// CHECK:         arith.maxf
+// CHECK:       %[[UPDATE:.*]] = tensor.insert_slice %[[COMBINE]] into %[[FILL_]][%[[I]], %[[J]]] [2, 4] [1, 1]
+// CHECK:       scf.yield %[[UPDATE]], %[[FILL_TILE]] : tensor<4x8xf32>, tensor<2x4xf32>
+// CHECK:     scf.yield %[[LOOP_K]]#0, %[[LOOP_K]]#1
+// CHECK:   scf.yield %[[LOOP_J]]#0, %[[LOOP_J]]#1
+// CHECK: return %[[LOOP_I]]#0 : tensor<4x8xf32>
@@ -0,0 +1,38 @@
+// RUN: mlir-proto-opt %s\
+// RUN: -linalg-split-reduction="anchor-func=reduce split-ratio=8 inner-parallel" |\
+// RUN: FileCheck %s
+
+//   CHECK-DAG: #[[$IN:.*]] = affine_map<(d0, d1) -> (d0, d1)>
+//   CHECK-DAG: #[[$PARTIAL:.*]] = affine_map<(d0, d1) -> (d1)>
+//   CHECK-DAG: #[[$ID:.*]] = affine_map<(d0) -> (d0)>
+//   CHECK-DAG: #[[$OUT:.*]] = affine_map<(d0) -> ()>
+
+// CHECK-LABEL: func @reduce
+//  CHECK-SAME:   %[[IN:[0-9a-z]+]]: tensor<64xf32>
+//  CHECK-SAME:   %[[OUT:[0-9a-z]+]]: tensor<f32>
+func @reduce(%in: tensor<64xf32>, %out: tensor<f32>) -> tensor<f32> {
+  //  CHECK-DAG: %[[NEG_INF:.*]] = arith.constant 0xFF800000 : f32
+  //  CHECK-DAG: %[[EXPANDED:.*]] = tensor.expand_shape %[[IN]] {{\[}}[0, 1]] : tensor<64xf32> into tensor<8x8xf32>
+  //  CHECK-DAG: %[[INIT:.*]] = linalg.init_tensor [8] : tensor<8xf32>
+  //      CHECK: %[[FILL:.*]] = linalg.fill ins(%[[NEG_INF]] : f32) outs(%[[INIT]] : tensor<8xf32>)
+  //      CHECK: %[[PARTIAL:.*]] = linalg.generic
+  // CHECK-SAME:   indexing_maps = [#[[$IN]], #[[$PARTIAL]]]
+  // CHECK-SAME:   iterator_types = ["reduction", "parallel"]
+  // CHECK-SAME:   ins(%[[EXPANDED]] : tensor<8x8xf32>) outs(%[[FILL]] : tensor<8xf32>)
+  //      CHECK:   arith.maxf
+  //      CHECK: %[[RES:.*]] = linalg.generic
+  // CHECK-SAME:   indexing_maps = [#[[$ID]], #[[$OUT]]]
+  // CHECK-SAME:   iterator_types = ["reduction"]
+  // CHECK-SAME:   ins(%[[PARTIAL]] : tensor<8xf32>) outs(%[[OUT]] : tensor<f32>)
+  //      CHECK:   arith.maxf
+  //      CHECK: return %[[RES]]
+  %0 = linalg.generic {
+    indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> ()>],
+    iterator_types = ["reduction"]
+  } ins(%in : tensor<64xf32>) outs(%out : tensor<f32>) {
+  ^bb0(%arg0: f32, %arg1: f32):
+    %1 = arith.maxf %arg0, %arg1 : f32
+    linalg.yield %1 : f32
+  } -> tensor<f32>
+  return %0 : tensor<f32>
+}
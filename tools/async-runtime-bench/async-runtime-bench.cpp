@@ -0,0 +1,237 @@
+//===- async-runtime-bench.cpp - Async runtime executor benchmark ---------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the task spawn and completion throughput of the executors of the
+// sandbox async runtime:
+//   - flat: the main thread spawns independent tasks and waits for all of them
+//     with an async group, as the lowering of a 1-D in_parallel op does,
+//   - tree: every task spawns two child tasks until the given depth, such that
+//     most of the tasks are spawned by the worker threads themselves,
+//   - regions: the main thread runs a sequence of short parallel regions of
+//     one task per worker thread, which measures the latency of the wake ups,
+//   - parallel_for: the same regions run with `mlirAsyncRuntimeParallelFor`
+//     instead of tokens and groups.
+// The number of heap allocations performed by the runtime during an additional
+// repetition of the flat workload is reported, it is expected to be zero once
+// the runtime pools are warmed up.
+// The executor is selected with environment variables read once when the
+// default runtime is created, every configuration thus runs in its own child
+// process.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ExecutionEngine/AsyncRuntimeExtensions.h"
+#include "mlir/ExecutionEngine/AsyncRuntime.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace mlir::runtime;
+
+static llvm::cl::opt<int> numTasks("num-tasks",
+                                   llvm::cl::desc("Number of flat tasks"),
+                                   llvm::cl::init(1 << 18));
+static llvm::cl::opt<int> treeDepth("tree-depth",
+                                    llvm::cl::desc("Depth of the task tree"),
+                                    llvm::cl::init(18));
+static llvm::cl::opt<int>
+    numRegions("num-regions", llvm::cl::desc("Number of parallel regions"),
+               llvm::cl::init(1 << 14));
+static llvm::cl::opt<int> numRepetitions(
+    "num-repetitions", llvm::cl::desc("Number of repetitions per workload"),
+    llvm::cl::init(5));
+static llvm::cl::list<unsigned>
+    numThreads("num-threads", llvm::cl::desc("Numbers of worker threads"),
+               llvm::cl::CommaSeparated);
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+//===----------------------------------------------------------------------===//
+// Flat workload.
+//===----------------------------------------------------------------------===//
+
+struct FlatTask {
+  AsyncToken *token;
+};
+
+void runFlatTask(void *handle) {
+  mlirAsyncRuntimeEmplaceToken(static_cast<FlatTask *>(handle)->token);
+}
+
+double runFlat() {
+  std::unique_ptr<FlatTask[]> tasks(new FlatTask[numTasks]);
+  AsyncGroup *group = mlirAsyncRuntimeCreateGroup(numTasks);
+  auto start = Clock::now();
+  for (int i = 0; i < numTasks; ++i) {
+    tasks[i].token = mlirAsyncRuntimeCreateToken();
+    mlirAsyncRuntimeAddTokenToGroup(tasks[i].token, group);
+    mlirAsyncRuntimeExecute(&tasks[i], runFlatTask);
+  }
+  mlirAsyncRuntimeAwaitAllInGroup(group);
+  auto end = Clock::now();
+  for (int i = 0; i < numTasks; ++i)
+    mlirAsyncRuntimeDropRef(tasks[i].token, 1);
+  mlirAsyncRuntimeDropRef(group, 1);
+  return numTasks / std::chrono::duration<double>(end - start).count();
+}
+
+//===----------------------------------------------------------------------===//
+// Tree workload. The nodes are preallocated in heap order: the children of the
+// node `i` are the nodes `2i + 1` and `2i + 2`.
+//===----------------------------------------------------------------------===//
+
+struct Tree;
+
+struct TreeNode {
+  Tree *tree;
+  int64_t index;
+};
+
+struct Tree {
+  std::unique_ptr<TreeNode[]> nodes;
+  int64_t numInnerNodes;
+  std::atomic<int64_t> numPendingLeaves;
+  AsyncToken *done;
+};
+
+void runTreeNode(void *handle) {
+  auto *node = static_cast<TreeNode *>(handle);
+  Tree *tree = node->tree;
+  if (node->index < tree->numInnerNodes) {
+    mlirAsyncRuntimeExecute(&tree->nodes[2 * node->index + 1], runTreeNode);
+    mlirAsyncRuntimeExecute(&tree->nodes[2 * node->index + 2], runTreeNode);
+    return;
+  }
+  if (tree->numPendingLeaves.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    mlirAsyncRuntimeEmplaceToken(tree->done);
+}
+
+double runTree() {
+  int64_t numNodes = (int64_t(1) << (treeDepth + 1)) - 1;
+  Tree tree;
+  tree.nodes.reset(new TreeNode[numNodes]);
+  for (int64_t i = 0; i < numNodes; ++i)
+    tree.nodes[i] = TreeNode{&tree, i};
+  tree.numInnerNodes = (int64_t(1) << treeDepth) - 1;
+  tree.numPendingLeaves = int64_t(1) << treeDepth;
+  tree.done = mlirAsyncRuntimeCreateToken();
+  auto start = Clock::now();
+  mlirAsyncRuntimeExecute(&tree.nodes[0], runTreeNode);
+  mlirAsyncRuntimeAwaitToken(tree.done);
+  auto end = Clock::now();
+  mlirAsyncRuntimeDropRef(tree.done, 1);
+  return numNodes / std::chrono::duration<double>(end - start).count();
+}
+
+//===----------------------------------------------------------------------===//
+// Regions workload.
+//===----------------------------------------------------------------------===//
+
+// Number of tasks per region, one per worker thread.
+unsigned regionSize;
+
+double runRegions() {
+  std::unique_ptr<FlatTask[]> tasks(new FlatTask[regionSize]);
+  auto start = Clock::now();
+  for (int region = 0; region < numRegions; ++region) {
+    AsyncGroup *group = mlirAsyncRuntimeCreateGroup(regionSize);
+    for (unsigned i = 0; i < regionSize; ++i) {
+      tasks[i].token = mlirAsyncRuntimeCreateToken();
+      mlirAsyncRuntimeAddTokenToGroup(tasks[i].token, group);
+      mlirAsyncRuntimeExecute(&tasks[i], runFlatTask);
+    }
+    mlirAsyncRuntimeAwaitAllInGroup(group);
+    for (unsigned i = 0; i < regionSize; ++i)
+      mlirAsyncRuntimeDropRef(tasks[i].token, 1);
+    mlirAsyncRuntimeDropRef(group, 1);
+  }
+  auto end = Clock::now();
+  return numRegions / std::chrono::duration<double>(end - start).count();
+}
+
+void runParallelForBody(int64_t begin, int64_t end, void *ctx) {}
+
+double runParallelForRegions() {
+  auto start = Clock::now();
+  for (int region = 0; region < numRegions; ++region) {
+    mlirAsyncRuntimeParallelFor(0, regionSize, /*grain=*/1, runParallelForBody,
+                                /*ctx=*/nullptr);
+  }
+  auto end = Clock::now();
+  return numRegions / std::chrono::duration<double>(end - start).count();
+}
+
+double best(double (*workload)()) {
+  double result = 0.0;
+  for (int i = 0; i < numRepetitions; ++i)
+    result = std::max(result, workload());
+  return result;
+}
+
+// Runs the workloads with the given executor configuration in a child process.
+void runConfiguration(const char *executor, unsigned threads) {
+  llvm::outs().flush();
+  pid_t pid = fork();
+  if (pid < 0) {
+    llvm::errs() << "fork failed\n";
+    std::exit(1);
+  }
+  if (pid > 0) {
+    waitpid(pid, nullptr, 0);
+    return;
+  }
+  setenv("SANDBOX_ASYNC_EXECUTOR", executor, /*overwrite=*/1);
+  setenv("SANDBOX_ASYNC_NUM_THREADS", std::to_string(threads).c_str(),
+         /*overwrite=*/1);
+  double flat = best(runFlat);
+  int64_t numHeapAllocations =
+      mlirAsyncRuntimeGetAllocationCounters().numHeapAllocations;
+  runFlat();
+  numHeapAllocations =
+      mlirAsyncRuntimeGetAllocationCounters().numHeapAllocations -
+      numHeapAllocations;
+  double tree = best(runTree);
+  regionSize = threads;
+  double regions = best(runRegions);
+  double parallelForRegions = best(runParallelForRegions);
+  llvm::outs() << llvm::format(
+      "%-14s %8u %14.3e %14.3e %14.3e %14.3e %12lld\n", executor, threads,
+      flat, tree, regions, parallelForRegions,
+      static_cast<long long>(numHeapAllocations));
+  llvm::outs().flush();
+  std::exit(0);
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  llvm::InitLLVM y(argc, argv);
+  llvm::cl::ParseCommandLineOptions(argc, argv,
+                                    "Async runtime executor benchmark\n");
+  if (numThreads.empty())
+    numThreads.push_back(std::max(std::thread::hardware_concurrency(), 1u));
+
+  llvm::outs() << "executor        threads   flat tasks/s   tree tasks/s"
+                  "      regions/s pfor regions/s  heap allocs\n";
+  for (unsigned threads : numThreads) {
+    runConfiguration("thread_pool", threads);
+    runConfiguration("work_stealing", threads);
+  }
+  return 0;
+}